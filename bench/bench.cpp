@@ -0,0 +1,597 @@
+/**
+ * R3D - Benchmark suite
+ *
+ * Renders synthetic stress scenes along fixed camera paths for a fixed number of frames in a
+ * hidden window, and writes a JSON report with the CPU submission time, the GPU time of each
+ * pass (see `R3D_FLAG_GPU_PROFILING`), the heap allocations and the frame counters of each scene.
+ *
+ * The camera paths, the random seed and the time steps are fixed, so two runs of the same
+ * version render the same frames and their reports can be compared to track regressions.
+ *
+ * No GPU is required, the suite runs on Mesa llvmpipe, e.g. on a CI machine:
+ *     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./r3d_bench --output report.json
+ *
+ * Usage: r3d_bench [options]
+ *     --list                  Lists the scenes of the suite
+ *     --scene <name>          Runs only this scene of the suite, can be repeated
+ *     --frames <n>            Number of measured frames per scene (default 300)
+ *     --warmup <n>            Number of frames rendered before measuring (default 30)
+ *     --size <w>x<h>          Resolution of the window and of the rendering (default 1280x720)
+ *     --output <file>         Path of the JSON report (default 'r3d_bench.json')
+ *
+ *   Any of the following options runs a single custom scene instead of the suite:
+ *     --models <n>            Number of static models, cubes and spheres on a grid
+ *     --lights <n>            Number of lights above the grid
+ *     --shadows <0|1>         Whether the lights are shadow casting spotlights or omni lights without shadows
+ *     --particles <n>         Number of particles alive in a CPU particle system
+ *     --characters <n>        Number of animated characters ('robot.glb' of the examples)
+ *     --sprites <n>           Number of billboard sprites
+ *     --path <orbit|fly>      Camera path, around the scene or through it
+ */
+
+#include <r3d.h>
+
+#if defined(__APPLE__)
+#   define GL_SILENCE_DEPRECATION
+#   include <OpenGL/gl3.h>
+#else
+#   include <glad.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef R3D_ASSETS_PATH
+#   define R3D_ASSETS_PATH "assets/"
+#endif
+
+
+/* Allocation counting */
+
+// The C++ heap allocations of the whole program (the renderer included) go through these
+// replacements. The C objects and raylib allocate with 'malloc', they are not counted.
+
+static std::atomic<size_t> gAllocCount{ 0 };
+static std::atomic<size_t> gAllocBytes{ 0 };
+
+void* operator new(std::size_t size)
+{
+    gAllocCount.fetch_add(1, std::memory_order_relaxed);
+    gAllocBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+/* Scenes */
+
+enum class CameraPath {
+    ORBIT,      ///< Turns once around the scene, looking at its center.
+    FLY         ///< Crosses the scene at low height, looking ahead.
+};
+
+struct SceneDesc {
+    std::string name;
+    int models;
+    int lights;
+    bool shadows;
+    int particles;
+    int characters;
+    int sprites;
+    CameraPath path;
+};
+
+static const SceneDesc SUITE[] = {
+    { "models_2k",          2000,   1,  false,  0,      0,  0,      CameraPath::ORBIT },
+    { "lights_8",           400,    8,  false,  0,      0,  0,      CameraPath::ORBIT },
+    { "shadows_4",          400,    4,  true,   0,      0,  0,      CameraPath::ORBIT },
+    { "particles_4k",       0,      1,  false,  4096,   0,  0,      CameraPath::ORBIT },
+    { "characters_16",      0,      1,  true,   0,      16, 0,      CameraPath::ORBIT },
+    { "sprites_4k",         0,      1,  false,  0,      0,  4096,   CameraPath::ORBIT },
+    { "mixed_fly",          1000,   4,  true,   2048,   8,  1024,   CameraPath::FLY   },
+};
+
+static constexpr float GRID_SPACING = 2.5f;
+static constexpr float TIME_STEP = 1.0f / 60.0f;
+static constexpr unsigned int RANDOM_SEED = 1234;
+
+
+/* Measurements */
+
+struct PassTime {
+    const char* zone;       ///< Name of the GPU zone, see `R3D_GetGPUZone`.
+    const char* key;        ///< Key of the pass in the report.
+    double sum = 0.0;
+    int count = 0;
+};
+
+struct SceneResult {
+    SceneDesc desc;
+    int characters = 0;                 ///< Characters actually loaded, zero if the asset is missing.
+    std::vector<double> submitTimes;    ///< CPU time from the updates to the return of `R3D_End`, in milliseconds.
+    std::vector<double> frameTimes;     ///< CPU time including the buffer swap, in milliseconds.
+    size_t allocCount = 0;
+    size_t allocBytes = 0;
+    std::vector<PassTime> passes;
+    double counters[15] = { 0 };        ///< Sums of the counters of `R3D_FrameStats`, in declaration order.
+};
+
+static const char* COUNTER_NAMES[15] = {
+    "objectsSubmitted", "objectsCulledFrustum", "objectsCulledLayer", "objectsCulledOcclusion", "objectsCulledDistance", "objectsCulledScreenSize",
+    "sceneDraws", "shadowDraws", "spriteBatchDraws", "triangles",
+    "shaderBinds", "textureBinds", "uniformUploads",
+    "particlesSimulated", "shadowMapsUpdated"
+};
+
+static void accumulateCounters(SceneResult& result, const R3D_FrameStats& stats)
+{
+    const int values[15] = {
+        stats.objectsSubmitted, stats.objectsCulledFrustum, stats.objectsCulledLayer, stats.objectsCulledOcclusion, stats.objectsCulledDistance, stats.objectsCulledScreenSize,
+        stats.sceneDraws, stats.shadowDraws, stats.spriteBatchDraws, stats.triangles,
+        stats.shaderBinds, stats.textureBinds, stats.uniformUploads,
+        stats.particlesSimulated, stats.shadowMapsUpdated
+    };
+
+    for (int i = 0; i < 15; i++) {
+        result.counters[i] += values[i];
+    }
+}
+
+static void accumulatePassTimes(SceneResult& result)
+{
+    int count = R3D_GetGPUZoneCount();
+
+    for (int i = 0; i < count; i++) {
+        R3D_GPUZone zone = R3D_GetGPUZone(i);
+        for (PassTime& pass : result.passes) {
+            if (std::strcmp(zone.name, pass.zone) == 0) {
+                pass.sum += zone.time;
+                pass.count++;
+            }
+        }
+    }
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static double mean(const std::vector<double>& values)
+{
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+
+/* Scene execution */
+
+static Camera3D getCamera(CameraPath path, float extent, float t)
+{
+    Camera3D camera{};
+    camera.up = { 0, 1, 0 };
+    camera.fovy = 60.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    switch (path) {
+        case CameraPath::ORBIT: {
+            float angle = 2.0f * PI * t;
+            float radius = 0.75f * extent + 8.0f;
+            camera.position = { radius * std::cos(angle), 0.3f * extent + 4.0f, radius * std::sin(angle) };
+            camera.target = { 0, 0, 0 };
+        } break;
+        case CameraPath::FLY: {
+            float x = -0.5f * extent - 5.0f + t * (extent + 10.0f);
+            camera.position = { x, 2.0f, 0.25f * GRID_SPACING };
+            camera.target = { x + 1.0f, 1.8f, 0.25f * GRID_SPACING };
+        } break;
+    }
+
+    return camera;
+}
+
+static Vector3 getGridPosition(int index, int side, float y)
+{
+    float offset = 0.5f * (side - 1) * GRID_SPACING;
+    return {
+        (index % side) * GRID_SPACING - offset, y,
+        (index / side) * GRID_SPACING - offset
+    };
+}
+
+static SceneResult runScene(const SceneDesc& desc, int warmupFrames, int measuredFrames)
+{
+    SceneResult result;
+    result.desc = desc;
+    result.passes = {
+        { "Frame", "frame" }, { "Shadow pass", "shadowPass" }, { "Scene pass", "scenePass" },
+        { "Bloom", "bloom" }, { "Post process", "postProcess" }, { "Present", "present" }
+    };
+
+    SetRandomSeed(RANDOM_SEED);
+
+    int objectCount = std::max({ desc.models, desc.sprites, desc.characters * 4, 16 });
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+    float extent = side * GRID_SPACING;
+
+    // Static geometry
+
+    Image image = GenImageChecked(64, 64, 8, 8, GRAY, LIGHTGRAY);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    R3D_Model ground = R3D_LoadModelFromMesh(GenMeshPlane(extent + 10.0f, extent + 10.0f, 1, 1));
+    R3D_SetMapAlbedo(&ground, 0, &texture, WHITE);
+    ground.shadow = R3D_CAST_OFF;
+
+    R3D_Model cube = R3D_LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+    R3D_Model sphere = R3D_LoadModelFromMesh(GenMeshSphere(0.5f, 16, 32));
+
+    // Animated characters
+
+    std::vector<R3D_Model> characters;
+
+    if (desc.characters > 0 && FileExists(R3D_ASSETS_PATH "robot.glb")) {
+        for (int i = 0; i < desc.characters; i++) {
+            R3D_Model robot = R3D_LoadModel(R3D_ASSETS_PATH "robot.glb");
+            R3D_LoadModelAnimations(&robot, R3D_ASSETS_PATH "robot.glb");
+            characters.push_back(robot);
+        }
+    }
+
+    result.characters = static_cast<int>(characters.size());
+
+    // Sprites
+
+    R3D_Sprite sprite = R3D_CreateSprite(texture, 1, 1);
+
+    // Particles, the emission rate keeps the requested count alive
+
+    Mesh particleMesh = GenMeshSphere(0.05f, 8, 16);
+    R3D_Material particleMaterial = R3D_CreateMaterial(R3D_GetDefaultMaterialConfig());
+    R3D_ParticleSystemCPU* particles = nullptr;
+
+    if (desc.particles > 0) {
+        particles = R3D_LoadParticleEmitterCPU(&particleMesh, &particleMaterial, desc.particles);
+        particles->initialVelocity = { 0, 6.0f, 0 };
+        particles->spreadAngle = 45.0f;
+        particles->lifetime = 2.0f;
+        particles->emissionRate = desc.particles / particles->lifetime;
+        R3D_UpdateParticleEmitterCPUAABB(particles);
+    }
+
+    // Lights
+
+    std::vector<R3D_Light> lights;
+    int lightSide = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(desc.lights))));
+
+    for (int i = 0; i < desc.lights; i++) {
+        Vector3 position = getGridPosition(i, lightSide, 6.0f);
+        position.x *= extent / (lightSide * GRID_SPACING);
+        position.z *= extent / (lightSide * GRID_SPACING);
+
+        R3D_Light light;
+
+        if (desc.shadows) {
+            light = R3D_CreateLight(R3D_SPOTLIGHT, 1024);
+            R3D_SetLightPositionTarget(light, position, { position.x, 0, position.z + 1.0f });
+            R3D_SetLightOuterCutOff(light, 60.0f);
+        } else {
+            light = R3D_CreateLight(R3D_OMNILIGHT, 0);
+            R3D_SetLightPosition(light, position);
+        }
+
+        R3D_SetLightRange(light, std::max(extent / lightSide, 10.0f) * 2.0f);
+        R3D_SetLightActive(light, true);
+        lights.push_back(light);
+    }
+
+    // Frames
+
+    int totalFrames = warmupFrames + measuredFrames;
+
+    result.submitTimes.reserve(measuredFrames);
+    result.frameTimes.reserve(measuredFrames);
+
+    for (int frame = 0; frame < totalFrames; frame++)
+    {
+        bool measured = (frame >= warmupFrames);
+        Camera3D camera = getCamera(desc.path, extent, static_cast<float>(frame) / totalFrames);
+
+        size_t allocCount = gAllocCount.load(std::memory_order_relaxed);
+        size_t allocBytes = gAllocBytes.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        if (particles != nullptr) {
+            R3D_UpdateParticleEmitterCPU(particles, TIME_STEP);
+        }
+
+        for (size_t i = 0; i < characters.size(); i++) {
+            R3D_UpdateModelAnimation(&characters[i], "Robot_Dance", frame + 7 * static_cast<int>(i));
+        }
+
+        BeginDrawing();
+            R3D_Begin(camera);
+                R3D_DrawModel(&ground);
+                for (int i = 0; i < desc.models; i++) {
+                    R3D_DrawModelEx((i % 2) ? &sphere : &cube, getGridPosition(i, side, 0.5f), 1.0f);
+                }
+                for (size_t i = 0; i < characters.size(); i++) {
+                    R3D_DrawModelEx(&characters[i], getGridPosition(static_cast<int>(4 * i), side, 0.0f), 0.5f);
+                }
+                for (int i = 0; i < desc.sprites; i++) {
+                    Vector3 position = getGridPosition(i, side, 1.75f);
+                    position.x += 0.5f * GRID_SPACING;
+                    R3D_DrawSpriteEx(&sprite, position, 1.0f);
+                }
+                if (particles != nullptr) {
+                    R3D_DrawParticleSystemCPU(particles);
+                }
+            R3D_End();
+
+        auto submitted = std::chrono::steady_clock::now();
+        size_t frameAllocCount = gAllocCount.load(std::memory_order_relaxed) - allocCount;
+        size_t frameAllocBytes = gAllocBytes.load(std::memory_order_relaxed) - allocBytes;
+
+        EndDrawing();
+
+        auto presented = std::chrono::steady_clock::now();
+
+        // Waiting for the GPU after each frame (outside of the measured time) makes
+        // the GPU timings of exactly one frame available at the end of the next one
+
+        glFinish();
+
+        if (!measured) {
+            continue;
+        }
+
+        result.submitTimes.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        result.frameTimes.push_back(std::chrono::duration<double, std::milli>(presented - start).count());
+        result.allocCount += frameAllocCount;
+        result.allocBytes += frameAllocBytes;
+
+        accumulateCounters(result, R3D_GetFrameStats());
+        accumulatePassTimes(result);
+    }
+
+    // Cleanup
+
+    for (R3D_Light light : lights) {
+        R3D_DestroyLight(light);
+    }
+
+    if (particles != nullptr) {
+        R3D_UnloadParticleEmitterCPU(particles);
+    }
+
+    for (R3D_Model& robot : characters) {
+        R3D_UnloadModel(&robot);
+    }
+
+    R3D_UnloadModel(&sphere);
+    R3D_UnloadModel(&cube);
+    R3D_UnloadModel(&ground);
+
+    UnloadMesh(particleMesh);
+    UnloadTexture(texture);
+
+    return result;
+}
+
+
+/* Report */
+
+static std::string jsonString(const char* str)
+{
+    std::string out = "\"";
+    for (const char* c = str ? str : ""; *c; c++) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20) out += *c;
+    }
+    return out + "\"";
+}
+
+static bool writeReport(const char* fileName, const std::vector<SceneResult>& results, int width, int height, int warmupFrames, int measuredFrames)
+{
+    FILE* file = std::fopen(fileName, "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"gl\": { \"vendor\": %s, \"renderer\": %s, \"version\": %s },\n",
+        jsonString(reinterpret_cast<const char*>(glGetString(GL_VENDOR))).c_str(),
+        jsonString(reinterpret_cast<const char*>(glGetString(GL_RENDERER))).c_str(),
+        jsonString(reinterpret_cast<const char*>(glGetString(GL_VERSION))).c_str());
+    std::fprintf(file, "  \"config\": { \"width\": %d, \"height\": %d, \"warmupFrames\": %d, \"measuredFrames\": %d },\n",
+        width, height, warmupFrames, measuredFrames);
+    std::fprintf(file, "  \"scenes\": [\n");
+
+    for (size_t s = 0; s < results.size(); s++)
+    {
+        const SceneResult& r = results[s];
+        const SceneDesc& d = r.desc;
+        double frames = static_cast<double>(std::max<size_t>(r.submitTimes.size(), 1));
+
+        std::fprintf(file, "    {\n");
+        std::fprintf(file, "      \"name\": %s,\n", jsonString(d.name.c_str()).c_str());
+        std::fprintf(file, "      \"params\": { \"models\": %d, \"lights\": %d, \"shadows\": %s, \"particles\": %d, \"characters\": %d, \"sprites\": %d, \"path\": \"%s\" },\n",
+            d.models, d.lights, d.shadows ? "true" : "false", d.particles, r.characters, d.sprites,
+            d.path == CameraPath::ORBIT ? "orbit" : "fly");
+        std::fprintf(file, "      \"cpu\": { \"submitMean\": %.4f, \"submitMedian\": %.4f, \"submitP95\": %.4f, \"submitMax\": %.4f, \"frameMean\": %.4f },\n",
+            mean(r.submitTimes), percentile(r.submitTimes, 0.5), percentile(r.submitTimes, 0.95),
+            percentile(r.submitTimes, 1.0), mean(r.frameTimes));
+
+        std::fprintf(file, "      \"gpu\": {");
+        for (size_t i = 0; i < r.passes.size(); i++) {
+            const PassTime& pass = r.passes[i];
+            double time = (pass.count > 0) ? pass.sum / pass.count : 0.0;
+            std::fprintf(file, "%s \"%s\": %.4f", (i > 0) ? "," : "", pass.key, time);
+        }
+        std::fprintf(file, " },\n");
+
+        std::fprintf(file, "      \"allocations\": { \"count\": %zu, \"bytes\": %zu, \"countPerFrame\": %.2f },\n",
+            r.allocCount, r.allocBytes, r.allocCount / frames);
+
+        std::fprintf(file, "      \"countersPerFrame\": {");
+        for (int i = 0; i < 15; i++) {
+            std::fprintf(file, "%s \"%s\": %.2f", (i > 0) ? "," : "", COUNTER_NAMES[i], r.counters[i] / frames);
+        }
+        std::fprintf(file, " }\n");
+
+        std::fprintf(file, "    }%s\n", (s + 1 < results.size()) ? "," : "");
+    }
+
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+
+    return true;
+}
+
+
+/* Command line */
+
+static bool parseInt(const char* str, int* value)
+{
+    char* end = nullptr;
+    long v = std::strtol(str, &end, 10);
+    if (end == str || *end != '\0' || v < 0) return false;
+    *value = static_cast<int>(v);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int width = 1280, height = 720;
+    int warmupFrames = 30, measuredFrames = 300;
+    const char* output = "r3d_bench.json";
+
+    std::vector<std::string> selected;
+    SceneDesc custom = { "custom", 0, 1, false, 0, 0, 0, CameraPath::ORBIT };
+    bool useCustom = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (arg == "--list") {
+            for (const SceneDesc& desc : SUITE) std::printf("%s\n", desc.name.c_str());
+            return 0;
+        }
+
+        if (value == nullptr) {
+            std::fprintf(stderr, "Missing value for '%s'\n", arg.c_str());
+            return 1;
+        }
+
+        auto customInt = [&](int* dst) {
+            useCustom = true;
+            return parseInt(value, dst);
+        };
+
+        int shadows = 0;
+
+        if (arg == "--scene") selected.push_back(value);
+        else if (arg == "--frames") ok = parseInt(value, &measuredFrames) && measuredFrames > 0;
+        else if (arg == "--warmup") ok = parseInt(value, &warmupFrames);
+        else if (arg == "--size") ok = (std::sscanf(value, "%dx%d", &width, &height) == 2) && width > 0 && height > 0;
+        else if (arg == "--output") output = value;
+        else if (arg == "--models") ok = customInt(&custom.models);
+        else if (arg == "--lights") ok = customInt(&custom.lights);
+        else if (arg == "--particles") ok = customInt(&custom.particles);
+        else if (arg == "--characters") ok = customInt(&custom.characters);
+        else if (arg == "--sprites") ok = customInt(&custom.sprites);
+        else if (arg == "--shadows") {
+            ok = customInt(&shadows);
+            custom.shadows = (shadows != 0);
+        }
+        else if (arg == "--path") {
+            useCustom = true;
+            ok = (std::strcmp(value, "orbit") == 0) || (std::strcmp(value, "fly") == 0);
+            custom.path = (std::strcmp(value, "fly") == 0) ? CameraPath::FLY : CameraPath::ORBIT;
+        }
+        else {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return 1;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "Invalid value '%s' for '%s'\n", value, arg.c_str());
+            return 1;
+        }
+
+        i++;
+    }
+
+    std::vector<SceneDesc> scenes;
+
+    if (useCustom) {
+        scenes.push_back(custom);
+    } else {
+        for (const SceneDesc& desc : SUITE) {
+            if (selected.empty() || std::find(selected.begin(), selected.end(), desc.name) != selected.end()) {
+                scenes.push_back(desc);
+            }
+        }
+    }
+
+    if (scenes.empty()) {
+        std::fprintf(stderr, "No scene to run, see '--list'\n");
+        return 1;
+    }
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(width, height, "R3D - Bench");
+
+    R3D_InitEx(width, height, R3D_FLAG_GPU_PROFILING);
+
+    std::vector<SceneResult> results;
+
+    for (const SceneDesc& desc : scenes) {
+        std::fprintf(stderr, "Running '%s'...\n", desc.name.c_str());
+        results.push_back(runScene(desc, warmupFrames, measuredFrames));
+    }
+
+    bool written = writeReport(output, results, width, height, warmupFrames, measuredFrames);
+
+    R3D_Close();
+    CloseWindow();
+
+    if (!written) {
+        std::fprintf(stderr, "Failed to write '%s'\n", output);
+        return 1;
+    }
+
+    std::fprintf(stderr, "Report written to '%s'\n", output);
+
+    return 0;
+}
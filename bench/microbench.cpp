@@ -0,0 +1,340 @@
+/**
+ * R3D - CPU kernel microbenchmarks
+ *
+ * Measures the pure math kernels of the hot CPU paths at several data sizes. This program
+ * is built from the GL-free sources of these kernels only, without the renderer, and never
+ * creates a window or a GL context, so it can run on any machine.
+ *
+ * Each kernel is run repeatedly for at least the minimum time, then the average time per
+ * call and per processed item is printed.
+ *
+ * Usage: r3d_microbench [options]
+ *     --filter <text>         Runs only the kernels whose name contains this text
+ *     --min-time <ms>         Minimum measuring time per kernel and size (default 200)
+ */
+
+#include <r3d.h>
+
+#include "detail/frustum.hpp"
+#include "detail/math.h"
+#include "objects/model.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string gFilter;
+static double gMinTime = 200.0;
+
+static volatile float gSink = 0.0f;     ///< Receives the results so that the kernels are not optimized out.
+
+
+/* Harness */
+
+static bool isSelected(const char* kernel)
+{
+    return gFilter.empty() || std::strstr(kernel, gFilter.c_str()) != nullptr;
+}
+
+template <typename Fn>
+static void measure(const char* kernel, int size, int items, Fn&& fn)
+{
+    fn();   // Warm-up, also touches the data
+
+    using Clock = std::chrono::steady_clock;
+
+    int iterations = 0;
+    double elapsed = 0.0;
+    auto start = Clock::now();
+
+    do {
+        fn();
+        iterations++;
+        elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    } while (elapsed < gMinTime);
+
+    double nsPerCall = 1e6 * elapsed / iterations;
+
+    std::printf("%-24s %10d %12d %14.1f %12.2f\n",
+        kernel, size, iterations, nsPerCall, nsPerCall / items);
+}
+
+static float randomFloat(float min, float max)
+{
+    return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+}
+
+static Vector3 randomVector3(float min, float max)
+{
+    return { randomFloat(min, max), randomFloat(min, max), randomFloat(min, max) };
+}
+
+static Matrix randomTransform()
+{
+    Vector3 axis = Vector3Normalize(randomVector3(-1.0f, 1.0f));
+    Vector3 position = randomVector3(-100.0f, 100.0f);
+    return MatrixMultiply(MatrixRotate(axis, randomFloat(0.0f, 2.0f * PI)), MatrixTranslate(position.x, position.y, position.z));
+}
+
+
+/* Kernels */
+
+static void benchFrustumAABB()
+{
+    const char* kernel = "frustum_aabb_in";
+    if (!isSelected(kernel)) return;
+
+    Matrix view = MatrixLookAt({ 0, 10, -50 }, { 0, 0, 0 }, { 0, 1, 0 });
+    Matrix proj = MatrixPerspective(60.0 * DEG2RAD, 16.0 / 9.0, 0.05, 1000.0);
+    r3d::Frustum frustum(view, proj);
+
+    for (int size : { 1000, 10000, 100000 }) {
+        std::vector<BoundingBox> boxes(size);
+        for (BoundingBox& box : boxes) {
+            box.min = randomVector3(-150.0f, 150.0f);
+            box.max = Vector3Add(box.min, randomVector3(0.5f, 4.0f));
+        }
+        measure(kernel, size, size, [&]() {
+            int visible = 0;
+            for (const BoundingBox& box : boxes) {
+                visible += frustum.aabbIn(box);
+            }
+            gSink = gSink + visible;
+        });
+    }
+}
+
+static void benchTransformBoundingBox()
+{
+    const char* kernel = "transform_bounding_box";
+    if (!isSelected(kernel)) return;
+
+    for (int size : { 1000, 10000, 100000 }) {
+        std::vector<Matrix> transforms(size);
+        for (Matrix& transform : transforms) {
+            transform = randomTransform();
+        }
+        BoundingBox box = { { -1, -1, -1 }, { 1, 1, 1 } };
+        measure(kernel, size, size, [&]() {
+            float sum = 0.0f;
+            for (const Matrix& transform : transforms) {
+                sum += r3d::transformBoundingBox(box, transform).max.x;
+            }
+            gSink = gSink + sum;
+        });
+    }
+}
+
+static void benchBillboardRotation()
+{
+    const char* kernel = "billboard_rotation";
+    if (!isSelected(kernel)) return;
+
+    for (int size : { 1000, 10000, 100000 }) {
+        std::vector<Matrix> views(size);
+        for (Matrix& view : views) {
+            view = MatrixLookAt(randomVector3(-50.0f, 50.0f), { 0, 0, 0 }, { 0, 1, 0 });
+        }
+        measure(kernel, size, size, [&]() {
+            float sum = 0.0f;
+            for (int i = 0; i < size; i++) {
+                R3D_BillboardMode mode = (i & 1) ? R3D_BILLBOARD_Y_AXIS : R3D_BILLBOARD_ENABLED;
+                sum += r3d::getBillboardRotationMatrix(mode, views[i]).m0;
+            }
+            gSink = gSink + sum;
+        });
+    }
+}
+
+static void benchAnimationBones()
+{
+    const char* kernel = "animation_bones";
+    if (!isSelected(kernel)) return;
+
+    const int frameCount = 60;
+
+    for (int boneCount : { 16, 64, 256 }) {
+        r3d::Model model;
+
+        // The memory is released the way 'r3d::Model' and 'r3d::Model::Animation' expect it
+
+        ::Transform* bindPose = static_cast<::Transform*>(std::malloc(boneCount * sizeof(::Transform)));
+        for (int i = 0; i < boneCount; i++) {
+            bindPose[i] = { randomVector3(-1.0f, 1.0f), QuaternionIdentity(), { 1, 1, 1 } };
+        }
+        model.bindPose = std::span<::Transform>(bindPose, boneCount);
+
+        ::ModelAnimation rlAnim{};
+        rlAnim.boneCount = boneCount;
+        rlAnim.frameCount = frameCount;
+        rlAnim.bones = static_cast<::BoneInfo*>(RL_CALLOC(boneCount, sizeof(::BoneInfo)));
+        rlAnim.framePoses = static_cast<::Transform**>(RL_MALLOC(frameCount * sizeof(::Transform*)));
+        for (int f = 0; f < frameCount; f++) {
+            rlAnim.framePoses[f] = static_cast<::Transform*>(RL_MALLOC(boneCount * sizeof(::Transform)));
+            for (int i = 0; i < boneCount; i++) {
+                Quaternion rotation = QuaternionFromAxisAngle(Vector3Normalize(randomVector3(-1.0f, 1.0f)), randomFloat(0.0f, PI));
+                rlAnim.framePoses[f][i] = { randomVector3(-1.0f, 1.0f), rotation, { 1, 1, 1 } };
+            }
+        }
+        r3d::Model::Animation anim(rlAnim);
+
+        std::vector<Matrix> boneMatrices(boneCount);
+
+        R3D_Surface surface{};
+        surface.mesh.boneCount = boneCount;
+        surface.mesh.boneMatrices = boneMatrices.data();
+        model.surfaces.push_back(surface);
+
+        int frame = 0;
+        measure(kernel, boneCount, boneCount, [&]() {
+            model.updateAnimationBones(anim, frame++);
+            gSink = gSink + boneMatrices[0].m0;
+        });
+
+        model.surfaces.clear();     // The mesh has no GL buffers to unload
+    }
+}
+
+static void benchSkinning()
+{
+    const char* kernel = "skinning";
+    if (!isSelected(kernel)) return;
+
+    const int boneCount = 64;
+
+    std::vector<Matrix> boneMatrices(boneCount);
+    for (Matrix& matrix : boneMatrices) {
+        matrix = randomTransform();
+    }
+
+    for (int vertexCount : { 1000, 10000, 100000 }) {
+        std::vector<float> vertices(3 * vertexCount), normals(3 * vertexCount);
+        std::vector<float> animVertices(3 * vertexCount), animNormals(3 * vertexCount);
+        std::vector<unsigned char> boneIds(4 * vertexCount);
+        std::vector<float> boneWeights(4 * vertexCount);
+
+        for (int i = 0; i < 3 * vertexCount; i++) {
+            vertices[i] = randomFloat(-1.0f, 1.0f);
+            normals[i] = randomFloat(-1.0f, 1.0f);
+        }
+
+        // Two to four influences per vertex, as in typical skinned meshes
+        for (int i = 0; i < vertexCount; i++) {
+            int influences = 2 + (i % 3);
+            for (int j = 0; j < 4; j++) {
+                boneIds[4 * i + j] = static_cast<unsigned char>(std::rand() % boneCount);
+                boneWeights[4 * i + j] = (j < influences) ? 1.0f / influences : 0.0f;
+            }
+        }
+
+        Mesh mesh{};
+        mesh.vertexCount = vertexCount;
+        mesh.vertices = vertices.data();
+        mesh.normals = normals.data();
+        mesh.animVertices = animVertices.data();
+        mesh.animNormals = animNormals.data();
+        mesh.boneIds = boneIds.data();
+        mesh.boneWeights = boneWeights.data();
+        mesh.boneCount = boneCount;
+        mesh.boneMatrices = boneMatrices.data();
+
+        measure(kernel, vertexCount, vertexCount, [&]() {
+            r3d::Model::skinMesh(mesh);
+            gSink = gSink + animVertices[0];
+        });
+    }
+}
+
+static void benchParticlesUpdate()
+{
+    const char* kernel = "particles_update";
+    if (!isSelected(kernel)) return;
+
+    R3D_InterpolationCurve curve = R3D_LoadInterpolationCurve(3);
+    R3D_AddKeyframe(&curve, 0.0f, 0.0f);
+    R3D_AddKeyframe(&curve, 0.5f, 1.0f);
+    R3D_AddKeyframe(&curve, 1.0f, 0.0f);
+
+    Mesh mesh{};
+    R3D_Material material{};
+
+    for (int size : { 1000, 10000, 100000 }) {
+        R3D_ParticleSystemCPU* system = R3D_LoadParticleEmitterCPU(&mesh, &material, size);
+        system->initialVelocity = { 0, 10.0f, 0 };
+        system->spreadAngle = 45.0f;
+        system->scaleOverLifetime = &curve;
+        system->opacityOverLifetime = &curve;
+
+        // The particles live long enough to keep their count constant during the measure
+        system->lifetime = 1e6f;
+        while (R3D_EmitParticleCPU(system)) { }
+        system->emissionRate = 0.0f;
+
+        measure(kernel, size, size, [&]() {
+            R3D_UpdateParticleEmitterCPU(system, 1.0f / 60.0f);
+            gSink = gSink + system->particles[0].position.y;
+        });
+
+        R3D_UnloadParticleEmitterCPU(system);
+    }
+
+    R3D_UnloadInterpolationCurve(&curve);
+}
+
+static void benchEvaluateCurve()
+{
+    const char* kernel = "evaluate_curve";
+    if (!isSelected(kernel)) return;
+
+    const int evaluations = 10000;
+
+    for (int keyframeCount : { 4, 16, 64 }) {
+        R3D_InterpolationCurve curve = R3D_LoadInterpolationCurve(keyframeCount);
+        for (int i = 0; i < keyframeCount; i++) {
+            R3D_AddKeyframe(&curve, static_cast<float>(i) / (keyframeCount - 1), randomFloat(0.0f, 1.0f));
+        }
+        measure(kernel, keyframeCount, evaluations, [&]() {
+            float sum = 0.0f;
+            for (int i = 0; i < evaluations; i++) {
+                sum += R3D_EvaluateCurve(&curve, static_cast<float>(i) / evaluations);
+            }
+            gSink = gSink + sum;
+        });
+        R3D_UnloadInterpolationCurve(&curve);
+    }
+}
+
+
+/* Main */
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            gFilter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            gMinTime = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::srand(1234);
+    SetRandomSeed(1234);
+
+    std::printf("%-24s %10s %12s %14s %12s\n", "kernel", "size", "iterations", "ns/call", "ns/item");
+
+    benchFrustumAABB();
+    benchTransformBoundingBox();
+    benchBillboardRotation();
+    benchAnimationBones();
+    benchSkinning();
+    benchParticlesUpdate();
+    benchEvaluateCurve();
+
+    return 0;
+}
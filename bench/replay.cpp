@@ -0,0 +1,198 @@
+/**
+ * R3D - Capture replay
+ *
+ * Replays a capture written by `R3D_BeginCapture` / `R3D_EndCapture` a fixed number of times,
+ * and reports the CPU submission time, the GPU frame time (see `R3D_FLAG_GPU_PROFILING`) and
+ * the draw calls of the replayed frames. A capture of several frames is replayed in a loop.
+ *
+ * The capture contains the geometry but not the textures, which are replaced by generated
+ * textures of the same size and format, so the timings are close to those of the original
+ * frames without having to ship the assets of the application.
+ *
+ * With '--null' the frames are replayed without window nor GL context (see `R3D_FLAG_NULL_BACKEND`),
+ * only the CPU time is then measured, and the GL commands issued per frame are reported.
+ *
+ * Usage: r3d_replay <capture> [options]
+ *     --frames <n>            Number of measured frames (default 300)
+ *     --warmup <n>            Number of frames replayed before measuring (default 30)
+ *     --null                  Replays the capture with the null backend
+ */
+
+#include <r3d.h>
+
+#if defined(__APPLE__)
+#   define GL_SILENCE_DEPRECATION
+#   include <OpenGL/gl3.h>
+#else
+#   include <glad.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+/* Helpers */
+
+static bool parseInt(const char* str, int* value)
+{
+    char* end = nullptr;
+    long v = std::strtol(str, &end, 10);
+    if (end == str || *end != '\0' || v < 0) return false;
+    *value = static_cast<int>(v);
+    return true;
+}
+
+
+/* Main */
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    int warmupFrames = 30, measuredFrames = 300;
+    bool useNull = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (arg == "--null") {
+            useNull = true;
+            continue;
+        }
+
+        if (arg.rfind("--", 0) != 0) {
+            path = argv[i];
+            continue;
+        }
+
+        if (value == nullptr) {
+            std::fprintf(stderr, "Missing value for '%s'\n", arg.c_str());
+            return 1;
+        }
+
+        if (arg == "--frames") ok = parseInt(value, &measuredFrames) && measuredFrames > 0;
+        else if (arg == "--warmup") ok = parseInt(value, &warmupFrames);
+        else {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return 1;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "Invalid value '%s' for '%s'\n", value, arg.c_str());
+            return 1;
+        }
+
+        i++;
+    }
+
+    if (path == nullptr) {
+        std::fprintf(stderr, "Usage: r3d_replay <capture> [--frames <n>] [--warmup <n>] [--null]\n");
+        return 1;
+    }
+
+    // Loading the file does not require the renderer, the GPU resources are created by the first replay
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    R3D_Capture capture = R3D_LoadCapture(path);
+
+    if (capture.internal == nullptr || capture.frameCount == 0) {
+        std::fprintf(stderr, "Failed to load '%s' or empty capture\n", path);
+        return 1;
+    }
+
+    int width = capture.internalWidth;
+    int height = capture.internalHeight;
+    int flags = (capture.flags & ~R3D_FLAG_NULL_BACKEND) | R3D_FLAG_GPU_PROFILING;
+
+    if (useNull) {
+        flags = (flags & ~R3D_FLAG_GPU_PROFILING) | R3D_FLAG_NULL_BACKEND;
+    } else {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(width, height, "R3D - Replay");
+    }
+
+    R3D_InitEx(width, height, flags);
+
+    // The first replay creates the resources and starts compiling the shaders of the captured
+    // materials, the compilations must be done before measuring anything
+
+    R3D_ReplayCapture(&capture, 0);
+
+    while (R3D_GetPendingShaderCompileCount() > 0) {
+        R3D_ReplayCapture(&capture, 0);
+    }
+
+    // Frames
+
+    std::vector<double> cpuTimes;
+    cpuTimes.reserve(measuredFrames);
+
+    double gpuTime = 0.0;
+    long long draws = 0;
+    long long commands = 0;
+
+    int totalFrames = warmupFrames + measuredFrames;
+
+    for (int frame = 0; frame < totalFrames; frame++)
+    {
+        bool measured = (frame >= warmupFrames);
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (!useNull) BeginDrawing();
+            R3D_ReplayCapture(&capture, frame % capture.frameCount);
+        if (!useNull) EndDrawing();
+
+        auto end = std::chrono::steady_clock::now();
+
+        // Waiting for the GPU after each frame (outside of the measured time) makes
+        // the GPU timings of exactly one frame available at the end of the next one
+
+        glFinish();
+
+        if (!measured) {
+            continue;
+        }
+
+        R3D_FrameStats stats = R3D_GetFrameStats();
+
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        gpuTime += stats.gpu.frame;
+        draws += stats.sceneDraws + stats.shadowDraws;
+        commands += R3D_GetRecordedCommandCount();
+    }
+
+    // Report
+
+    double sum = 0.0;
+    for (double time : cpuTimes) sum += time;
+
+    std::printf("Capture:  '%s', %d frame(s), %dx%d\n", path, capture.frameCount, width, height);
+    std::printf("Replayed: %d frames (%d warmup)%s\n", measuredFrames, warmupFrames, useNull ? ", null backend" : "");
+    std::printf("CPU ms:   avg %.4f, min %.4f, max %.4f\n", sum / measuredFrames,
+        *std::min_element(cpuTimes.begin(), cpuTimes.end()), *std::max_element(cpuTimes.begin(), cpuTimes.end()));
+
+    if (useNull) {
+        std::printf("Commands: %.1f per frame\n", static_cast<double>(commands) / measuredFrames);
+    } else {
+        std::printf("GPU ms:   avg %.4f\n", gpuTime / measuredFrames);
+    }
+
+    std::printf("Draws:    %.1f per frame\n", static_cast<double>(draws) / measuredFrames);
+
+    R3D_UnloadCapture(&capture);
+    R3D_Close();
+
+    if (!useNull) {
+        CloseWindow();
+    }
+
+    return 0;
+}
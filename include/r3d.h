@@ -60,6 +60,48 @@ typedef enum {
                                              *   loaded. If this flag is not set, calling `R3D_DrawShadowMap` 
                                              *   will have no effect.
                                              */
+
+    R3D_FLAG_HDR_R11G11B10F     = 1 << 4,   /**< Stores the HDR colors of the scene in a packed 'GL_R11F_G11F_B10F'
+                                             *   buffer instead of the default 'GL_RGBA16F', halving the bandwidth
+                                             *   of the main pass. The packed format has about 6 bits of mantissa
+                                             *   (5 for blue) and cannot store negative values, which can cause
+                                             *   slight banding or hue shifts in smooth bright gradients.
+                                             *   This flag cannot be changed after initialization.
+                                             */
+
+    R3D_FLAG_GPU_PROFILING      = 1 << 5,   /**< Measures the GPU time of each rendering pass with timestamp queries,
+                                             *   see `R3D_GetFrameStats` and `R3D_GetGPUZone`. The results are read
+                                             *   a few frames later to avoid stalling the CPU. This flag can be
+                                             *   toggled at any time.
+                                             */
+
+    R3D_FLAG_NULL_BACKEND       = 1 << 6,   /**< Runs the library without any window or GL context: no GL command is
+                                             *   executed, they are recorded instead (see `R3D_GetRecordedCommands`),
+                                             *   to measure the CPU cost of the renderer on machines without a GPU.
+                                             *   `InitWindow` must not be called, the internal resolution being the
+                                             *   size of the default framebuffer (1280x720 if not specified). Since
+                                             *   `GetFrameTime` stays zero, use `R3D_SetShadowsUpdateFrequency(0)`
+                                             *   to update the shadows every frame. This flag implies
+                                             *   `R3D_FLAG_ASPECT_KEEP` and cannot be changed after initialization.
+                                             */
+
+    R3D_FLAG_OCCLUSION_QUERIES  = 1 << 7,   /**< Culls the models hidden behind other objects on the GPU: the bounding
+                                             *   box of each model drawn is tested against the depth of the scene with
+                                             *   an occlusion query, and the model is skipped by the GPU during the next
+                                             *   frame if its box was entirely hidden (conditional rendering). The CPU
+                                             *   never waits for the results, and a model that was not drawn during the
+                                             *   previous frame is always rendered, but a model that comes out from
+                                             *   behind an occluder appears one frame late. The draw calls are still
+                                             *   submitted and counted in `R3D_GetFrameStats`. Not used during stereo
+                                             *   rendering. This flag can be toggled at any time.
+                                             */
+
+    R3D_FLAG_MODEL_LODS         = 1 << 8,   /**< Generates a chain of 3 levels of detail for each model loaded with
+                                             *   `R3D_LoadModel` or `R3D_LoadModelFromMesh`, each level keeping half the
+                                             *   triangles of the previous one (see `R3D_GenerateModelLODs`). This increases
+                                             *   the loading time and the memory used by the models. The levels drawn are
+                                             *   selected with `R3D_SetLODErrorThreshold`.
+                                             */
 } R3D_Flags;
 
 /**
@@ -89,6 +131,17 @@ typedef enum {
     R3D_BLOOM_SOFT_LIGHT        /**< Soft light bloom effect, which creates a softer, more diffused glow around bright areas. */
 } R3D_Bloom;
 
+/**
+ * @enum R3D_BloomFilter
+ * @brief Defines the filters used to blur the bright areas of the bloom effect.
+ * 
+ * The filter determines how the number of iterations of the bloom (see `R3D_SetEnvBloomIterations`) is interpreted.
+ */
+typedef enum {
+    R3D_BLOOM_FILTER_GAUSSIAN,  /**< Separable Gaussian blur at half resolution; each iteration is a full pass, so the cost grows linearly with the radius. */
+    R3D_BLOOM_FILTER_MIP_CHAIN  /**< Progressive downsample/upsample chain; each iteration adds a level at half the previous resolution, doubling the radius (max 8 levels). */
+} R3D_BloomFilter;
+
 /**
  * @enum R3D_Fog
  * @brief Defines the types of fog effects available for rendering.
@@ -178,6 +231,24 @@ typedef enum {
     R3D_CULL_BACK,                      /**< Cull back faces, rendering only the front faces of the geometry. */
 } R3D_CullMode;
 
+/**
+ * @enum R3D_RenderScale
+ * @brief Defines the resolution at which the surfaces of a material are rendered.
+ * 
+ * Transparent surfaces such as particles are often limited by fill-rate rather than geometry.
+ * Materials using a reduced scale are rendered in an offscreen target of lower resolution, tested against
+ * a downsampled copy of the scene depth, then composited over the scene using a depth-aware upsample.
+ * 
+ * @note Only the `R3D_BLEND_ALPHA`, `R3D_BLEND_ADDITIVE`, `R3D_BLEND_ADD_COLORS` and `R3D_BLEND_ALPHA_PREMULTIPLY`
+ *       blend modes can be rendered at reduced resolution, other materials are always rendered at full resolution.
+ *       Surfaces rendered at reduced resolution do not write to the depth buffer.
+ */
+typedef enum {
+    R3D_RENDER_SCALE_FULL,              /**< Surfaces are rendered at the internal resolution (default). */
+    R3D_RENDER_SCALE_HALF,              /**< Surfaces are rendered at half the internal resolution. */
+    R3D_RENDER_SCALE_QUARTER,           /**< Surfaces are rendered at a quarter of the internal resolution. */
+} R3D_RenderScale;
+
 /**
  * @enum R3D_MaterialFlags
  * @brief Defines flags used to configure material properties in the rendering engine.
@@ -191,7 +262,7 @@ typedef enum {
  */
 typedef enum {
     R3D_MATERIAL_FLAG_NONE              = 0,          /**< No material flags set. */
-    R3D_MATERIAL_FLAG_VERTEX_COLOR      = 1 << 0,     /**< Material uses vertex colors for shading. */
+    R3D_MATERIAL_FLAG_VERTEX_COLOR      = 1 << 0,     /**< Material uses vertex colors for shading. Always set by the renderer for sprites, whose albedo color is stored in the vertices of their batch. */
     R3D_MATERIAL_FLAG_RECEIVE_SHADOW    = 1 << 1,     /**< Material will receive shadows in the rendering process. */
     R3D_MATERIAL_FLAG_MAP_EMISSION      = 1 << 2,     /**< Material uses an emission map (emissive texture). */
     R3D_MATERIAL_FLAG_MAP_NORMAL        = 1 << 3,     /**< Material uses a normal map to modify surface normals. */
@@ -285,6 +356,7 @@ typedef struct {
         float intensity;        /**< Intensity of the bloom effect. Default: `1.0f`. */
         float hdrThreshold;     /**< HDR brightness threshold for the bloom effect. Default: `1.0f`. */
         int iterations;         /**< Number of iterations for the bloom effect. Default: `10`. */
+        R3D_BloomFilter filter; /**< Filter used to blur the bright areas. Default: `R3D_BLOOM_FILTER_GAUSSIAN`. */
     } bloom;                    /**< Configuration for bloom effects. */
 
     struct {
@@ -305,6 +377,7 @@ typedef struct {
         float brightness;       /**< Brightness adjustment. Default: `1.0f`. */
         float contrast;         /**< Contrast adjustment. Default: `1.0f`. */
         float saturation;       /**< Saturation adjustment. Default: `1.0f`. */
+        Texture2D lut;          /**< Color grading LUT applied after the adjustments (see `R3D_SetEnvAdjustLUT`). Default: none (`id == 0`). */
     } adjustements;             /**< Configuration for post-processing color adjustments. */
 
     struct {
@@ -314,6 +387,108 @@ typedef struct {
     } world;                    /**< Configuration for the world environment, including skybox and ambient settings. */
 } R3D_Environment;
 
+/**
+ * @struct R3D_FrameStats
+ * @brief Statistics of the last rendered frames.
+ * 
+ * The counters cover the last complete frame, from the end of the previous `R3D_End` to the end of the last one,
+ * so they include the objects submitted with the `R3D_Draw*` functions and the CPU particle systems updated in between.
+ * They are always gathered, at the cost of a few integer increments.
+ * 
+ * The GPU times are rolling averages in milliseconds, measured only while `R3D_FLAG_GPU_PROFILING` is set.
+ * A pass keeps its last average during the frames where it does not run (e.g. the shadow pass, see `R3D_SetShadowsUpdateFrequency`).
+ */
+typedef struct {
+    int objectsSubmitted;       /**< Number of models, sprites and particle systems submitted with the `R3D_Draw*` functions. */
+    int objectsCulledFrustum;   /**< Number of submitted objects outside the view frustum, only tested without `R3D_FLAG_NO_FRUSTUM_CULLING`. */
+    int objectsCulledLayer;     /**< Number of submitted objects whose layer is inactive, only tested without `R3D_FLAG_NO_FRUSTUM_CULLING`. */
+    int objectsCulledOcclusion; /**< Number of submitted objects hidden behind the occluders of the frame (see `R3D_DrawOccluder`). */
+    int objectsCulledDistance;  /**< Number of submitted models beyond their draw distance (see `R3D_Model::maxDrawDistance`). */
+    int objectsCulledScreenSize; /**< Number of submitted objects too small on screen (see `R3D_SetScreenSizeCullThreshold`). */
+    int sceneDraws;             /**< Number of draw calls of the scene, each stereo eye counting as one draw. */
+    int shadowDraws;            /**< Number of draw calls into the shadow maps, each cube face counting as one draw (see `R3D_GetLightShadowDrawCount`). */
+    int spriteBatchDraws;       /**< Number of draw calls of sprite batches, whose quads are expanded on the CPU (nothing is instanced), included in `sceneDraws` and `shadowDraws`. */
+    int triangles;              /**< Number of triangles drawn by the scene and shadow draw calls. */
+    int shaderBinds;            /**< Number of material and depth shaders bound. */
+    int textureBinds;           /**< Number of textures bound to the material shaders. */
+    int uniformUploads;         /**< Number of uniforms uploaded to the material and depth shaders, the unchanged values being skipped. */
+    int particlesSimulated;     /**< Number of particles updated by `R3D_UpdateParticleEmitterCPU`. */
+    int shadowMapsUpdated;      /**< Number of shadow maps rendered, see `R3D_SetShadowsUpdateFrequency`. */
+    struct {
+        float frame;            /**< GPU time of all the passes rendered by `R3D_End`. */
+        float shadowPass;       /**< GPU time of the shadow maps update. */
+        float scenePass;        /**< GPU time of the scene rendering, including the reduced resolution surfaces. */
+        float bloom;            /**< GPU time of the bloom filter, included in `postProcess`. */
+        float postProcess;      /**< GPU time of the post-processing, including the bloom. */
+        float present;          /**< GPU time of the blit to the target framebuffer. */
+    } gpu;                      /**< GPU time of each pass, in milliseconds. */
+} R3D_FrameStats;
+
+/**
+ * @struct R3D_GPUZone
+ * @brief GPU timing of a profiled zone of a frame (see `R3D_GetGPUZone`).
+ */
+typedef struct {
+    const char *name;           /**< Name of the zone (e.g. "Scene pass", "Light 2", "Face 4", "Batch 1"), valid until the next call to `R3D_End`. */
+    int depth;                  /**< Nesting depth of the zone, the whole frame being at depth 0. */
+    float time;                 /**< GPU time of the zone during the last resolved frame, in milliseconds. */
+    float average;              /**< Rolling average of the GPU time of the zone, in milliseconds. */
+} R3D_GPUZone;
+
+/**
+ * @enum R3D_CommandType
+ * @brief Types of the GL commands recorded by the null backend (see `R3D_FLAG_NULL_BACKEND`).
+ * 
+ * The creations, deletions and queries of GL objects are not recorded.
+ */
+typedef enum {
+    R3D_COMMAND_BIND_PROGRAM,       /**< `glUseProgram`, `object` is the program. */
+    R3D_COMMAND_BIND_TEXTURE,       /**< `glBindTexture`, `object` is the texture and `value` the texture unit. */
+    R3D_COMMAND_BIND_FRAMEBUFFER,   /**< `glBindFramebuffer`, `object` is the framebuffer and `value` the target. */
+    R3D_COMMAND_BIND_VERTEX_ARRAY,  /**< `glBindVertexArray`, `object` is the vertex array. */
+    R3D_COMMAND_BIND_BUFFER,        /**< `glBindBuffer` and `glBindBufferBase`, `object` is the buffer and `value` the target. */
+    R3D_COMMAND_UNIFORM,            /**< `glUniform*`, `object` is the bound program and `value` the location. */
+    R3D_COMMAND_DRAW,               /**< `glDraw*`, `object` is the number of instances and `value` the number of vertices or indices. */
+    R3D_COMMAND_CLEAR,              /**< `glClear`, `value` is the mask of the cleared buffers. */
+    R3D_COMMAND_BLIT,               /**< `glBlitFramebuffer`, `value` is the mask of the copied buffers. */
+    R3D_COMMAND_STATE,              /**< Any other state change (`glEnable`, `glViewport`, `glDepthMask`...), `object` is
+                                     *   the GL enum of the state (e.g. the capability, `GL_DEPTH_FUNC`) and `value` its
+                                     *   new value when it is an integer, zero otherwise. */
+    R3D_COMMAND_UPLOAD,             /**< `glBufferData`, `glTexImage*`..., `object` is the target and `value` the size,
+                                     *   in bytes for the buffers and in texels for the textures. */
+    R3D_COMMAND_TYPE_COUNT          /**< Number of command types. */
+} R3D_CommandType;
+
+/**
+ * @struct R3D_Command
+ * @brief GL command recorded by the null backend (see `R3D_GetRecordedCommands`).
+ * 
+ * The objects are named deterministically from the initialization, so the streams of two
+ * runs of the same program can be compared.
+ */
+typedef struct {
+    unsigned int type;          /**< Type of the command (see `R3D_CommandType`). */
+    unsigned int object;        /**< Object or enum affected by the command, depending on its type. */
+    int value;                  /**< Parameter of the command, depending on its type. */
+} R3D_Command;
+
+/**
+ * @struct R3D_Capture
+ * @brief Frames recorded with `R3D_BeginCapture` and loaded with `R3D_LoadCapture` to be replayed.
+ * 
+ * A capture is self-contained: it stores the camera, the environment, the lights and every object submitted
+ * with the `R3D_Draw*` functions, with their final transforms, materials and the geometry of their meshes.
+ * The textures are replaced by generated textures of the same size and format, so a frame can be replayed
+ * to reproduce its cost without the assets of the application.
+ */
+typedef struct {
+    int frameCount;             /**< Number of frames recorded in the capture. */
+    int internalWidth;          /**< Internal resolution width of the renderer when the frames were recorded. */
+    int internalHeight;         /**< Internal resolution height of the renderer when the frames were recorded. */
+    int flags;                  /**< Flags of the renderer when the frames were recorded (see `R3D_Flags`). */
+    void *internal;             /**< Internal data of the capture, `NULL` if it could not be loaded. */
+} R3D_Capture;
+
 /**
  * @struct R3D_MaterialShaderConfig
  * @brief Configuration for material shaders, including diffuse, specular, and additional flags.
@@ -324,7 +499,7 @@ typedef struct {
 typedef struct {
     unsigned char diffuse;     /**< The diffuse mode for the material (see `R3D_DiffuseMode`). */
     unsigned char specular;    /**< The specular mode for the material (see `R3D_SpecularMode`). */
-    unsigned char reserved;    /**< Reserved for future use. */
+    unsigned char billboard;   /**< The billboard mode of the drawn object (see `R3D_BillboardMode`), set by the renderer. Can be set to precompile a billboard variant. */
     unsigned char flags;       /**< Flags indicating additional shader settings. */
 } R3D_MaterialShaderConfig;
 
@@ -339,7 +514,7 @@ typedef struct {
     R3D_MaterialShaderConfig shader;  /**< Shader configuration for the material. */
     unsigned char blendMode;          /**< Blending mode for the material (see `R3D_BlendMode`). */
     unsigned char cullMode;           /**< Culling mode for the material (see `R3D_CullMode`). */
-    unsigned char reserved1;          /**< Reserved for future use. */
+    unsigned char renderScale;        /**< Resolution at which the surfaces are rendered (see `R3D_RenderScale`). */
     unsigned char reserved2;          /**< Reserved for future use. */
 } R3D_MaterialConfig;
 
@@ -403,8 +578,34 @@ typedef struct R3D_Transform {
     Quaternion rotation;                /**< Rotation of the object, represented as a quaternion. */
     Vector3 scale;                      /**< Scale of the object along each axis. */
     const struct R3D_Transform *parent; /**< Pointer to the parent transform for hierarchical relationships. */
+    const Matrix *world;                /**< Optional pointer to a cached world matrix (see `R3D_TransformHierarchy`). When set, the other fields are ignored. */
 } R3D_Transform;
 
+/**
+ * @struct R3D_TransformHierarchy
+ * @brief Stores a hierarchy of transforms and caches their world matrices.
+ * 
+ * The nodes are identified by their index and are kept in a flat array. A second array lists the nodes
+ * sorted by depth, so that every parent precedes its children; this allows all world matrices to be
+ * computed in a single linear pass. Only the nodes that were modified, and their descendants, are recomputed.
+ * 
+ * The capacity is fixed at load time, so the addresses of the cached world matrices remain valid until
+ * the hierarchy is unloaded. This is what allows a `R3D_Transform` to reference one of them.
+ * 
+ * @note The fields should not be modified directly; use the `R3D_*TransformNode*` functions instead.
+ */
+typedef struct {
+    R3D_Transform *locals;      /**< Local transform of each node. Their `parent` and `world` fields are ignored. */
+    Matrix *worlds;             /**< Cached world matrix of each node, valid after `R3D_UpdateTransformHierarchy`. */
+    int *parents;               /**< Index of the parent of each node, or `-1` for root nodes. */
+    int *depths;                /**< Depth of each node in the hierarchy, `0` for root nodes. */
+    int *order;                 /**< Node indices sorted by depth, parents always precede their children. */
+    bool *dirty;                /**< Indicates for each node whether its local transform has changed since the last update. */
+    int count;                  /**< Current number of nodes in the hierarchy. */
+    int capacity;               /**< Maximum number of nodes in the hierarchy. */
+    bool orderDirty;            /**< Indicates whether the order array must be rebuilt during the next update. */
+} R3D_TransformHierarchy;
+
 /**
  * @struct R3D_Surface
  * @brief Represents a renderable surface, combining a material and a mesh.
@@ -429,6 +630,8 @@ typedef struct {
     R3D_CastShadow shadow;          /**< Shadow casting behavior of the model (see `R3D_CastShadow`). */
     R3D_BillboardMode billboard;    /**< Indicates whether the model should be rendered as a billboard. */
     R3D_Layer layer;                /**< Indicates the layer in which the model should be rendered */
+    float maxDrawDistance;          /**< Distance from the camera beyond which the model is not drawn, 0 for no limit. */
+    float maxShadowDistance;        /**< Distance from the camera beyond which the model no longer casts shadows, 0 for no limit. */
     void *internal;                 /**< Internal data used by the rendering engine. Should not be modified directly. */
 } R3D_Model;
 
@@ -447,6 +650,7 @@ typedef struct {
     R3D_Material material;          /**< The material used for rendering the sprite, including its texture and shading properties. */
 
     float currentFrame;             /**< The current animation frame, represented as a floating-point value to allow smooth interpolation. */
+    Rectangle region;               /**< The region of the albedo texture containing the frames, in pixels. Covers the whole texture unless the sprite comes from an atlas. */
     Vector2 frameSize;              /**< The size of a single animation frame, in texture coordinates (width and height). */
     int xFrameCount;                /**< The number of frames along the horizontal (X) axis of the texture. */
     int yFrameCount;                /**< The number of frames along the vertical (Y) axis of the texture. */
@@ -457,6 +661,26 @@ typedef struct {
 
 } R3D_Sprite;
 
+/**
+ * @brief Represents a texture atlas into which several spritesheets are packed.
+ * 
+ * Sprites created from the same atlas share the same albedo texture and only differ by their UV rect,
+ * which allows the renderer to draw them in a single batch even if they come from different spritesheets.
+ * 
+ * The spritesheets are packed in rows (shelves) from the top-left corner of the atlas. Each one is surrounded
+ * by a border of `padding` pixels in which its edges are extruded, to avoid bleeding with bilinear filtering.
+ */
+typedef struct {
+    Texture2D texture;      /**< The atlas texture, in which the spritesheets are packed. */
+    Rectangle *regions;     /**< The region of each packed spritesheet in the atlas, in pixels. */
+    int count;              /**< The number of packed spritesheets. */
+    int capacity;           /**< The maximum number of spritesheets that can be packed. */
+    int padding;            /**< The border in pixels around each spritesheet. Default: 2. */
+    int shelfX;             /**< Horizontal position of the packing cursor in the current shelf, should not be modified manually. */
+    int shelfY;             /**< Vertical position of the current shelf, should not be modified manually. */
+    int shelfHeight;        /**< Height of the current shelf, should not be modified manually. */
+} R3D_SpriteAtlas;
+
 /**
  * @brief Represents a keyframe in an interpolation curve.
  * 
@@ -614,6 +838,21 @@ void R3D_InitEx(int internalWidth, int internalHeight, int flags);
  */
 void R3D_Close(void);
 
+/**
+ * @brief Defines the directory in which the compiled shader programs are cached.
+ * 
+ * When a directory is defined and the driver supports program binaries (`ARB_get_program_binary`),
+ * the linked shader programs are saved in it and reloaded on the next launch instead of being compiled
+ * again, which removes most of the startup cost and the hitches caused by new material configurations.
+ * Each binary is identified by its complete source code and the driver strings, so a binary is never
+ * reused with another driver. If a binary is rejected, the program is recompiled and its binary replaced.
+ * 
+ * @param directory The directory of the cache, created if necessary. `NULL` or an empty string disables the cache (default).
+ * 
+ * @note To also cache the internal shaders of the renderer, this function must be called before `R3D_Init`.
+ */
+void R3D_SetShaderCacheDirectory(const char* directory);
+
 /**
  * @brief Updates the resolution of the internal render targets.
  * 
@@ -772,6 +1011,66 @@ void R3D_RemoveActiveLayer(R3D_Layer layer);
  */
 void R3D_ToggleActiveLayer(R3D_Layer layer);
 
+/**
+ * @brief Sets the projected screen size below which objects are culled.
+ *
+ * The size of an object is the diameter of the sphere enclosing its bounding box, projected with the
+ * camera projection and expressed as a fraction of the viewport height. Objects smaller than the threshold
+ * are not drawn, which removes the distant clutter that covers a handful of pixels.
+ * They still cast shadows, up to the `maxShadowDistance` of the models.
+ *
+ * The test is skipped with `R3D_FLAG_NO_FRUSTUM_CULLING`, like the other visibility tests.
+ *
+ * @param threshold Fraction of the viewport height, e.g. 0.005 for 5 pixels at 1080p. Set to 0 to disable it (default).
+ */
+void R3D_SetScreenSizeCullThreshold(float threshold);
+
+/**
+ * @brief Gets the global projected screen size below which objects are culled.
+ *
+ * @return The fraction of the viewport height set with `R3D_SetScreenSizeCullThreshold`.
+ */
+float R3D_GetScreenSizeCullThreshold(void);
+
+/**
+ * @brief Sets the projected screen size below which the objects of some layers are culled.
+ *
+ * This threshold replaces the global one (see `R3D_SetScreenSizeCullThreshold`) for the objects of the
+ * given layers, e.g. to cull small props earlier than buildings. An object whose layer mask contains several
+ * layers uses the smallest of their thresholds.
+ *
+ * @param layers A bitmask of the layers (`R3D_Layer`) to configure.
+ * @param threshold Fraction of the viewport height. A negative value restores the global threshold (default).
+ */
+void R3D_SetLayerScreenSizeCullThreshold(int layers, float threshold);
+
+/**
+ * @brief Gets the projected screen size below which the objects of a layer are culled.
+ *
+ * @param layer The layer (`R3D_Layer`) to query.
+ * @return The threshold of the layer, or a negative value if it uses the global threshold.
+ */
+float R3D_GetLayerScreenSizeCullThreshold(R3D_Layer layer);
+
+/**
+ * @brief Sets the largest projected error allowed when selecting the level of detail of the models.
+ *
+ * Each draw of a model with LOD levels (see `R3D_GenerateModelLODs` and `R3D_AddModelLOD`) uses the coarsest
+ * level whose error, projected with the camera at the nearest point of the model, is below this threshold.
+ * The same level is used in the scene and in the shadow maps. To avoid popping, a model drawn around a distance
+ * of transition keeps its level until the error is clearly above or below the threshold.
+ *
+ * @param pixels The threshold, in pixels of the internal resolution. Default is 1. Set to 0 to always draw the full detail.
+ */
+void R3D_SetLODErrorThreshold(float pixels);
+
+/**
+ * @brief Gets the largest projected error allowed when selecting the level of detail of the models.
+ *
+ * @return The threshold in pixels, see `R3D_SetLODErrorThreshold`.
+ */
+float R3D_GetLODErrorThreshold(void);
+
 /**
  * @brief Begins a new rendering frame using the R3D engine with the specified camera.
  * 
@@ -882,6 +1181,26 @@ void R3D_DrawSpritePro(const R3D_Sprite* sprite, Vector3 position, Vector3 rotat
  */
 void R3D_DrawParticleSystemCPU(R3D_ParticleSystemCPU* system);
 
+/**
+ * @brief Adds a mesh as occluder for the software occlusion culling of the current frame.
+ * 
+ * The occluder is not rendered. Its triangles are rasterized on the CPU into a low resolution (256x128)
+ * depth buffer, against which the bounding box of every object drawn afterwards in the frame is tested.
+ * The objects entirely hidden behind the occluders are not rendered in the scene, but they still cast
+ * their shadows. The culling only takes place in the frames where at least one occluder is drawn.
+ * 
+ * Occluders should be large, closed and simple shapes, such as the walls of the buildings or low-poly
+ * proxies of the scenery contained in the rendered meshes. They are two-sided.
+ * 
+ * @param mesh      A pointer to the mesh, whose vertices (and indices if any) must still be in CPU memory.
+ * @param transform A pointer to the transform of the occluder, its parent is taken into account.
+ * 
+ * @note The occluders should be drawn first after `R3D_Begin`: an object is only tested against the
+ *       occluders drawn before it. The occlusion culling is disabled with `R3D_FLAG_NO_FRUSTUM_CULLING`
+ *       and during stereo rendering.
+ */
+void R3D_DrawOccluder(const Mesh* mesh, const R3D_Transform* transform);
+
 /**
  * @brief Finalizes the current rendering frame.
  * 
@@ -1024,6 +1343,23 @@ int R3D_GetEnvBloomIterations(void);
  */
 void R3D_SetEnvBloomIterations(int iterations);
 
+/**
+ * @brief Retrieves the filter used to blur the bright areas for the bloom effect.
+ * 
+ * @return The current `R3D_BloomFilter`. Default is `R3D_BLOOM_FILTER_GAUSSIAN`.
+ */
+R3D_BloomFilter R3D_GetEnvBloomFilter(void);
+
+/**
+ * @brief Sets the filter used to blur the bright areas for the bloom effect.
+ * 
+ * With `R3D_BLOOM_FILTER_MIP_CHAIN`, the number of iterations is the number of levels of the chain, clamped between 1 and 8.
+ * A wide radius then costs about as much as a single half resolution pass of the Gaussian filter; 5 or 6 levels are usually enough.
+ * 
+ * @param filter The desired `R3D_BloomFilter`.
+ */
+void R3D_SetEnvBloomFilter(R3D_BloomFilter filter);
+
 /**
  * @brief Retrieves the current fog mode in the environment settings.
  * 
@@ -1227,6 +1563,31 @@ float R3D_GetEnvAdjustSaturation(void);
  */
 void R3D_SetEnvAdjustSaturation(float saturation);
 
+/**
+ * @brief Retrieves the color grading LUT currently used by the environment.
+ * 
+ * @return The current color grading LUT texture. Its `id` is `0` if no LUT is used (default).
+ */
+Texture2D R3D_GetEnvAdjustLUT(void);
+
+/**
+ * @brief Sets an artist-authored color grading LUT for the environment.
+ * 
+ * The tonemapping, gamma correction and color adjustments are baked together into a 3D LUT, so that the
+ * post-processing pass applies them with a single texture fetch after the exposure. The LUT given here is
+ * applied last, on the gamma corrected colors, and is baked along with them at no additional cost per frame.
+ * 
+ * The texture must be a horizontal strip of N square slices of N x N texels (e.g. 1024 x 32 for a 32³ LUT).
+ * Within a slice, red increases to the right and green downwards, the slices being ordered by increasing blue.
+ * The texels are interpolated when baking, so the texture filter does not matter.
+ * 
+ * @note The texture is only read when the LUT is baked, that is when this LUT, the tonemap mode or white point,
+ *       or the color adjustments are changed. The texture must stay valid while it is used, pass a texture with an `id` of `0` to remove it.
+ * 
+ * @param lut The color grading LUT texture.
+ */
+void R3D_SetEnvAdjustLUT(Texture2D lut);
+
 /**
  * @brief Retrieves the current skybox used in the environment settings.
  * 
@@ -1351,10 +1712,42 @@ void R3D_SetDefaultMaterialConfig(R3D_MaterialConfig config);
  * You can call this function directly for more control over shader compilation, for example, at the start of the program to avoid shader compilation
  * during the main loop execution.
  * 
+ * If the driver supports parallel shader compilation (`KHR_parallel_shader_compile`), the shader is compiled in the background and the
+ * objects using this configuration are drawn with the shader of the default configuration until it is ready. Otherwise it is compiled immediately.
+ * 
  * @param config The material configuration.
  */
 void R3D_RegisterMaterialConfig(R3D_MaterialConfig config);
 
+/**
+ * @brief Starts the compilation of the shaders of several material configurations.
+ * 
+ * This function registers each configuration like `R3D_RegisterMaterialConfig` does. It is intended to be called during a loading screen,
+ * with all the configurations the scene will use, so that no shader is compiled during gameplay. When parallel compilation is supported,
+ * all the shaders are compiled at the same time by the driver, and `R3D_GetPendingShaderCompileCount` can be polled each frame to
+ * know when they are ready.
+ * 
+ * Unlike `R3D_RegisterMaterialConfig`, this also compiles the variants specialized for fewer lights (0, 1, 2 and 4), which
+ * are otherwise compiled the first time an object affected by that many lights is drawn.
+ * 
+ * Objects drawn with a billboard mode use a distinct shader variant; to precompile it, set the `shader.billboard` field of the
+ * configuration to the desired `R3D_BillboardMode`.
+ * 
+ * @param configs Array of material configurations to compile.
+ * @param count Number of configurations in the array.
+ */
+void R3D_PrecompileMaterialConfigs(const R3D_MaterialConfig* configs, int count);
+
+/**
+ * @brief Gets the number of material shaders whose compilation is still in progress.
+ * 
+ * Shaders whose compilation has finished are made available by this call, so it can be polled each frame during a loading screen.
+ * Always returns 0 if the driver does not support parallel shader compilation, since shaders are then compiled immediately.
+ * 
+ * @return The number of shaders still being compiled.
+ */
+int R3D_GetPendingShaderCompileCount(void);
+
 /**
  * @brief Releases a material configuration, use with caution.
  * 
@@ -1779,14 +2172,78 @@ void R3D_RemoveLightLayer(R3D_Light light, R3D_Layer layer);
 void R3D_ToggleLightLayer(R3D_Light light, R3D_Layer layer);
 
 
+/* [Core] - Capture Functions */
+
+/**
+ * @brief Begins recording the frames rendered by the library into a capture file.
+ * 
+ * Every frame rendered from `R3D_Begin` to `R3D_End` until `R3D_EndCapture` is recorded: the camera,
+ * the environment, the lights, the active layers and every object submitted with the `R3D_Draw*`
+ * functions. Meshes and textures are stored once, even if they are drawn several times. Usually a
+ * single frame is captured, e.g. the one showing a performance issue, to be replayed elsewhere
+ * (see `R3D_LoadCapture` and the `r3d_replay` tool).
+ * 
+ * The geometry is read from the CPU copies of the meshes (`Mesh::vertices`...), the animated
+ * vertices being stored in their current pose. Meshes without CPU data are stored as degenerate
+ * meshes with the same number of vertices and triangles.
+ * 
+ * @param fileName The path of the capture file written by `R3D_EndCapture`.
+ * @return `true` if the recording has started, `false` if a capture is already being recorded.
+ */
+bool R3D_BeginCapture(const char* fileName);
+
+/**
+ * @brief Ends the recording started by `R3D_BeginCapture` and writes the capture file.
+ * 
+ * The frame being rendered, if any, is not included: call this function after `R3D_End`.
+ * 
+ * @return `true` if the file has been written, `false` if no capture was recorded or the file could not be written.
+ */
+bool R3D_EndCapture(void);
+
+/**
+ * @brief Loads a capture file to replay its frames.
+ * 
+ * The file is only read by this function, so it can be called before `R3D_Init` to initialize the
+ * library with the resolution and flags of the capture. The GPU resources (meshes, placeholder
+ * textures, lights...) are created by the first call to `R3D_ReplayCapture`.
+ * 
+ * @param fileName The path of the capture file.
+ * @return The loaded capture, with a `NULL` internal pointer if the file could not be read.
+ */
+R3D_Capture R3D_LoadCapture(const char* fileName);
+
+/**
+ * @brief Unloads a capture and releases its GPU resources.
+ * 
+ * @param capture The capture to unload.
+ */
+void R3D_UnloadCapture(R3D_Capture* capture);
+
+/**
+ * @brief Renders a captured frame exactly as it was submitted.
+ * 
+ * This function calls `R3D_Begin` and `R3D_End` itself, so it must be called between raylib's
+ * `BeginDrawing` and `EndDrawing` (or `BeginTextureMode`...) instead of them. It replaces the
+ * environment, the active layers and the depth sorting order of the renderer by those of the
+ * captured frame, and the shadow maps are updated if they were updated in the captured frame.
+ * 
+ * The lights of the capture are created along with its other resources; the lights created by
+ * the application should be disabled during the replay so as not to change its cost.
+ * 
+ * @param capture The capture to replay.
+ * @param frame The index of the frame, between `0` and `capture->frameCount - 1`.
+ */
+void R3D_ReplayCapture(R3D_Capture* capture, int frame);
+
+
 /* [Core] - Debug functions */
 
 /**
  * @brief Retrieves the count of draw calls for the scene and shadows.
  * 
- * This function returns the number of elements that will be drawn during the `R3D_End` function call, which 
- * is between `R3D_Begin` and `R3D_End`. It does not store values directly, instead, it counts the number of 
- * draw calls for scene rendering and shadow rendering that are scheduled to be drawn.
+ * This function returns the number of draw calls issued by the last `R3D_End` for scene rendering and shadow
+ * rendering. It is a shortcut for the `sceneDraws` and `shadowDraws` counters of `R3D_GetFrameStats`.
  * 
  * The `sceneDrawCount` and `shadowDrawCount` provide the count of draw calls for the scene and shadow elements, respectively.
  * 
@@ -1798,6 +2255,92 @@ void R3D_ToggleLightLayer(R3D_Light light, R3D_Layer layer);
  */
 void R3D_GetDrawCallCount(int* sceneDrawCount, int* shadowDrawCount);
 
+/**
+ * @brief Retrieves the statistics of the last rendered frames.
+ * 
+ * The counters cover the last complete frame and are always gathered.
+ * 
+ * The GPU times are only measured while the flag `R3D_FLAG_GPU_PROFILING` is set, otherwise they keep their
+ * last values (zero if never measured). They are also zero if the OpenGL implementation cannot measure time.
+ * 
+ * @return The statistics of the last rendered frames.
+ */
+R3D_FrameStats R3D_GetFrameStats(void);
+
+/**
+ * @brief Retrieves the number of draw calls of the last update of a light's shadow map.
+ * 
+ * The count is kept until the shadow map is updated again, see `R3D_SetShadowsUpdateFrequency`.
+ * The draws of the six faces of an omni-directional light are all counted.
+ * 
+ * @param light The light to query.
+ * @return The number of draw calls, zero if the light has never updated its shadow map.
+ */
+int R3D_GetLightShadowDrawCount(R3D_Light light);
+
+/**
+ * @brief Retrieves the number of GPU zones measured during the last resolved frame.
+ * 
+ * The zones are the passes of the frame and their subdivisions: each light and cube face of the shadow pass,
+ * each material batch of the scene pass, the bloom... They are listed in the order in which they began,
+ * so that a zone is followed by the zones nested in it.
+ * 
+ * @return The number of zones, zero if `R3D_FLAG_GPU_PROFILING` has never been set.
+ */
+int R3D_GetGPUZoneCount(void);
+
+/**
+ * @brief Retrieves a GPU zone measured during the last resolved frame.
+ * 
+ * @param index The index of the zone, between `0` and `R3D_GetGPUZoneCount() - 1`.
+ * @return The timing of the zone, or a zone with a `NULL` name if the index is out of range.
+ */
+R3D_GPUZone R3D_GetGPUZone(int index);
+
+/**
+ * @brief Saves the CPU trace zones recorded so far as a Chrome trace JSON file.
+ * 
+ * The library records scoped zones around its CPU hot paths (draw submission, culling, light setup,
+ * batch sorting, animation and particle updates, shader compilation...) only if it has been built with
+ * the `R3D_ENABLE_TRACE` option, which is disabled by default. Each thread keeps its last 65536 zones.
+ * 
+ * The file can be opened with `chrome://tracing` or https://ui.perfetto.dev to attribute frame spikes.
+ * 
+ * @param fileName The path of the JSON file to write.
+ * @return `true` if the trace has been saved, `false` if tracing is disabled or the file could not be written.
+ * 
+ * @note Zones recorded by other threads while the trace is being saved may be corrupted,
+ *       call this function when the library is not used by other threads (e.g. after `R3D_End`).
+ */
+bool R3D_SaveTraceJSON(const char* fileName);
+
+/**
+ * @brief Retrieves the number of GL commands recorded during the last frame by the null backend.
+ * 
+ * The commands of a frame are those issued from `R3D_Begin` to `R3D_End`, including the raylib draws
+ * in between. This allows deterministic tests of the CPU cost of a scene, e.g. that it never needs
+ * more than a given number of binds, on machines without a GPU.
+ * 
+ * @return The number of commands, zero if the library has not been initialized with `R3D_FLAG_NULL_BACKEND`.
+ */
+int R3D_GetRecordedCommandCount(void);
+
+/**
+ * @brief Retrieves the GL commands recorded during the last frame by the null backend.
+ * 
+ * @return The commands in the order they have been issued, valid until the next call to `R3D_End`,
+ *         or `NULL` if no command has been recorded (see `R3D_GetRecordedCommandCount`).
+ */
+const R3D_Command* R3D_GetRecordedCommands(void);
+
+/**
+ * @brief Counts the GL commands of a given type recorded during the last frame by the null backend.
+ * 
+ * @param type The type of the commands to count.
+ * @return The number of commands of this type.
+ */
+int R3D_CountRecordedCommands(R3D_CommandType type);
+
 /**
  * @brief Draws the shadow map for debugging purposes.
  * 
@@ -2143,6 +2686,58 @@ void R3D_UpdateModelAABB(R3D_Model* model, float extraMargin);
  */
 void R3D_GenTangents(R3D_Model* model);
 
+/**
+ * @brief Generates the levels of detail of all the surfaces of a model.
+ *
+ * Each surface is simplified with a quadric error metric, producing a chain of meshes with fewer triangles whose
+ * vertices keep the attributes of the original ones. The borders and attribute seams (e.g. UV discontinuities) of
+ * the meshes are preserved, so the chain of a surface can stop before `levelCount` if they prevent further
+ * simplification. The surfaces are simplified in parallel when the library is built with OpenMP.
+ *
+ * The existing levels of the model are replaced. The meshes must have their vertices in CPU memory.
+ *
+ * @param model A pointer to the `R3D_Model` object.
+ * @param levelCount The maximum number of levels to generate, in addition to the full detail.
+ * @param reduction Fraction of the triangles of the previous level kept by each level, between 0 and 1 exclusive (e.g. 0.5).
+ * @return The number of levels of the model after generation.
+ *
+ * @note The skinned meshes are not simplified, since their levels would not follow the animations.
+ */
+int R3D_GenerateModelLODs(R3D_Model* model, int levelCount, float reduction);
+
+/**
+ * @brief Adds a level of detail authored by an artist to a surface of a model.
+ *
+ * The mesh is appended to the chain of the surface, after the generated levels or those added before it.
+ * The model takes the ownership of the mesh, which is uploaded to the GPU if it is not already.
+ * A surface whose chain is shorter than those of the other surfaces uses its coarsest mesh for the next levels.
+ *
+ * @param model A pointer to the `R3D_Model` object.
+ * @param surfaceIndex The index of the surface.
+ * @param mesh The mesh of the level, drawn with the material of the surface.
+ * @param error The largest distance between this mesh and the full detail one, in the units of the model.
+ *              It is raised to the error of the previous level if lower.
+ * @return `false` if the surface index is out of range, the mesh then remains owned by the caller.
+ *
+ * @note The meshes added are not animated by `R3D_UpdateModelAnimation`.
+ */
+bool R3D_AddModelLOD(R3D_Model* model, int surfaceIndex, Mesh mesh, float error);
+
+/**
+ * @brief Unloads all the levels of detail of a model, which is then always drawn with its full detail.
+ *
+ * @param model A pointer to the `R3D_Model` object.
+ */
+void R3D_ClearModelLODs(R3D_Model* model);
+
+/**
+ * @brief Gets the number of levels of detail of a model.
+ *
+ * @param model A pointer to the `R3D_Model` object.
+ * @return The number of levels in addition to the full detail, zero if the model has none.
+ */
+int R3D_GetModelLODCount(const R3D_Model* model);
+
 
 /* [Objects] - Sprite Functions */
 
@@ -2210,7 +2805,70 @@ Vector2 R3D_GetCurrentSpriteFrameCoord(const R3D_Sprite* sprite);
  * 
  * @return A `Rectangle` representing the current frame's position and size.
  */
-static Rectangle R3D_GetCurrentSpriteFrameRect(const R3D_Sprite* sprite);
+Rectangle R3D_GetCurrentSpriteFrameRect(const R3D_Sprite* sprite);
+
+
+/* [Objects] - Sprite Atlas Functions */
+
+/**
+ * @brief Loads an empty sprite atlas.
+ * 
+ * @param width The width of the atlas texture, in pixels.
+ * @param height The height of the atlas texture, in pixels.
+ * @param capacity The maximum number of spritesheets that can be packed in the atlas.
+ * 
+ * @return A new `R3D_SpriteAtlas`. Its texture id is 0 if the texture could not be created.
+ */
+R3D_SpriteAtlas R3D_LoadSpriteAtlas(int width, int height, int capacity);
+
+/**
+ * @brief Unloads a sprite atlas and its texture.
+ * 
+ * @warning Sprites created from the atlas must no longer be drawn after this call.
+ * 
+ * @param atlas A pointer to the `R3D_SpriteAtlas` to unload.
+ */
+void R3D_UnloadSpriteAtlas(R3D_SpriteAtlas* atlas);
+
+/**
+ * @brief Packs a spritesheet image into the atlas.
+ * 
+ * The image is copied, it can be unloaded by the caller after this call.
+ * 
+ * @param atlas A pointer to the `R3D_SpriteAtlas`.
+ * @param image The spritesheet image to pack.
+ * 
+ * @return The index of the region of the spritesheet in the atlas, or `-1` if there is not enough space left.
+ */
+int R3D_AddSpriteAtlasImage(R3D_SpriteAtlas* atlas, Image image);
+
+/**
+ * @brief Packs a spritesheet texture into the atlas.
+ * 
+ * The texture is read back from the GPU and copied; it can be unloaded by the caller after this call.
+ * 
+ * @param atlas A pointer to the `R3D_SpriteAtlas`.
+ * @param texture The spritesheet texture to pack.
+ * 
+ * @return The index of the region of the spritesheet in the atlas, or `-1` if there is not enough space left.
+ */
+int R3D_AddSpriteAtlasTexture(R3D_SpriteAtlas* atlas, Texture2D texture);
+
+/**
+ * @brief Creates a sprite from a spritesheet packed in an atlas.
+ * 
+ * The atlas texture is used as the albedo of the sprite's material, and the frames are read within the region
+ * of the spritesheet. Sprites sharing the same atlas and material settings can be drawn in a single batch.
+ * 
+ * @param atlas A pointer to the `R3D_SpriteAtlas` containing the spritesheet.
+ * @param region The index of the spritesheet, as returned by `R3D_AddSpriteAtlasImage` or `R3D_AddSpriteAtlasTexture`.
+ * @param xFrameCount The number of frames in the horizontal direction.
+ * @param yFrameCount The number of frames in the vertical direction.
+ * 
+ * @return A `R3D_Sprite` object displaying the first frame of the spritesheet, or the whole atlas
+ *         if the region is out of range or the frame counts are not positive.
+ */
+R3D_Sprite R3D_CreateSpriteFromAtlas(const R3D_SpriteAtlas* atlas, int region, int xFrameCount, int yFrameCount);
 
 
 /* [Objects] - Interpolation Curve Functions */
@@ -2379,6 +3037,114 @@ Matrix R3D_TransformToLocal(const R3D_Transform* transform);
  */
 Matrix R3D_TransformToGlobal(const R3D_Transform* transform);
 
+/**
+ * @brief Creates a transform that references the cached world matrix of a hierarchy node.
+ * 
+ * The returned transform can be assigned to a model or a sprite; when drawn, the cached world matrix of the node
+ * is used directly instead of being rebuilt from the parent chain. The hierarchy must be updated with
+ * `R3D_UpdateTransformHierarchy` before drawing for the matrix to be up to date.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy` containing the node.
+ * @param node The index of the node.
+ * 
+ * @return A new `R3D_Transform` referencing the world matrix of the node,
+ *         or an identity transform if the node index is invalid.
+ */
+R3D_Transform R3D_CreateTransformFromNode(const R3D_TransformHierarchy* hierarchy, int node);
+
+
+/* [Objects] - Transform Hierarchy Functions */
+
+/**
+ * @brief Loads a transform hierarchy able to hold a fixed number of nodes.
+ * 
+ * @param capacity The maximum number of nodes the hierarchy can hold.
+ * 
+ * @return A new, empty `R3D_TransformHierarchy`, or a zeroed one with a
+ *         capacity of 0 if `capacity` is not positive or the allocation failed.
+ */
+R3D_TransformHierarchy R3D_LoadTransformHierarchy(int capacity);
+
+/**
+ * @brief Unloads a transform hierarchy and frees its resources.
+ * 
+ * Transforms created with `R3D_CreateTransformFromNode` from this hierarchy must no longer be used.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy` to unload.
+ */
+void R3D_UnloadTransformHierarchy(R3D_TransformHierarchy* hierarchy);
+
+/**
+ * @brief Adds a node to a transform hierarchy.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy`.
+ * @param parent The index of the parent node, or `-1` to add a root node.
+ * @param local The local transform of the node. Its `parent` and `world` fields are ignored.
+ * 
+ * @return The index of the new node, or `-1` if the hierarchy is full or the parent is invalid.
+ */
+int R3D_AddTransformNode(R3D_TransformHierarchy* hierarchy, int parent, R3D_Transform local);
+
+/**
+ * @brief Changes the parent of a node.
+ * 
+ * The node keeps its local transform, so its world matrix, and those of its descendants,
+ * will be recomputed relative to the new parent during the next update.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy`.
+ * @param node The index of the node to reparent.
+ * @param parent The index of the new parent node, or `-1` to make the node a root.
+ * 
+ * @return `true` if the parent was changed, `false` if an index is invalid or if it would create a cycle.
+ */
+bool R3D_SetTransformNodeParent(R3D_TransformHierarchy* hierarchy, int node, int parent);
+
+/**
+ * @brief Sets the local transform of a node and marks it as dirty.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy`.
+ * @param node The index of the node.
+ * @param local The new local transform of the node. Its `parent` and `world` fields are ignored.
+ * 
+ * @note A warning is logged and nothing is changed if the node index is invalid.
+ */
+void R3D_SetTransformNodeLocal(R3D_TransformHierarchy* hierarchy, int node, R3D_Transform local);
+
+/**
+ * @brief Gets the local transform of a node.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy`.
+ * @param node The index of the node.
+ * 
+ * @return The local transform of the node, or an identity transform if the node index is invalid.
+ */
+R3D_Transform R3D_GetTransformNodeLocal(const R3D_TransformHierarchy* hierarchy, int node);
+
+/**
+ * @brief Gets the cached world matrix of a node.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy`.
+ * @param node The index of the node.
+ * 
+ * @return The world matrix of the node as computed by the last call to `R3D_UpdateTransformHierarchy`,
+ *         or an identity matrix if the node index is invalid.
+ */
+Matrix R3D_GetTransformNodeWorld(const R3D_TransformHierarchy* hierarchy, int node);
+
+/**
+ * @brief Updates the cached world matrices of a transform hierarchy.
+ * 
+ * Only the world matrices of the dirty nodes and their descendants are recomputed, in a single pass
+ * over the nodes sorted by depth. If the library is built with `R3D_ENABLE_OPENMP`, the nodes of each
+ * depth level are processed in parallel.
+ * 
+ * This function should be called once per frame, after the local transforms have been modified
+ * and before the models referencing the hierarchy are drawn.
+ * 
+ * @param hierarchy A pointer to the `R3D_TransformHierarchy` to update.
+ */
+void R3D_UpdateTransformHierarchy(R3D_TransformHierarchy* hierarchy);
+
 
 #ifdef __cplusplus
 } // extern "C"
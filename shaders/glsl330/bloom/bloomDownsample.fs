@@ -0,0 +1,53 @@
+// Downsamples the previous level of the bloom mip chain with the 13-tap filter
+// presented by Jorge Jimenez in "Next Generation Post Processing in Call of Duty:
+// Advanced Warfare" (SIGGRAPH 2014). The five overlapping 2x2 boxes avoid the
+// pulsating artifacts of a plain bilinear downsample on small bright areas.
+
+#version 330 core
+
+in vec2 vTexCoord;
+
+uniform sampler2D uTexture;
+uniform float uThreshold;
+
+out vec4 FragColor;
+
+// Bright pass, only the first level reads the scene colors with the HDR threshold
+// The following levels use a threshold of zero, which keeps all the downsampled colors
+vec3 Sample(vec2 uv)
+{
+    vec3 color = texture(uTexture, uv).rgb;
+    float lum = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return (lum > uThreshold) ? color : vec3(0.0);
+}
+
+void main()
+{
+    vec2 txl = 1.0 / vec2(textureSize(uTexture, 0));
+
+    vec3 a = Sample(vTexCoord + txl * vec2(-2.0,  2.0));
+    vec3 b = Sample(vTexCoord + txl * vec2( 0.0,  2.0));
+    vec3 c = Sample(vTexCoord + txl * vec2( 2.0,  2.0));
+
+    vec3 d = Sample(vTexCoord + txl * vec2(-2.0,  0.0));
+    vec3 e = Sample(vTexCoord);
+    vec3 f = Sample(vTexCoord + txl * vec2( 2.0,  0.0));
+
+    vec3 g = Sample(vTexCoord + txl * vec2(-2.0, -2.0));
+    vec3 h = Sample(vTexCoord + txl * vec2( 0.0, -2.0));
+    vec3 i = Sample(vTexCoord + txl * vec2( 2.0, -2.0));
+
+    vec3 j = Sample(vTexCoord + txl * vec2(-1.0,  1.0));
+    vec3 k = Sample(vTexCoord + txl * vec2( 1.0,  1.0));
+    vec3 l = Sample(vTexCoord + txl * vec2(-1.0, -1.0));
+    vec3 m = Sample(vTexCoord + txl * vec2( 1.0, -1.0));
+
+    // The center box weights 0.5, the four corner boxes 0.125 each
+
+    vec3 result = e * 0.125;
+    result += (a + c + g + i) * 0.03125;
+    result += (b + d + f + h) * 0.0625;
+    result += (j + k + l + m) * 0.125;
+
+    FragColor = vec4(result, 1.0);
+}
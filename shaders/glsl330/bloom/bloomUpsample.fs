@@ -0,0 +1,32 @@
+// Upsamples the next level of the bloom mip chain with a 9-tap tent filter and
+// blends it over the current level, which already contains its downsampled image.
+// The output alpha is the weight of the upsampled image, so that with standard
+// alpha blending each level ends up as the average of itself and all smaller levels.
+
+#version 330 core
+
+in vec2 vTexCoord;
+
+uniform sampler2D uTexture;
+uniform float uWeight;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec2 txl = 1.0 / vec2(textureSize(uTexture, 0));
+
+    vec3 result = texture(uTexture, vTexCoord).rgb * 4.0;
+
+    result += texture(uTexture, vTexCoord + txl * vec2( 0.0,  1.0)).rgb * 2.0;
+    result += texture(uTexture, vTexCoord + txl * vec2(-1.0,  0.0)).rgb * 2.0;
+    result += texture(uTexture, vTexCoord + txl * vec2( 1.0,  0.0)).rgb * 2.0;
+    result += texture(uTexture, vTexCoord + txl * vec2( 0.0, -1.0)).rgb * 2.0;
+
+    result += texture(uTexture, vTexCoord + txl * vec2(-1.0,  1.0)).rgb;
+    result += texture(uTexture, vTexCoord + txl * vec2( 1.0,  1.0)).rgb;
+    result += texture(uTexture, vTexCoord + txl * vec2(-1.0, -1.0)).rgb;
+    result += texture(uTexture, vTexCoord + txl * vec2( 1.0, -1.0)).rgb;
+
+    FragColor = vec4(result / 16.0, uWeight);
+}
@@ -6,6 +6,7 @@
 in vec2 vTexCoord;
 uniform sampler2D uTexture;
 uniform vec2 uDirection;
+uniform float uThreshold;
 out vec4 FragColor;
 
 // === Blur Coefs ===
@@ -28,6 +29,16 @@ const float WEIGHTS[5] = float[5](
     0.06332669582763516
 );
 
+// === Helper Functions ===
+
+// Bright pass, only the first pass reads the scene colors with the HDR threshold
+// The following passes use a threshold of zero, which keeps all the blurred colors
+vec3 BrightPass(vec3 color)
+{
+    float lum = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return (lum > uThreshold) ? color : vec3(0.0);
+}
+
 // === Main Program ===
 
 void main()
@@ -38,7 +49,7 @@ void main()
     for (int i = 0; i < SAMPLE_COUNT; ++i)
     {
         vec2 offset = uDirection * OFFSETS[i] / size;
-        result += texture(uTexture, vTexCoord + offset).rgb * WEIGHTS[i];
+        result += BrightPass(texture(uTexture, vTexCoord + offset).rgb) * WEIGHTS[i];
     }
 
     FragColor = vec4(result, 1.0);
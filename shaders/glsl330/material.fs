@@ -35,6 +35,14 @@
  *
  */
 
+/**
+ * Variant Parameters
+ *
+ * NUM_LIGHTS: Number of lights of the variant (0, 1, 2, 4 or 8)
+ *             RECEIVE_SHADOW is never defined when it is 0
+ *
+ */
+
 
 #ifndef DIFFUSE_UNSHADED
 
@@ -42,7 +50,9 @@
 
 #define PI 3.1415926535897932384626433832795028
 
+#ifndef NUM_LIGHTS
 #define NUM_LIGHTS  8
+#endif
 
 #define DIRLIGHT    0
 #define SPOTLIGHT   1
@@ -85,20 +95,20 @@ in vec4 vColor;
 in mat3 vTBN;
 #endif
 
-#ifdef RECEIVE_SHADOW
-in vec4 vPosLightSpace[NUM_LIGHTS];
-#endif
-
 // === Outputs ===
 
-layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 FragBrightness;
+out vec4 FragColor;
 
 // === Uniforms ===
 
+#if NUM_LIGHTS > 0
 uniform Light uLights[NUM_LIGHTS];
+#endif
+
+#ifdef RECEIVE_SHADOW
+uniform mat4 uMatLightMVP[NUM_LIGHTS];
+#endif
 
-uniform float uBloomHdrThreshold;
 uniform vec3 uColAmbient;
 uniform vec3 uViewPos;
 
@@ -216,7 +226,9 @@ float ShadowOmni(int i, float cNdotL)
 
 float Shadow(int i, float cNdotL)
 {
-    vec4 p = vPosLightSpace[i];
+    // The light-space position is only computed for the lights that cast shadows,
+    // rather than interpolated from the vertex shader for every light of the variant
+    vec4 p = uMatLightMVP[i] * vec4(vPosition, 1.0);
 
     vec3 projCoords = p.xyz/p.w;
     projCoords = projCoords*0.5 + 0.5;
@@ -288,6 +300,7 @@ void main()
     vec3 diffuse = vec3(0.0);
     vec3 specular = vec3(0.0);
 
+    #if NUM_LIGHTS > 0
     for (int i = 0; i < NUM_LIGHTS; i++)
     {
         if (uLights[i].enabled)
@@ -460,6 +473,7 @@ void main()
             specular += specLight * shadow;
         }
     }
+    #endif
 
     /* Compute ambient - (IBL diffuse) */
 
@@ -528,11 +542,6 @@ void main()
     /* Compute the final fragment color by combining diffuse, specular, and emission contributions */
 
     FragColor = vec4(diffuse + specular + emission, albedo.a);
-
-    /* Handle bright colors for bloom */
-
-    float lum = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-    FragBrightness = (lum > uBloomHdrThreshold) ? vec4(FragColor.rgb, lum) : vec4(0.0, 0.0, 0.0, lum);
 }
 
 
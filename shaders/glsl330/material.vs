@@ -4,17 +4,44 @@
  * Additional Features
  *
  * VERTEX_COLOR
- * RECEIVE_SHADOW
  * MAP_NORMAL
+ * BILLBOARD
+ * BILLBOARD_Y_AXIS
  *
  */
 
 
-#ifndef DIFFUSE_UNSHADED
+// === Billboarding ===
+
+#ifdef BILLBOARD
+
+// Camera basis shared by all material shaders, updated once per frame
+layout(std140) uniform ViewBlock
+{
+    vec4 uViewRight;
+    vec4 uViewUp;
+    vec4 uViewBack;
+};
 
-// === General configuration ===
+// Offset of the pivot of the billboard, only provided by batched geometry
+// When the attribute is not enabled, its generic value (0, 0, 0) is used
+layout(location = 10) in vec3 aBillboardCenter;
 
-#define NUM_LIGHTS 8
+mat3 BillboardBasis()
+{
+    #ifdef BILLBOARD_Y_AXIS
+        // The camera's right vector stays horizontal with a Y-up camera
+        vec3 right = normalize(vec3(uViewRight.x, 0.0, uViewRight.z));
+        return mat3(right, vec3(0.0, 1.0, 0.0), vec3(-right.z, 0.0, right.x));
+    #else
+        return mat3(uViewRight.xyz, uViewUp.xyz, uViewBack.xyz);
+    #endif
+}
+
+#endif // BILLBOARD
+
+
+#ifndef DIFFUSE_UNSHADED
 
 // === Inputs ===
 
@@ -36,10 +63,6 @@ uniform mat4 uMatNormal;
 uniform mat4 uMatModel;
 uniform mat4 uMatMVP;
 
-#ifdef RECEIVE_SHADOW
-uniform mat4 uMatLightMVP[NUM_LIGHTS];
-#endif
-
 uniform vec2 uTexCoordOffset;
 uniform vec2 uTexCoordScale;
 
@@ -57,17 +80,24 @@ out mat3 vTBN;
 out vec4 vColor;
 #endif
 
-#ifdef RECEIVE_SHADOW
-out vec4 vPosLightSpace[NUM_LIGHTS];
-#endif
-
 // === Main program ===
 
 void main()
 {
-    vPosition = vec3(uMatModel * vec4(aPosition, 1.0));
+    #ifdef BILLBOARD
+        // The rotation/scale of the model is applied first, then the surface
+        // is oriented towards the camera around its pivot
+        // NOTE: In this case 'uMatMVP' only contains the view-projection
+        mat3 matBillboard = BillboardBasis();
+        vec3 pivot = uMatModel[3].xyz + aBillboardCenter;
+        vPosition = pivot + matBillboard * (mat3(uMatModel) * aPosition);
+        vNormal = normalize(matBillboard * (mat3(uMatNormal) * aNormal));
+    #else
+        vPosition = vec3(uMatModel * vec4(aPosition, 1.0));
+        vNormal = normalize(vec3(uMatNormal * vec4(aNormal, 1.0)));
+    #endif
+
     vTexCoord = uTexCoordOffset + aTexCoord * uTexCoordScale;
-    vNormal = normalize(vec3(uMatNormal * vec4(aNormal, 1.0)));
 
     #ifdef VERTEX_COLOR
         vColor = aColor;
@@ -76,19 +106,20 @@ void main()
     #ifdef MAP_NORMAL
         // The TBN matrix is used to transform vectors from tangent space to world space
         // It is currently used to transform normals from a normal map to world space normals
-        vec3 T = normalize(vec3(uMatModel * vec4(aTangent.xyz, 0.0)));
+        #ifdef BILLBOARD
+            vec3 T = normalize(matBillboard * (mat3(uMatModel) * aTangent.xyz));
+        #else
+            vec3 T = normalize(vec3(uMatModel * vec4(aTangent.xyz, 0.0)));
+        #endif
         vec3 B = cross(vNormal, T) * aTangent.w;
         vTBN = mat3(T, B, vNormal);
     #endif
 
-    #ifdef RECEIVE_SHADOW
-        for (int i = 0; i < NUM_LIGHTS; i++)
-        {
-            vPosLightSpace[i] = uMatLightMVP[i] * vec4(vPosition, 1.0);
-        }
+    #ifdef BILLBOARD
+        gl_Position = uMatMVP * vec4(vPosition, 1.0);
+    #else
+        gl_Position = uMatMVP * vec4(aPosition, 1.0);
     #endif
-
-    gl_Position = uMatMVP * vec4(aPosition, 1.0);
 }
 
 
@@ -105,6 +136,10 @@ layout(location = 3) in vec4 aColor;
 
 // === Uniforms ===
 
+#ifdef BILLBOARD
+uniform mat4 uMatModel;
+#endif
+
 uniform mat4 uMatMVP;
 
 uniform vec2 uTexCoordOffset;
@@ -128,7 +163,13 @@ void main()
         vColor = aColor;
     #endif
 
-    gl_Position = uMatMVP * vec4(aPosition, 1.0);
+    #ifdef BILLBOARD
+        vec3 pivot = uMatModel[3].xyz + aBillboardCenter;
+        vec3 position = pivot + BillboardBasis() * (mat3(uMatModel) * aPosition);
+        gl_Position = uMatMVP * vec4(position, 1.0);
+    #else
+        gl_Position = uMatMVP * vec4(aPosition, 1.0);
+    #endif
 }
 
 #endif // DIFFUSE_UNSHADED
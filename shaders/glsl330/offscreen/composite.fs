@@ -0,0 +1,63 @@
+// Composites the reduced resolution transparent surfaces over the scene.
+// The RGB channels contain the accumulated color and the alpha channel the
+// transmittance, the blending must be set to (GL_ONE, GL_SRC_ALPHA).
+
+// The upsample is bilinear, except on depth discontinuities where we take
+// the low resolution texel whose depth is the nearest of the full resolution one.
+
+#version 330 core
+
+in vec2 vTexCoord;
+
+uniform sampler2D uTexColor;
+uniform sampler2D uTexDepth;
+uniform sampler2D uTexSceneDepth;
+
+uniform float uNear;
+uniform float uFar;
+uniform bool uOrthographic;
+
+out vec4 FragColor;
+
+// === Helper functions === //
+
+float LinearizeDepth(float depth)
+{
+    if (uOrthographic) return uNear + depth * (uFar - uNear);
+    return (2.0 * uNear * uFar) / (uFar + uNear - (2.0 * depth - 1.0) * (uFar - uNear));
+}
+
+// === Main program === //
+
+void main()
+{
+    const float DEPTH_THRESHOLD = 0.1; // Relative difference
+
+    vec2 size = vec2(textureSize(uTexDepth, 0));
+    vec2 txl = 1.0 / size;
+
+    vec2 uv = (floor(vTexCoord * size - 0.5) + 0.5) * txl;
+
+    float sceneDepth = LinearizeDepth(texture(uTexSceneDepth, vTexCoord).r);
+
+    vec2 nearestUV = uv;
+    float minDist = 1e9;
+    float maxDist = 0.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        vec2 sampleUV = uv + vec2(i % 2, i / 2) * txl;
+        float dist = abs(LinearizeDepth(texture(uTexDepth, sampleUV).r) - sceneDepth);
+
+        if (dist < minDist)
+        {
+            minDist = dist;
+            nearestUV = sampleUV;
+        }
+
+        maxDist = max(maxDist, dist);
+    }
+
+    FragColor = (maxDist < DEPTH_THRESHOLD * sceneDepth)
+        ? texture(uTexColor, vTexCoord) : texture(uTexColor, nearestUV);
+}
@@ -0,0 +1,31 @@
+// Writes into the reduced resolution depth buffer the farthest depth
+// of the full resolution texels covered by each fragment.
+// The color attachment is cleared at the same time, the alpha channel
+// storing the transmittance of the transparent surfaces rendered afterwards.
+
+#version 330 core
+
+uniform sampler2D uTexDepth;
+uniform int uScale;
+
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 base = ivec2(gl_FragCoord.xy) * uScale;
+    ivec2 maxCoord = textureSize(uTexDepth, 0) - 1;
+
+    float depth = 0.0;
+
+    for (int y = 0; y < uScale; y++)
+    {
+        for (int x = 0; x < uScale; x++)
+        {
+            ivec2 coord = min(base + ivec2(x, y), maxCoord);
+            depth = max(depth, texelFetch(uTexDepth, coord, 0).r);
+        }
+    }
+
+    gl_FragDepth = depth;
+    FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -1,6 +1,19 @@
-// TODO: Replace runtime conditions with pre-processor conditions
-
-#version 330 core
+// #version 330 core
+
+/**
+ * Variant Parameters
+ *
+ * LUT_SIZE: Number of texels per axis of the color grading LUT
+ *
+ * BLOOM_MODE: One of the BLOOM_* values
+ * FOG_MODE: One of the FOG_* values
+ *
+ * LUT_BAKE: Defined to bake the color grading into a layer of the LUT instead of applying it
+ * TONEMAP_MODE: One of the TONEMAP_* values (LUT_BAKE only)
+ * COLOR_ADJUSTMENT: Defined if brightness, contrast or saturation differ from 1.0 (LUT_BAKE only)
+ * USER_LUT: Defined if a user color grading LUT is applied after the adjustments (LUT_BAKE only)
+ *
+ */
 
 #define BLOOM_DISABLED 0
 #define BLOOM_ADDITIVE 1
@@ -16,31 +29,67 @@
 #define TONEMAP_FILMIC 2
 #define TONEMAP_ACES 3
 
+#ifndef BLOOM_MODE
+#define BLOOM_MODE BLOOM_DISABLED
+#endif
+
+#ifndef FOG_MODE
+#define FOG_MODE FOG_DISABLED
+#endif
+
+#ifndef TONEMAP_MODE
+#define TONEMAP_MODE TONEMAP_LINEAR
+#endif
+
+#ifndef LUT_SIZE
+#define LUT_SIZE 32
+#endif
+
+#ifndef LUT_BAKE
+
 in vec2 vTexCoord;
 
 uniform sampler2D uTexSceneHDR;
-uniform sampler2D uTexSceneDepth;
+uniform sampler3D uTexLUT;
+uniform float uExposure;
+
+#if BLOOM_MODE != BLOOM_DISABLED
 uniform sampler2D uTexBloomBlurHDR;
+uniform float uBloomIntensity;
+#endif
 
+#if FOG_MODE != FOG_DISABLED
+uniform sampler2D uTexSceneDepth;
 uniform float uNear;
 uniform float uFar;
-
-uniform lowp int uBloomMode;
-uniform float uBloomIntensity;
-
-uniform lowp int uFogMode;
 uniform vec3 uFogColor;
+#if FOG_MODE == FOG_LINEAR
 uniform float uFogStart;
 uniform float uFogEnd;
+#else
 uniform float uFogDensity;
+#endif
+#endif
 
-uniform lowp int uTonemapper;
-uniform float uExposure;
+#else // LUT_BAKE
+
+uniform float uLayer;
+
+#if TONEMAP_MODE != TONEMAP_LINEAR
 uniform float uWhite;
+#endif
 
+#ifdef COLOR_ADJUSTMENT
 uniform float uBrightness;
 uniform float uContrast;
 uniform float uSaturation;
+#endif
+
+#ifdef USER_LUT
+uniform sampler2D uTexUserLUT;
+#endif
+
+#endif // LUT_BAKE
 
 out vec4 FragColor;
 
@@ -148,73 +197,164 @@ vec3 TonemapACES(vec3 color, float pWhite)
 }
 
 
+// The LUT is indexed by the log2 of the exposed HDR colors, which spreads its texels evenly
+// over the stops of the scene, the first texel of each axis being pure black
+const float LUT_LOG2_MIN = -12.0;
+const float LUT_LOG2_MAX = 6.0;
+
+vec3 LutEncode(vec3 color)
+{
+    vec3 t = (log2(max(color, vec3(1e-8))) - LUT_LOG2_MIN) / (LUT_LOG2_MAX - LUT_LOG2_MIN);
+    return clamp(t, 0.0, 1.0);
+}
+
+vec3 LutDecode(vec3 t)
+{
+    vec3 color = exp2(mix(vec3(LUT_LOG2_MIN), vec3(LUT_LOG2_MAX), t));
+    return mix(color, vec3(0.0), lessThanEqual(t, vec3(0.0)));
+}
+
+
 // === Post process functions === //
 
-float FogFactor(float dist, int mode, float density, float start, float end)
+#if FOG_MODE != FOG_DISABLED
+float FogFactor(float dist)
 {
-    if (mode == FOG_LINEAR) return FogFactorLinear(dist, start, end);
-    if (mode == FOG_EXP2) return FogFactorExp2(dist, density);
-    if (mode == FOG_EXP) return FogFactorExp(dist, density);
-    return 1.0; // FOG_DISABLED
+    #if FOG_MODE == FOG_LINEAR
+        return FogFactorLinear(dist, uFogStart, uFogEnd);
+    #elif FOG_MODE == FOG_EXP2
+        return FogFactorExp2(dist, uFogDensity);
+    #else
+        return FogFactorExp(dist, uFogDensity);
+    #endif
 }
+#endif
 
-vec3 Tonemapping(vec3 color, float pWhite) // inputs are LINEAR
+#ifdef LUT_BAKE
+
+vec3 Tonemapping(vec3 color) // inputs are LINEAR
 {
     // Ensure color values passed to tonemappers are positive.
     // They can be negative in the case of negative lights, which leads to undesired behavior.
-    if (uTonemapper == TONEMAP_REINHARD) return TonemapReinhard(max(vec3(0.0f), color), pWhite);
-    if (uTonemapper == TONEMAP_FILMIC) return TonemapFilmic(max(vec3(0.0f), color), pWhite);
-    if (uTonemapper == TONEMAP_ACES) return TonemapACES(max(vec3(0.0f), color), pWhite);
-    return color; // TONEMAP_LINEAR
+    #if TONEMAP_MODE == TONEMAP_REINHARD
+        return TonemapReinhard(max(vec3(0.0f), color), uWhite);
+    #elif TONEMAP_MODE == TONEMAP_FILMIC
+        return TonemapFilmic(max(vec3(0.0f), color), uWhite);
+    #elif TONEMAP_MODE == TONEMAP_ACES
+        return TonemapACES(max(vec3(0.0f), color), uWhite);
+    #else
+        return color; // TONEMAP_LINEAR
+    #endif
+}
+
+#ifdef USER_LUT
+vec3 UserLutFetch(int r, int g, int b, int size)
+{
+    return texelFetch(uTexUserLUT, ivec2(b * size + r, g), 0).rgb;
 }
 
+// The user LUT is a strip of square slices, the red increasing to the right within
+// a slice, the green downwards, and the blue selecting the slice from left to right
+// NOTE: The texels are interpolated manually, whatever the filter of the texture
+vec3 UserLut(vec3 color)
+{
+    int size = textureSize(uTexUserLUT, 0).y;
+
+    vec3 coord = clamp(color, 0.0, 1.0) * float(size - 1);
+    ivec3 i0 = ivec3(floor(coord));
+    ivec3 i1 = min(i0 + 1, ivec3(size - 1));
+    vec3 f = coord - vec3(i0);
+
+    vec3 c00 = mix(UserLutFetch(i0.r, i0.g, i0.b, size), UserLutFetch(i1.r, i0.g, i0.b, size), f.r);
+    vec3 c10 = mix(UserLutFetch(i0.r, i1.g, i0.b, size), UserLutFetch(i1.r, i1.g, i0.b, size), f.r);
+    vec3 c01 = mix(UserLutFetch(i0.r, i0.g, i1.b, size), UserLutFetch(i1.r, i0.g, i1.b, size), f.r);
+    vec3 c11 = mix(UserLutFetch(i0.r, i1.g, i1.b, size), UserLutFetch(i1.r, i1.g, i1.b, size), f.r);
+
+    return mix(mix(c00, c10, f.g), mix(c01, c11, f.g), f.b);
+}
+#endif
+
+#endif // LUT_BAKE
+
 
 // === Main program === //
 
+#ifndef LUT_BAKE
+
 void main()
 {
     // Sampling scene color texture
     vec3 result = texture(uTexSceneHDR, vTexCoord).rgb;
 
     // Apply bloom
-    if (uBloomMode != BLOOM_DISABLED)
+    #if BLOOM_MODE != BLOOM_DISABLED
     {
         vec3 bloom = texture(uTexBloomBlurHDR, vTexCoord).rgb;
         bloom *= uBloomIntensity;
 
-        if (uBloomMode == BLOOM_SOFT_LIGHT) {
+        #if BLOOM_MODE == BLOOM_SOFT_LIGHT
             bloom = clamp(bloom.rgb, vec3(0.0), vec3(1.0));
             result = max((result + bloom) - (result * bloom), vec3(0.0));
-        } else if (uBloomMode == BLOOM_ADDITIVE) {
+        #else
             result += bloom;
-        }
+        #endif
     }
+    #endif
 
-    if (uFogMode != FOG_DISABLED)
+    #if FOG_MODE != FOG_DISABLED
     {
         // Depth retrieval and distance calculation
         float depth = texture(uTexSceneDepth, vTexCoord).r;
         depth = LinearizeDepth(depth, uNear, uFar);
 
         // Applying the fog factor to the resulting color
-        float fogFactor = FogFactor(depth, uFogMode, uFogDensity, uFogStart, uFogEnd);
+        float fogFactor = FogFactor(depth);
         result = mix(result, uFogColor, fogFactor);
     }
+    #endif
+
+    // Apply the exposure here rather than in the LUT, so that
+    // its range always covers the same stops of the exposed colors
+    result *= uExposure;
+
+    // Apply the color grading, baked in the LUT
+    vec3 uvw = LutEncode(result) * (float(LUT_SIZE - 1) / float(LUT_SIZE)) + 0.5 / float(LUT_SIZE);
+    result = texture(uTexLUT, uvw).rgb;
+
+    // Final color output
+    FragColor = vec4(result, 1.0);
+}
+
+#else // LUT_BAKE
+
+void main()
+{
+    // Retrieving the exposed HDR color of the texel of the layer
+    vec2 rg = (gl_FragCoord.xy - 0.5) / float(LUT_SIZE - 1);
+    vec3 result = LutDecode(vec3(rg, uLayer));
 
     // Appply tonemapping
     //result = SRGBToLinear(result);        // already linear
-    result *= uExposure;
-    result = Tonemapping(result, uWhite);
+    result = Tonemapping(result);
 
     // Apply gamma correction (or LinearToSRGB)
     result = pow(result, vec3(1.0/2.2));
     //result = LinearToSRGB(result);
 
     // Color adjustment
+    #ifdef COLOR_ADJUSTMENT
 	result = mix(vec3(0.0), result, uBrightness);
 	result = mix(vec3(0.5), result, uContrast);
 	result = mix(vec3(dot(vec3(1.0), result) * 0.33333), result, uSaturation);
+    #endif
+
+    // Artist-authored grading
+    #ifdef USER_LUT
+        result = UserLut(result);
+    #endif
 
     // Final color output
     FragColor = vec4(result, 1.0);
 }
+
+#endif // LUT_BAKE
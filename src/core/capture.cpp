@@ -0,0 +1,773 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "r3d.h"
+
+#include "./renderer.hpp"
+
+#include "../detail/frame_capture.hpp"
+#include "../objects/skybox.hpp"
+#include "../objects/model.hpp"
+
+#include <raylib.h>
+#include <raymath.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+
+/* Internal data */
+
+namespace {
+
+using CaptureData = r3d::CaptureData;
+
+struct CaptureRecorder
+{
+    std::string path;                                   ///< Path of the file written by 'R3D_EndCapture'.
+    CaptureData data;                                   ///< Content recorded so far.
+    std::unordered_map<unsigned int, int> textures;     ///< Index of the textures recorded, by GL id.
+    std::unordered_map<unsigned int, int> meshes;       ///< Index of the meshes recorded, by VAO id.
+    std::unordered_map<const void*, int> models;        ///< Index of the models recorded, by internal data.
+    bool inFrame = false;                               ///< Whether a frame has begun and not ended yet.
+};
+
+struct CaptureReplay
+{
+    CaptureData data;                                       ///< Content of the capture file.
+    bool loaded = false;                                    ///< Whether the GPU resources have been created.
+    std::vector<Texture2D> textures;                        ///< Placeholder textures, zero for the default textures.
+    std::vector<::Mesh> meshes;                             ///< Uploaded meshes.
+    std::vector<R3D_Model> models;                          ///< Models sharing the uploaded meshes.
+    std::map<int, R3D_Skybox> skyboxes;                     ///< Placeholder skyboxes, by face size.
+    std::vector<std::vector<R3D_Light>> lights;             ///< Lights of each frame.
+    std::vector<std::vector<R3D_ParticleSystemCPU*>> particleSystems;  ///< Particle system of each draw, null for the other draws.
+};
+
+std::unique_ptr<CaptureRecorder> gRecorder;
+
+template <typename T>
+std::vector<T> copyArray(const T* data, int count)
+{
+    return (data != nullptr && count > 0) ? std::vector<T>(data, data + count) : std::vector<T>();
+}
+
+template <typename T>
+T* allocArray(const std::vector<T>& values)
+{
+    if (values.empty()) return nullptr;
+    T* data = static_cast<T*>(RL_MALLOC(values.size() * sizeof(T)));
+    std::copy(values.begin(), values.end(), data);
+    return data;
+}
+
+/* Recording */
+
+int recordTexture(const Texture2D& texture)
+{
+    if (texture.id == 0) {
+        return -1;
+    }
+
+    auto it = gRecorder->textures.find(texture.id);
+    if (it != gRecorder->textures.end()) {
+        return it->second;
+    }
+
+    CaptureData::Texture record {
+        .kind = CaptureData::TEXTURE_PLACEHOLDER,
+        .width = texture.width,
+        .height = texture.height,
+        .mipmaps = texture.mipmaps,
+        .format = texture.format
+    };
+
+    if (texture.id == R3D_GetDefaultTextureWhite()->id) {
+        record.kind = CaptureData::TEXTURE_DEFAULT_WHITE;
+    } else if (texture.id == R3D_GetDefaultTextureBlack()->id) {
+        record.kind = CaptureData::TEXTURE_DEFAULT_BLACK;
+    }
+
+    int index = static_cast<int>(gRecorder->data.textures.size());
+    gRecorder->data.textures.push_back(record);
+    gRecorder->textures.emplace(texture.id, index);
+
+    return index;
+}
+
+int recordMesh(const ::Mesh& mesh)
+{
+    auto it = gRecorder->meshes.find(mesh.vaoId);
+    if (mesh.vaoId != 0 && it != gRecorder->meshes.end()) {
+        return it->second;
+    }
+
+    // NOTE: The animated vertices are stored in their current pose, the replay does not animate them
+
+    CaptureData::Mesh record {
+        .vertexCount = mesh.vertexCount,
+        .triangleCount = mesh.triangleCount,
+        .vertices = copyArray(mesh.animVertices ? mesh.animVertices : mesh.vertices, 3 * mesh.vertexCount),
+        .texcoords = copyArray(mesh.texcoords, 2 * mesh.vertexCount),
+        .texcoords2 = copyArray(mesh.texcoords2, 2 * mesh.vertexCount),
+        .normals = copyArray(mesh.animNormals ? mesh.animNormals : mesh.normals, 3 * mesh.vertexCount),
+        .tangents = copyArray(mesh.tangents, 4 * mesh.vertexCount),
+        .colors = copyArray(mesh.colors, 4 * mesh.vertexCount),
+        .indices = copyArray(mesh.indices, 3 * mesh.triangleCount)
+    };
+
+    int index = static_cast<int>(gRecorder->data.meshes.size());
+    gRecorder->data.meshes.push_back(std::move(record));
+
+    if (mesh.vaoId != 0) {
+        gRecorder->meshes.emplace(mesh.vaoId, index);
+    }
+
+    return index;
+}
+
+CaptureData::Material recordMaterial(const R3D_Material& material)
+{
+    return CaptureData::Material {
+        .albedo = recordTexture(material.albedo.texture),
+        .albedoColor = material.albedo.color,
+        .metalness = recordTexture(material.metalness.texture),
+        .metalnessFactor = material.metalness.factor,
+        .roughness = recordTexture(material.roughness.texture),
+        .roughnessFactor = material.roughness.factor,
+        .emission = recordTexture(material.emission.texture),
+        .emissionEnergy = material.emission.energy,
+        .emissionColor = material.emission.color,
+        .normal = recordTexture(material.normal.texture),
+        .ao = recordTexture(material.ao.texture),
+        .aoLightAffect = material.ao.lightAffect,
+        .uvOffset = material.uv.offset,
+        .uvScale = material.uv.scale,
+        .config = material.config
+    };
+}
+
+int recordModel(const R3D_Model& model)
+{
+    auto it = gRecorder->models.find(model.internal);
+    if (it != gRecorder->models.end()) {
+        return it->second;
+    }
+
+    CaptureData::Model record;
+
+    for (const R3D_Surface& surface : static_cast<const r3d::Model*>(model.internal)->surfaces) {
+        record.surfaces.push_back(CaptureData::Surface {
+            .mesh = recordMesh(surface.mesh),
+            .material = recordMaterial(surface.material)
+        });
+    }
+
+    int index = static_cast<int>(gRecorder->data.models.size());
+    gRecorder->data.models.push_back(std::move(record));
+    gRecorder->models.emplace(model.internal, index);
+
+    return index;
+}
+
+CaptureData::Environment recordEnvironment(const R3D_Environment& env)
+{
+    CaptureData::Environment record {
+        .bloomMode = env.bloom.mode,
+        .bloomIntensity = env.bloom.intensity,
+        .bloomHdrThreshold = env.bloom.hdrThreshold,
+        .bloomIterations = env.bloom.iterations,
+        .bloomFilter = env.bloom.filter,
+        .fogMode = env.fog.mode,
+        .fogColor = env.fog.color,
+        .fogStart = env.fog.start,
+        .fogEnd = env.fog.end,
+        .fogDensity = env.fog.density,
+        .tonemapMode = env.tonemap.mode,
+        .tonemapExposure = env.tonemap.exposure,
+        .tonemapWhite = env.tonemap.white,
+        .brightness = env.adjustements.brightness,
+        .contrast = env.adjustements.contrast,
+        .saturation = env.adjustements.saturation,
+        .lut = recordTexture(env.adjustements.lut),
+        .skyboxSize = 0,
+        .skyboxRotation = {},
+        .background = env.world.background,
+        .ambient = env.world.ambient
+    };
+
+    if (env.world.skybox != nullptr && env.world.skybox->internal != nullptr) {
+        record.skyboxSize = static_cast<const r3d::Skybox*>(env.world.skybox->internal)->getSkyboxCubemapSize();
+        record.skyboxRotation = env.world.skybox->rotation;
+    }
+
+    return record;
+}
+
+CaptureData::Draw& addDraw(CaptureData::DrawType type, const Matrix& transform, R3D_CastShadow shadow,
+                           R3D_BillboardMode billboard, R3D_Layer layer)
+{
+    CaptureData::Draw& draw = gRecorder->data.frames.back().draws.emplace_back();
+
+    draw.type = type;
+    draw.transform = transform;
+    draw.shadow = shadow;
+    draw.billboard = billboard;
+    draw.layer = layer;
+
+    return draw;
+}
+
+/* Replay */
+
+Texture2D getReplayTexture(const CaptureReplay& replay, int index)
+{
+    if (index < 0) {
+        return *R3D_GetDefaultTextureWhite();
+    }
+
+    switch (replay.data.textures[index].kind) {
+        case CaptureData::TEXTURE_DEFAULT_WHITE:
+            return *R3D_GetDefaultTextureWhite();
+        case CaptureData::TEXTURE_DEFAULT_BLACK:
+            return *R3D_GetDefaultTextureBlack();
+        default:
+            return replay.textures[index];
+    }
+}
+
+R3D_Material getReplayMaterial(const CaptureReplay& replay, const CaptureData::Material& material)
+{
+    R3D_Material result = R3D_CreateMaterial(material.config);
+
+    result.albedo = { getReplayTexture(replay, material.albedo), material.albedoColor };
+    result.metalness = { getReplayTexture(replay, material.metalness), material.metalnessFactor };
+    result.roughness = { getReplayTexture(replay, material.roughness), material.roughnessFactor };
+    result.emission = { getReplayTexture(replay, material.emission), material.emissionEnergy, material.emissionColor };
+    result.normal = { getReplayTexture(replay, material.normal) };
+    result.ao = { getReplayTexture(replay, material.ao), material.aoLightAffect };
+    result.uv = { material.uvOffset, material.uvScale };
+
+    return result;
+}
+
+Texture2D loadPlaceholderTexture(const CaptureData::Texture& texture)
+{
+    int width = std::max(texture.width, 1);
+    int height = std::max(texture.height, 1);
+
+    Image image = GenImageChecked(width, height, std::max(width / 8, 1), std::max(height / 8, 1), WHITE, GRAY);
+
+    // NOTE: The compressed formats are replaced by RGBA8, they cannot be generated
+    if (texture.format < PIXELFORMAT_COMPRESSED_DXT1_RGB && texture.format != image.format) {
+        ImageFormat(&image, texture.format);
+    }
+
+    if (texture.mipmaps > 1) {
+        ImageMipmaps(&image);
+    }
+
+    Texture2D result = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    if (result.mipmaps > 1) {
+        SetTextureFilter(result, TEXTURE_FILTER_TRILINEAR);
+    }
+
+    return result;
+}
+
+::Mesh loadReplayMesh(const CaptureData::Mesh& record)
+{
+    ::Mesh mesh{};
+
+    mesh.vertexCount = record.vertexCount;
+    mesh.triangleCount = record.triangleCount;
+
+    mesh.vertices = allocArray(record.vertices);
+    mesh.texcoords = allocArray(record.texcoords);
+    mesh.texcoords2 = allocArray(record.texcoords2);
+    mesh.normals = allocArray(record.normals);
+    mesh.tangents = allocArray(record.tangents);
+    mesh.colors = allocArray(record.colors);
+    mesh.indices = allocArray(record.indices);
+
+    // Degenerate geometry with the same number of vertices if the mesh had no CPU data
+    if (mesh.vertices == nullptr) {
+        mesh.vertices = static_cast<float*>(RL_CALLOC(3 * std::max(mesh.vertexCount, 1), sizeof(float)));
+    }
+
+    UploadMesh(&mesh, false);
+
+    return mesh;
+}
+
+void loadReplayResources(CaptureReplay& replay)
+{
+    R3D_TRACE_ZONE("loadReplayResources");
+
+    const CaptureData& data = replay.data;
+    std::vector<R3D_MaterialConfig> configs;
+
+    auto addConfig = [&configs](R3D_MaterialConfig config) {
+        auto equal = [&config](const R3D_MaterialConfig& other) {
+            return std::memcmp(&config, &other, sizeof(config)) == 0;
+        };
+        if (std::find_if(configs.begin(), configs.end(), equal) == configs.end()) {
+            configs.push_back(config);
+        }
+    };
+
+    for (const CaptureData::Texture& texture : data.textures) {
+        replay.textures.push_back((texture.kind == CaptureData::TEXTURE_PLACEHOLDER)
+            ? loadPlaceholderTexture(texture) : Texture2D{});
+    }
+
+    for (const CaptureData::Mesh& mesh : data.meshes) {
+        replay.meshes.push_back(loadReplayMesh(mesh));
+    }
+
+    for (const CaptureData::Model& model : data.models) {
+        r3d::Model* internal = new r3d::Model();
+        for (const CaptureData::Surface& surface : model.surfaces) {
+            internal->surfaces.push_back(R3D_Surface {
+                .material = getReplayMaterial(replay, surface.material),
+                .mesh = replay.meshes[surface.mesh]
+            });
+            addConfig(surface.material.config);
+        }
+        replay.models.push_back(R3D_Model {
+            .transform = R3D_CreateTransformIdentity(nullptr),
+            .aabb = {},
+            .shadow = R3D_CAST_ON,
+            .billboard = R3D_BILLBOARD_DISABLED,
+            .layer = R3D_LAYER_1,
+            .maxDrawDistance = 0.0f,
+            .maxShadowDistance = 0.0f,
+            .internal = internal
+        });
+    }
+
+    for (const CaptureData::Frame& frame : data.frames) {
+        if (frame.environment.skyboxSize > 0 && !replay.skyboxes.contains(frame.environment.skyboxSize)) {
+            int size = frame.environment.skyboxSize;
+            Image image = GenImageChecked(6 * size, size, std::max(size / 4, 1), std::max(size / 4, 1), SKYBLUE, DARKBLUE);
+            replay.skyboxes[size] = R3D_Skybox {
+                .rotation = {},
+                .internal = new r3d::Skybox(image, CUBEMAP_LAYOUT_LINE_HORIZONTAL)
+            };
+            UnloadImage(image);
+        }
+
+        std::vector<R3D_Light>& lights = replay.lights.emplace_back();
+
+        for (const CaptureData::Light& record : frame.lights) {
+            R3D_Light id = R3D_CreateLight(static_cast<R3D_LightType>(record.type), record.shadowResolution);
+            r3d::Light& light = gRenderer->getLight(id);
+            light.color = record.color;
+            light.position = record.position;
+            light.direction = record.direction;
+            light.energy = record.energy;
+            light.maxDistance = record.maxDistance;
+            light.attenuation = record.attenuation;
+            light.innerCutOff = record.innerCutOff;
+            light.outerCutOff = record.outerCutOff;
+            light.shadowBias = record.shadowBias;
+            light.layers = record.layers;
+            light.enabled = false;
+            if (light.type != R3D_OMNILIGHT) {
+                light.updateFrustum();
+            }
+            lights.push_back(id);
+        }
+
+        std::vector<R3D_ParticleSystemCPU*>& systems = replay.particleSystems.emplace_back();
+
+        for (const CaptureData::Draw& draw : frame.draws) {
+            if (draw.type != CaptureData::DRAW_MODEL) {
+                addConfig(draw.material.config);
+            }
+            if (draw.type != CaptureData::DRAW_PARTICLE_SYSTEM) {
+                systems.push_back(nullptr);
+                continue;
+            }
+
+            R3D_Material material = getReplayMaterial(replay, draw.material);
+            int count = static_cast<int>(draw.particles.size());
+
+            R3D_ParticleSystemCPU* system = R3D_LoadParticleEmitterCPU(&replay.meshes[draw.index], &material, std::max(count, 1));
+            for (int i = 0; i < count; i++) {
+                const CaptureData::Particle& particle = draw.particles[i];
+                system->particles[i] = R3D_Particle {};
+                system->particles[i].position = particle.position;
+                system->particles[i].rotation = particle.rotation;
+                system->particles[i].scale = particle.scale;
+                system->particles[i].color = particle.color;
+            }
+            system->particleCount = count;
+            system->position = { draw.transform.m12, draw.transform.m13, draw.transform.m14 };
+            system->aabb = draw.aabb;
+            system->shadow = static_cast<R3D_CastShadow>(draw.shadow);
+            system->billboard = static_cast<R3D_BillboardMode>(draw.billboard);
+            system->layer = static_cast<R3D_Layer>(draw.layer);
+            system->autoEmission = false;
+
+            systems.push_back(system);
+        }
+    }
+
+    R3D_PrecompileMaterialConfigs(configs.data(), static_cast<int>(configs.size()));
+
+    replay.loaded = true;
+}
+
+void unloadReplayResources(CaptureReplay& replay)
+{
+    for (const auto& systems : replay.particleSystems) {
+        for (R3D_ParticleSystemCPU* system : systems) {
+            if (system != nullptr) R3D_UnloadParticleEmitterCPU(system);
+        }
+    }
+
+    for (const auto& lights : replay.lights) {
+        for (R3D_Light light : lights) {
+            R3D_DestroyLight(light);
+        }
+    }
+
+    // The meshes are shared between the models, so they are unloaded separately
+    for (R3D_Model& model : replay.models) {
+        static_cast<r3d::Model*>(model.internal)->surfaces.clear();
+        R3D_UnloadModel(&model);
+    }
+
+    for (::Mesh& mesh : replay.meshes) {
+        UnloadMesh(mesh);
+    }
+
+    for (auto& [size, skybox] : replay.skyboxes) {
+        R3D_UnloadSkybox(&skybox);
+    }
+
+    for (size_t i = 0; i < replay.textures.size(); i++) {
+        if (replay.textures[i].id == 0) continue;
+        if (gRenderer->environment.adjustements.lut.id == replay.textures[i].id) {
+            gRenderer->environment.adjustements.lut = {};
+        }
+        UnloadTexture(replay.textures[i]);
+    }
+}
+
+} // namespace
+
+/* Internal API */
+
+namespace r3d {
+
+bool isCaptureRecording()
+{
+    return gRecorder != nullptr;
+}
+
+void captureBeginFrame(const Camera3D& camera)
+{
+    if (gRecorder == nullptr) return;
+
+    CaptureData::Frame& frame = gRecorder->data.frames.emplace_back();
+
+    frame.camera = camera;
+    frame.activeLayers = gRenderer->activeLayers;
+    frame.screenSizeCullThreshold = gRenderer->screenSizeCullThreshold;
+    std::copy(std::begin(gRenderer->layerScreenSizeCullThresholds), std::end(gRenderer->layerScreenSizeCullThresholds),
+              std::begin(frame.layerScreenSizeCullThresholds));
+    frame.depthSortingOrder = gRenderer->depthSortingOrder;
+
+    gRecorder->inFrame = true;
+}
+
+void captureEndFrame()
+{
+    if (gRecorder == nullptr || !gRecorder->inFrame) return;
+
+    CaptureData::Frame& frame = gRecorder->data.frames.back();
+
+    frame.environment = recordEnvironment(gRenderer->environment);
+    frame.shadowsUpdated = gRenderer->shadowsUpdateTimer >= gRenderer->shadowsUpdateFrequency;
+
+    for (const auto& [id, light] : gRenderer->getLightMap()) {
+        frame.lights.push_back(CaptureData::Light {
+            .type = light.type,
+            .color = light.color,
+            .position = light.position,
+            .direction = light.direction,
+            .energy = light.energy,
+            .maxDistance = light.maxDistance,
+            .attenuation = light.attenuation,
+            .innerCutOff = light.innerCutOff,
+            .outerCutOff = light.outerCutOff,
+            .shadowBias = light.shadowBias,
+            .shadowResolution = (light.shadow && light.map) ? light.map->width() : 0,
+            .layers = light.layers,
+            .enabled = light.enabled
+        });
+    }
+
+    gRecorder->inFrame = false;
+}
+
+void captureModel(const R3D_Model& model, const Matrix& transform)
+{
+    if (gRecorder == nullptr || !gRecorder->inFrame) return;
+
+    int index = recordModel(model);
+
+    CaptureData::Draw& draw = addDraw(CaptureData::DRAW_MODEL, transform, model.shadow, model.billboard, model.layer);
+    draw.aabb = model.aabb;
+    draw.index = index;
+    draw.maxDrawDistance = model.maxDrawDistance;
+    draw.maxShadowDistance = model.maxShadowDistance;
+}
+
+void captureSprite(const R3D_Sprite& sprite, const Matrix& transform)
+{
+    if (gRecorder == nullptr || !gRecorder->inFrame) return;
+
+    CaptureData::Material material = recordMaterial(sprite.material);
+
+    CaptureData::Draw& draw = addDraw(CaptureData::DRAW_SPRITE, transform, sprite.shadow, sprite.billboard, sprite.layer);
+    draw.material = material;
+    draw.currentFrame = sprite.currentFrame;
+    draw.region = sprite.region;
+    draw.frameSize = sprite.frameSize;
+    draw.xFrameCount = sprite.xFrameCount;
+    draw.yFrameCount = sprite.yFrameCount;
+}
+
+void captureParticleSystem(const R3D_ParticleSystemCPU& system)
+{
+    if (gRecorder == nullptr || !gRecorder->inFrame) return;
+
+    int mesh = recordMesh(system.surface.mesh);
+    CaptureData::Material material = recordMaterial(system.surface.material);
+    Matrix transform = MatrixTranslate(system.position.x, system.position.y, system.position.z);
+
+    CaptureData::Draw& draw = addDraw(CaptureData::DRAW_PARTICLE_SYSTEM, transform, system.shadow, system.billboard, system.layer);
+    draw.aabb = system.aabb;
+    draw.index = mesh;
+    draw.material = material;
+
+    draw.particles.reserve(system.particleCount);
+    for (int i = 0; i < system.particleCount; i++) {
+        const R3D_Particle& particle = system.particles[i];
+        draw.particles.push_back({ particle.position, particle.rotation, particle.scale, particle.color });
+    }
+}
+
+} // namespace r3d
+
+/* Public API */
+
+bool R3D_BeginCapture(const char* fileName)
+{
+    if (gRecorder != nullptr) {
+        TraceLog(LOG_WARNING, "R3D: A capture is already being recorded to '%s'", gRecorder->path.c_str());
+        return false;
+    }
+
+    gRecorder = std::make_unique<CaptureRecorder>();
+    gRecorder->path = fileName;
+    gRecorder->data.flags = gRenderer->flags;
+    gRenderer->getInternalResolution(&gRecorder->data.internalWidth, &gRecorder->data.internalHeight);
+
+    return true;
+}
+
+bool R3D_EndCapture(void)
+{
+    if (gRecorder == nullptr) {
+        return false;
+    }
+
+    std::unique_ptr<CaptureRecorder> recorder = std::move(gRecorder);
+
+    // The frame being recorded, if any, is incomplete
+    if (recorder->inFrame) {
+        recorder->data.frames.pop_back();
+    }
+
+    if (!recorder->data.save(recorder->path)) {
+        TraceLog(LOG_WARNING, "R3D: Failed to write the capture '%s'", recorder->path.c_str());
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "R3D: Capture of %i frame(s) written to '%s' (%i meshes, %i textures)",
+        static_cast<int>(recorder->data.frames.size()), recorder->path.c_str(),
+        static_cast<int>(recorder->data.meshes.size()), static_cast<int>(recorder->data.textures.size()));
+
+    return true;
+}
+
+R3D_Capture R3D_LoadCapture(const char* fileName)
+{
+    auto replay = std::make_unique<CaptureReplay>();
+
+    if (!replay->data.load(fileName)) {
+        TraceLog(LOG_WARNING, "R3D: Failed to load the capture '%s'", fileName);
+        return {};
+    }
+
+    const CaptureData& data = replay->data;
+
+    return R3D_Capture {
+        .frameCount = static_cast<int>(data.frames.size()),
+        .internalWidth = data.internalWidth,
+        .internalHeight = data.internalHeight,
+        .flags = data.flags,
+        .internal = replay.release()
+    };
+}
+
+void R3D_UnloadCapture(R3D_Capture* capture)
+{
+    if (capture->internal == nullptr) {
+        return;
+    }
+
+    CaptureReplay* replay = static_cast<CaptureReplay*>(capture->internal);
+
+    if (replay->loaded) {
+        unloadReplayResources(*replay);
+    }
+
+    delete replay;
+    capture->internal = nullptr;
+}
+
+void R3D_ReplayCapture(R3D_Capture* capture, int frame)
+{
+    R3D_TRACE_ZONE("R3D_ReplayCapture");
+
+    CaptureReplay* replay = static_cast<CaptureReplay*>(capture->internal);
+
+    if (replay == nullptr || frame < 0 || frame >= static_cast<int>(replay->data.frames.size())) {
+        return;
+    }
+
+    if (!replay->loaded) {
+        loadReplayResources(*replay);
+    }
+
+    const CaptureData::Frame& record = replay->data.frames[frame];
+
+    // Only the lights of the replayed frame are enabled
+
+    for (size_t i = 0; i < replay->lights.size(); i++) {
+        for (size_t j = 0; j < replay->lights[i].size(); j++) {
+            bool enabled = (static_cast<int>(i) == frame) && replay->data.frames[i].lights[j].enabled;
+            gRenderer->getLight(replay->lights[i][j]).enabled = enabled;
+        }
+    }
+
+    // Environment and renderer state
+
+    const CaptureData::Environment& env = record.environment;
+    R3D_Environment& target = gRenderer->environment;
+
+    target.bloom = { static_cast<R3D_Bloom>(env.bloomMode), env.bloomIntensity, env.bloomHdrThreshold,
+                     env.bloomIterations, static_cast<R3D_BloomFilter>(env.bloomFilter) };
+    target.fog = { static_cast<R3D_Fog>(env.fogMode), env.fogColor, env.fogStart, env.fogEnd, env.fogDensity };
+    target.tonemap = { static_cast<R3D_Tonemap>(env.tonemapMode), env.tonemapExposure, env.tonemapWhite };
+    target.adjustements = { env.brightness, env.contrast, env.saturation, {} };
+    target.world.skybox = nullptr;
+    target.world.background = env.background;
+    target.world.ambient = env.ambient;
+
+    if (env.lut >= 0) {
+        target.adjustements.lut = getReplayTexture(*replay, env.lut);
+    }
+
+    if (env.skyboxSize > 0) {
+        R3D_Skybox& skybox = replay->skyboxes.at(env.skyboxSize);
+        skybox.rotation = env.skyboxRotation;
+        target.world.skybox = &skybox;
+    }
+
+    gRenderer->activeLayers = record.activeLayers;
+    gRenderer->screenSizeCullThreshold = record.screenSizeCullThreshold;
+    std::copy(std::begin(record.layerScreenSizeCullThresholds), std::end(record.layerScreenSizeCullThresholds),
+              std::begin(gRenderer->layerScreenSizeCullThresholds));
+    gRenderer->depthSortingOrder = static_cast<R3D_DepthSortingOrder>(record.depthSortingOrder);
+
+    // Frame
+
+    R3D_Begin(record.camera);
+
+    gRenderer->shadowsUpdateTimer = record.shadowsUpdated ? gRenderer->shadowsUpdateFrequency : -1.0f;
+
+    for (size_t i = 0; i < record.draws.size(); i++) {
+        const CaptureData::Draw& draw = record.draws[i];
+
+        R3D_Transform transform = R3D_CreateTransformIdentity(nullptr);
+        transform.world = &draw.transform;
+
+        switch (draw.type) {
+            case CaptureData::DRAW_MODEL: {
+                R3D_Model model = replay->models[draw.index];
+                model.transform = transform;
+                model.aabb = draw.aabb;
+                model.shadow = static_cast<R3D_CastShadow>(draw.shadow);
+                model.billboard = static_cast<R3D_BillboardMode>(draw.billboard);
+                model.layer = static_cast<R3D_Layer>(draw.layer);
+                model.maxDrawDistance = draw.maxDrawDistance;
+                model.maxShadowDistance = draw.maxShadowDistance;
+                R3D_DrawModel(&model);
+            } break;
+
+            case CaptureData::DRAW_SPRITE: {
+                R3D_Sprite sprite{};
+                sprite.transform = transform;
+                sprite.material = getReplayMaterial(*replay, draw.material);
+                sprite.currentFrame = draw.currentFrame;
+                sprite.region = draw.region;
+                sprite.frameSize = draw.frameSize;
+                sprite.xFrameCount = draw.xFrameCount;
+                sprite.yFrameCount = draw.yFrameCount;
+                sprite.shadow = static_cast<R3D_CastShadow>(draw.shadow);
+                sprite.billboard = static_cast<R3D_BillboardMode>(draw.billboard);
+                sprite.layer = static_cast<R3D_Layer>(draw.layer);
+                // The recorded transform already contains the size of the sprite,
+                // which 'R3D_DrawSpritePro' halves before applying it
+                R3D_DrawSpritePro(&sprite, {}, {}, 0.0f, { 2.0f, 2.0f });
+            } break;
+
+            case CaptureData::DRAW_PARTICLE_SYSTEM: {
+                R3D_DrawParticleSystemCPU(replay->particleSystems[frame][i]);
+            } break;
+
+            default:
+                break;
+        }
+    }
+
+    R3D_End();
+}
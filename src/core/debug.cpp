@@ -28,6 +28,38 @@ void R3D_GetDrawCallCount(int* sceneDrawCount, int* shadowDrawCount)
     gRenderer->getDrawCallCount(sceneDrawCount, shadowDrawCount);
 }
 
+int R3D_GetLightShadowDrawCount(R3D_Light light)
+{
+    return gRenderer->getLight(light).shadowDrawCount;
+}
+
+R3D_FrameStats R3D_GetFrameStats()
+{
+    return gRenderer->getFrameStats();
+}
+
+int R3D_GetGPUZoneCount()
+{
+    return static_cast<int>(gRenderer->getGPUProfiler().zones().size());
+}
+
+R3D_GPUZone R3D_GetGPUZone(int index)
+{
+    const auto& zones = gRenderer->getGPUProfiler().zones();
+
+    if (index < 0 || index >= static_cast<int>(zones.size())) {
+        return R3D_GPUZone { nullptr, 0, 0.0f, 0.0f };
+    }
+
+    const auto& zone = zones[index];
+
+    return R3D_GPUZone {
+        zone.name.c_str(), zone.depth,
+        static_cast<float>(zone.time),
+        static_cast<float>(zone.average)
+    };
+}
+
 void R3D_DrawShadowMap(R3D_Light light, int x, int y, int width, int height, float zNear, float zFar)
 {
     gRenderer->drawShadowMap(light, x, y, width, height, zNear, zFar);
@@ -73,6 +73,16 @@ void R3D_SetEnvBloomIterations(int iterations)
     gRenderer->environment.bloom.iterations = iterations;
 }
 
+R3D_BloomFilter R3D_GetEnvBloomFilter()
+{
+    return gRenderer->environment.bloom.filter;
+}
+
+void R3D_SetEnvBloomFilter(R3D_BloomFilter filter)
+{
+    gRenderer->environment.bloom.filter = filter;
+}
+
 R3D_Fog R3D_GetEnvFogMode()
 {
     return gRenderer->environment.fog.mode;
@@ -183,6 +193,16 @@ void R3D_SetEnvAdjustSaturation(float saturation)
     gRenderer->environment.adjustements.saturation = saturation;
 }
 
+Texture2D R3D_GetEnvAdjustLUT()
+{
+    return gRenderer->environment.adjustements.lut;
+}
+
+void R3D_SetEnvAdjustLUT(Texture2D lut)
+{
+    gRenderer->environment.adjustements.lut = lut;
+}
+
 R3D_Skybox* R3D_GetEnvWorldSkybox()
 {
     return gRenderer->environment.world.skybox;
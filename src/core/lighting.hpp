@@ -56,6 +56,7 @@ struct Light
     bool enabled;                    ///< Flag indicating whether the light is active.
     R3D_LightType type;              ///< Type of the light (e.g., directional, point, spotlight).
     int layers;                      ///< Represents the layers (`R3D_Layer`) in which the light illuminates
+    int shadowDrawCount = 0;         ///< Number of draw calls of the last update of the shadow map.
 
     /**
      * @brief Constructs a light of the specified type.
@@ -228,7 +229,7 @@ inline Matrix Light::projMatrix() const
 
 inline Matrix Light::vpMatrix(int face) const
 {
-    return MatrixMultiply(viewMatrix(face), projMatrix());
+    return simdMatrixMultiply(viewMatrix(face), projMatrix());
 }
 
 } // namespace r3d
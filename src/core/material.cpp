@@ -30,12 +30,12 @@ R3D_MaterialConfig R3D_CreateMaterialConfig(R3D_DiffuseMode diffuse, R3D_Specula
         .shader {
             .diffuse = static_cast<uint8_t>(diffuse),
             .specular = static_cast<uint8_t>(specular),
-            .reserved = 0,
+            .billboard = R3D_BILLBOARD_DISABLED,
             .flags = static_cast<uint8_t>(flags)
         },
         .blendMode = static_cast<uint8_t>(blendMode),
         .cullMode = static_cast<uint8_t>(cullMode),
-        .reserved1 = 0,
+        .renderScale = R3D_RENDER_SCALE_FULL,
         .reserved2 = 0
     };
 
@@ -93,6 +93,18 @@ void R3D_RegisterMaterialConfig(R3D_MaterialConfig config)
     gRenderer->loadMaterialConfig(config);
 }
 
+void R3D_PrecompileMaterialConfigs(const R3D_MaterialConfig* configs, int count)
+{
+    for (int i = 0; i < count; i++) {
+        gRenderer->precompileMaterialConfig(configs[i]);
+    }
+}
+
+int R3D_GetPendingShaderCompileCount(void)
+{
+    return gRenderer->getPendingShaderCount();
+}
+
 void R3D_UnloadMaterialConfig(R3D_MaterialConfig config)
 {
     gRenderer->unloadMaterialConfig(config);
@@ -0,0 +1,858 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "r3d.h"
+
+#include "../detail/null_backend.h"
+#include "../detail/gl.hpp"
+
+#include <raylib.h>
+#include <rlgl.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+
+#ifdef GLAD_API_PTR
+#   define NULL_GL_API GLAD_API_PTR
+#else
+#   define NULL_GL_API
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#   define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+/* Internal data */
+
+namespace {
+
+using NullProc = void (*)(void);
+
+struct NullUniform
+{
+    std::string name;   ///< Name as reported by 'glGetActiveUniform' ("u[0]" for the arrays).
+    GLint size;         ///< Number of elements of the arrays, one otherwise.
+    GLenum type;        ///< Type of the uniform, only samplers are distinguished from 'GL_FLOAT' types.
+};
+
+struct NullProgram
+{
+    std::vector<GLuint> shaders;                        ///< Attached shaders.
+    std::vector<NullUniform> uniforms;                  ///< Active uniforms found when linking.
+    std::unordered_map<std::string, GLint> locations;   ///< Location of each uniform and array element.
+};
+
+struct NullMember
+{
+    std::string type;   ///< GLSL type of the declaration.
+    std::string name;   ///< Name of the declared variable.
+    int arraySize;      ///< Number of elements, zero if the variable is not an array.
+};
+
+bool gActive = false;
+
+std::vector<R3D_Command> gCommands;         ///< Commands recorded since the beginning of the frame.
+std::vector<R3D_Command> gLastCommands;     ///< Commands of the last complete frame.
+
+std::unordered_map<GLuint, std::string> gShaders;
+std::unordered_map<GLuint, NullProgram> gPrograms;
+
+GLuint gNextObject = 1;         ///< Next name returned by the 'glGen*' and 'glCreate*' functions.
+GLuint gCurrentProgram = 0;
+GLint gActiveTextureUnit = 0;
+GLint gViewport[4]{};
+
+void record(R3D_CommandType type, GLuint object, GLint value)
+{
+    gCommands.push_back(R3D_Command { static_cast<unsigned int>(type), object, value });
+}
+
+void generate(GLsizei n, GLuint* names)
+{
+    for (GLsizei i = 0; i < n; i++) {
+        names[i] = gNextObject++;
+    }
+}
+
+/* Shader source parsing */
+
+// NOTE: The parser below only knows the subset of GLSL used by the shaders of the library and
+//       raylib. Conditional directives are ignored, so the uniforms of all branches are declared,
+//       which is harmless since real drivers also report some uniforms and not others.
+
+std::string stripComments(const std::string& source)
+{
+    std::string result;
+    result.reserve(source.size());
+
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source.compare(i, 2, "//") == 0) {
+            i = source.find('\n', i);
+            if (i == std::string::npos) break;
+            result += '\n';
+        } else if (source.compare(i, 2, "/*") == 0) {
+            i = source.find("*/", i + 2);
+            if (i == std::string::npos) break;
+            i++;
+        } else {
+            result += source[i];
+        }
+    }
+
+    return result;
+}
+
+std::vector<std::string> tokenize(const std::string& text)
+{
+    std::vector<std::string> tokens;
+    std::string token;
+
+    for (char c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+            token += c;
+            continue;
+        }
+        if (!token.empty()) {
+            tokens.push_back(std::move(token));
+            token.clear();
+        }
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            tokens.push_back(std::string(1, c));
+        }
+    }
+
+    if (!token.empty()) {
+        tokens.push_back(std::move(token));
+    }
+
+    return tokens;
+}
+
+int evaluateSize(std::string token, const std::unordered_map<std::string, std::string>& defines)
+{
+    for (int depth = 0; depth < 8; depth++) {
+        if (!token.empty() && std::isdigit(static_cast<unsigned char>(token[0]))) {
+            return std::atoi(token.c_str());
+        }
+        auto it = defines.find(token);
+        if (it == defines.end()) break;
+        token = it->second;
+    }
+    return 1;
+}
+
+/**
+ * Parses a declaration such as "lowp vec3 a, b[4]" without its trailing semicolon.
+ */
+std::vector<NullMember> parseDeclaration(const std::string& text, const std::unordered_map<std::string, std::string>& defines)
+{
+    static const char* qualifiers[] = {
+        "const", "lowp", "mediump", "highp", "flat", "smooth", "noperspective", "invariant"
+    };
+
+    std::vector<NullMember> members;
+    std::vector<std::string> tokens = tokenize(text);
+    std::string type;
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+        const std::string& token = tokens[i];
+
+        if (token == "layout") {
+            while (i < tokens.size() && tokens[i] != ")") i++;
+            continue;
+        }
+        if (std::find(std::begin(qualifiers), std::end(qualifiers), token) != std::end(qualifiers)) {
+            continue;
+        }
+        if (token == ",") {
+            continue;
+        }
+        if (type.empty()) {
+            type = token;
+            continue;
+        }
+
+        NullMember member { type, token, 0 };
+        if (i + 2 < tokens.size() && tokens[i + 1] == "[") {
+            member.arraySize = evaluateSize(tokens[i + 2], defines);
+            while (i < tokens.size() && tokens[i] != "]") i++;
+        }
+        members.push_back(std::move(member));
+    }
+
+    return members;
+}
+
+GLenum uniformType(const std::string& type)
+{
+    static const std::unordered_map<std::string, GLenum> types = {
+        { "bool", GL_BOOL }, { "int", GL_INT }, { "uint", GL_UNSIGNED_INT }, { "float", GL_FLOAT },
+        { "vec2", GL_FLOAT_VEC2 }, { "vec3", GL_FLOAT_VEC3 }, { "vec4", GL_FLOAT_VEC4 },
+        { "ivec2", GL_INT_VEC2 }, { "ivec3", GL_INT_VEC3 }, { "ivec4", GL_INT_VEC4 },
+        { "mat2", GL_FLOAT_MAT2 }, { "mat3", GL_FLOAT_MAT3 }, { "mat4", GL_FLOAT_MAT4 },
+        { "sampler1D", GL_SAMPLER_1D }, { "sampler2D", GL_SAMPLER_2D }, { "sampler3D", GL_SAMPLER_3D },
+        { "samplerCube", GL_SAMPLER_CUBE }, { "sampler2DShadow", GL_SAMPLER_2D_SHADOW }
+    };
+
+    auto it = types.find(type);
+    return (it != types.end()) ? it->second : GL_FLOAT;
+}
+
+void declareUniform(NullProgram& program, const NullMember& uniform,
+                    const std::unordered_map<std::string, std::vector<NullMember>>& structs)
+{
+    int count = (uniform.arraySize > 0) ? uniform.arraySize : 1;
+
+    auto structIt = structs.find(uniform.type);
+
+    if (structIt != structs.end()) {
+        // GL reports each member of each element of the arrays of structures
+        for (int i = 0; i < count; i++) {
+            std::string base = uniform.name;
+            if (uniform.arraySize > 0) {
+                base += "[" + std::to_string(i) + "]";
+            }
+            for (const NullMember& member : structIt->second) {
+                declareUniform(program, NullMember { member.type, base + "." + member.name, member.arraySize }, structs);
+            }
+        }
+        return;
+    }
+
+    std::string name = uniform.name;
+    if (uniform.arraySize > 0) {
+        name += "[0]";
+    }
+
+    if (program.locations.contains(name)) {
+        return; // Declared by several shaders of the program
+    }
+
+    program.uniforms.push_back(NullUniform { name, count, uniformType(uniform.type) });
+
+    if (uniform.arraySize > 0) {
+        for (int i = 0; i < count; i++) {
+            GLint location = static_cast<GLint>(program.locations.size());
+            program.locations.emplace(uniform.name + "[" + std::to_string(i) + "]", location);
+        }
+    } else {
+        GLint location = static_cast<GLint>(program.locations.size());
+        program.locations.emplace(name, location);
+    }
+}
+
+void parseUniforms(NullProgram& program, const std::string& source)
+{
+    std::unordered_map<std::string, std::string> defines;
+    std::unordered_map<std::string, std::vector<NullMember>> structs;
+
+    // Collects the defines, keeping the first definition of each macro
+    // since the configuration defines are inserted before the shader code
+
+    std::string stripped = stripComments(source);
+    std::string code;
+
+    for (size_t start = 0; start < stripped.size();) {
+        size_t end = stripped.find('\n', start);
+        if (end == std::string::npos) end = stripped.size();
+
+        std::string line = stripped.substr(start, end - start);
+        std::vector<std::string> tokens = tokenize(line);
+
+        if (tokens.size() >= 2 && tokens[0] == "#") {
+            if (tokens[1] == "define" && tokens.size() >= 4) {
+                defines.try_emplace(tokens[2], tokens[3]);
+            }
+        } else {
+            code += line;
+            code += '\n';
+        }
+
+        start = end + 1;
+    }
+
+    // Collects the structures and the uniforms, skipping the uniform blocks
+
+    std::vector<std::string> tokens = tokenize(code);
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i] == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{") {
+            std::string name = tokens[i + 1];
+            std::vector<NullMember> members;
+            std::string declaration;
+            for (i += 3; i < tokens.size() && tokens[i] != "}"; i++) {
+                if (tokens[i] == ";") {
+                    for (NullMember& member : parseDeclaration(declaration, defines)) {
+                        members.push_back(std::move(member));
+                    }
+                    declaration.clear();
+                } else {
+                    declaration += tokens[i] + " ";
+                }
+            }
+            structs[name] = std::move(members);
+        } else if (tokens[i] == "uniform") {
+            std::string declaration;
+            bool block = false;
+            for (i++; i < tokens.size() && tokens[i] != ";"; i++) {
+                if (tokens[i] == "{") {
+                    while (i < tokens.size() && tokens[i] != "}") i++;
+                    block = true;
+                } else {
+                    declaration += tokens[i] + " ";
+                }
+            }
+            if (!block) {
+                for (const NullMember& uniform : parseDeclaration(declaration, defines)) {
+                    declareUniform(program, uniform, structs);
+                }
+            }
+        }
+    }
+}
+
+/* Stub functions */
+
+const GLubyte* NULL_GL_API nullGetString(GLenum name)
+{
+    const char* str = "";
+    switch (name) {
+        case GL_VENDOR: str = "R3D"; break;
+        case GL_RENDERER: str = "R3D Null Backend"; break;
+        case GL_VERSION: str = "3.3.0 R3D Null Backend"; break;
+        case GL_SHADING_LANGUAGE_VERSION: str = "3.30"; break;
+        default: break;
+    }
+    return reinterpret_cast<const GLubyte*>(str);
+}
+
+const GLubyte* NULL_GL_API nullGetStringi(GLenum, GLuint)
+{
+    return reinterpret_cast<const GLubyte*>("");
+}
+
+void NULL_GL_API nullGetIntegerv(GLenum pname, GLint* data)
+{
+    switch (pname) {
+        case GL_MAJOR_VERSION: *data = 3; break;
+        case GL_MINOR_VERSION: *data = 3; break;
+        case GL_MAX_TEXTURE_SIZE: *data = 16384; break;
+        case GL_MAX_TEXTURE_IMAGE_UNITS: *data = 16; break;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: *data = 48; break;
+        case GL_MAX_DRAW_BUFFERS: *data = 8; break;
+        case GL_MAX_COLOR_ATTACHMENTS: *data = 8; break;
+        case GL_MAX_SAMPLES: *data = 8; break;
+        case GL_CURRENT_PROGRAM: *data = static_cast<GLint>(gCurrentProgram); break;
+        case GL_ACTIVE_TEXTURE: *data = GL_TEXTURE0 + gActiveTextureUnit; break;
+        case GL_VIEWPORT: std::memcpy(data, gViewport, sizeof(gViewport)); break;
+        default: *data = 0; break;
+    }
+}
+
+void NULL_GL_API nullGetFloatv(GLenum pname, GLfloat* data)
+{
+    *data = (pname == GL_MAX_TEXTURE_MAX_ANISOTROPY) ? 16.0f : 0.0f;
+}
+
+GLenum NULL_GL_API nullGetError(void) { return GL_NO_ERROR; }
+GLenum NULL_GL_API nullCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+
+void NULL_GL_API nullGenBuffers(GLsizei n, GLuint* buffers) { generate(n, buffers); }
+void NULL_GL_API nullGenFramebuffers(GLsizei n, GLuint* framebuffers) { generate(n, framebuffers); }
+void NULL_GL_API nullGenQueries(GLsizei n, GLuint* ids) { generate(n, ids); }
+void NULL_GL_API nullGenRenderbuffers(GLsizei n, GLuint* renderbuffers) { generate(n, renderbuffers); }
+void NULL_GL_API nullGenTextures(GLsizei n, GLuint* textures) { generate(n, textures); }
+void NULL_GL_API nullGenVertexArrays(GLsizei n, GLuint* arrays) { generate(n, arrays); }
+
+void NULL_GL_API nullDeleteObjects(GLsizei, const GLuint*) { }
+
+GLuint NULL_GL_API nullCreateShader(GLenum)
+{
+    GLuint shader = gNextObject++;
+    gShaders[shader];
+    return shader;
+}
+
+void NULL_GL_API nullShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    std::string& source = gShaders[shader];
+    source.clear();
+
+    for (GLsizei i = 0; i < count; i++) {
+        if (length != nullptr && length[i] >= 0) source.append(string[i], length[i]);
+        else source.append(string[i]);
+    }
+}
+
+void NULL_GL_API nullCompileShader(GLuint) { }
+void NULL_GL_API nullDeleteShader(GLuint shader) { gShaders.erase(shader); }
+
+void NULL_GL_API nullGetShaderiv(GLuint, GLenum pname, GLint* params)
+{
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void NULL_GL_API nullGetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if (length != nullptr) *length = 0;
+    if (bufSize > 0) infoLog[0] = '\0';
+}
+
+GLuint NULL_GL_API nullCreateProgram(void)
+{
+    GLuint program = gNextObject++;
+    gPrograms[program];
+    return program;
+}
+
+void NULL_GL_API nullDeleteProgram(GLuint program) { gPrograms.erase(program); }
+void NULL_GL_API nullAttachShader(GLuint program, GLuint shader) { gPrograms[program].shaders.push_back(shader); }
+void NULL_GL_API nullDetachShader(GLuint, GLuint) { }
+void NULL_GL_API nullBindAttribLocation(GLuint, GLuint, const GLchar*) { }
+void NULL_GL_API nullProgramParameteri(GLuint, GLenum, GLint) { }
+void NULL_GL_API nullProgramBinary(GLuint, GLenum, const void*, GLsizei) { }
+void NULL_GL_API nullGetProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*) { if (length) *length = 0; }
+
+void NULL_GL_API nullLinkProgram(GLuint id)
+{
+    NullProgram& program = gPrograms[id];
+    program.uniforms.clear();
+    program.locations.clear();
+
+    for (GLuint shader : program.shaders) {
+        parseUniforms(program, gShaders[shader]);
+    }
+}
+
+void NULL_GL_API nullGetProgramiv(GLuint id, GLenum pname, GLint* params)
+{
+    switch (pname) {
+        case GL_LINK_STATUS:
+        case GL_VALIDATE_STATUS:
+        case GL_COMPLETION_STATUS_KHR:
+            *params = GL_TRUE;
+            break;
+        case GL_ACTIVE_UNIFORMS:
+            *params = static_cast<GLint>(gPrograms[id].uniforms.size());
+            break;
+        default:
+            *params = 0;
+            break;
+    }
+}
+
+void NULL_GL_API nullGetActiveUniform(GLuint id, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    const NullProgram& program = gPrograms[id];
+
+    if (index >= program.uniforms.size() || bufSize <= 0) {
+        if (length != nullptr) *length = 0;
+        return;
+    }
+
+    const NullUniform& uniform = program.uniforms[index];
+    GLsizei count = std::min(static_cast<GLsizei>(uniform.name.size()), bufSize - 1);
+
+    std::memcpy(name, uniform.name.data(), count);
+    name[count] = '\0';
+
+    if (length != nullptr) *length = count;
+    *size = uniform.size;
+    *type = uniform.type;
+}
+
+GLint NULL_GL_API nullGetUniformLocation(GLuint id, const GLchar* name)
+{
+    const NullProgram& program = gPrograms[id];
+
+    auto it = program.locations.find(name);
+    if (it == program.locations.end()) {
+        it = program.locations.find(std::string(name) + "[0]");
+    }
+
+    return (it != program.locations.end()) ? it->second : -1;
+}
+
+GLint NULL_GL_API nullGetAttribLocation(GLuint, const GLchar*) { return -1; }
+GLuint NULL_GL_API nullGetUniformBlockIndex(GLuint, const GLchar*) { return 0; }
+void NULL_GL_API nullUniformBlockBinding(GLuint, GLuint, GLuint) { }
+
+void NULL_GL_API nullUseProgram(GLuint program)
+{
+    gCurrentProgram = program;
+    record(R3D_COMMAND_BIND_PROGRAM, program, 0);
+}
+
+void NULL_GL_API nullActiveTexture(GLenum texture) { gActiveTextureUnit = static_cast<GLint>(texture - GL_TEXTURE0); }
+void NULL_GL_API nullBindTexture(GLenum, GLuint texture) { record(R3D_COMMAND_BIND_TEXTURE, texture, gActiveTextureUnit); }
+void NULL_GL_API nullBindFramebuffer(GLenum target, GLuint framebuffer) { record(R3D_COMMAND_BIND_FRAMEBUFFER, framebuffer, static_cast<GLint>(target)); }
+void NULL_GL_API nullBindVertexArray(GLuint array) { record(R3D_COMMAND_BIND_VERTEX_ARRAY, array, 0); }
+void NULL_GL_API nullBindBuffer(GLenum target, GLuint buffer) { record(R3D_COMMAND_BIND_BUFFER, buffer, static_cast<GLint>(target)); }
+void NULL_GL_API nullBindBufferBase(GLenum target, GLuint, GLuint buffer) { record(R3D_COMMAND_BIND_BUFFER, buffer, static_cast<GLint>(target)); }
+void NULL_GL_API nullBindRenderbuffer(GLenum, GLuint renderbuffer) { record(R3D_COMMAND_STATE, GL_RENDERBUFFER_BINDING, static_cast<GLint>(renderbuffer)); }
+
+// NOTE: The uniform functions only record the upload, their values are not stored
+
+void uniform(GLint location) { record(R3D_COMMAND_UNIFORM, gCurrentProgram, location); }
+
+void NULL_GL_API nullUniform1f(GLint location, GLfloat) { uniform(location); }
+void NULL_GL_API nullUniform2f(GLint location, GLfloat, GLfloat) { uniform(location); }
+void NULL_GL_API nullUniform3f(GLint location, GLfloat, GLfloat, GLfloat) { uniform(location); }
+void NULL_GL_API nullUniform4f(GLint location, GLfloat, GLfloat, GLfloat, GLfloat) { uniform(location); }
+void NULL_GL_API nullUniform1i(GLint location, GLint) { uniform(location); }
+void NULL_GL_API nullUniform2i(GLint location, GLint, GLint) { uniform(location); }
+void NULL_GL_API nullUniform3i(GLint location, GLint, GLint, GLint) { uniform(location); }
+void NULL_GL_API nullUniform4i(GLint location, GLint, GLint, GLint, GLint) { uniform(location); }
+void NULL_GL_API nullUniformfv(GLint location, GLsizei, const GLfloat*) { uniform(location); }
+void NULL_GL_API nullUniformiv(GLint location, GLsizei, const GLint*) { uniform(location); }
+void NULL_GL_API nullUniformuiv(GLint location, GLsizei, const GLuint*) { uniform(location); }
+void NULL_GL_API nullUniformMatrixfv(GLint location, GLsizei, GLboolean, const GLfloat*) { uniform(location); }
+
+void NULL_GL_API nullDrawArrays(GLenum, GLint, GLsizei count) { record(R3D_COMMAND_DRAW, 1, count); }
+void NULL_GL_API nullDrawElements(GLenum, GLsizei count, GLenum, const void*) { record(R3D_COMMAND_DRAW, 1, count); }
+void NULL_GL_API nullDrawArraysInstanced(GLenum, GLint, GLsizei count, GLsizei instances) { record(R3D_COMMAND_DRAW, instances, count); }
+void NULL_GL_API nullDrawElementsInstanced(GLenum, GLsizei count, GLenum, const void*, GLsizei instances) { record(R3D_COMMAND_DRAW, instances, count); }
+
+void NULL_GL_API nullClear(GLbitfield mask) { record(R3D_COMMAND_CLEAR, 0, static_cast<GLint>(mask)); }
+
+void NULL_GL_API nullBlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield mask, GLenum)
+{
+    record(R3D_COMMAND_BLIT, 0, static_cast<GLint>(mask));
+}
+
+void NULL_GL_API nullEnable(GLenum cap) { record(R3D_COMMAND_STATE, cap, GL_TRUE); }
+void NULL_GL_API nullDisable(GLenum cap) { record(R3D_COMMAND_STATE, cap, GL_FALSE); }
+void NULL_GL_API nullEnablei(GLenum cap, GLuint) { record(R3D_COMMAND_STATE, cap, GL_TRUE); }
+void NULL_GL_API nullDisablei(GLenum cap, GLuint) { record(R3D_COMMAND_STATE, cap, GL_FALSE); }
+void NULL_GL_API nullDepthMask(GLboolean flag) { record(R3D_COMMAND_STATE, GL_DEPTH_WRITEMASK, flag); }
+void NULL_GL_API nullDepthFunc(GLenum func) { record(R3D_COMMAND_STATE, GL_DEPTH_FUNC, static_cast<GLint>(func)); }
+void NULL_GL_API nullCullFace(GLenum mode) { record(R3D_COMMAND_STATE, GL_CULL_FACE_MODE, static_cast<GLint>(mode)); }
+void NULL_GL_API nullFrontFace(GLenum mode) { record(R3D_COMMAND_STATE, GL_FRONT_FACE, static_cast<GLint>(mode)); }
+void NULL_GL_API nullBlendFunc(GLenum sfactor, GLenum) { record(R3D_COMMAND_STATE, GL_BLEND_SRC, static_cast<GLint>(sfactor)); }
+void NULL_GL_API nullBlendFuncSeparate(GLenum sfactor, GLenum, GLenum, GLenum) { record(R3D_COMMAND_STATE, GL_BLEND_SRC, static_cast<GLint>(sfactor)); }
+void NULL_GL_API nullBlendEquation(GLenum mode) { record(R3D_COMMAND_STATE, GL_BLEND_EQUATION, static_cast<GLint>(mode)); }
+void NULL_GL_API nullBlendEquationSeparate(GLenum mode, GLenum) { record(R3D_COMMAND_STATE, GL_BLEND_EQUATION, static_cast<GLint>(mode)); }
+void NULL_GL_API nullColorMask(GLboolean red, GLboolean, GLboolean, GLboolean) { record(R3D_COMMAND_STATE, GL_COLOR_WRITEMASK, red); }
+void NULL_GL_API nullClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { record(R3D_COMMAND_STATE, GL_COLOR_CLEAR_VALUE, 0); }
+void NULL_GL_API nullClearDepth(GLdouble) { record(R3D_COMMAND_STATE, GL_DEPTH_CLEAR_VALUE, 0); }
+void NULL_GL_API nullLineWidth(GLfloat) { record(R3D_COMMAND_STATE, GL_LINE_WIDTH, 0); }
+void NULL_GL_API nullPolygonMode(GLenum, GLenum mode) { record(R3D_COMMAND_STATE, GL_POLYGON_MODE, static_cast<GLint>(mode)); }
+void NULL_GL_API nullScissor(GLint, GLint, GLsizei, GLsizei) { record(R3D_COMMAND_STATE, GL_SCISSOR_BOX, 0); }
+void NULL_GL_API nullDrawBuffer(GLenum buf) { record(R3D_COMMAND_STATE, GL_DRAW_BUFFER, static_cast<GLint>(buf)); }
+void NULL_GL_API nullDrawBuffers(GLsizei n, const GLenum*) { record(R3D_COMMAND_STATE, GL_DRAW_BUFFER, n); }
+void NULL_GL_API nullReadBuffer(GLenum src) { record(R3D_COMMAND_STATE, GL_READ_BUFFER, static_cast<GLint>(src)); }
+void NULL_GL_API nullPixelStorei(GLenum pname, GLint param) { record(R3D_COMMAND_STATE, pname, param); }
+void NULL_GL_API nullTexParameteri(GLenum, GLenum pname, GLint param) { record(R3D_COMMAND_STATE, pname, param); }
+void NULL_GL_API nullTexParameterf(GLenum, GLenum pname, GLfloat) { record(R3D_COMMAND_STATE, pname, 0); }
+void NULL_GL_API nullTexParameterfv(GLenum, GLenum pname, const GLfloat*) { record(R3D_COMMAND_STATE, pname, 0); }
+
+void NULL_GL_API nullViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    gViewport[0] = x, gViewport[1] = y;
+    gViewport[2] = width, gViewport[3] = height;
+    record(R3D_COMMAND_STATE, GL_VIEWPORT, 0);
+}
+
+void NULL_GL_API nullVertexAttribPointer(GLuint index, GLint, GLenum, GLboolean, GLsizei, const void*) { record(R3D_COMMAND_STATE, GL_VERTEX_ATTRIB_ARRAY_POINTER, static_cast<GLint>(index)); }
+void NULL_GL_API nullVertexAttribIPointer(GLuint index, GLint, GLenum, GLsizei, const void*) { record(R3D_COMMAND_STATE, GL_VERTEX_ATTRIB_ARRAY_POINTER, static_cast<GLint>(index)); }
+void NULL_GL_API nullEnableVertexAttribArray(GLuint index) { record(R3D_COMMAND_STATE, GL_VERTEX_ATTRIB_ARRAY_ENABLED, static_cast<GLint>(index)); }
+void NULL_GL_API nullDisableVertexAttribArray(GLuint index) { record(R3D_COMMAND_STATE, GL_VERTEX_ATTRIB_ARRAY_ENABLED, static_cast<GLint>(index)); }
+void NULL_GL_API nullVertexAttribDivisor(GLuint index, GLuint) { record(R3D_COMMAND_STATE, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, static_cast<GLint>(index)); }
+void NULL_GL_API nullVertexAttribfv(GLuint index, const GLfloat*) { record(R3D_COMMAND_STATE, GL_CURRENT_VERTEX_ATTRIB, static_cast<GLint>(index)); }
+
+// NOTE: The size of the uploads is in bytes for the buffers and in texels for the textures
+
+void NULL_GL_API nullBufferData(GLenum target, GLsizeiptr size, const void*, GLenum) { record(R3D_COMMAND_UPLOAD, target, static_cast<GLint>(size)); }
+void NULL_GL_API nullBufferSubData(GLenum target, GLintptr, GLsizeiptr size, const void*) { record(R3D_COMMAND_UPLOAD, target, static_cast<GLint>(size)); }
+
+void NULL_GL_API nullTexImage1D(GLenum target, GLint, GLint, GLsizei width, GLint, GLenum, GLenum, const void*)
+{
+    record(R3D_COMMAND_UPLOAD, target, width);
+}
+
+void NULL_GL_API nullTexImage2D(GLenum target, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum, GLenum, const void*)
+{
+    record(R3D_COMMAND_UPLOAD, target, width * height);
+}
+
+void NULL_GL_API nullTexImage3D(GLenum target, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum, GLenum, const void*)
+{
+    record(R3D_COMMAND_UPLOAD, target, width * height * depth);
+}
+
+void NULL_GL_API nullTexSubImage2D(GLenum target, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, const void*)
+{
+    record(R3D_COMMAND_UPLOAD, target, width * height);
+}
+
+void NULL_GL_API nullCompressedTexImage2D(GLenum target, GLint, GLenum, GLsizei width, GLsizei height, GLint, GLsizei, const void*)
+{
+    record(R3D_COMMAND_UPLOAD, target, width * height);
+}
+
+void NULL_GL_API nullGenerateMipmap(GLenum target) { record(R3D_COMMAND_UPLOAD, target, 0); }
+
+void NULL_GL_API nullFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) { }
+void NULL_GL_API nullFramebufferTextureLayer(GLenum, GLenum, GLuint, GLint, GLint) { }
+void NULL_GL_API nullFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) { }
+void NULL_GL_API nullRenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) { }
+void NULL_GL_API nullRenderbufferStorageMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei) { }
+
+void NULL_GL_API nullReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*) { }
+void NULL_GL_API nullGetTexImage(GLenum, GLint, GLenum, GLenum, void*) { }
+
+// NOTE: Timestamps are reported without any bit, so the GPU profiler considers them unsupported
+
+void NULL_GL_API nullGetQueryiv(GLenum, GLenum, GLint* params) { *params = 0; }
+void NULL_GL_API nullQueryCounter(GLuint, GLenum) { }
+void NULL_GL_API nullGetQueryObjectiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+void NULL_GL_API nullGetQueryObjectui64v(GLuint, GLenum, GLuint64* params) { *params = 0; }
+void NULL_GL_API nullBeginQuery(GLenum, GLuint) { }
+void NULL_GL_API nullEndQuery(GLenum) { }
+void NULL_GL_API nullBeginConditionalRender(GLuint, GLenum) { }
+void NULL_GL_API nullEndConditionalRender(void) { }
+
+void NULL_GL_API nullFlush(void) { }
+
+template <typename Fn>
+NullProc proc(Fn fn)
+{
+    return reinterpret_cast<NullProc>(fn);
+}
+
+// NOTE: The functions missing from this table are left unloaded by glad,
+//       they are not used by the library nor by rlgl with OpenGL 3.3
+
+const std::unordered_map<std::string, NullProc> gProcs = {
+    { "glGetString", proc(&nullGetString) },
+    { "glGetStringi", proc(&nullGetStringi) },
+    { "glGetIntegerv", proc(&nullGetIntegerv) },
+    { "glGetFloatv", proc(&nullGetFloatv) },
+    { "glGetError", proc(&nullGetError) },
+    { "glCheckFramebufferStatus", proc(&nullCheckFramebufferStatus) },
+    { "glGenBuffers", proc(&nullGenBuffers) },
+    { "glGenFramebuffers", proc(&nullGenFramebuffers) },
+    { "glGenQueries", proc(&nullGenQueries) },
+    { "glGenRenderbuffers", proc(&nullGenRenderbuffers) },
+    { "glGenTextures", proc(&nullGenTextures) },
+    { "glGenVertexArrays", proc(&nullGenVertexArrays) },
+    { "glDeleteBuffers", proc(&nullDeleteObjects) },
+    { "glDeleteFramebuffers", proc(&nullDeleteObjects) },
+    { "glDeleteQueries", proc(&nullDeleteObjects) },
+    { "glDeleteRenderbuffers", proc(&nullDeleteObjects) },
+    { "glDeleteTextures", proc(&nullDeleteObjects) },
+    { "glDeleteVertexArrays", proc(&nullDeleteObjects) },
+    { "glCreateShader", proc(&nullCreateShader) },
+    { "glShaderSource", proc(&nullShaderSource) },
+    { "glCompileShader", proc(&nullCompileShader) },
+    { "glDeleteShader", proc(&nullDeleteShader) },
+    { "glGetShaderiv", proc(&nullGetShaderiv) },
+    { "glGetShaderInfoLog", proc(&nullGetInfoLog) },
+    { "glGetProgramInfoLog", proc(&nullGetInfoLog) },
+    { "glCreateProgram", proc(&nullCreateProgram) },
+    { "glDeleteProgram", proc(&nullDeleteProgram) },
+    { "glAttachShader", proc(&nullAttachShader) },
+    { "glDetachShader", proc(&nullDetachShader) },
+    { "glBindAttribLocation", proc(&nullBindAttribLocation) },
+    { "glProgramParameteri", proc(&nullProgramParameteri) },
+    { "glProgramBinary", proc(&nullProgramBinary) },
+    { "glGetProgramBinary", proc(&nullGetProgramBinary) },
+    { "glLinkProgram", proc(&nullLinkProgram) },
+    { "glGetProgramiv", proc(&nullGetProgramiv) },
+    { "glGetActiveUniform", proc(&nullGetActiveUniform) },
+    { "glGetUniformLocation", proc(&nullGetUniformLocation) },
+    { "glGetAttribLocation", proc(&nullGetAttribLocation) },
+    { "glGetUniformBlockIndex", proc(&nullGetUniformBlockIndex) },
+    { "glUniformBlockBinding", proc(&nullUniformBlockBinding) },
+    { "glUseProgram", proc(&nullUseProgram) },
+    { "glActiveTexture", proc(&nullActiveTexture) },
+    { "glBindTexture", proc(&nullBindTexture) },
+    { "glBindFramebuffer", proc(&nullBindFramebuffer) },
+    { "glBindVertexArray", proc(&nullBindVertexArray) },
+    { "glBindBuffer", proc(&nullBindBuffer) },
+    { "glBindBufferBase", proc(&nullBindBufferBase) },
+    { "glBindRenderbuffer", proc(&nullBindRenderbuffer) },
+    { "glUniform1f", proc(&nullUniform1f) },
+    { "glUniform2f", proc(&nullUniform2f) },
+    { "glUniform3f", proc(&nullUniform3f) },
+    { "glUniform4f", proc(&nullUniform4f) },
+    { "glUniform1i", proc(&nullUniform1i) },
+    { "glUniform2i", proc(&nullUniform2i) },
+    { "glUniform3i", proc(&nullUniform3i) },
+    { "glUniform4i", proc(&nullUniform4i) },
+    { "glUniform1fv", proc(&nullUniformfv) },
+    { "glUniform2fv", proc(&nullUniformfv) },
+    { "glUniform3fv", proc(&nullUniformfv) },
+    { "glUniform4fv", proc(&nullUniformfv) },
+    { "glUniform1iv", proc(&nullUniformiv) },
+    { "glUniform2iv", proc(&nullUniformiv) },
+    { "glUniform3iv", proc(&nullUniformiv) },
+    { "glUniform4iv", proc(&nullUniformiv) },
+    { "glUniform1uiv", proc(&nullUniformuiv) },
+    { "glUniform2uiv", proc(&nullUniformuiv) },
+    { "glUniform3uiv", proc(&nullUniformuiv) },
+    { "glUniform4uiv", proc(&nullUniformuiv) },
+    { "glUniformMatrix3fv", proc(&nullUniformMatrixfv) },
+    { "glUniformMatrix4fv", proc(&nullUniformMatrixfv) },
+    { "glDrawArrays", proc(&nullDrawArrays) },
+    { "glDrawElements", proc(&nullDrawElements) },
+    { "glDrawArraysInstanced", proc(&nullDrawArraysInstanced) },
+    { "glDrawElementsInstanced", proc(&nullDrawElementsInstanced) },
+    { "glClear", proc(&nullClear) },
+    { "glBlitFramebuffer", proc(&nullBlitFramebuffer) },
+    { "glEnable", proc(&nullEnable) },
+    { "glDisable", proc(&nullDisable) },
+    { "glEnablei", proc(&nullEnablei) },
+    { "glDisablei", proc(&nullDisablei) },
+    { "glDepthMask", proc(&nullDepthMask) },
+    { "glDepthFunc", proc(&nullDepthFunc) },
+    { "glCullFace", proc(&nullCullFace) },
+    { "glFrontFace", proc(&nullFrontFace) },
+    { "glBlendFunc", proc(&nullBlendFunc) },
+    { "glBlendFuncSeparate", proc(&nullBlendFuncSeparate) },
+    { "glBlendEquation", proc(&nullBlendEquation) },
+    { "glBlendEquationSeparate", proc(&nullBlendEquationSeparate) },
+    { "glColorMask", proc(&nullColorMask) },
+    { "glClearColor", proc(&nullClearColor) },
+    { "glClearDepth", proc(&nullClearDepth) },
+    { "glLineWidth", proc(&nullLineWidth) },
+    { "glPolygonMode", proc(&nullPolygonMode) },
+    { "glScissor", proc(&nullScissor) },
+    { "glDrawBuffer", proc(&nullDrawBuffer) },
+    { "glDrawBuffers", proc(&nullDrawBuffers) },
+    { "glReadBuffer", proc(&nullReadBuffer) },
+    { "glPixelStorei", proc(&nullPixelStorei) },
+    { "glTexParameteri", proc(&nullTexParameteri) },
+    { "glTexParameterf", proc(&nullTexParameterf) },
+    { "glTexParameterfv", proc(&nullTexParameterfv) },
+    { "glViewport", proc(&nullViewport) },
+    { "glVertexAttribPointer", proc(&nullVertexAttribPointer) },
+    { "glVertexAttribIPointer", proc(&nullVertexAttribIPointer) },
+    { "glEnableVertexAttribArray", proc(&nullEnableVertexAttribArray) },
+    { "glDisableVertexAttribArray", proc(&nullDisableVertexAttribArray) },
+    { "glVertexAttribDivisor", proc(&nullVertexAttribDivisor) },
+    { "glVertexAttrib1fv", proc(&nullVertexAttribfv) },
+    { "glVertexAttrib2fv", proc(&nullVertexAttribfv) },
+    { "glVertexAttrib3fv", proc(&nullVertexAttribfv) },
+    { "glVertexAttrib4fv", proc(&nullVertexAttribfv) },
+    { "glBufferData", proc(&nullBufferData) },
+    { "glBufferSubData", proc(&nullBufferSubData) },
+    { "glTexImage1D", proc(&nullTexImage1D) },
+    { "glTexImage2D", proc(&nullTexImage2D) },
+    { "glTexImage3D", proc(&nullTexImage3D) },
+    { "glTexSubImage2D", proc(&nullTexSubImage2D) },
+    { "glCompressedTexImage2D", proc(&nullCompressedTexImage2D) },
+    { "glGenerateMipmap", proc(&nullGenerateMipmap) },
+    { "glFramebufferTexture2D", proc(&nullFramebufferTexture2D) },
+    { "glFramebufferTextureLayer", proc(&nullFramebufferTextureLayer) },
+    { "glFramebufferRenderbuffer", proc(&nullFramebufferRenderbuffer) },
+    { "glRenderbufferStorage", proc(&nullRenderbufferStorage) },
+    { "glRenderbufferStorageMultisample", proc(&nullRenderbufferStorageMultisample) },
+    { "glReadPixels", proc(&nullReadPixels) },
+    { "glGetTexImage", proc(&nullGetTexImage) },
+    { "glGetQueryiv", proc(&nullGetQueryiv) },
+    { "glQueryCounter", proc(&nullQueryCounter) },
+    { "glGetQueryObjectiv", proc(&nullGetQueryObjectiv) },
+    { "glGetQueryObjectui64v", proc(&nullGetQueryObjectui64v) },
+    { "glBeginQuery", proc(&nullBeginQuery) },
+    { "glEndQuery", proc(&nullEndQuery) },
+    { "glBeginConditionalRender", proc(&nullBeginConditionalRender) },
+    { "glEndConditionalRender", proc(&nullEndConditionalRender) },
+    { "glFlush", proc(&nullFlush) },
+    { "glFinish", proc(&nullFlush) },
+};
+
+NullProc nullGetProcAddress(const char* name)
+{
+    auto it = gProcs.find(name);
+    return (it != gProcs.end()) ? it->second : nullptr;
+}
+
+} // namespace
+
+/* Internal API */
+
+void r3d_nullBackendInit(int width, int height)
+{
+    gActive = true;
+    gNextObject = 1;
+    gCurrentProgram = 0;
+    gActiveTextureUnit = 0;
+
+    rlLoadExtensions(reinterpret_cast<void*>(&nullGetProcAddress));
+    rlglInit(width, height);
+
+    TraceLog(LOG_INFO, "R3D: Null backend initialized (%ix%i), no GL command will be executed", width, height);
+}
+
+void r3d_nullBackendClose(void)
+{
+    if (!gActive) return;
+
+    rlglClose();
+
+    gShaders.clear();
+    gPrograms.clear();
+    gCommands.clear();
+    gLastCommands.clear();
+
+    gActive = false;
+}
+
+bool r3d_nullBackendIsActive(void)
+{
+    return gActive;
+}
+
+void r3d_nullBackendBeginFrame(void)
+{
+    gCommands.clear();
+}
+
+void r3d_nullBackendEndFrame(void)
+{
+    gLastCommands.swap(gCommands);
+    gCommands.clear();
+}
+
+/* Public API */
+
+int R3D_GetRecordedCommandCount(void)
+{
+    return static_cast<int>(gLastCommands.size());
+}
+
+const R3D_Command* R3D_GetRecordedCommands(void)
+{
+    return gLastCommands.empty() ? nullptr : gLastCommands.data();
+}
+
+int R3D_CountRecordedCommands(R3D_CommandType type)
+{
+    int count = 0;
+    for (const R3D_Command& command : gLastCommands) {
+        count += (command.type == static_cast<unsigned int>(type));
+    }
+    return count;
+}
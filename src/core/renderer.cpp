@@ -21,6 +21,10 @@
 
 #include "./renderer.hpp"
 
+#include "../detail/frame_capture.hpp"
+#include "../detail/null_backend.h"
+#include "../detail/trace.h"
+
 #include <raylib.h>
 #include <raymath.h>
 
@@ -40,12 +44,28 @@ void R3D_Init(void)
 
 void R3D_InitEx(int internalWidth, int internalHeight, int flags)
 {
+    if (flags & R3D_FLAG_NULL_BACKEND) {
+        // NOTE: Without any window, the screen size is zero, so the aspect ratio
+        //       of the projection is taken from the internal resolution
+        if (internalWidth <= 0 || internalHeight <= 0) {
+            internalWidth = 1280, internalHeight = 720;
+        }
+        r3d_nullBackendInit(internalWidth, internalHeight);
+        flags |= R3D_FLAG_ASPECT_KEEP;
+    }
+
     gRenderer = std::make_unique<r3d::Renderer>(internalWidth, internalHeight, flags);
 }
 
 void R3D_Close()
 {
     gRenderer.reset();
+    r3d_nullBackendClose();
+}
+
+void R3D_SetShaderCacheDirectory(const char* directory)
+{
+    r3d::ProgramCache::setDirectory(directory ? directory : "");
 }
 
 void R3D_UpdateInternalResolution(int width, int height)
@@ -121,8 +141,55 @@ void R3D_ToggleActiveLayer(R3D_Layer layer)
     else layers |= layer;
 }
 
+void R3D_SetScreenSizeCullThreshold(float threshold)
+{
+    gRenderer->screenSizeCullThreshold = threshold;
+}
+
+float R3D_GetScreenSizeCullThreshold(void)
+{
+    return gRenderer->screenSizeCullThreshold;
+}
+
+void R3D_SetLayerScreenSizeCullThreshold(int layers, float threshold)
+{
+    for (int i = 0; i < 10; i++) {
+        if (layers & (1 << i)) {
+            gRenderer->layerScreenSizeCullThresholds[i] = threshold;
+        }
+    }
+}
+
+float R3D_GetLayerScreenSizeCullThreshold(R3D_Layer layer)
+{
+    for (int i = 0; i < 10; i++) {
+        if (layer & (1 << i)) {
+            return gRenderer->layerScreenSizeCullThresholds[i];
+        }
+    }
+    return -1.0f;
+}
+
+void R3D_SetLODErrorThreshold(float pixels)
+{
+    gRenderer->lodErrorThreshold = pixels;
+}
+
+float R3D_GetLODErrorThreshold(void)
+{
+    return gRenderer->lodErrorThreshold;
+}
+
 void R3D_Begin(Camera3D camera)
 {
+    if (r3d_nullBackendIsActive()) {
+        r3d_nullBackendBeginFrame();
+    }
+
+    if (r3d::isCaptureRecording()) {
+        r3d::captureBeginFrame(camera);
+    }
+
     gRenderer->setCamera(camera);
     gRenderer->shadowsUpdateTimer += GetFrameTime();
 }
@@ -139,19 +206,31 @@ void R3D_DrawModelEx(const R3D_Model* model, Vector3 position, float scale)
 
 void R3D_DrawModelPro(const R3D_Model* model, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale)
 {
+    R3D_TRACE_ZONE("R3D_DrawModelPro");
+
     Matrix transform = gRenderer->getGlobalTrasformMatrix(
-        model->billboard, model->transform,
-        position, rotationAxis, rotationAngle, scale
+        model->transform, position, rotationAxis, rotationAngle, scale
     );
 
+    if (r3d::isCaptureRecording()) {
+        r3d::captureModel(*model, transform);
+    }
+
     BoundingBox aabb = r3d::transformBoundingBox(model->aabb, transform);
 
+    if (model->billboard != R3D_BILLBOARD_DISABLED) {
+        aabb = r3d::getBillboardBoundingBox(aabb, r3d::getMatrixTrasnlation(transform));
+    }
+
+    int lod = gRenderer->selectModelLOD(*model, aabb, transform);
+    int instance = gRenderer->addModelInstance(*model);
+
     if (gRenderer->isObjectVisible(*model, aabb)) {
         r3d::ShaderLightArray lightArray{};
-        gRenderer->setupLightsAndShadows(*model, aabb, transform, &lightArray);
-        gRenderer->addObjectToSceneBatch(*model, transform, lightArray);
+        gRenderer->setupLightsAndShadows(*model, aabb, transform, &lightArray, lod);
+        gRenderer->addObjectToSceneBatch(*model, aabb, transform, lightArray, lod, instance);
     } else if (gRenderer->shadowsUpdateTimer >= gRenderer->shadowsUpdateFrequency) {
-        gRenderer->setupLightsAndShadows(*model, aabb, transform, nullptr);
+        gRenderer->setupLightsAndShadows(*model, aabb, transform, nullptr, lod);
     }
 }
 
@@ -167,20 +246,30 @@ void R3D_DrawSpriteEx(const R3D_Sprite* sprite, Vector3 position, float size)
 
 void R3D_DrawSpritePro(const R3D_Sprite* sprite, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector2 size)
 {
+    R3D_TRACE_ZONE("R3D_DrawSpritePro");
+
     Matrix transform = gRenderer->getGlobalTrasformMatrix(
-        sprite->billboard, sprite->transform,
-        position, rotationAxis, rotationAngle, { size.x * 0.5f, size.y * 0.5f, 1.0f }
+        sprite->transform, position, rotationAxis, rotationAngle,
+        { size.x * 0.5f, size.y * 0.5f, 1.0f }
     );
 
+    if (r3d::isCaptureRecording()) {
+        r3d::captureSprite(*sprite, transform);
+    }
+
     BoundingBox aabb = r3d::transformBoundingBox({
         { -1.0f, -1.0f, 0 },
         { 1.0f, 1.0f, 0 }
     }, transform);
 
+    if (sprite->billboard != R3D_BILLBOARD_DISABLED) {
+        aabb = r3d::getBillboardBoundingBox(aabb, r3d::getMatrixTrasnlation(transform));
+    }
+
     if (gRenderer->isObjectVisible(*sprite, aabb)) {
         r3d::ShaderLightArray lightArray{};
         gRenderer->setupLightsAndShadows(*sprite, aabb, transform, &lightArray);
-        gRenderer->addObjectToSceneBatch(*sprite, transform, lightArray);
+        gRenderer->addObjectToSceneBatch(*sprite, aabb, transform, lightArray);
     } else if (gRenderer->shadowsUpdateTimer >= gRenderer->shadowsUpdateFrequency) {
         gRenderer->setupLightsAndShadows(*sprite, aabb, transform, nullptr);
     }
@@ -188,22 +277,47 @@ void R3D_DrawSpritePro(const R3D_Sprite* sprite, Vector3 position, Vector3 rotat
 
 void R3D_DrawParticleSystemCPU(R3D_ParticleSystemCPU* system)
 {
+    R3D_TRACE_ZONE("R3D_DrawParticleSystemCPU");
+
     Matrix transform = MatrixTranslate(system->position.x, system->position.y, system->position.z);
 
+    if (r3d::isCaptureRecording()) {
+        r3d::captureParticleSystem(*system);
+    }
+
     if (gRenderer->isObjectVisible(*system, system->aabb)) {
         r3d::ShaderLightArray lightArray{};
         gRenderer->setupLightsAndShadows(*system, system->aabb, transform, &lightArray);
-        gRenderer->addObjectToSceneBatch(*system, transform, lightArray);
+        gRenderer->addObjectToSceneBatch(*system, system->aabb, transform, lightArray);
     } else if (gRenderer->shadowsUpdateTimer >= gRenderer->shadowsUpdateFrequency) {
         gRenderer->setupLightsAndShadows(*system, system->aabb, transform, nullptr);
     }
 }
 
+void R3D_DrawOccluder(const Mesh* mesh, const R3D_Transform* transform)
+{
+    R3D_TRACE_ZONE("R3D_DrawOccluder");
+
+    Matrix matTransform = gRenderer->getGlobalTrasformMatrix(
+        *transform, {}, {}, 0.0f, { 1.0f, 1.0f, 1.0f }
+    );
+
+    gRenderer->addOccluder(*mesh, matTransform);
+}
+
 void R3D_End()
 {
+    R3D_TRACE_ZONE("R3D_End");
+
+    if (r3d::isCaptureRecording()) {
+        r3d::captureEndFrame();
+    }
+
     rlDrawRenderBatchActive();
     rlEnableDepthTest();
 
+    gRenderer->beginFrameProfiling();
+
     if (gRenderer->shadowsUpdateTimer >= gRenderer->shadowsUpdateFrequency) {
         gRenderer->shadowsUpdateTimer = 0.0f;
         gRenderer->renderShadowPass();
@@ -216,5 +330,12 @@ void R3D_End()
     gRenderer->renderPostProcessPass();
     gRenderer->present();
 
+    gRenderer->endFrameProfiling();
+    gRenderer->endFrameStats();
+
+    if (r3d_nullBackendIsActive()) {
+        r3d_nullBackendEndFrame();
+    }
+
     rlViewport(0, 0, GetScreenWidth(), GetScreenHeight());
 }
@@ -22,6 +22,7 @@
 
 #include "r3d.h"
 
+#include "../detail/gl_helper/gl_uniform_buffer.hpp"
 #include "../detail/gl_helper/gl_framebuffer.hpp"
 #include "../detail/rl_helper/rl_camera_3d.hpp"
 #include "../detail/rl_helper/rl_texture.hpp"
@@ -29,13 +30,23 @@
 #include "../detail/gl_helper/gl_shader.hpp"
 
 #include "../detail/shader_material.hpp"
+#include "../detail/program_cache.hpp"
+#include "../detail/offscreen_renderer.hpp"
+#include "../detail/occlusion_buffer.hpp"
+#include "../detail/occlusion_queries.hpp"
+#include "../detail/lod_selector.hpp"
+#include "../detail/sprite_batcher.hpp"
 #include "../detail/bloom_renderer.hpp"
+#include "../detail/color_grading.hpp"
+#include "../detail/gpu_profiler.hpp"
 #include "../detail/render_target.hpp"
 #include "../detail/shader_code.hpp"
 #include "../detail/batch_map.hpp"
 #include "../detail/frustum.hpp"
 #include "../detail/id_manager.hpp"
 #include "../detail/drawable_quad.hpp"
+#include "../detail/stats.h"
+#include "../detail/trace.h"
 #include "../detail/gl.hpp"
 
 #include "../objects/skybox.hpp"
@@ -48,8 +59,13 @@
 
 #include <unordered_map>
 #include <algorithm>
+#include <optional>
+#include <iterator>
+#include <limits>
 #include <cstdint>
 #include <variant>
+#include <cmath>
+#include <array>
 #include <cstdio>
 #include <memory>
 #include <map>
@@ -112,20 +128,22 @@ public:
     DrawCall_Shadow(const R3D_ParticleSystemCPU* system);
 
     /**
-     * @brief Draws the object (mesh, sprite, or particle system) for shadow mapping.
+     * @brief Draws the object (mesh or particle system) for shadow mapping.
+     * @note Sprites are not drawn individually, they are batched by the renderer (see `getSprite`).
      */
     void draw(const Light& light) const;
 
-private:
     /**
-     * @brief Draws the mesh for shadow mapping.
+     * @brief Retrieves the sprite of the draw call, if applicable.
+     * @return Returns `nullptr` if the draw call is not a sprite.
      */
-    void drawMesh(const Light& light) const;
+    const Sprite* getSprite() const;
 
+private:
     /**
-     * @brief Draws the sprite for shadow mapping.
+     * @brief Draws the mesh for shadow mapping.
      */
-    void drawSprite(const Light& light) const;
+    void drawMesh(const Light& light) const;
 
     /**
      * @brief Draws the particle system for shadow mapping.
@@ -153,6 +171,7 @@ public:
         } surface;                      ///< Surface information for the draw call.
         ShaderLightArray lights;        ///< Array of light pointers influencing this draw call.
         Matrix transform;               ///< Transformation matrix for the draw call.
+        int occlusionQuery;             ///< Handle of the query conditioning the draw, -1 if it is unconditional (see `OcclusionQueries`).
     };
 
     /**
@@ -176,9 +195,9 @@ public:
 
 public:
     /**
-     * @brief Constructs a draw call for a surface to be rendered in the scene.
+     * @brief Constructs a draw call for a surface to be rendered in the scene, with the mesh of one of its LOD levels.
      */
-    DrawCall_Scene(const R3D_Surface& surface, const Matrix& transform, const ShaderLightArray& lights);
+    DrawCall_Scene(const R3D_Surface& surface, const ::Mesh& mesh, const Matrix& transform, const ShaderLightArray& lights, int occlusionQuery = -1);
 
     /**
      * @brief Constructs a draw call for a sprite to be rendered in the scene.
@@ -192,25 +211,39 @@ public:
 
     /**
      * @brief Executes the draw call using the provided shader material.
+     * @note Sprites are not drawn individually, they are batched by the renderer (see `getSprite`).
      */
     void draw(ShaderMaterial& shader) const;
 
+    /**
+     * @brief Retrieves the sprite of the draw call, if applicable.
+     * @return Returns `nullptr` if the draw call is not a sprite.
+     */
+    const Sprite* getSprite() const;
+
     /**
      * @brief Retrieves the transformation matrix of the surface, if applicable.
      * @return Returns `nullptr` if the underlying object does not have a direct transformation.
      */
     const Matrix* getTransform() const;
 
-private:
     /**
-     * @brief Draws the mesh for this draw call using the shader material.
+     * @brief Retrieves the lights affecting the draw call.
+     * @return The light array, filled from the beginning, the first null entry marks its end.
      */
-    void drawMesh(ShaderMaterial& shader) const;
+    const ShaderLightArray& getLights() const;
+
+    /**
+     * @brief Retrieves the handle of the occlusion query conditioning the draw call (see `OcclusionQueries::getQuery`).
+     * @return Returns -1 if the draw call is unconditional.
+     */
+    int getOcclusionQuery() const;
 
+private:
     /**
-     * @brief Draws the sprite for this draw call using the shader material.
+     * @brief Draws the mesh for this draw call using the shader material.
      */
-    void drawSprite(ShaderMaterial& shader) const;
+    void drawMesh(ShaderMaterial& shader) const;
 
     /**
      * @brief Draws the particle system for this draw call using the shader material.
@@ -221,25 +254,37 @@ private:
     std::variant<Surface, Sprite, ParticlesCPU> mCall; ///< Holds either a surface (mesh), sprite, or particle system for rendering in the scene.
 };
 
+/**
+ * @brief Key of the unordered_map used to store shaders.
+ * 
+ * Each `R3D_MaterialShaderConfig` has one variant per light count of `SHADER_LIGHT_BUCKETS`.
+ */
+struct ShaderMaterialKey {
+    R3D_MaterialShaderConfig config;    ///< Configuration of the material shader.
+    int lightCount;                     ///< Number of lights of the variant.
+};
+
 /**
  * @brief Custom hasher for the unordered_map used to store shaders.
  * 
- * The key used is `R3D_MaterialShaderConfig`, enabling sorting of shaders based on their features.
+ * The key used is `ShaderMaterialKey`, enabling sorting of shaders based on their features.
  */
-struct MaterialShaderConfigHash {
-    size_t operator()(const R3D_MaterialShaderConfig& config) const {
-        return std::hash<uint32_t>()(*reinterpret_cast<const uint32_t*>(&config));
+struct ShaderMaterialKeyHash {
+    size_t operator()(const ShaderMaterialKey& key) const {
+        uint64_t value = *reinterpret_cast<const uint32_t*>(&key.config);
+        return std::hash<uint64_t>()(value | (static_cast<uint64_t>(key.lightCount) << 32));
     }
 };
 
 /**
  * @brief Equality comparator for the unordered_map used to store shaders.
  * 
- * Compares two `R3D_MaterialShaderConfig` objects to determine equality.
+ * Compares two `ShaderMaterialKey` objects to determine equality.
  */
-struct MaterialShaderConfigEqual {
-    bool operator()(const R3D_MaterialShaderConfig& lhs, const R3D_MaterialShaderConfig& rhs) const {
-        return *reinterpret_cast<const uint32_t*>(&lhs) == *reinterpret_cast<const uint32_t*>(&rhs);
+struct ShaderMaterialKeyEqual {
+    bool operator()(const ShaderMaterialKey& lhs, const ShaderMaterialKey& rhs) const {
+        return *reinterpret_cast<const uint32_t*>(&lhs.config) == *reinterpret_cast<const uint32_t*>(&rhs.config)
+            && lhs.lightCount == rhs.lightCount;
     }
 };
 
@@ -275,6 +320,9 @@ public:
     float shadowsUpdateFrequency;               ///< Reciprocal of the number of shadow map updates per second.  
     float shadowsUpdateTimer;                   ///< Timer used to control the frequency of shadow map updates.
     int activeLayers;                           ///< `R3D_Layer` that are active.
+    float screenSizeCullThreshold;              ///< Projected size below which objects are culled, as a fraction of the viewport height.
+    float layerScreenSizeCullThresholds[10];    ///< Thresholds replacing the global one for each `R3D_Layer`, negative to use the global one.
+    float lodErrorThreshold;                    ///< Largest projected error of the LOD of the models, in pixels of the internal resolution.
 
     int flags;  /**< Copies of the flags assigned during initialization,
                  *   may be modified during execution, except for flags that
@@ -291,16 +339,28 @@ public:
      */
     Renderer(int internalWidth, int internalHeight, int flags);
 
+    /**
+     * @brief Releases the programs of the material shaders still being compiled.
+     */
+    ~Renderer();
+
     /**
      * @brief Loads and compiles the specified material configuration.
      * 
+     * When `async` is true and the driver supports parallel shader compilation, the shader is compiled in the
+     * background and the configuration is drawn with the default shader variant until it is ready.
+     * 
      * @param config The material configuration to load.
+     * @param async Allows the shader to be compiled without waiting for it.
      */
-    void loadMaterialConfig(R3D_MaterialConfig config);
+    void loadMaterialConfig(R3D_MaterialConfig config, bool async = true);
 
     /**
      * @brief Unloads the specified material configuration.
      * 
+     * The configurations derived from it for each billboard mode by `getBillboardMaterialConfig`,
+     * with or without the vertex colors used by the sprites, are unloaded as well.
+     * 
      * @param config The material configuration to unload.
      */
     void unloadMaterialConfig(R3D_MaterialConfig config);
@@ -313,6 +373,24 @@ public:
      */
     bool isMaterialConfigValid(R3D_MaterialConfig config) const;
 
+    /**
+     * @brief Loads a material configuration along with all its light count variants.
+     * 
+     * The variants with fewer lights are otherwise only compiled the first time a draw can use them.
+     * 
+     * @param config The material configuration to load.
+     */
+    void precompileMaterialConfig(R3D_MaterialConfig config);
+
+    /**
+     * @brief Retrieves the number of material shaders whose compilation is still in progress.
+     * 
+     * The shaders that have finished compiling are made available before counting the remaining ones.
+     * 
+     * @return The number of pending shader compilations.
+     */
+    int getPendingShaderCount();
+
     /**
      * @brief Sets the camera for the renderer and calculates its view matrix, projection matrix, and frustum.
      * 
@@ -326,9 +404,13 @@ public:
 
     /**
      * @brief Computes the global transformation matrix for an object.
+     * 
+     * The billboard rotation is not included, it is applied by the material shader
+     * (see `getBillboardMaterialConfig`) and on the CPU only for the shadow maps.
+     * 
      * @return The computed global transformation matrix.
      */
-    Matrix getGlobalTrasformMatrix(R3D_BillboardMode billboard, const R3D_Transform& transform,
+    Matrix getGlobalTrasformMatrix(const R3D_Transform& transform,
                                    const Vector3& position, const Vector3& rotationAxis,
                                    float rotationAngle, const Vector3& scale);
 
@@ -339,18 +421,64 @@ public:
     template <typename Object>
     bool isObjectVisible(const Object& object, const BoundingBox& globalAABB);
 
+    /**
+     * @brief Adds an occluder to the occlusion buffer of the current frame.
+     * 
+     * @param mesh The mesh of the occluder, with its vertices in CPU memory.
+     * @param globalTransform The global transform of the occluder.
+     */
+    void addOccluder(const ::Mesh& mesh, const Matrix& globalTransform);
+
+    /**
+     * @brief Computes the projected size of a bounding box with the camera projection.
+     * 
+     * @param globalAABB The bounding box in world space.
+     * @return The diameter of the sphere enclosing the box, as a fraction of the viewport height.
+     */
+    float getScreenSize(const BoundingBox& globalAABB) const;
+
+    /**
+     * @brief Retrieves the screen size culling threshold applying to the given layers.
+     */
+    float getScreenSizeCullThreshold(int layers) const;
+
+    /**
+     * @brief Computes the depth of a point in the view space of the camera, positive in front of it.
+     */
+    float getViewDepth(const Vector3& position) const;
+
+    /**
+     * @brief Selects the LOD level of a model from the projected error of its levels (see `LODSelector`).
+     * 
+     * @param model The model to draw, must be called once per draw so that its instances are counted.
+     * @param globalAABB The bounding box of the model in world space.
+     * @param globalTransform The global transform of the model.
+     * @return The LOD level to draw the model with, 0 being the full detail.
+     */
+    int selectModelLOD(const R3D_Model& model, const BoundingBox& globalAABB, const Matrix& globalTransform);
+
+    /**
+     * @brief Numbers a draw of a model for its occlusion query (see `OcclusionQueries`).
+     * 
+     * @param model The model to draw, must be called once per draw before it is culled.
+     * @return The number of the instance to pass to `addObjectToSceneBatch`, or -1 if the occlusion queries are disabled.
+     */
+    int addModelInstance(const R3D_Model& model);
+
     /**
      * @brief Prepares lighting and shadow mapping data for a given object.
      */
     template <typename Object>
     void setupLightsAndShadows(const Object& object, const BoundingBox& globalAABB,
-                               const Matrix& globalTransform, ShaderLightArray* lightArray);
+                               const Matrix& globalTransform, ShaderLightArray* lightArray, int lod = 0);
 
     /**
      * @brief Adds an object and its associated lighting data to the rendering batch.
      */
     template <typename Object>
-    void addObjectToSceneBatch(const Object& object, const Matrix& globalTransform, const ShaderLightArray& lightArray);
+    void addObjectToSceneBatch(const Object& object, const BoundingBox& globalAABB,
+                               const Matrix& globalTransform, const ShaderLightArray& lightArray,
+                               int lod = 0, int instance = -1);
 
     /**
      * @brief Executes the shadow map rendering pass.
@@ -367,6 +495,17 @@ public:
      */
     void renderPostProcessPass();
 
+    /**
+     * @brief Retrieves the post-processing shader variant matching the current environment.
+     * 
+     * The bloom and fog modes are compiled into the shader so that the pass only pays for the enabled
+     * effects, the tonemapping and color adjustments are baked into a LUT (see `ColorGrading`).
+     * Variants are compiled on first use.
+     * 
+     * @return The post-processing shader to use.
+     */
+    GLShader& getShaderPostFX();
+
     /**
      * @brief Presents the final render (scene + post-process) to the target framebuffer.
      * 
@@ -374,6 +513,21 @@ public:
      */
     void present();
 
+    /**
+     * @brief Starts the GPU profiling of the passes rendered by `R3D_End`, if `R3D_FLAG_GPU_PROFILING` is set.
+     */
+    void beginFrameProfiling();
+
+    /**
+     * @brief Ends the GPU profiling of the frame and reads the results of the previous frames that are available.
+     */
+    void endFrameProfiling();
+
+    /**
+     * @brief Publishes the counters gathered since the previous frame and resets them, see `getFrameStats`.
+     */
+    void endFrameStats();
+
     /**
      * @brief Updates the internal resolution of the renderer.
      * 
@@ -414,6 +568,21 @@ public:
      */
     Light& getLight(R3D_Light id);
 
+    /**
+     * @brief Retrieves all the lights, sorted by their ID.
+     * 
+     * @return A constant reference to the map of the lights.
+     */
+    const std::map<R3D_Light, Light>& getLightMap() const;
+
+    /**
+     * @brief Retrieves the internal resolution of the renderer.
+     * 
+     * @param width Pointer to store the internal width.
+     * @param height Pointer to store the internal height.
+     */
+    void getInternalResolution(int* width, int* height) const;
+
     /**
      * @brief Retrieves the default material configuration used by the renderer.
      * 
@@ -443,13 +612,24 @@ public:
     const Texture2D& getTextureWhite() const;
 
     /**
-     * @brief Retrieves the draw call counts for the current frame.
+     * @brief Retrieves the draw call counts of the last rendered frame.
      * 
      * @param sceneDrawCount Pointer to store the count of draw calls for the main scene.
      * @param shadowDrawCount Pointer to store the count of draw calls for shadow maps.
      */
     void getDrawCallCount(int* sceneDrawCount, int* shadowDrawCount) const;
 
+    /**
+     * @brief Retrieves the statistics of the last profiled frames.
+     * @return The counters of the last complete frame and the rolling averages of the GPU time of each pass, in milliseconds.
+     */
+    R3D_FrameStats getFrameStats() const;
+
+    /**
+     * @brief Returns the GPU profiler, to read the timings of each zone of the last resolved frame.
+     */
+    const GPUProfiler& getGPUProfiler() const;
+
     /**
      * @brief Renders a shadow map for debugging purposes.
      * 
@@ -490,18 +670,103 @@ private:
      */
     void drawMeshScene(const Mesh& mesh, const Matrix& transform, ShaderMaterial& shader, R3D_MaterialConfig config) const;
 
+    /**
+     * @brief Draws a batch of draw calls in the shadow map of a light.
+     * 
+     * Consecutive sprites are gathered by the sprite batcher and drawn in a single call.
+     * 
+     * @param light The light casting shadows on the scene.
+     * @param batch The draw calls to render.
+     */
+    void drawShadowBatch(const Light& light, const std::vector<DrawCall_Shadow>& batch);
+
+    /**
+     * @brief Draws a batch of draw calls in the main scene render pass.
+     * 
+     * Consecutive sprites are gathered by the sprite batcher and drawn in a single call, as long as their
+     * materials only differ by their UV rect and they are lit by the same lights, so that each sprite keeps
+     * the lights selected for it by `setupLightsAndShadows` (layers and range).
+     * 
+     * Each draw uses the shader variant matching its number of lights (see `getShaderMaterial`),
+     * the shader is only switched when this variant differs from the previous draw.
+     * 
+     * @param batch The draw calls to render, all sharing the same material configuration.
+     * @param config The material shader configuration of the batch.
+     */
+    void drawSceneBatch(const std::vector<DrawCall_Scene>& batch, R3D_MaterialShaderConfig config);
+
+    /**
+     * @brief Retrieves the resolution at which the surfaces of a material configuration are rendered.
+     * 
+     * Returns `R3D_RENDER_SCALE_FULL` if the requested scale is invalid, if the blend mode of the
+     * configuration cannot be rendered offscreen or if the corresponding offscreen renderer is not loaded.
+     * 
+     * @param config The material configuration to check.
+     * @return The effective render scale of the configuration.
+     */
+    R3D_RenderScale getRenderScale(R3D_MaterialConfig config) const;
+
+    /**
+     * @brief Retrieves the material configuration used to draw an object with the given billboard mode.
+     * 
+     * The billboard mode is part of the shader configuration, so that the orientation is computed
+     * in the vertex shader. The configuration is loaded the first time it is requested.
+     * 
+     * @param config The material configuration of the object.
+     * @param billboard The billboard mode of the object.
+     * @return The material configuration including the billboard mode.
+     */
+    R3D_MaterialConfig getBillboardMaterialConfig(R3D_MaterialConfig config, R3D_BillboardMode billboard);
+
+    /**
+     * @brief Loads a material shader variant if it is neither loaded nor being compiled.
+     * 
+     * @param key The material shader configuration and light count of the variant to load.
+     * @param async Allows the shader to be compiled in the background, if supported by the driver.
+     */
+    void loadShaderMaterial(ShaderMaterialKey key, bool async);
+
+    /**
+     * @brief Makes available the material shaders whose background compilation has finished.
+     */
+    void updatePendingShaderMaterials();
+
+    /**
+     * @brief Retrieves the shader to use to draw a material shader configuration.
+     * 
+     * The variant with the smallest light count that can hold `lightCount` lights is requested, and the
+     * variant with all lights is used while it is being compiled. If the latter is not ready either, the
+     * default shader configuration with the same billboard mode is returned instead, loaded if necessary.
+     * 
+     * @param config The material shader configuration to draw.
+     * @param lightCount The number of lights affecting the draw.
+     * @return The shader to use, or nullptr if no suitable shader is ready yet.
+     */
+    ShaderMaterial* getShaderMaterial(R3D_MaterialShaderConfig config, int lightCount);
+
 private:
     int mInternalWidth;                         ///< Internal framebuffer width.
     int mInternalHeight;                        ///< Internal framebuffer height.
     RenderTarget mTargetScene;                  ///< Render target for the main scene.
     RenderTarget mTargetPostFX;                 ///< Render target for post-processing effects.
     BloomRenderer mBloomRenderer;               ///< Blur renderer used for the bloom effect.
+    ColorGrading mColorGrading;                 ///< Color grading LUT baked from the environment.
+    GPUProfiler mGPUProfiler;                   ///< GPU timings of the passes, see `R3D_FLAG_GPU_PROFILING`.
+    mutable R3D_FrameStats mStatsFrame{};       ///< Counters of the frame being gathered, incremented by the const draw functions too.
+    R3D_FrameStats mStatsLast{};                ///< Counters of the last complete frame, without the GPU times.
+
+    std::array<std::optional<OffscreenRenderer>, 2> mOffscreenRenderers;   ///< Half and quarter resolution renderers, loaded on demand.
 
     std::unordered_map<
-        R3D_MaterialShaderConfig, ShaderMaterial,
-        MaterialShaderConfigHash, MaterialShaderConfigEqual
+        ShaderMaterialKey, ShaderMaterial,
+        ShaderMaterialKeyHash, ShaderMaterialKeyEqual
     > mShaderMaterials; ///< Shader map for material properties.
 
+    std::unordered_map<
+        ShaderMaterialKey, ProgramCache::Request,
+        ShaderMaterialKeyHash, ShaderMaterialKeyEqual
+    > mPendingShaderMaterials; ///< Material shaders being compiled in the background.
+
     BatchMap<R3D_MaterialConfig, DrawCall_Scene> mSceneBatches;      ///< Scene draw calls sorted by material.
     BatchMap<R3D_Light, DrawCall_Shadow> mShadowBatches;             ///< Shadow draw calls for each light.
 
@@ -512,8 +777,10 @@ private:
     RLTexture mBlackTexture2D;      ///< Black placeholder texture.
     RLTexture mWhiteTexture2D;      ///< White placeholder texture.
     Quad mQuad;                     ///< Quad used for rendering.
+    Cube mCube;                     ///< Cube used for the boxes of the occlusion queries.
+    SpriteBatcher mSpriteBatcher;   ///< Streamed geometry used to draw sprites in batches.
 
-    GLShader mShaderPostFX;         ///< Shader for post-processing effects.
+    std::unordered_map<uint32_t, GLShader> mShaderPostFX;  ///< Post-processing shader variants, see `getShaderPostFX`.
     RLShader mShaderDepthCube;      ///< Shader for cube depth rendering.
     RLShader mShaderDepth;          ///< Shader for depth rendering.
 
@@ -521,6 +788,11 @@ private:
     Matrix mMatCameraView;          ///< View matrix for the camera.
     Matrix mMatCameraProj;          ///< Projection matrix for the camera.
     Frustum mFrustumCamera;         ///< Camera frustum.
+    OcclusionBuffer mOcclusionBuffer;   ///< Occluders of the frame rasterized on the CPU, see `R3D_DrawOccluder`.
+    OcclusionQueries mOcclusionQueries; ///< Occlusion queries of the models, see `R3D_FLAG_OCCLUSION_QUERIES`.
+    LODSelector mLODSelector;           ///< LOD levels of the models drawn during the previous frame.
+    GLUniformBuffer mViewBlock;     ///< Camera basis shared by the material shaders (see `ShaderViewBlock`).
+    uint32_t mSceneFrame = 0;       ///< Index of the frame rendered by the scene pass, see `ShaderMaterial::setEnvironment`.
 
     std::optional<GLShader> mDebugShaderDepthTexture2D; ///< Debug shader for 2D depth textures.
     std::optional<GLShader> mDebugShaderDepthCubemap;   ///< Debug shader for cubemap depth textures.
@@ -537,7 +809,8 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
             .mode           = R3D_BLOOM_DISABLED,
             .intensity      = 1.0f,
             .hdrThreshold   = 1.0f,
-            .iterations     = 10
+            .iterations     = 10,
+            .filter         = R3D_BLOOM_FILTER_GAUSSIAN
         },
         .fog {
             .mode           = R3D_FOG_DISABLED,
@@ -554,7 +827,8 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
         .adjustements {
             .brightness     = 1.0f,
             .contrast       = 1.0f,
-            .saturation     = 1.0f
+            .saturation     = 1.0f,
+            .lut            = {}
         },
         .world {
             .skybox         = nullptr,
@@ -567,6 +841,8 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
     , shadowsUpdateFrequency(1.0f / 30)
     , shadowsUpdateTimer(1.0f / 30)
     , activeLayers(R3D_LAYER_1)
+    , screenSizeCullThreshold(0.0f)
+    , lodErrorThreshold(1.0f)
     , flags(flags)
     , mTargetScene(mInternalWidth, mInternalHeight)
     , mTargetPostFX(mInternalWidth, mInternalHeight)
@@ -575,20 +851,20 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
         .shader = {
             .diffuse = R3D_DIFFUSE_BURLEY,
             .specular = R3D_SPECULAR_SCHLICK_GGX,
-            .reserved = 0,
+            .billboard = R3D_BILLBOARD_DISABLED,
             .flags = R3D_MATERIAL_FLAG_RECEIVE_SHADOW
                    | R3D_MATERIAL_FLAG_SKY_IBL
         },
         .blendMode = R3D_BLEND_ALPHA,
         .cullMode = R3D_CULL_BACK,
-        .reserved1 = 0,
+        .renderScale = R3D_RENDER_SCALE_FULL,
         .reserved2 = 0
     })
     , mBlackTexture2D(BLACK)
     , mWhiteTexture2D(WHITE)
-    , mShaderPostFX(VS_CODE_POSTFX, FS_CODE_POSTFX)
     , mShaderDepthCube(VS_CODE_DEPTH_CUBE, FS_CODE_DEPTH_CUBE)
     , mShaderDepth(VS_CODE_DEPTH, FS_CODE_DEPTH)
+    , mViewBlock(sizeof(ShaderViewBlock), SHADER_VIEW_BLOCK_BINDING)
 {
     // Managing initialization attributes
 
@@ -597,27 +873,30 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
         mDebugShaderDepthCubemap.emplace(VS_CODE_DEBUG_DEPTH, FS_CODE_DEBUG_DEPTH_CUBEMAP);
     }
 
+    // All layers use the global screen size threshold by default
+
+    std::fill(std::begin(layerScreenSizeCullThresholds), std::end(layerScreenSizeCullThresholds), -1.0f);
+
     // Setup of some shaders
 
     mShaderDepthCube.locs[SHADER_LOC_VECTOR_VIEW] = mShaderDepthCube.location("viewPos");
 
     // Setup the default material
 
-    loadMaterialConfig(mDefaultMaterialConfig);
+    loadMaterialConfig(mDefaultMaterialConfig, false);
 
     // Configuring the scene render target
     // DEPTH: Contains the depth of the scene...
-    // COLOR_0: Contains the final colors of the scene
-    // COLOR_1: Contains the colors of areas brighter than the HDR threshold for bloom, the Alpha component contains the perceived luminance
+    // COLOR_0: Contains the final HDR colors of the scene, the bright areas for bloom are extracted from it in the first bloom pass
+    // NOTE: The alpha of COLOR_0 is never read, so the packed format only trades precision (and negative values) for bandwidth
 
     mTargetScene.createAttachment(GLAttachement::DEPTH, GL_TEXTURE_2D, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
-    mTargetScene.createAttachment(GLAttachement::COLOR_0, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_FLOAT);
-    mTargetScene.createAttachment(GLAttachement::COLOR_1, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_FLOAT);
 
-    mTargetScene.setDrawBuffers({
-        GLAttachement::COLOR_0,
-        GLAttachement::COLOR_1,
-    });
+    if (flags & R3D_FLAG_HDR_R11G11B10F) {
+        mTargetScene.createAttachment(GLAttachement::COLOR_0, GL_TEXTURE_2D, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT);
+    } else {
+        mTargetScene.createAttachment(GLAttachement::COLOR_0, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    }
 
     // Configuring the post effects render target
 
@@ -627,7 +906,14 @@ inline Renderer::Renderer(int internalWidth, int internalHeight, int flags)
     );
 }
 
-inline void Renderer::loadMaterialConfig(R3D_MaterialConfig config)
+inline Renderer::~Renderer()
+{
+    for (const auto& [_, request] : mPendingShaderMaterials) {
+        glDeleteProgram(request.program);
+    }
+}
+
+inline void Renderer::loadMaterialConfig(R3D_MaterialConfig config, bool async)
 {
     // Instantiates an entity vector in 'm_material_batches' for this material type if it has not already been created
 
@@ -635,31 +921,86 @@ inline void Renderer::loadMaterialConfig(R3D_MaterialConfig config)
         mSceneBatches.addBatch(config);
     }
 
-    // Compiles a shader for the given configuration if necessary
-
-    const auto it_material_shader = mShaderMaterials.find(config.shader);
+    // Loads the offscreen renderer if the configuration requests a reduced resolution
 
-    if (it_material_shader != mShaderMaterials.cend()) {
-        return;
+    if (config.renderScale > R3D_RENDER_SCALE_FULL && config.renderScale <= R3D_RENDER_SCALE_QUARTER) {
+        auto& offscreen = mOffscreenRenderers[config.renderScale - 1];
+        if (!offscreen.has_value()) {
+            offscreen.emplace(mInternalWidth, mInternalHeight, 1 << config.renderScale);
+        }
     }
 
-    mShaderMaterials.emplace(config.shader, config.shader);
+    // Compiles a shader for the given configuration if necessary
+    // The variants with fewer lights are compiled on first use
+
+    loadShaderMaterial({ config.shader, SHADER_LIGHT_COUNT }, async);
 }
 
 inline void Renderer::unloadMaterialConfig(R3D_MaterialConfig config)
 {
-    mSceneBatches.eraseBatch(config);
+    auto unloadDerivedConfig = [this](R3D_MaterialConfig config) {
+        mSceneBatches.eraseBatch(config);
+
+        for (int lightCount : SHADER_LIGHT_BUCKETS) {
+            const ShaderMaterialKey key = { config.shader, lightCount };
+
+            auto it_material_shader = mShaderMaterials.find(key);
+
+            if (it_material_shader != mShaderMaterials.end()) {
+                mShaderMaterials.erase(it_material_shader);
+            }
+
+            auto it_pending_shader = mPendingShaderMaterials.find(key);
+
+            if (it_pending_shader != mPendingShaderMaterials.end()) {
+                glDeleteProgram(it_pending_shader->second.program);
+                mPendingShaderMaterials.erase(it_pending_shader);
+            }
+        }
+    };
+
+    // The sprites are drawn with vertex colors (see `addObjectToSceneBatch`)
 
-    auto it_material_shader = mShaderMaterials.find(config.shader);
+    const unsigned char flags[] = {
+        config.shader.flags,
+        static_cast<unsigned char>(config.shader.flags | R3D_MATERIAL_FLAG_VERTEX_COLOR)
+    };
 
-    if (it_material_shader != mShaderMaterials.end()) {
-        mShaderMaterials.erase(it_material_shader);
+    for (unsigned char flag : flags) {
+        for (R3D_BillboardMode billboard : { R3D_BILLBOARD_DISABLED, R3D_BILLBOARD_ENABLED, R3D_BILLBOARD_Y_AXIS }) {
+            config.shader.flags = flag;
+            config.shader.billboard = static_cast<uint8_t>(billboard);
+            unloadDerivedConfig(config);
+        }
     }
 }
 
 inline bool Renderer::isMaterialConfigValid(R3D_MaterialConfig config) const
 {
-    return (mShaderMaterials.find(config.shader) != mShaderMaterials.cend());
+    const ShaderMaterialKey key = { config.shader, SHADER_LIGHT_COUNT };
+
+    return (mShaderMaterials.find(key) != mShaderMaterials.cend())
+        || (mPendingShaderMaterials.find(key) != mPendingShaderMaterials.cend());
+}
+
+inline void Renderer::precompileMaterialConfig(R3D_MaterialConfig config)
+{
+    loadMaterialConfig(config);
+
+    if (config.shader.diffuse == R3D_DIFFUSE_UNSHADED) {
+        return;
+    }
+
+    for (int lightCount : SHADER_LIGHT_BUCKETS) {
+        loadShaderMaterial({ config.shader, lightCount }, true);
+    }
+}
+
+inline int Renderer::getPendingShaderCount()
+{
+    updatePendingShaderMaterials();
+
+    return static_cast<int>(mPendingShaderMaterials.size());
 }
 
 inline void Renderer::setCamera(const Camera3D& camera)
@@ -683,29 +1024,27 @@ inline void Renderer::setCamera(const Camera3D& camera)
     // Computes the camera's frustum if necessary
 
     if (!(flags & R3D_FLAG_NO_FRUSTUM_CULLING)) {
-        mFrustumCamera = Frustum(MatrixMultiply(mMatCameraView, mMatCameraProj));
+        Matrix matViewProj = simdMatrixMultiply(mMatCameraView, mMatCameraProj);
+        mFrustumCamera = Frustum(matViewProj);
+        mOcclusionBuffer.begin(matViewProj);
     }
+
+    mOcclusionQueries.beginFrame();
+    mLODSelector.beginFrame();
 }
 
-inline Matrix Renderer::getGlobalTrasformMatrix(R3D_BillboardMode billboard, const R3D_Transform& transform, const Vector3& position, const Vector3& rotationAxis, float rotationAngle, const Vector3& scale)
+inline Matrix Renderer::getGlobalTrasformMatrix(const R3D_Transform& transform, const Vector3& position, const Vector3& rotationAxis, float rotationAngle, const Vector3& scale)
 {
-    Matrix mat = MatrixMultiply(
-        MatrixMultiply(
+    Matrix mat = simdMatrixMultiplyAffine(
+        simdMatrixMultiplyAffine(
             MatrixScale(scale.x, scale.y, scale.z),
             MatrixRotate(rotationAxis, rotationAngle * DEG2RAD)
         ),
         MatrixTranslate(position.x, position.y, position.z)
     );
 
-    mat = MatrixMultiply(mat, R3D_TransformToGlobal(&transform));
-    mat = MatrixMultiply(mat, rlGetMatrixTransform());
-
-    if (billboard != R3D_BILLBOARD_DISABLED) {
-        const Vector3 translation = getMatrixTrasnlation(mat);
-        mat = MatrixMultiply(mat, getBillboardRotationMatrix(
-            billboard, translation, mCamera.position
-        ));
-    }
+    mat = simdMatrixMultiplyAffine(mat, R3D_TransformToGlobal(&transform));
+    mat = simdMatrixMultiplyAffine(mat, rlGetMatrixTransform());
 
     return mat;
 }
@@ -713,15 +1052,152 @@ inline Matrix Renderer::getGlobalTrasformMatrix(R3D_BillboardMode billboard, con
 template <typename Object>
 inline bool Renderer::isObjectVisible(const Object& object, const BoundingBox& globalAABB)
 {
+    R3D_TRACE_ZONE("Renderer::isObjectVisible");
+
+    mStatsFrame.objectsSubmitted++;
+
     if (object.shadow == R3D_CAST_SHADOW_ONLY) return false;
     if (flags & R3D_FLAG_NO_FRUSTUM_CULLING) return true;
-    if (!(activeLayers & object.layer)) return false;
-    return mFrustumCamera.aabbIn(globalAABB);
+
+    if (!(activeLayers & object.layer)) {
+        mStatsFrame.objectsCulledLayer++;
+        return false;
+    }
+
+    // The distance tests come first, they only cost a few multiplications
+
+    if constexpr (std::is_same_v<Object, R3D_Model>) {
+        if (object.maxDrawDistance > 0.0f) {
+            Vector3 center = Vector3Scale(Vector3Add(globalAABB.min, globalAABB.max), 0.5f);
+            if (Vector3DistanceSqr(center, mCamera.position) > object.maxDrawDistance * object.maxDrawDistance) {
+                mStatsFrame.objectsCulledDistance++;
+                return false;
+            }
+        }
+    }
+
+    float threshold = getScreenSizeCullThreshold(object.layer);
+    if (threshold > 0.0f && getScreenSize(globalAABB) < threshold) {
+        mStatsFrame.objectsCulledScreenSize++;
+        return false;
+    }
+
+    if (!mFrustumCamera.aabbIn(globalAABB)) {
+        mStatsFrame.objectsCulledFrustum++;
+        return false;
+    }
+
+    // The occlusion buffer is rendered from the center camera, it cannot be used for the eyes
+    if (!mOcclusionBuffer.empty() && !rlIsStereoRenderEnabled() && !mOcclusionBuffer.aabbIn(globalAABB)) {
+        mStatsFrame.objectsCulledOcclusion++;
+        return false;
+    }
+
+    return true;
+}
+
+inline void Renderer::addOccluder(const ::Mesh& mesh, const Matrix& globalTransform)
+{
+    R3D_TRACE_ZONE("Renderer::addOccluder");
+
+    if (flags & R3D_FLAG_NO_FRUSTUM_CULLING) {
+        return;
+    }
+
+    mOcclusionBuffer.addOccluder(mesh, globalTransform);
+}
+
+inline float Renderer::getScreenSize(const BoundingBox& globalAABB) const
+{
+    Vector3 center = Vector3Scale(Vector3Add(globalAABB.min, globalAABB.max), 0.5f);
+    float radius = 0.5f * Vector3Distance(globalAABB.min, globalAABB.max);
+
+    // 'm5' scales the view space Y to the [-1, 1] range of the NDC, so the radius
+    // divided by 'w' directly gives the diameter as a fraction of the viewport height
+
+    if (mMatCameraProj.m15 != 0.0f) {   //< Orthographic projection, 'w' is constant
+        return radius * mMatCameraProj.m5;
+    }
+
+    float depth = getViewDepth(center);
+
+    if (depth <= radius) {      //< The camera is inside or too close to the sphere
+        return std::numeric_limits<float>::max();
+    }
+
+    return radius * mMatCameraProj.m5 / depth;
+}
+
+inline float Renderer::getScreenSizeCullThreshold(int layers) const
+{
+    float threshold = std::numeric_limits<float>::max();
+    bool layerThreshold = false;
+
+    for (int i = 0; i < 10; i++) {
+        if ((layers & (1 << i)) && layerScreenSizeCullThresholds[i] >= 0.0f) {
+            threshold = std::min(threshold, layerScreenSizeCullThresholds[i]);
+            layerThreshold = true;
+        }
+    }
+
+    return layerThreshold ? threshold : screenSizeCullThreshold;
+}
+
+inline float Renderer::getViewDepth(const Vector3& position) const
+{
+    const Matrix& view = mMatCameraView;
+    return -(view.m2 * position.x + view.m6 * position.y + view.m10 * position.z + view.m14);
+}
+
+inline int Renderer::selectModelLOD(const R3D_Model& model, const BoundingBox& globalAABB, const Matrix& globalTransform)
+{
+    const std::vector<float>& errors = static_cast<const Model*>(model.internal)->lodErrors;
+
+    if (errors.empty()) {
+        return 0;
+    }
+
+    // The errors are in the units of the model, they are scaled by the largest scale of its transform
+
+    float scale = std::sqrt(std::max({
+        globalTransform.m0 * globalTransform.m0 + globalTransform.m1 * globalTransform.m1 + globalTransform.m2 * globalTransform.m2,
+        globalTransform.m4 * globalTransform.m4 + globalTransform.m5 * globalTransform.m5 + globalTransform.m6 * globalTransform.m6,
+        globalTransform.m8 * globalTransform.m8 + globalTransform.m9 * globalTransform.m9 + globalTransform.m10 * globalTransform.m10
+    }));
+
+    // Number of pixels covered by one unit of the model at the nearest point of its bounding sphere,
+    // 'm5' scaling the view space Y to the [-1, 1] range of the NDC
+
+    float pixelsPerUnit = 0.5f * mInternalHeight * mMatCameraProj.m5 * scale;
+
+    if (mMatCameraProj.m15 == 0.0f) {
+        Vector3 center = Vector3Scale(Vector3Add(globalAABB.min, globalAABB.max), 0.5f);
+        float radius = 0.5f * Vector3Distance(globalAABB.min, globalAABB.max);
+        float depth = getViewDepth(center) - radius;
+        pixelsPerUnit = (depth > rlGetCullDistanceNear()) ? pixelsPerUnit / depth : std::numeric_limits<float>::max();
+    }
+
+    // Every instance goes through the selector, even with LODs disabled, so that they keep the same keys
+
+    float threshold = std::max(lodErrorThreshold, 0.0f);
+
+    return mLODSelector.select(model.internal, errors, pixelsPerUnit, threshold);
+}
+
+inline int Renderer::addModelInstance(const R3D_Model& model)
+{
+    if (!(flags & R3D_FLAG_OCCLUSION_QUERIES)) {
+        return -1;
+    }
+
+    return mOcclusionQueries.addInstance(model.internal);
 }
 
 template <typename Object>
-inline void Renderer::setupLightsAndShadows(const Object& object, const BoundingBox& globalAABB, const Matrix& globalTransform, ShaderLightArray* lightArray)
+inline void Renderer::setupLightsAndShadows(const Object& object, const BoundingBox& globalAABB, const Matrix& globalTransform, ShaderLightArray* lightArray, int lod)
 {
+    R3D_TRACE_ZONE("Renderer::setupLightsAndShadows");
+
     if (!(activeLayers & object.layer)) {   //< If the object's layer is inactive, return
         return;
     }
@@ -729,10 +1205,28 @@ inline void Renderer::setupLightsAndShadows(const Object& object, const Bounding
     bool shadow = (object.shadow != R3D_CAST_OFF)
         && (shadowsUpdateTimer >= shadowsUpdateFrequency);
 
+    if constexpr (std::is_same_v<Object, R3D_Model>) {
+        if (shadow && object.maxShadowDistance > 0.0f) {
+            Vector3 center = Vector3Scale(Vector3Add(globalAABB.min, globalAABB.max), 0.5f);
+            shadow = Vector3DistanceSqr(center, mCamera.position) <= object.maxShadowDistance * object.maxShadowDistance;
+        }
+    }
+
     if (!shadow && lightArray == nullptr) {
         return;
     }
 
+    // The depth shaders have no billboard variants, so the rotation
+    // is applied here, only when the object is drawn in shadow maps
+
+    Matrix shadowTransform = globalTransform;
+
+    if constexpr (!std::is_same_v<Object, R3D_ParticleSystemCPU>) {
+        if (shadow && object.billboard != R3D_BILLBOARD_DISABLED) {
+            shadowTransform = getBillboardTransformMatrix(object.billboard, globalTransform, mMatCameraView);
+        }
+    }
+
     int lightCount = 0;
 
     for (const auto& [id, light] : mLights) {
@@ -768,11 +1262,12 @@ inline void Renderer::setupLightsAndShadows(const Object& object, const Bounding
 
         if (shadow && light.shadow) {
             if constexpr (std::is_same_v<Object, R3D_Model>) {
-                for (const auto& surface : static_cast<Model*>(object.internal)->surfaces) {
-                    mShadowBatches.pushDrawCall(id, DrawCall_Shadow(&surface.mesh, globalTransform));
+                const Model& model = *static_cast<Model*>(object.internal);
+                for (size_t i = 0; i < model.surfaces.size(); i++) {
+                    mShadowBatches.pushDrawCall(id, DrawCall_Shadow(&model.getMesh(i, lod), shadowTransform));
                 }
             } else if constexpr (std::is_same_v<Object, R3D_Sprite>) {
-                mShadowBatches.pushDrawCall(id, DrawCall_Shadow(&object, globalTransform));
+                mShadowBatches.pushDrawCall(id, DrawCall_Shadow(&object, shadowTransform));
             } else if constexpr (std::is_same_v<Object, R3D_ParticleSystemCPU>) {
                 mShadowBatches.pushDrawCall(id, DrawCall_Shadow(&object));
             }
@@ -787,20 +1282,29 @@ inline void Renderer::setupLightsAndShadows(const Object& object, const Bounding
 }
 
 template <typename Object>
-inline void Renderer::addObjectToSceneBatch(const Object& object, const Matrix& globalTransform, const ShaderLightArray& lightArray)
+inline void Renderer::addObjectToSceneBatch(const Object& object, const BoundingBox& globalAABB, const Matrix& globalTransform, const ShaderLightArray& lightArray, int lod, int instance)
 {
     if constexpr (std::is_same_v<Object, R3D_Model>) {
-        for (const auto& surface : static_cast<Model*>(object.internal)->surfaces) {
-            mSceneBatches.pushDrawCall(surface.material.config,
-                DrawCall_Scene(surface, globalTransform, lightArray)
+        int query = -1;
+        if (instance >= 0 && !rlIsStereoRenderEnabled()) {
+            query = mOcclusionQueries.request(object.internal, instance, globalAABB, mCamera.position, rlGetCullDistanceNear());
+        }
+        const Model& model = *static_cast<Model*>(object.internal);
+        for (size_t i = 0; i < model.surfaces.size(); i++) {
+            const R3D_Surface& surface = model.surfaces[i];
+            mSceneBatches.pushDrawCall(getBillboardMaterialConfig(surface.material.config, object.billboard),
+                DrawCall_Scene(surface, model.getMesh(i, lod), globalTransform, lightArray, query)
             );
         }
     } else if constexpr (std::is_same_v<Object, R3D_Sprite>) {
-        mSceneBatches.pushDrawCall(object.material.config,
+        // The albedo colors of the sprites are stored in the vertices of their batches
+        R3D_MaterialConfig config = object.material.config;
+        config.shader.flags |= R3D_MATERIAL_FLAG_VERTEX_COLOR;
+        mSceneBatches.pushDrawCall(getBillboardMaterialConfig(config, object.billboard),
             DrawCall_Scene(&object, globalTransform, lightArray)
         );
     } else if constexpr (std::is_same_v<Object, R3D_ParticleSystemCPU>) {
-        mSceneBatches.pushDrawCall(object.surface.material.config,
+        mSceneBatches.pushDrawCall(getBillboardMaterialConfig(object.surface.material.config, object.billboard),
             DrawCall_Scene(&object, lightArray)
         );
     }
@@ -808,6 +1312,8 @@ inline void Renderer::addObjectToSceneBatch(const Object& object, const Matrix&
 
 inline void Renderer::renderShadowPass()
 {
+    GPUProfiler::Scope zone(mGPUProfiler, "Shadow pass");
+
     rlDisableColorBlend();  /**< We deactivate the color bleding because the omni
                              *   lights write the distances in a color attachment
                              */
@@ -818,7 +1324,10 @@ inline void Renderer::renderShadowPass()
     for (auto& [lightID, batch] : mShadowBatches) {
         if (batch.empty()) continue;
 
-        const auto& light = mLights.at(lightID);
+        auto& light = mLights.at(lightID);
+        int shadowDraws = mStatsFrame.shadowDraws;
+
+        GPUProfiler::Scope zoneLight(mGPUProfiler, "Light %u", lightID);
 
         rlSetMatrixProjection(light.projMatrix());
 
@@ -830,9 +1339,7 @@ inline void Renderer::renderShadowPass()
                 {
                     glClear(GL_DEPTH_BUFFER_BIT);
                     rlSetMatrixModelview(light.viewMatrix());
-                    for (const auto& drawCall : batch) {
-                        drawCall.draw(light);
-                    }
+                    drawShadowBatch(light, batch);
                 }
                 light.map->end();
             } break;
@@ -841,18 +1348,22 @@ inline void Renderer::renderShadowPass()
                 light.map->begin();
                 {
                     for (int i = 0; i < 6; i++) {
+                        GPUProfiler::Scope zoneFace(mGPUProfiler, "Face %i", i);
                         light.map->bindFace(GLAttachement::COLOR_0, i);
                         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
                         rlSetMatrixModelview(light.viewMatrix(i));
-                        for (const auto& drawCall : batch) {
-                            drawCall.draw(light);
-                        }
+                        drawShadowBatch(light, batch);
                     }
                 }
                 light.map->end();
             } break;
         }
 
+        light.shadowDrawCount = mStatsFrame.shadowDraws - shadowDraws;
+
+        mStatsFrame.shadowMapsUpdated++;
+        mStatsFrame.shaderBinds++;
+
         batch.clear();
     }
 
@@ -865,8 +1376,16 @@ inline void Renderer::renderShadowPass()
 
 inline void Renderer::renderScenePass()
 {
+    GPUProfiler::Scope zone(mGPUProfiler, "Scene pass");
+
+    mSceneFrame++;
+
+    updatePendingShaderMaterials();
+
     const Vector3 camPos = mCamera.position;
 
+    R3D_TRACE_BEGIN("Renderer::sortSceneBatches");
+
     switch (depthSortingOrder) {
         case R3D_DEPTH_SORT_FAR_TO_NEAR: {
             for (auto& [_, batch] : mSceneBatches) {
@@ -896,6 +1415,25 @@ inline void Renderer::renderScenePass()
             break;
     }
 
+    // The opaque draws are grouped by the light count variant of their shader, so that each variant is bound
+    // once per batch (see `drawSceneBatch`), the blended draws keep their depth order
+
+    auto getBucket = [](const DrawCall_Scene& call) {
+        return ShaderMaterial::getLightBucket(ShaderMaterial::getLightCount(call.getLights()));
+    };
+
+    auto compareBuckets = [&getBucket](const DrawCall_Scene& a, const DrawCall_Scene& b) {
+        return getBucket(a) < getBucket(b);
+    };
+
+    for (auto& [config, batch] : mSceneBatches) {
+        if (config.blendMode != R3D_BLEND_DISABLED || config.shader.diffuse == R3D_DIFFUSE_UNSHADED) continue;
+        if (std::is_sorted(batch.begin(), batch.end(), compareBuckets)) continue;
+        std::stable_sort(batch.begin(), batch.end(), compareBuckets);
+    }
+
+    R3D_TRACE_END();
+
     mTargetScene.begin();
     {
         const R3D_Skybox *skybox = environment.world.skybox;
@@ -924,6 +1462,16 @@ inline void Renderer::renderScenePass()
         rlLoadIdentity();
         rlMultMatrixf(MatrixToFloat(mMatCameraView));
 
+        /* Update the camera basis used by the billboard shaders */
+
+        const ShaderViewBlock viewBlock = {
+            .right = { mMatCameraView.m0, mMatCameraView.m4, mMatCameraView.m8, 0.0f },
+            .up = { mMatCameraView.m1, mMatCameraView.m5, mMatCameraView.m9, 0.0f },
+            .back = { mMatCameraView.m2, mMatCameraView.m6, mMatCameraView.m10, 0.0f }
+        };
+
+        mViewBlock.update(&viewBlock, sizeof(viewBlock));
+
         /* Render skybox */
 
         if (skybox != nullptr) {
@@ -932,17 +1480,17 @@ inline void Renderer::renderScenePass()
             static_cast<Skybox*>(skybox->internal)->draw(quatSkybox);
         }
 
-        /* Preparing the scene rendering */
-
-        glDisablei(GL_BLEND, 1);    /*< Here we disable color blending for the output `COLOR_1`
-                                                   *  which corresponds to the HDR values for bloom calculation, as
-                                                   *  we store the perceived luminance in the alpha component.
-                                                   */
-
         /* Render surfaces */
 
+        // NOTE: The batches are profiled by their index in the batch map, which is stable while their materials are used
+        int batchIndex = -1;
+
         for (auto& [config, batch] : mSceneBatches) {
+            batchIndex++;
             if (batch.empty()) continue;
+            if (getRenderScale(config) != R3D_RENDER_SCALE_FULL) continue;  //< Rendered offscreen below
+
+            GPUProfiler::Scope zoneBatch(mGPUProfiler, "Batch %i", batchIndex);
 
             // TODO: Find a method to reduce calls to state changes, even if probably ignored by most drivers...
 
@@ -960,18 +1508,66 @@ inline void Renderer::renderScenePass()
                 rlSetCullFace(config.cullMode - 1);
             }
 
-            ShaderMaterial& shader = mShaderMaterials.at(config.shader);
+            drawSceneBatch(batch, config.shader);
 
-            shader.begin();
+            batch.clear();
+        }
+
+        /* Query the visibility of the models for the next frame, against the depth of the surfaces rendered at full resolution */
+
+        if (flags & R3D_FLAG_OCCLUSION_QUERIES) {
+            GPUProfiler::Scope zoneQueries(mGPUProfiler, "Occlusion queries");
+            mShaderDepth.use();
+            mOcclusionQueries.issue(mCube, mShaderDepth.locs[SHADER_LOC_MATRIX_MVP], simdMatrixMultiply(mMatCameraView, mMatCameraProj));
+            rlDisableShader();
+        }
+
+        /* Render surfaces at reduced resolution and composite them over the scene */
+
+        for (int i = 0; i < static_cast<int>(mOffscreenRenderers.size()); i++) {
+            auto& offscreen = mOffscreenRenderers[i];
+            if (!offscreen.has_value()) continue;
+
+            const R3D_RenderScale scale = static_cast<R3D_RenderScale>(i + 1);
+
+            bool hasDrawCalls = std::any_of(mSceneBatches.begin(), mSceneBatches.end(), [this, scale](const auto& pair) {
+                return !pair.second.empty() && getRenderScale(pair.first) == scale;
+            });
+
+            if (!hasDrawCalls) {
+                continue;
+            }
+
+            GPUProfiler::Scope zoneOffscreen(mGPUProfiler, "Offscreen 1/%i", 1 << static_cast<int>(scale));
+
+            offscreen->begin(mTargetScene.attachement(GLAttachement::DEPTH));
             {
-                shader.setEnvironment(environment, mCamera.position);
-                for (const auto& drawCall : batch) {
-                    drawCall.draw(shader);
+                batchIndex = -1;
+
+                for (auto& [config, batch] : mSceneBatches) {
+                    batchIndex++;
+                    if (batch.empty() || getRenderScale(config) != scale) continue;
+
+                    GPUProfiler::Scope zoneBatch(mGPUProfiler, "Batch %i", batchIndex);
+
+                    OffscreenRenderer::setBlendMode(static_cast<R3D_BlendMode>(config.blendMode));
+
+                    if (config.cullMode == R3D_CULL_DISABLED) {
+                        rlDisableBackfaceCulling();
+                    } else {
+                        rlEnableBackfaceCulling();
+                        rlSetCullFace(config.cullMode - 1);
+                    }
+
+                    drawSceneBatch(batch, config.shader);
+
+                    batch.clear();
                 }
             }
-            shader.end();
+            offscreen->end();
 
-            batch.clear();
+            mTargetScene.begin();
+            offscreen->composite(mTargetScene.attachement(GLAttachement::DEPTH), mMatCameraProj.m15 != 0.0f);
         }
 
         /* Reset to the default state */
@@ -993,60 +1589,85 @@ inline void Renderer::renderScenePass()
 
 inline void Renderer::renderPostProcessPass()
 {
-    /* Apply gaussian blur (two passes) for bloom if needed */
+    GPUProfiler::Scope zone(mGPUProfiler, "Post process");
+
+    /* Extract the bright areas and blur them for bloom if needed */
 
     if (environment.bloom.mode != R3D_BLOOM_DISABLED) {
+        GPUProfiler::Scope zoneBloom(mGPUProfiler, "Bloom");
         mBloomRenderer.render(
-            mTargetScene.attachement(GLAttachement::COLOR_1),
-            environment.bloom.iterations
+            mTargetScene.attachement(GLAttachement::COLOR_0),
+            environment.bloom.hdrThreshold,
+            environment.bloom.iterations,
+            environment.bloom.filter
         );
     }
 
+    /* Bake the color grading if the environment has changed */
+
+    mColorGrading.update(environment);
+
     /* Apply post effects */
 
+    GLShader& shader = getShaderPostFX();
+
     mTargetPostFX.begin();
-        mShaderPostFX.begin();
+        shader.begin();
         {
-            mShaderPostFX.setValue("uBloomMode", static_cast<int>(environment.bloom.mode));
-
             if (environment.bloom.mode != R3D_BLOOM_DISABLED) {
-                mShaderPostFX.bindTexture("uTexBloomBlurHDR", mBloomRenderer.result());
-                mShaderPostFX.setValue("uBloomIntensity", environment.bloom.intensity);
+                shader.bindTexture("uTexBloomBlurHDR", mBloomRenderer.result());
+                shader.setValue("uBloomIntensity", environment.bloom.intensity);
             }
 
-            mShaderPostFX.setValue("uFogMode", static_cast<int>(environment.fog.mode));
-
-            if (environment.fog.mode == R3D_FOG_LINEAR) {
-                mShaderPostFX.setColor("uFogColor", environment.fog.color, false);
-                mShaderPostFX.setValue("uFogStart", environment.fog.start);
-                mShaderPostFX.setValue("uFogEnd", environment.fog.end);
-            } else if (environment.fog.mode != R3D_FOG_DISABLED) {
-                mShaderPostFX.setColor("uFogColor", environment.fog.color, false);
-                mShaderPostFX.setValue("uFogDensity", environment.fog.density);
+            if (environment.fog.mode != R3D_FOG_DISABLED) {
+                shader.bindTexture("uTexSceneDepth", mTargetScene.attachement(GLAttachement::DEPTH));
+                shader.setValue("uNear", rlGetCullDistanceNear());
+                shader.setValue("uFar", rlGetCullDistanceFar());
+                shader.setColor("uFogColor", environment.fog.color, false);
+                if (environment.fog.mode == R3D_FOG_LINEAR) {
+                    shader.setValue("uFogStart", environment.fog.start);
+                    shader.setValue("uFogEnd", environment.fog.end);
+                } else {
+                    shader.setValue("uFogDensity", environment.fog.density);
+                }
             }
 
-            mShaderPostFX.setValue("uTonemapper", static_cast<int>(environment.tonemap.mode));
-            mShaderPostFX.setValue("uExposure", environment.tonemap.exposure);
-            mShaderPostFX.setValue("uWhite", environment.tonemap.white);
-
-            mShaderPostFX.setValue("uBrightness", environment.adjustements.brightness);
-            mShaderPostFX.setValue("uContrast", environment.adjustements.contrast);
-            mShaderPostFX.setValue("uSaturation", environment.adjustements.saturation);
-
-            mShaderPostFX.bindTexture("uTexSceneHDR", mTargetScene.attachement(GLAttachement::COLOR_0));
-            mShaderPostFX.bindTexture("uTexSceneDepth", mTargetScene.attachement(GLAttachement::DEPTH));
-
-            mShaderPostFX.setValue("uNear", rlGetCullDistanceNear());
-            mShaderPostFX.setValue("uFar", rlGetCullDistanceFar());
+            shader.bindTexture("uTexSceneHDR", mTargetScene.attachement(GLAttachement::COLOR_0));
+            shader.bindTexture("uTexLUT", mColorGrading.lut());
+            shader.setValue("uExposure", environment.tonemap.exposure);
 
             mQuad.draw();
         }
-        mShaderPostFX.end();
+        shader.end();
     mTargetPostFX.end();
 }
 
+inline GLShader& Renderer::getShaderPostFX()
+{
+    const uint32_t key = static_cast<uint32_t>(environment.bloom.mode)
+        | (static_cast<uint32_t>(environment.fog.mode) << 8);
+
+    auto it = mShaderPostFX.find(key);
+
+    if (it != mShaderPostFX.end()) {
+        return it->second;
+    }
+
+    std::string fsCode("#version 330 core\n");
+    {
+        fsCode += TextFormat("#define LUT_SIZE %i\n", ColorGrading::LUT_SIZE);
+        fsCode += TextFormat("#define BLOOM_MODE %i\n", environment.bloom.mode);
+        fsCode += TextFormat("#define FOG_MODE %i\n", environment.fog.mode);
+        fsCode += FS_CODE_POSTFX;
+    }
+
+    return mShaderPostFX.try_emplace(key, VS_CODE_POSTFX, fsCode).first->second;
+}
+
 inline void Renderer::present()
 {
+    GPUProfiler::Scope zone(mGPUProfiler, "Present");
+
     bool blitLinear = R3D_FLAG_BLIT_LINEAR;
     GLint target = customRenderTarget ? customRenderTarget->id : 0;
 
@@ -1059,6 +1680,31 @@ inline void Renderer::present()
     }
 }
 
+inline void Renderer::beginFrameProfiling()
+{
+    mGPUProfiler.beginFrame(flags & R3D_FLAG_GPU_PROFILING);
+}
+
+inline void Renderer::endFrameProfiling()
+{
+    mGPUProfiler.endFrame();
+}
+
+inline void Renderer::endFrameStats()
+{
+    ShaderMaterial::Counters& counters = ShaderMaterial::sCounters;
+
+    mStatsFrame.shaderBinds += counters.shaderBinds;
+    mStatsFrame.textureBinds += counters.textureBinds;
+    mStatsFrame.uniformUploads += counters.uniformUploads;
+    counters = ShaderMaterial::Counters{};
+
+    mStatsFrame.particlesSimulated += r3d_statsTakeParticlesSimulated();
+
+    mStatsLast = mStatsFrame;
+    mStatsFrame = R3D_FrameStats{};
+}
+
 inline void Renderer::updateInternalResolution(int newWidth, int newHeight)
 {
     if (newWidth == mInternalWidth && newHeight == mInternalHeight) {
@@ -1074,6 +1720,12 @@ inline void Renderer::updateInternalResolution(int newWidth, int newHeight)
     mTargetScene.resize(newWidth, newHeight);
     mTargetPostFX.resize(newWidth, newHeight);
     mBloomRenderer.resize(newWidth, newHeight);
+
+    for (auto& offscreen : mOffscreenRenderers) {
+        if (offscreen.has_value()) {
+            offscreen->resize(newWidth, newHeight);
+        }
+    }
 }
 
 inline R3D_Light Renderer::addLight(R3D_LightType type, int shadowMapResolution)
@@ -1103,6 +1755,17 @@ inline Light& Renderer::getLight(R3D_Light id)
     return mLights.at(id);
 }
 
+inline const std::map<R3D_Light, Light>& Renderer::getLightMap() const
+{
+    return mLights;
+}
+
+inline void Renderer::getInternalResolution(int* width, int* height) const
+{
+    *width = mInternalWidth;
+    *height = mInternalHeight;
+}
+
 inline R3D_MaterialConfig Renderer::getDefaultMaterialConfig() const
 {
     return mDefaultMaterialConfig;
@@ -1111,7 +1774,7 @@ inline R3D_MaterialConfig Renderer::getDefaultMaterialConfig() const
 inline void Renderer::setDefaultMaterialConfig(R3D_MaterialConfig config)
 {
     mDefaultMaterialConfig = config;
-    loadMaterialConfig(config);         ///< Just in case
+    loadMaterialConfig(config, false);  ///< Just in case, the default shader must always be ready
 }
 
 inline const Texture2D& Renderer::getTextureBlack() const
@@ -1127,20 +1790,33 @@ inline const Texture2D& Renderer::getTextureWhite() const
 inline void Renderer::getDrawCallCount(int* sceneDrawCount, int* shadowDrawCount) const
 {
     if (sceneDrawCount != nullptr) {
-        *sceneDrawCount = 0;
-        for (const auto& [_, batch] : mSceneBatches) {
-            *sceneDrawCount += batch.size();
-        }
+        *sceneDrawCount = mStatsLast.sceneDraws;
     }
 
     if (shadowDrawCount != nullptr) {
-        *shadowDrawCount = 0;
-        for (const auto& [_, batch] : mShadowBatches) {
-            *shadowDrawCount += batch.size();
-        }
+        *shadowDrawCount = mStatsLast.shadowDraws;
     }
 }
 
+inline R3D_FrameStats Renderer::getFrameStats() const
+{
+    R3D_FrameStats stats = mStatsLast;
+
+    stats.gpu.frame = mGPUProfiler.average("Frame");
+    stats.gpu.shadowPass = mGPUProfiler.average("Shadow pass");
+    stats.gpu.scenePass = mGPUProfiler.average("Scene pass");
+    stats.gpu.bloom = mGPUProfiler.average("Post process/Bloom");
+    stats.gpu.postProcess = mGPUProfiler.average("Post process");
+    stats.gpu.present = mGPUProfiler.average("Present");
+
+    return stats;
+}
+
+inline const GPUProfiler& Renderer::getGPUProfiler() const
+{
+    return mGPUProfiler;
+}
+
 inline void Renderer::drawShadowMap(R3D_Light light, int x, int y, int width, int height, float zNear, float zFar) const
 {
     if (!mDebugShaderDepthTexture2D.has_value()) {
@@ -1200,8 +1876,8 @@ inline void Renderer::drawMeshShadow(const Light& light, const Mesh& mesh, const
         }
     }
 
-    ::Matrix matMVP = MatrixMultiply(
-        MatrixMultiply(transform, rlGetMatrixModelview()),
+    ::Matrix matMVP = simdMatrixMultiply(
+        simdMatrixMultiplyAffine(transform, rlGetMatrixModelview()),
         rlGetMatrixProjection()
     );
 
@@ -1209,16 +1885,22 @@ inline void Renderer::drawMeshShadow(const Light& light, const Mesh& mesh, const
         rlSetUniform(mShaderDepthCube.locs[SHADER_LOC_VECTOR_VIEW], &light.position, SHADER_UNIFORM_VEC3, 1);
         rlSetUniformMatrix(mShaderDepthCube.locs[SHADER_LOC_MATRIX_MODEL], transform);
         rlSetUniformMatrix(mShaderDepthCube.locs[SHADER_LOC_MATRIX_MVP], matMVP);
+        mStatsFrame.uniformUploads += 3;
     } else {
         rlSetUniformMatrix(mShaderDepth.locs[SHADER_LOC_MATRIX_MVP], matMVP);
+        mStatsFrame.uniformUploads += 1;
     }
 
     if (mesh.vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] == 0) {
         rlDrawVertexArray(0, mesh.vertexCount);
+        mStatsFrame.triangles += mesh.vertexCount / 3;
     } else {
         rlDrawVertexArrayElements(0, 3 * mesh.triangleCount, 0);
+        mStatsFrame.triangles += mesh.triangleCount;
     }
 
+    mStatsFrame.shadowDraws++;
+
     rlDisableVertexArray();
     rlDisableVertexBuffer();
     rlDisableVertexBufferElement();
@@ -1227,10 +1909,16 @@ inline void Renderer::drawMeshShadow(const Light& light, const Mesh& mesh, const
 inline void Renderer::drawMeshScene(const Mesh& mesh, const Matrix& transform, ShaderMaterial& shader, R3D_MaterialConfig config) const
 {
     Matrix matView = rlGetMatrixModelview();
-
-    Matrix matModelView = MatrixMultiply(transform, matView);
     Matrix matProjection = rlGetMatrixProjection();
 
+    // The billboard shaders compute the world position themselves, the MVP is then only the view-projection
+
+    Matrix matModelView = matView;
+
+    if (shader.config().billboard == R3D_BILLBOARD_DISABLED) {
+        matModelView = simdMatrixMultiplyAffine(transform, matView);
+    }
+
     // Try binding vertex array objects (VAO) or use VBOs if not possible
     if (!rlEnableVertexArray(mesh.vaoId))
     {
@@ -1299,16 +1987,19 @@ inline void Renderer::drawMeshScene(const Mesh& mesh, const Matrix& transform, S
 
     for (int eye = 0; eye < eyeCount; eye++) {
         if (eyeCount == 1) {
-            shader.setMatMVP(MatrixMultiply(matModelView, matProjection));
+            shader.setMatMVP(simdMatrixMultiply(matModelView, matProjection));
         } else {
             glViewport(eye*rlGetFramebufferWidth()/2, 0, rlGetFramebufferWidth()/2, rlGetFramebufferHeight());
-            shader.setMatMVP(MatrixMultiply(MatrixMultiply(matModelView, rlGetMatrixViewOffsetStereo(eye)), rlGetMatrixProjectionStereo(eye)));
+            shader.setMatMVP(simdMatrixMultiply(simdMatrixMultiplyAffine(matModelView, rlGetMatrixViewOffsetStereo(eye)), rlGetMatrixProjectionStereo(eye)));
         }
         if (mesh.vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] == 0) {
             rlDrawVertexArray(0, mesh.vertexCount);
+            mStatsFrame.triangles += mesh.vertexCount / 3;
         } else {
             rlDrawVertexArrayElements(0, 3 * mesh.triangleCount, 0);
+            mStatsFrame.triangles += mesh.triangleCount;
         }
+        mStatsFrame.sceneDraws++;
     }
 
     // Disable all possible vertex array objects (or VBOs)
@@ -1321,6 +2012,222 @@ inline void Renderer::drawMeshScene(const Mesh& mesh, const Matrix& transform, S
     rlSetMatrixProjection(matProjection);
 }
 
+inline R3D_RenderScale Renderer::getRenderScale(R3D_MaterialConfig config) const
+{
+    if (config.renderScale == R3D_RENDER_SCALE_FULL || config.renderScale > R3D_RENDER_SCALE_QUARTER) {
+        return R3D_RENDER_SCALE_FULL;
+    }
+
+    if (!OffscreenRenderer::isBlendModeSupported(static_cast<R3D_BlendMode>(config.blendMode))) {
+        return R3D_RENDER_SCALE_FULL;
+    }
+
+    if (!mOffscreenRenderers[config.renderScale - 1].has_value()) {
+        return R3D_RENDER_SCALE_FULL;
+    }
+
+    return static_cast<R3D_RenderScale>(config.renderScale);
+}
+
+inline R3D_MaterialConfig Renderer::getBillboardMaterialConfig(R3D_MaterialConfig config, R3D_BillboardMode billboard)
+{
+    config.shader.billboard = static_cast<uint8_t>(billboard);
+
+    if (!mSceneBatches.isBatchExist(config)) {
+        loadMaterialConfig(config);
+    }
+
+    return config;
+}
+
+inline void Renderer::loadShaderMaterial(ShaderMaterialKey key, bool async)
+{
+    if (mShaderMaterials.find(key) != mShaderMaterials.cend()) {
+        return;
+    }
+
+    auto it_pending_shader = mPendingShaderMaterials.find(key);
+
+    if (it_pending_shader != mPendingShaderMaterials.end()) {
+        if (!async) {
+            // Waits for the compilation already started
+            mShaderMaterials.try_emplace(key, key.config, key.lightCount, ProgramCache::finish(it_pending_shader->second));
+            mPendingShaderMaterials.erase(it_pending_shader);
+        }
+        return;
+    }
+
+    const std::string vsCode = ShaderMaterial::getVertexCode(key.config);
+    const std::string fsCode = ShaderMaterial::getFragmentCode(key.config, key.lightCount);
+
+    // Without parallel compilation, the first status query would block anyway,
+    // so the shader is compiled right away rather than at an unpredictable frame
+
+    if (async && ProgramCache::isParallelSupported()) {
+        mPendingShaderMaterials.emplace(key, ProgramCache::loadAsync(vsCode, fsCode));
+    } else {
+        mShaderMaterials.try_emplace(key, key.config, key.lightCount, ProgramCache::load(vsCode, fsCode));
+    }
+}
+
+inline void Renderer::updatePendingShaderMaterials()
+{
+    for (auto it = mPendingShaderMaterials.begin(); it != mPendingShaderMaterials.end();) {
+        if (!ProgramCache::isComplete(it->second)) {
+            ++it;
+            continue;
+        }
+        const ShaderMaterialKey& key = it->first;
+        mShaderMaterials.try_emplace(key, key.config, key.lightCount, ProgramCache::finish(it->second));
+        it = mPendingShaderMaterials.erase(it);
+    }
+}
+
+inline ShaderMaterial* Renderer::getShaderMaterial(R3D_MaterialShaderConfig config, int lightCount)
+{
+    // The unshaded variants ignore the lights, only the one registered with the configuration exists
+
+    int bucket = SHADER_LIGHT_COUNT;
+
+    if (config.diffuse != R3D_DIFFUSE_UNSHADED) {
+        bucket = ShaderMaterial::getLightBucket(lightCount);
+    }
+
+    // While a variant is being compiled, the next key is tried: the variant with all lights, then the
+    // default configuration, keeping the billboard mode since it defines how the vertices are positioned
+
+    R3D_MaterialShaderConfig fallback = mDefaultMaterialConfig.shader;
+    fallback.billboard = config.billboard;
+
+    const ShaderMaterialKey keys[] = {
+        { config, bucket },
+        { config, SHADER_LIGHT_COUNT },
+        { fallback, SHADER_LIGHT_COUNT }
+    };
+
+    for (const ShaderMaterialKey& key : keys) {
+        loadShaderMaterial(key, true);
+        auto it_material_shader = mShaderMaterials.find(key);
+        if (it_material_shader != mShaderMaterials.end()) {
+            return &it_material_shader->second;
+        }
+    }
+
+    return nullptr;
+}
+
+inline void Renderer::drawShadowBatch(const Light& light, const std::vector<DrawCall_Shadow>& batch)
+{
+    for (size_t i = 0; i < batch.size();) {
+        if (batch[i].getSprite() == nullptr) {
+            batch[i++].draw(light);
+            continue;
+        }
+
+        // Gathers the consecutive sprites, their materials are irrelevant here
+
+        mSpriteBatcher.clear();
+
+        for (; i < batch.size(); i++) {
+            const DrawCall_Shadow::Sprite* call = batch[i].getSprite();
+            if (call == nullptr) break;
+
+            const R3D_Material& material = call->sprite->material;
+            if (!mSpriteBatcher.push(call->transform, material.uv.offset, material.uv.scale, material.albedo.color, false)) {
+                break;
+            }
+        }
+
+        drawMeshShadow(light, mSpriteBatcher.upload(), MatrixIdentity());
+        mStatsFrame.spriteBatchDraws++;
+    }
+}
+
+inline void Renderer::drawSceneBatch(const std::vector<DrawCall_Scene>& batch, R3D_MaterialShaderConfig config)
+{
+    ShaderMaterial* shader = nullptr;
+    int shaderLightCount = -1;
+
+    // Switches to the variant matching the number of lights of the next draw, returns false if none is ready
+
+    auto useShader = [&](const ShaderLightArray& lights) -> bool {
+        int lightCount = ShaderMaterial::getLightCount(lights);
+        if (lightCount == shaderLightCount) {
+            return shader != nullptr;
+        }
+        ShaderMaterial* next = getShaderMaterial(config, lightCount);
+        if (next != shader) {
+            if (shader != nullptr) shader->end();
+            if (next != nullptr) {
+                next->begin();
+                next->setEnvironment(environment, mCamera.position, mSceneFrame);
+            }
+            shader = next;
+        }
+        shaderLightCount = lightCount;
+        return shader != nullptr;
+    };
+
+    bool billboard = (config.billboard != R3D_BILLBOARD_DISABLED);
+
+    for (size_t i = 0; i < batch.size();) {
+        const DrawCall_Scene::Sprite* first = batch[i].getSprite();
+
+        if (first == nullptr) {
+            if (useShader(batch[i].getLights())) {
+                GLuint query = mOcclusionQueries.getQuery(batch[i].getOcclusionQuery());
+                if (query != 0) glBeginConditionalRender(query, GL_QUERY_NO_WAIT);
+                batch[i].draw(*shader);
+                if (query != 0) glEndConditionalRender();
+            }
+            i++;
+            continue;
+        }
+
+        // Gathers the following sprites that can share the same uniforms,
+        // the order of the draw calls is kept for the depth sorting
+
+        const ShaderLightArray& lights = first->lights;
+
+        mSpriteBatcher.clear();
+
+        for (; i < batch.size(); i++) {
+            const DrawCall_Scene::Sprite* call = batch[i].getSprite();
+            if (call == nullptr || mSpriteBatcher.count() >= SpriteBatcher::MAX_SPRITES) break;
+
+            const R3D_Material& material = call->sprite->material;
+            if (!SpriteBatcher::isMaterialBatchable(first->sprite->material, material)) break;
+            if (call->lights != lights) break;
+
+            mSpriteBatcher.push(call->transform, material.uv.offset, material.uv.scale, material.albedo.color, billboard);
+        }
+
+        if (!useShader(lights)) {
+            continue;
+        }
+
+        // The UV rects and the albedo colors are baked in the vertices and the vertices are in world space,
+        // or relative to their pivot stored in the vertices for billboards
+
+        R3D_Material material = first->sprite->material;
+        material.config.shader = config;
+        material.albedo.color = WHITE;
+        material.uv.offset = { 0.0f, 0.0f };
+        material.uv.scale = { 1.0f, 1.0f };
+
+        shader->setMaterial(material);
+        shader->setMatModel(MatrixIdentity());
+        shader->setLights(lights);
+
+        drawMeshScene(mSpriteBatcher.upload(), MatrixIdentity(), *shader, material.config);
+        mStatsFrame.spriteBatchDraws++;
+    }
+
+    if (shader != nullptr) {
+        shader->end();
+    }
+}
+
 
 /* DrawCall_Shadow implementation */
 
@@ -1340,34 +2247,20 @@ inline void DrawCall_Shadow::draw(const Light& light) const
 {
     switch (mCall.index()) {
         case 0: drawMesh(light); break;
-        case 1: drawSprite(light); break;
         case 2: drawParticlesCPU(light); break;
+        default: break;
     }
 }
 
-inline void DrawCall_Shadow::drawMesh(const Light& light) const
+inline const DrawCall_Shadow::Sprite* DrawCall_Shadow::getSprite() const
 {
-    const auto& call = std::get<0>(mCall);
-    gRenderer->drawMeshShadow(light, *call.mesh, call.transform);
+    return std::get_if<Sprite>(&mCall);
 }
 
-inline void DrawCall_Shadow::drawSprite(const Light& light) const
+inline void DrawCall_Shadow::drawMesh(const Light& light) const
 {
-    const auto& call = std::get<1>(mCall);
-
-    unsigned int vbo[9]{};
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = gRenderer->mQuad.ebo();
-
-    Mesh mesh {
-        .triangleCount = 2,
-        .vaoId = gRenderer->mQuad.vao(),
-        .vboId = vbo
-    };
-
-    gRenderer->drawMeshShadow(light, mesh, call.transform);
+    const auto& call = std::get<0>(mCall);
+    gRenderer->drawMeshShadow(light, *call.mesh, call.transform);
 }
 
 inline void DrawCall_Shadow::drawParticlesCPU(const Light& light) const
@@ -1375,8 +2268,8 @@ inline void DrawCall_Shadow::drawParticlesCPU(const Light& light) const
     const auto& call = std::get<2>(mCall);
     for (int i = 0; i < call.system->particleCount; i++) {
         const R3D_Particle& particle = call.system->particles[i];
-        Matrix transform = MatrixMultiply(
-            MatrixMultiply(
+        Matrix transform = simdMatrixMultiplyAffine(
+            simdMatrixMultiplyAffine(
                 MatrixScale(particle.scale.x, particle.scale.y, particle.scale.z),
                 MatrixRotateXYZ(particle.rotation)
             ),
@@ -1384,7 +2277,7 @@ inline void DrawCall_Shadow::drawParticlesCPU(const Light& light) const
         );
         gRenderer->drawMeshShadow(
             light, call.system->surface.mesh,
-            MatrixMultiply(transform, rlGetMatrixTransform())
+            simdMatrixMultiplyAffine(transform, rlGetMatrixTransform())
         );
     }
 }
@@ -1392,8 +2285,8 @@ inline void DrawCall_Shadow::drawParticlesCPU(const Light& light) const
 
 /* DrawCall_Scene implementation */
 
-inline DrawCall_Scene::DrawCall_Scene(const R3D_Surface& surface, const Matrix& transform, const ShaderLightArray& lights)
-    : mCall(Surface { &surface.mesh, surface.material, lights, transform })
+inline DrawCall_Scene::DrawCall_Scene(const R3D_Surface& surface, const ::Mesh& mesh, const Matrix& transform, const ShaderLightArray& lights, int occlusionQuery)
+    : mCall(Surface { &mesh, surface.material, lights, transform, occlusionQuery })
 { }
 
 inline DrawCall_Scene::DrawCall_Scene(const R3D_Sprite* sprite, const Matrix& transform, const ShaderLightArray& lights)
@@ -1408,11 +2301,27 @@ inline void DrawCall_Scene::draw(ShaderMaterial& shader) const
 {
     switch (mCall.index()) {
         case 0: drawMesh(shader); break;
-        case 1: drawSprite(shader); break;
         case 2: drawParticlesCPU(shader); break;
+        default: break;
     }
 }
 
+inline const DrawCall_Scene::Sprite* DrawCall_Scene::getSprite() const
+{
+    return std::get_if<Sprite>(&mCall);
+}
+
+inline const ShaderLightArray& DrawCall_Scene::getLights() const
+{
+    return std::visit([](const auto& call) -> const ShaderLightArray& { return call.lights; }, mCall);
+}
+
+inline int DrawCall_Scene::getOcclusionQuery() const
+{
+    const Surface* call = std::get_if<Surface>(&mCall);
+    return (call != nullptr) ? call->occlusionQuery : -1;
+}
+
 inline const Matrix* DrawCall_Scene::getTransform() const {
     switch (mCall.index()) {
         case 0: return &std::get<0>(mCall).transform;
@@ -1433,29 +2342,6 @@ inline void DrawCall_Scene::drawMesh(ShaderMaterial& shader) const
     gRenderer->drawMeshScene(*call.surface.mesh, call.transform, shader, call.surface.material.config);
 }
 
-inline void DrawCall_Scene::drawSprite(ShaderMaterial& shader) const
-{
-    const auto& call = std::get<1>(mCall);
-
-    shader.setMaterial(call.sprite->material);
-    shader.setMatModel(call.transform);
-    shader.setLights(call.lights);
-
-    unsigned int vbo[9]{};
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = gRenderer->mQuad.vbo();
-    vbo[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = gRenderer->mQuad.ebo();
-
-    Mesh mesh {
-        .triangleCount = 2,
-        .vaoId = gRenderer->mQuad.vao(),
-        .vboId = vbo
-    };
-
-    gRenderer->drawMeshScene(mesh, call.transform, shader, call.sprite->material.config);
-}
-
 inline void DrawCall_Scene::drawParticlesCPU(ShaderMaterial& shader) const
 {
     auto& call = std::get<2>(mCall);
@@ -1473,22 +2359,14 @@ inline void DrawCall_Scene::drawParticlesCPU(ShaderMaterial& shader) const
 
     for (int i = 0; i < call.system->particleCount; i++) {
         const R3D_Particle& particle = call.system->particles[i];
-        Matrix transform = MatrixMultiply(
-            MatrixMultiply(
+        Matrix transform = simdMatrixMultiplyAffine(
+            simdMatrixMultiplyAffine(
                 MatrixScale(particle.scale.x, particle.scale.y, particle.scale.z),
                 MatrixRotateXYZ(particle.rotation)
             ),
             MatrixTranslate(particle.position.x, particle.position.y, particle.position.z)
         );
 
-        if (call.system->billboard != R3D_BILLBOARD_DISABLED) {
-            Vector3 modelPos = getMatrixTrasnlation(transform);
-            Matrix billboardRotation = getBillboardRotationMatrix(
-                call.system->billboard, modelPos, gRenderer->mCamera.position
-            );
-            transform = MatrixMultiply(transform, billboardRotation);
-        }
-
         R3D_Material material = call.system->surface.material;
 
         material.albedo.color = (Color) {
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "r3d.h"
+
+#include "../detail/trace.h"
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <mutex>
+#include <array>
+
+/* Internal data */
+
+#ifdef R3D_ENABLE_TRACE
+
+namespace {
+
+constexpr uint32_t TRACE_CAPACITY = 1 << 16;    ///< Number of zones kept per thread, must be a power of two.
+constexpr int TRACE_MAX_DEPTH = 64;             ///< Maximum nesting depth of the zones of a thread.
+
+struct TraceEvent
+{
+    const char* name;   ///< Name of the zone.
+    int64_t start;      ///< Start time of the zone in nanoseconds, relative to 'gTraceEpoch'.
+    int64_t duration;   ///< Duration of the zone in nanoseconds.
+};
+
+struct TraceBuffer
+{
+    std::array<TraceEvent, TRACE_CAPACITY> events;      ///< Ring buffer of the completed zones.
+    std::atomic<uint32_t> head{ 0 };                    ///< Number of zones ever recorded, only written by the owning thread.
+    std::array<TraceEvent, TRACE_MAX_DEPTH> stack;      ///< Zones that have begun and not ended yet.
+    int depth = 0;                                      ///< Number of zones in the stack, may exceed its size.
+    int tid = 0;                                        ///< Identifier of the thread in the trace.
+};
+
+// NOTE: The buffers are owned by the registry and never freed, so that the
+//       zones of threads that have exited can still be saved
+
+std::mutex gTraceMutex;
+std::vector<std::unique_ptr<TraceBuffer>> gTraceBuffers;
+const auto gTraceEpoch = std::chrono::steady_clock::now();
+
+int64_t traceNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - gTraceEpoch
+    ).count();
+}
+
+TraceBuffer& traceThreadBuffer()
+{
+    thread_local TraceBuffer* buffer = nullptr;
+
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(gTraceMutex);
+        buffer = gTraceBuffers.emplace_back(std::make_unique<TraceBuffer>()).get();
+        buffer->tid = static_cast<int>(gTraceBuffers.size());
+    }
+
+    return *buffer;
+}
+
+} // namespace
+
+#endif // R3D_ENABLE_TRACE
+
+/* Internal API */
+
+void r3d_traceBegin(const char* name)
+{
+#ifdef R3D_ENABLE_TRACE
+    TraceBuffer& buffer = traceThreadBuffer();
+    if (buffer.depth < TRACE_MAX_DEPTH) {
+        buffer.stack[buffer.depth] = TraceEvent { name, traceNow(), 0 };
+    }
+    buffer.depth++;
+#else
+    (void)name;
+#endif
+}
+
+void r3d_traceEnd(void)
+{
+#ifdef R3D_ENABLE_TRACE
+    TraceBuffer& buffer = traceThreadBuffer();
+    if (buffer.depth == 0) return;
+    if (--buffer.depth >= TRACE_MAX_DEPTH) return;
+
+    TraceEvent event = buffer.stack[buffer.depth];
+    event.duration = traceNow() - event.start;
+
+    uint32_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head & (TRACE_CAPACITY - 1)] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+#endif
+}
+
+/* Public API */
+
+bool R3D_SaveTraceJSON(const char* fileName)
+{
+#ifdef R3D_ENABLE_TRACE
+    FILE* file = std::fopen(fileName, "w");
+
+    if (file == nullptr) {
+        TraceLog(LOG_WARNING, "R3D: Failed to open '%s' to save the trace", fileName);
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+    std::vector<TraceEvent> events;
+
+    for (const auto& buffer : gTraceBuffers) {
+        uint32_t head = buffer->head.load(std::memory_order_acquire);
+        uint32_t count = (head < TRACE_CAPACITY) ? head : TRACE_CAPACITY;
+
+        events.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            events[i] = buffer->events[(head - count + i) & (TRACE_CAPACITY - 1)];
+        }
+
+        // NOTE: The owning thread may still be recording while we copy, and once its
+        //       ring is full each new zone overwrites the oldest slot. The zones written
+        //       meanwhile, plus the one possibly in progress, tell how many of the oldest
+        //       copied events may be torn, those are dropped.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t written = buffer->head.load(std::memory_order_relaxed) - head + 1;
+        uint64_t overlap = written + count;
+        uint32_t skip = (overlap <= TRACE_CAPACITY) ? 0
+            : static_cast<uint32_t>(std::min<uint64_t>(overlap - TRACE_CAPACITY, count));
+
+        for (uint32_t i = skip; i < count; i++) {
+            const TraceEvent& event = events[i];
+
+            // NOTE: The names are string literals of the library, they never need to be escaped
+            std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",", event.name, buffer->tid,
+                event.start * 1e-3, event.duration * 1e-3
+            );
+
+            first = false;
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    std::fclose(file);
+
+    TraceLog(LOG_INFO, "R3D: Trace saved to '%s'", fileName);
+
+    return true;
+#else
+    (void)fileName;
+    TraceLog(LOG_WARNING, "R3D: Tracing is disabled, build the library with 'R3D_ENABLE_TRACE' to record a trace");
+    return false;
+#endif
+}
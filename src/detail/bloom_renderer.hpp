@@ -1,11 +1,19 @@
 #ifndef R3D_DETAIL_BLOOM_RENDERER_HPP
 #define R3D_DETAIL_BLOOM_RENDERER_HPP
 
+#include "r3d.h"
+
 #include "./gl_helper/gl_framebuffer.hpp"
 #include "./render_target.hpp"
 #include "./gl_helper/gl_shader.hpp"
 #include "./shader_code.hpp"
 #include "./drawable_quad.hpp"
+
+#include <rlgl.h>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
 #include <array>
 
 namespace r3d {
@@ -14,9 +22,21 @@ namespace r3d {
  * @brief Class for rendering the bloom effect in a scene.
  * 
  * This class handles the process of applying a bloom effect by blurring the bright areas of the scene and combining them with the original image.
+ * The bright areas are extracted from the scene colors by the first pass of the filter, which discards the colors below the HDR threshold.
+ * 
+ * Two filters are available (see `R3D_BloomFilter`):
+ * - The Gaussian filter ping-pongs a separable blur between two half resolution targets, one pass per iteration.
+ * - The mip chain filter downsamples the bright areas into progressively smaller targets, then upsamples them back
+ *   while accumulating each level. Each iteration adds a level, doubling the radius for a quarter of the previous cost.
  */
 class BloomRenderer
 {
+public:
+    /**
+     * @brief Maximum number of levels of the mip chain, the first one being at half resolution.
+     */
+    static constexpr int MAX_MIP_LEVELS = 8;
+
 public:
     /**
      * @brief Constructs a BloomRenderer with specified dimensions.
@@ -33,11 +53,13 @@ public:
     void resize(int newWidth, int newHeight);
 
     /**
-     * @brief Renders the bloom effect using the given luminance texture.
-     * @param texSceneLum The texture containing the scene luminance for bloom.
-     * @param iterations The number of blur iterations to perform.
+     * @brief Renders the bloom effect using the given scene color texture.
+     * @param texScene The texture containing the HDR colors of the scene.
+     * @param hdrThreshold The perceived luminance above which colors contribute to bloom.
+     * @param iterations The number of blur iterations to perform, or the number of mip levels with the mip chain filter.
+     * @param filter The filter used to blur the bright areas.
      */
-    void render(const GLTexture& texSceneLum, int iterations);
+    void render(const GLTexture& texScene, float hdrThreshold, int iterations, R3D_BloomFilter filter);
 
     /**
      * @brief Returns the final result of the bloom effect.
@@ -45,11 +67,35 @@ public:
      */
     const GLTexture& result() const;
 
+private:
+    /**
+     * @brief Blurs the bright areas of the scene with the separable Gaussian filter.
+     */
+    void renderGaussian(const GLTexture& texScene, float hdrThreshold, int iterations);
+
+    /**
+     * @brief Blurs the bright areas of the scene with the downsample/upsample mip chain.
+     */
+    void renderMipChain(const GLTexture& texScene, float hdrThreshold, int levels);
+
+    /**
+     * @brief Creates the targets of the mip chain for the given renderer dimensions.
+     */
+    void createMipChain(int rendererWidth, int rendererHeight);
+
 private:
     std::array<RenderTarget, 2> mTargets;   /**< Render targets for the bloom effect. */
     GLShader mShaderBlur;                   /**< Shader used for the blur effect. */
     Quad mQuad;                             /**< A quad used for rendering the texture. */
 
+    std::vector<RenderTarget> mMipChain;    /**< Targets of the mip chain, created on first use, from half resolution down. */
+    std::optional<GLShader> mShaderDownsample;  /**< Shader used to downsample a level of the mip chain. */
+    std::optional<GLShader> mShaderUpsample;    /**< Shader used to upsample a level of the mip chain. */
+
+    int mRendererWidth;                     /**< Width of the renderer, used to create the mip chain. */
+    int mRendererHeight;                    /**< Height of the renderer, used to create the mip chain. */
+
+    const GLTexture* mResult;               /**< Texture containing the result of the last render. */
     bool mHorizontalPass;                   /**< Flag indicating whether the current pass is horizontal or vertical for the blur. */
 };
 
@@ -61,6 +107,9 @@ inline BloomRenderer::BloomRenderer(int rendererWidth, int rendererHeight)
         RenderTarget(rendererWidth / 2, rendererHeight / 2)
     })
     , mShaderBlur(VS_CODE_BLUR, FS_CODE_BLUR)
+    , mRendererWidth(rendererWidth)
+    , mRendererHeight(rendererHeight)
+    , mResult(nullptr)
 {
     for (int i = 0; i < 2; i++) {
         auto& texture = mTargets[i].createAttachment(
@@ -71,16 +120,36 @@ inline BloomRenderer::BloomRenderer(int rendererWidth, int rendererHeight)
         texture.wrap(GLTexture::Wrap::CLAMP_BORDER);
         texture.genMipmaps();
     }
+
+    mResult = &mTargets[0].attachement(GLAttachement::COLOR_0);
 }
 
 inline void BloomRenderer::resize(int newWidth, int newHeight)
 {
+    mRendererWidth = newWidth;
+    mRendererHeight = newHeight;
+
     for (auto& target : mTargets) {
         target.resize(newWidth / 2, newHeight / 2);
     }
+
+    // The number of levels depends on the dimensions, so the chain is recreated
+
+    if (!mMipChain.empty()) {
+        createMipChain(newWidth, newHeight);
+    }
 }
 
-inline void BloomRenderer::render(const GLTexture& texSceneLum, int iterations)
+inline void BloomRenderer::render(const GLTexture& texScene, float hdrThreshold, int iterations, R3D_BloomFilter filter)
+{
+    if (filter == R3D_BLOOM_FILTER_MIP_CHAIN) {
+        renderMipChain(texScene, hdrThreshold, iterations);
+    } else {
+        renderGaussian(texScene, hdrThreshold, iterations);
+    }
+}
+
+inline void BloomRenderer::renderGaussian(const GLTexture& texScene, float hdrThreshold, int iterations)
 {
     mHorizontalPass = true;
 
@@ -92,9 +161,10 @@ inline void BloomRenderer::render(const GLTexture& texSceneLum, int iterations)
                 mShaderBlur.setValue("uDirection", mHorizontalPass
                     ? Vector2 { 1, 0 } : Vector2 { 0, 1 }
                 );
+                mShaderBlur.setValue("uThreshold", i > 0 ? 0.0f : hdrThreshold);
                 mShaderBlur.bindTexture("uTexture", i > 0
                     ? mTargets[!mHorizontalPass].attachement(GLAttachement::COLOR_0)
-                    : texSceneLum
+                    : texScene
                 );
                 mQuad.draw();
             }
@@ -103,11 +173,86 @@ inline void BloomRenderer::render(const GLTexture& texSceneLum, int iterations)
         GLFramebuffer::unbind();
     }
     mShaderBlur.end();
+
+    mResult = &mTargets[!mHorizontalPass].attachement(GLAttachement::COLOR_0);
+}
+
+inline void BloomRenderer::renderMipChain(const GLTexture& texScene, float hdrThreshold, int levels)
+{
+    if (mMipChain.empty()) {
+        mShaderDownsample.emplace(VS_CODE_BLUR, FS_CODE_BLOOM_DOWNSAMPLE);
+        mShaderUpsample.emplace(VS_CODE_BLUR, FS_CODE_BLOOM_UPSAMPLE);
+        createMipChain(mRendererWidth, mRendererHeight);
+    }
+
+    levels = std::clamp(levels, 1, static_cast<int>(mMipChain.size()));
+
+    /* Downsample each level from the previous one, the first from the full resolution scene with the bright pass */
+
+    rlDisableColorBlend();
+
+    mShaderDownsample->begin();
+    {
+        for (int i = 0; i < levels; i++) {
+            mMipChain[i].begin();
+            {
+                mShaderDownsample->setValue("uThreshold", i > 0 ? 0.0f : hdrThreshold);
+                mShaderDownsample->bindTexture("uTexture", i > 0
+                    ? mMipChain[i - 1].attachement(GLAttachement::COLOR_0)
+                    : texScene
+                );
+                mQuad.draw();
+            }
+            mShaderDownsample->unbindTextures();
+        }
+    }
+    mShaderDownsample->end();
+
+    /* Upsample each level over the previous one, blended so that the result is their average */
+
+    rlEnableColorBlend();
+    rlSetBlendMode(RL_BLEND_ALPHA);
+
+    mShaderUpsample->begin();
+    {
+        for (int i = levels - 1; i > 0; i--) {
+            mMipChain[i - 1].begin();
+            {
+                // Level 'i - 1' keeps a weight of 1/N, N being the number of levels averaged into it
+                mShaderUpsample->setValue("uWeight", static_cast<float>(levels - i) / (levels - i + 1));
+                mShaderUpsample->bindTexture("uTexture", mMipChain[i].attachement(GLAttachement::COLOR_0));
+                mQuad.draw();
+            }
+            mShaderUpsample->unbindTextures();
+        }
+        GLFramebuffer::unbind();
+    }
+    mShaderUpsample->end();
+
+    mResult = &mMipChain[0].attachement(GLAttachement::COLOR_0);
+}
+
+inline void BloomRenderer::createMipChain(int rendererWidth, int rendererHeight)
+{
+    mMipChain.clear();
+
+    int w = rendererWidth / 2;
+    int h = rendererHeight / 2;
+
+    while (static_cast<int>(mMipChain.size()) < MAX_MIP_LEVELS && w >= 2 && h >= 2) {
+        auto& texture = mMipChain.emplace_back(w, h).createAttachment(
+            GLAttachement::COLOR_0, GL_TEXTURE_2D,
+            GL_RGBA16F, GL_RGBA, GL_FLOAT
+        );
+        texture.filter(GLTexture::Filter::BILINEAR);
+        texture.wrap(GLTexture::Wrap::CLAMP_EDGE);
+        w /= 2, h /= 2;
+    }
 }
 
 inline const GLTexture& BloomRenderer::result() const
 {
-    return mTargets[!mHorizontalPass].attachement(GLAttachement::COLOR_0);
+    return *mResult;
 }
 
 }
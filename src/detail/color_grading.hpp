@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_COLOR_GRADING_HPP
+#define R3D_DETAIL_COLOR_GRADING_HPP
+
+#include "r3d.h"
+
+#include "./gl_helper/gl_framebuffer.hpp"
+#include "./gl_helper/gl_texture.hpp"
+#include "./gl_helper/gl_shader.hpp"
+#include "./shader_code.hpp"
+#include "./drawable_quad.hpp"
+#include "./gl.hpp"
+
+#include <raylib.h>
+#include <unordered_map>
+#include <cstdint>
+#include <string>
+
+namespace r3d {
+
+/**
+ * @brief Class baking the color grading of the environment into a 3D LUT.
+ *
+ * The tonemapping, gamma correction, color adjustments and the optional user LUT are evaluated
+ * once per texel of the LUT, which is indexed by the log2 of the exposed HDR colors. The
+ * post-processing pass then only needs to apply the exposure and a single fetch. Since the
+ * exposure is not baked, the LUT always covers the same stops of the exposed colors.
+ *
+ * The LUT is baked on the GPU by the `LUT_BAKE` variant of the post-processing shader, one
+ * layer per draw, and is only baked again when the corresponding environment values change.
+ */
+class ColorGrading
+{
+public:
+    /**
+     * @brief Number of texels per axis of the LUT.
+     */
+    static constexpr int LUT_SIZE = 32;
+
+public:
+    /**
+     * @brief Creates the LUT, it is baked on the first call to `update`.
+     */
+    ColorGrading();
+
+    /**
+     * @brief Bakes the LUT again if the tonemap mode, white point or color adjustments of the environment have changed.
+     * @note The bound framebuffer and the viewport are not restored.
+     * @param env The environment to bake.
+     */
+    void update(const R3D_Environment& env);
+
+    /**
+     * @brief Returns the 3D texture containing the baked color grading.
+     */
+    const GLTexture& lut() const;
+
+private:
+    /**
+     * @brief Indicates if the LUT already contains the color grading of the given environment.
+     */
+    bool isBaked(const R3D_Environment& env) const;
+
+    /**
+     * @brief Retrieves the baking shader variant matching the environment, compiled on first use.
+     */
+    GLShader& getShaderBake(const R3D_Environment& env);
+
+    /**
+     * @brief Indicates if the brightness, contrast or saturation of the environment differ from their neutral value.
+     */
+    static bool hasColorAdjustments(const R3D_Environment& env);
+
+private:
+    GLTexture mLUT;                                         ///< RGBA16F 3D texture containing the baked color grading.
+    GLFramebuffer mFramebuffer;                             ///< Framebuffer used to render each layer of the LUT.
+    std::unordered_map<uint32_t, GLShader> mShaderBake;     ///< Baking shader variants, see `getShaderBake`.
+    Quad mQuad;                                             ///< Quad used to render the layers.
+
+    decltype(R3D_Environment::tonemap) mBakedTonemap;           ///< Tonemap values of the last bake.
+    decltype(R3D_Environment::adjustements) mBakedAdjustments;  ///< Color adjustments of the last bake.
+    bool mBaked;                                                ///< Indicates if the LUT has been baked at least once.
+};
+
+/* Implementation */
+
+inline ColorGrading::ColorGrading()
+    : mLUT(GLTexture::gen3D(nullptr, LUT_SIZE, LUT_SIZE, LUT_SIZE, GL_RGBA16F, GL_RGBA, GL_FLOAT))
+    , mBakedTonemap()
+    , mBakedAdjustments()
+    , mBaked(false)
+{
+    mLUT.filter(GLTexture::Filter::BILINEAR);
+    mLUT.wrap(GLTexture::Wrap::CLAMP_EDGE);
+}
+
+inline void ColorGrading::update(const R3D_Environment& env)
+{
+    if (isBaked(env)) {
+        return;
+    }
+
+    GLShader& shader = getShaderBake(env);
+
+    glViewport(0, 0, LUT_SIZE, LUT_SIZE);
+
+    shader.begin();
+    {
+        if (env.tonemap.mode != R3D_TONEMAP_LINEAR) {
+            shader.setValue("uWhite", env.tonemap.white);
+        }
+
+        if (hasColorAdjustments(env)) {
+            shader.setValue("uBrightness", env.adjustements.brightness);
+            shader.setValue("uContrast", env.adjustements.contrast);
+            shader.setValue("uSaturation", env.adjustements.saturation);
+        }
+
+        if (env.adjustements.lut.id != 0) {
+            shader.bindTexture("uTexUserLUT", GL_TEXTURE_2D, env.adjustements.lut.id);
+        }
+
+        for (int layer = 0; layer < LUT_SIZE; layer++) {
+            mFramebuffer.attachTextureLayer(GLAttachement::COLOR_0, mLUT, layer);
+            mFramebuffer.bind();
+            shader.setValue("uLayer", static_cast<float>(layer) / (LUT_SIZE - 1));
+            mQuad.draw();
+        }
+
+        GLFramebuffer::unbind();
+    }
+    shader.end();
+
+    mBakedTonemap = env.tonemap;
+    mBakedAdjustments = env.adjustements;
+    mBaked = true;
+}
+
+inline const GLTexture& ColorGrading::lut() const
+{
+    return mLUT;
+}
+
+/* Private implementation */
+
+inline bool ColorGrading::isBaked(const R3D_Environment& env) const
+{
+    return mBaked
+        && mBakedTonemap.mode == env.tonemap.mode
+        && mBakedTonemap.white == env.tonemap.white
+        && mBakedAdjustments.brightness == env.adjustements.brightness
+        && mBakedAdjustments.contrast == env.adjustements.contrast
+        && mBakedAdjustments.saturation == env.adjustements.saturation
+        && mBakedAdjustments.lut.id == env.adjustements.lut.id;
+}
+
+inline GLShader& ColorGrading::getShaderBake(const R3D_Environment& env)
+{
+    const bool adjustments = hasColorAdjustments(env);
+    const bool userLUT = (env.adjustements.lut.id != 0);
+
+    const uint32_t key = static_cast<uint32_t>(env.tonemap.mode)
+        | (static_cast<uint32_t>(adjustments) << 8)
+        | (static_cast<uint32_t>(userLUT) << 9);
+
+    auto it = mShaderBake.find(key);
+
+    if (it != mShaderBake.end()) {
+        return it->second;
+    }
+
+    std::string fsCode("#version 330 core\n");
+    {
+        fsCode += TextFormat("#define LUT_SIZE %i\n", LUT_SIZE);
+        fsCode += "#define LUT_BAKE\n";
+        fsCode += TextFormat("#define TONEMAP_MODE %i\n", env.tonemap.mode);
+        if (adjustments) {
+            fsCode += "#define COLOR_ADJUSTMENT\n";
+        }
+        if (userLUT) {
+            fsCode += "#define USER_LUT\n";
+        }
+        fsCode += FS_CODE_POSTFX;
+    }
+
+    return mShaderBake.try_emplace(key, VS_CODE_POSTFX, fsCode).first->second;
+}
+
+inline bool ColorGrading::hasColorAdjustments(const R3D_Environment& env)
+{
+    return env.adjustements.brightness != 1.0f
+        || env.adjustements.contrast != 1.0f
+        || env.adjustements.saturation != 1.0f;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_COLOR_GRADING_HPP
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_FRAME_CAPTURE_HPP
+#define R3D_DETAIL_FRAME_CAPTURE_HPP
+
+#include "r3d.h"
+
+#include <raylib.h>
+
+#include <type_traits>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace r3d {
+
+/**
+ * @brief Content of a capture file, see `R3D_BeginCapture`.
+ *
+ * The textures, meshes and models are stored once and referenced by their index in the frames,
+ * a texture index of -1 meaning no texture. Everything is stored as plain values, the enums as
+ * 32-bit integers, so the file does not depend on the layout of the public structures.
+ */
+struct CaptureData
+{
+    static constexpr uint32_t MAGIC = 0x43443352;   ///< "R3DC" in little endian.
+    static constexpr uint32_t VERSION = 2;          ///< Version of the file layout.
+
+    enum TextureKind : int32_t {
+        TEXTURE_PLACEHOLDER,    ///< Replaced by a generated texture of the same size and format.
+        TEXTURE_DEFAULT_WHITE,  ///< Default white texture of the renderer.
+        TEXTURE_DEFAULT_BLACK   ///< Default black texture of the renderer.
+    };
+
+    enum DrawType : int32_t {
+        DRAW_MODEL,
+        DRAW_SPRITE,
+        DRAW_PARTICLE_SYSTEM
+    };
+
+    struct Texture
+    {
+        int32_t kind;
+        int32_t width;
+        int32_t height;
+        int32_t mipmaps;
+        int32_t format;
+    };
+
+    struct Mesh
+    {
+        int32_t vertexCount;
+        int32_t triangleCount;
+        std::vector<float> vertices;            ///< Empty if the mesh had no CPU data.
+        std::vector<float> texcoords;
+        std::vector<float> texcoords2;
+        std::vector<float> normals;
+        std::vector<float> tangents;
+        std::vector<unsigned char> colors;
+        std::vector<unsigned short> indices;
+    };
+
+    struct Material
+    {
+        int32_t albedo;
+        Color albedoColor;
+        int32_t metalness;
+        float metalnessFactor;
+        int32_t roughness;
+        float roughnessFactor;
+        int32_t emission;
+        float emissionEnergy;
+        Color emissionColor;
+        int32_t normal;
+        int32_t ao;
+        float aoLightAffect;
+        Vector2 uvOffset;
+        Vector2 uvScale;
+        R3D_MaterialConfig config;
+    };
+
+    struct Surface
+    {
+        int32_t mesh;
+        Material material;
+    };
+
+    struct Model
+    {
+        std::vector<Surface> surfaces;
+    };
+
+    struct Particle
+    {
+        Vector3 position;
+        Vector3 rotation;
+        Vector3 scale;
+        Color color;
+    };
+
+    struct Draw
+    {
+        int32_t type;                   ///< See `DrawType`.
+        Matrix transform;               ///< Final transform, the translation of the particle systems.
+        BoundingBox aabb;               ///< Local bounding box of the models and particle systems.
+        int32_t shadow;
+        int32_t billboard;
+        int32_t layer;
+        int32_t index;                  ///< Model index, or mesh index of the particle systems.
+        float maxDrawDistance;          ///< Draw and shadow distances of the models.
+        float maxShadowDistance;
+        Material material;              ///< Material of the sprites and particle systems.
+        float currentFrame;             ///< Sprite animation.
+        Rectangle region;
+        Vector2 frameSize;
+        int32_t xFrameCount;
+        int32_t yFrameCount;
+        std::vector<Particle> particles;
+    };
+
+    struct Light
+    {
+        int32_t type;
+        Color color;
+        Vector3 position;
+        Vector3 direction;
+        float energy;
+        float maxDistance;
+        float attenuation;
+        float innerCutOff;              ///< Cosine of the angle, as stored by the renderer.
+        float outerCutOff;
+        float shadowBias;
+        int32_t shadowResolution;       ///< Zero if the light does not produce shadows.
+        int32_t layers;
+        int32_t enabled;
+    };
+
+    struct Environment
+    {
+        int32_t bloomMode;
+        float bloomIntensity;
+        float bloomHdrThreshold;
+        int32_t bloomIterations;
+        int32_t bloomFilter;
+        int32_t fogMode;
+        Color fogColor;
+        float fogStart;
+        float fogEnd;
+        float fogDensity;
+        int32_t tonemapMode;
+        float tonemapExposure;
+        float tonemapWhite;
+        float brightness;
+        float contrast;
+        float saturation;
+        int32_t lut;                    ///< Texture index of the color grading LUT.
+        int32_t skyboxSize;             ///< Size of a face of the skybox cubemap, zero without skybox.
+        Vector3 skyboxRotation;
+        Color background;
+        Color ambient;
+    };
+
+    struct Frame
+    {
+        Camera3D camera;
+        int32_t activeLayers;
+        float screenSizeCullThreshold;
+        float layerScreenSizeCullThresholds[10];
+        int32_t depthSortingOrder;
+        int32_t shadowsUpdated;         ///< Whether the shadow maps were updated by this frame.
+        Environment environment;
+        std::vector<Light> lights;
+        std::vector<Draw> draws;
+    };
+
+    int32_t internalWidth = 0;
+    int32_t internalHeight = 0;
+    int32_t flags = 0;
+
+    std::vector<Texture> textures;
+    std::vector<Mesh> meshes;
+    std::vector<Model> models;
+    std::vector<Frame> frames;
+
+    /**
+     * @brief Writes the capture to a file.
+     * @return True if the whole file has been written.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Reads a capture from a file.
+     * @return True if the file is a valid capture of the supported version.
+     */
+    bool load(const std::string& path);
+
+private:
+    template <typename Stream>
+    void transfer(Stream& stream);
+
+    /**
+     * @brief Checks the indices and the array sizes read from a file before they are used by the replay.
+     * @return True if every index refers to an existing element and every array matches its declared count.
+     */
+    bool validate() const;
+
+    bool validTexture(int32_t index) const;
+    bool validMaterial(const Material& material) const;
+    bool validMesh(const Mesh& mesh) const;
+    bool validDraw(const Draw& draw) const;
+};
+
+/* Serialization */
+
+namespace detail {
+
+class CaptureWriter
+{
+public:
+    explicit CaptureWriter(FILE* file) : mFile(file) { }
+
+    template <typename T>
+    void operator()(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        ok = ok && std::fwrite(&value, sizeof(T), 1, mFile) == 1;
+    }
+
+    template <typename T>
+    void operator()(std::vector<T>& values) {
+        uint32_t count = static_cast<uint32_t>(values.size());
+        (*this)(count);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            ok = ok && (count == 0 || std::fwrite(values.data(), sizeof(T), count, mFile) == count);
+        } else {
+            for (T& value : values) transferCapture(*this, value);
+        }
+    }
+
+    bool ok = true;
+
+private:
+    FILE* mFile;
+};
+
+class CaptureReader
+{
+public:
+    explicit CaptureReader(FILE* file) : mFile(file) { }
+
+    template <typename T>
+    void operator()(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        ok = ok && std::fread(&value, sizeof(T), 1, mFile) == 1;
+    }
+
+    template <typename T>
+    void operator()(std::vector<T>& values) {
+        uint32_t count = 0;
+        (*this)(count);
+        if (!ok || count > MAX_COUNT) {
+            ok = false;
+            return;
+        }
+        values.resize(count);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            ok = ok && (count == 0 || std::fread(values.data(), sizeof(T), count, mFile) == count);
+        } else {
+            for (T& value : values) transferCapture(*this, value);
+        }
+    }
+
+    bool ok = true;
+
+private:
+    static constexpr uint32_t MAX_COUNT = 1u << 28;     ///< Rejects the corrupted counts before allocating.
+
+    FILE* mFile;
+};
+
+} // namespace detail
+
+// NOTE: The nested structures with vectors are serialized by the 'transfer' functions below,
+//       the trivially copyable ones are written as is
+
+template <typename Stream>
+inline void transferCapture(Stream& stream, CaptureData::Mesh& mesh)
+{
+    stream(mesh.vertexCount);
+    stream(mesh.triangleCount);
+    stream(mesh.vertices);
+    stream(mesh.texcoords);
+    stream(mesh.texcoords2);
+    stream(mesh.normals);
+    stream(mesh.tangents);
+    stream(mesh.colors);
+    stream(mesh.indices);
+}
+
+template <typename Stream>
+inline void transferCapture(Stream& stream, CaptureData::Model& model)
+{
+    stream(model.surfaces);
+}
+
+template <typename Stream>
+inline void transferCapture(Stream& stream, CaptureData::Draw& draw)
+{
+    stream(draw.type);
+    stream(draw.transform);
+    stream(draw.aabb);
+    stream(draw.shadow);
+    stream(draw.billboard);
+    stream(draw.layer);
+    stream(draw.index);
+    stream(draw.maxDrawDistance);
+    stream(draw.maxShadowDistance);
+    stream(draw.material);
+    stream(draw.currentFrame);
+    stream(draw.region);
+    stream(draw.frameSize);
+    stream(draw.xFrameCount);
+    stream(draw.yFrameCount);
+    stream(draw.particles);
+}
+
+template <typename Stream>
+inline void transferCapture(Stream& stream, CaptureData::Frame& frame)
+{
+    stream(frame.camera);
+    stream(frame.activeLayers);
+    stream(frame.screenSizeCullThreshold);
+    stream(frame.layerScreenSizeCullThresholds);
+    stream(frame.depthSortingOrder);
+    stream(frame.shadowsUpdated);
+    stream(frame.environment);
+    stream(frame.lights);
+    stream(frame.draws);
+}
+
+template <typename Stream>
+inline void CaptureData::transfer(Stream& stream)
+{
+    stream(internalWidth);
+    stream(internalHeight);
+    stream(flags);
+    stream(textures);
+    stream(meshes);
+    stream(models);
+    stream(frames);
+}
+
+inline bool CaptureData::save(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    detail::CaptureWriter writer(file);
+
+    uint32_t magic = MAGIC, version = VERSION;
+    writer(magic);
+    writer(version);
+
+    // NOTE: The writer only reads the data, the same function is used to load it
+    const_cast<CaptureData*>(this)->transfer(writer);
+
+    bool ok = writer.ok;
+    ok = (std::fclose(file) == 0) && ok;
+
+    return ok;
+}
+
+inline bool CaptureData::load(const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    detail::CaptureReader reader(file);
+
+    uint32_t magic = 0, version = 0;
+    reader(magic);
+    reader(version);
+
+    if (reader.ok && magic == MAGIC && version == VERSION) {
+        transfer(reader);
+    } else {
+        reader.ok = false;
+    }
+
+    std::fclose(file);
+
+    return reader.ok && validate();
+}
+
+inline bool CaptureData::validTexture(int32_t index) const
+{
+    return index >= -1 && index < static_cast<int32_t>(textures.size());
+}
+
+inline bool CaptureData::validMaterial(const Material& material) const
+{
+    return validTexture(material.albedo) && validTexture(material.metalness)
+        && validTexture(material.roughness) && validTexture(material.emission)
+        && validTexture(material.normal) && validTexture(material.ao);
+}
+
+inline bool CaptureData::validMesh(const Mesh& mesh) const
+{
+    if (mesh.vertexCount < 0 || mesh.triangleCount < 0) {
+        return false;
+    }
+
+    // The attributes are either absent or complete
+
+    auto validArray = [](size_t size, int32_t count, size_t components) {
+        return size == 0 || size == components * static_cast<size_t>(count);
+    };
+
+    if (!validArray(mesh.vertices.size(), mesh.vertexCount, 3)
+     || !validArray(mesh.texcoords.size(), mesh.vertexCount, 2)
+     || !validArray(mesh.texcoords2.size(), mesh.vertexCount, 2)
+     || !validArray(mesh.normals.size(), mesh.vertexCount, 3)
+     || !validArray(mesh.tangents.size(), mesh.vertexCount, 4)
+     || !validArray(mesh.colors.size(), mesh.vertexCount, 4)
+     || !validArray(mesh.indices.size(), mesh.triangleCount, 3)) {
+        return false;
+    }
+
+    for (unsigned short index : mesh.indices) {
+        if (index >= mesh.vertexCount) return false;
+    }
+
+    return true;
+}
+
+inline bool CaptureData::validDraw(const Draw& draw) const
+{
+    switch (draw.type) {
+        case DRAW_MODEL:
+            return draw.index >= 0 && draw.index < static_cast<int32_t>(models.size());
+        case DRAW_SPRITE:
+            return validMaterial(draw.material) && draw.xFrameCount > 0 && draw.yFrameCount > 0;
+        case DRAW_PARTICLE_SYSTEM:
+            return validMaterial(draw.material) && draw.index >= 0 && draw.index < static_cast<int32_t>(meshes.size());
+        default:
+            return false;
+    }
+}
+
+inline bool CaptureData::validate() const
+{
+    if (internalWidth <= 0 || internalHeight <= 0) {
+        return false;
+    }
+
+    for (const Texture& texture : textures) {
+        if (texture.kind < TEXTURE_PLACEHOLDER || texture.kind > TEXTURE_DEFAULT_BLACK) return false;
+        if (texture.width < 0 || texture.height < 0 || texture.mipmaps < 0) return false;
+        if (texture.format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE || texture.format > PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA) return false;
+    }
+
+    for (const Mesh& mesh : meshes) {
+        if (!validMesh(mesh)) return false;
+    }
+
+    for (const Model& model : models) {
+        for (const Surface& surface : model.surfaces) {
+            if (surface.mesh < 0 || surface.mesh >= static_cast<int32_t>(meshes.size())) return false;
+            if (!validMaterial(surface.material)) return false;
+        }
+    }
+
+    for (const Frame& frame : frames) {
+        if (!validTexture(frame.environment.lut) || frame.environment.skyboxSize < 0) {
+            return false;
+        }
+        for (const Light& light : frame.lights) {
+            if (light.type < R3D_DIRLIGHT || light.type > R3D_OMNILIGHT || light.shadowResolution < 0) return false;
+        }
+        for (const Draw& draw : frame.draws) {
+            if (!validDraw(draw)) return false;
+        }
+    }
+
+    return true;
+}
+
+/* Recording hooks, implemented in 'src/core/capture.cpp' */
+
+/**
+ * @brief Indicates if a capture is being recorded, see `R3D_BeginCapture`.
+ */
+bool isCaptureRecording();
+
+/**
+ * @brief Begins recording a frame, called by `R3D_Begin`.
+ */
+void captureBeginFrame(const Camera3D& camera);
+
+/**
+ * @brief Records the lights, the environment and the shadow update of the frame, called by `R3D_End` before rendering.
+ */
+void captureEndFrame();
+
+/**
+ * @brief Records a model submitted with its final transform.
+ */
+void captureModel(const R3D_Model& model, const Matrix& transform);
+
+/**
+ * @brief Records a sprite submitted with its final transform, including its size.
+ */
+void captureSprite(const R3D_Sprite& sprite, const Matrix& transform);
+
+/**
+ * @brief Records a particle system submitted with its current particles.
+ */
+void captureParticleSystem(const R3D_ParticleSystemCPU& system);
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_FRAME_CAPTURE_HPP
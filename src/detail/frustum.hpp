@@ -20,6 +20,8 @@
 #ifndef R3D_DETAIL_FRUSTUM_HPP
 #define R3D_DETAIL_FRUSTUM_HPP
 
+#include "./simd.h"
+
 #include <raylib.h>
 #include <raymath.h>
 
@@ -198,7 +200,7 @@ inline Frustum::Frustum(const ::Matrix& viewProj)
 }
 
 inline Frustum::Frustum(const ::Matrix& view, const ::Matrix& proj)
-    : Frustum(MatrixMultiply(view, proj))
+    : Frustum(simdMatrixMultiply(view, proj))
 { }
 
 inline bool Frustum::pointIn(const ::Vector3& position) const
@@ -109,6 +109,15 @@ public:
      */
     void attachTexture(GLAttachement attach, const GLTexture& texture, int mipLevel = 0) const;
 
+    /**
+     * @brief Attaches a single layer of a 3D or array texture to the framebuffer.
+     * @param attach The attachment point.
+     * @param texture The texture to attach.
+     * @param layer The layer of the texture to attach.
+     * @param mipLevel The mipmap level to attach (default is 0).
+     */
+    void attachTextureLayer(GLAttachement attach, const GLTexture& texture, int layer, int mipLevel = 0) const;
+
     /**
      * @brief Attaches a renderbuffer to the framebuffer.
      * @param attach The attachment point.
@@ -220,6 +229,22 @@ inline void GLFramebuffer::attachTexture(GLAttachement attach, const GLTexture&
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+inline void GLFramebuffer::attachTextureLayer(GLAttachement attach, const GLTexture& texture, int layer, int mipLevel) const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, mID);
+
+        glFramebufferTextureLayer(
+            GL_FRAMEBUFFER, static_cast<GLenum>(attach),
+            texture.id(), mipLevel, layer
+        );
+
+        if constexpr (Build::DEBUG) {
+            glCheckError("GLFramebuffer::attachTextureLayer");
+        }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 inline void GLFramebuffer::attachRenderbuffer(GLAttachement attach, GLuint renderbufferID) const
 {
     glBindFramebuffer(GL_FRAMEBUFFER, mID);
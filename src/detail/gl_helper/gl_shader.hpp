@@ -20,6 +20,7 @@
 #ifndef R3D_DETAIL_GL_SHADER_HPP
 #define R3D_DETAIL_GL_SHADER_HPP
 
+#include "../program_cache.hpp"
 #include "../gl.hpp"
 
 #include "./gl_texture.hpp"
@@ -163,7 +164,7 @@ private:
 /* Public member functions */
 
 inline GLShader::GLShader(const std::string& vsCode, const std::string& fsCode)
-    : mID(rlLoadShaderCode(vsCode.c_str(), fsCode.c_str()))
+    : mID(ProgramCache::load(vsCode, fsCode))
 {
     assert(mID != 0);
 
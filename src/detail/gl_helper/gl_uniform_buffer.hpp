@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_GL_UNIFORM_BUFFER_HPP
+#define R3D_DETAIL_GL_UNIFORM_BUFFER_HPP
+
+#include "../build_info.hpp"
+#include "../gl.hpp"
+#include <utility>
+
+namespace r3d {
+
+/**
+ * @class GLUniformBuffer
+ * @brief Represents an OpenGL uniform buffer object, used to share a block of uniforms between several shader programs.
+ *
+ * The buffer is attached to a fixed binding point for its whole lifetime. Each program using the block
+ * must associate its uniform block index with the same binding point (see `glUniformBlockBinding`).
+ */
+class GLUniformBuffer
+{
+public:
+    /**
+     * @brief Constructor to create an OpenGL uniform buffer object.
+     * @param size The size of the buffer in bytes, it must match the std140 layout of the block.
+     * @param binding The binding point to which the buffer is attached.
+     */
+    GLUniformBuffer(GLsizeiptr size, GLuint binding);
+
+    /**
+     * @brief Destructor to delete the uniform buffer object.
+     */
+    ~GLUniformBuffer();
+
+    /**
+     * @brief Deleted copy constructor.
+     */
+    GLUniformBuffer(const GLUniformBuffer&) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator.
+     */
+    GLUniformBuffer& operator=(const GLUniformBuffer&) = delete;
+
+    /**
+     * @brief Move constructor.
+     * @param other The GLUniformBuffer instance to move.
+     */
+    GLUniformBuffer(GLUniformBuffer&& other) noexcept;
+
+    /**
+     * @brief Move assignment operator.
+     * @param other The GLUniformBuffer instance to move.
+     * @return A reference to the current instance.
+     */
+    GLUniformBuffer& operator=(GLUniformBuffer&& other) noexcept;
+
+    /**
+     * @brief Updates the content of the buffer.
+     * @param data Pointer to the data to upload.
+     * @param size The size of the data in bytes.
+     * @param offset The offset in bytes at which the data is written.
+     */
+    void update(const void* data, GLsizeiptr size, GLintptr offset = 0) const;
+
+    /**
+     * @brief Gets the OpenGL ID of the uniform buffer.
+     * @return The uniform buffer ID.
+     */
+    GLuint id() const { return mID; }
+
+    /**
+     * @brief Gets the binding point of the uniform buffer.
+     * @return The binding point.
+     */
+    GLuint binding() const { return mBinding; }
+
+private:
+    GLuint mID;             ///< OpenGL ID for the uniform buffer.
+    GLuint mBinding;        ///< Binding point to which the buffer is attached.
+};
+
+
+/* Public member functions */
+
+inline GLUniformBuffer::GLUniformBuffer(GLsizeiptr size, GLuint binding)
+    : mBinding(binding)
+{
+    glGenBuffers(1, &mID);
+    glBindBuffer(GL_UNIFORM_BUFFER, mID);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, mBinding, mID);
+
+    if constexpr (Build::DEBUG) {
+        glCheckError("GLUniformBuffer::GLUniformBuffer");
+    }
+}
+
+inline GLUniformBuffer::~GLUniformBuffer()
+{
+    if (mID > 0) {
+        glDeleteBuffers(1, &mID);
+    }
+}
+
+inline GLUniformBuffer::GLUniformBuffer(GLUniformBuffer&& other) noexcept
+    : mID(std::exchange(other.mID, 0))
+    , mBinding(other.mBinding)
+{ }
+
+inline GLUniformBuffer& GLUniformBuffer::operator=(GLUniformBuffer&& other) noexcept
+{
+    if (this != &other) {
+        if (mID > 0) {
+            glDeleteBuffers(1, &mID);
+        }
+        mID = std::exchange(other.mID, 0);
+        mBinding = other.mBinding;
+    }
+    return *this;
+}
+
+inline void GLUniformBuffer::update(const void* data, GLsizeiptr size, GLintptr offset) const
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, mID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_GL_UNIFORM_BUFFER_HPP
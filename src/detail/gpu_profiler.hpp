@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_GPU_PROFILER_HPP
+#define R3D_DETAIL_GPU_PROFILER_HPP
+
+#include "./gl.hpp"
+
+#include <raylib.h>
+
+#include <unordered_map>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+namespace r3d {
+
+/**
+ * @brief Measures the GPU time spent in nested zones of the frame with timestamp queries.
+ *
+ * Each zone issues a timestamp query when it begins and another one when it ends, which,
+ * unlike `GL_TIME_ELAPSED` queries, allows zones to be nested. The queries of a frame are
+ * only read once they are available, up to `FRAME_LATENCY` frames later, so the CPU never
+ * waits for the GPU. If the frame slot is reused before its results are available (the GPU
+ * being too far behind), the results of this frame are simply lost.
+ *
+ * Zones are identified by their path, the names of their parent zones below the frame followed by their
+ * own, separated by '/' (e.g. "Shadow pass/Light 2/Face 4"), which is used to keep a rolling average of
+ * their time. The same name can thus be used in different zones, such as the faces of each light.
+ */
+class GPUProfiler
+{
+public:
+    static constexpr int FRAME_LATENCY = 4;         ///< Number of frames recorded before the queries of a frame are reused.
+    static constexpr double AVERAGE_FACTOR = 0.1;   ///< Weight of a new sample in the rolling averages.
+
+    /**
+     * @brief Timing of a zone of the last resolved frame.
+     */
+    struct Zone
+    {
+        std::string name;   ///< Name of the zone.
+        std::string path;   ///< Path of the zone, see `GPUProfiler`.
+        int depth;          ///< Nesting depth of the zone, the frame itself being at depth 0.
+        double time;        ///< GPU time of the zone in milliseconds.
+        double average;     ///< Rolling average of the GPU time of the zone in milliseconds.
+    };
+
+    /**
+     * @brief Begins a zone on construction and ends it on destruction.
+     */
+    class Scope
+    {
+    public:
+        template <typename... Args>
+        Scope(GPUProfiler& profiler, const char* format, Args... args)
+            : mProfiler(profiler)
+        {
+            mProfiler.begin(format, args...);
+        }
+
+        ~Scope()
+        {
+            mProfiler.end();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GPUProfiler& mProfiler;
+    };
+
+public:
+    /**
+     * @brief Checks that timestamp queries are supported, the profiler does nothing otherwise.
+     */
+    GPUProfiler();
+
+    /**
+     * @brief Deletes the queries of all frames.
+     */
+    ~GPUProfiler();
+
+    GPUProfiler(const GPUProfiler&) = delete;
+    GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+    /**
+     * @brief Indicates if the implementation provides timestamp queries.
+     */
+    bool isSupported() const;
+
+    /**
+     * @brief Starts recording a new frame, and its root zone named "Frame".
+     * @param enabled If false, no zone is recorded until the next frame.
+     */
+    void beginFrame(bool enabled);
+
+    /**
+     * @brief Ends the recording of the frame, and reads the results of the previous frames that are available.
+     */
+    void endFrame();
+
+    /**
+     * @brief Begins a zone nested in the current one.
+     * @note The name is only formatted if the profiler is recording.
+     * @param format The name of the zone, formatted with `TextFormat`.
+     */
+    template <typename... Args>
+    void begin(const char* format, Args... args);
+
+    /**
+     * @brief Ends the current zone.
+     */
+    void end();
+
+    /**
+     * @brief Returns the zones of the last resolved frame, in the order they began.
+     */
+    const std::vector<Zone>& zones() const;
+
+    /**
+     * @brief Returns the rolling average of the GPU time of a zone in milliseconds, or 0 if it was never measured.
+     * @param path The path of the zone, e.g. "Post process/Bloom", or "Frame" for the whole frame.
+     */
+    double average(const std::string& path) const;
+
+private:
+    struct Query
+    {
+        std::string name;   ///< Name of the zone.
+        std::string path;   ///< Path of the zone, see `GPUProfiler`.
+        int depth;          ///< Nesting depth of the zone.
+        GLuint begin;       ///< Timestamp query issued when the zone begins.
+        GLuint end;         ///< Timestamp query issued when the zone ends.
+    };
+
+    struct Frame
+    {
+        std::vector<Query> queries; ///< Queries of the frame, kept to be reused, only the first 'count' are valid.
+        int count = 0;              ///< Number of zones recorded during the frame.
+        bool pending = false;       ///< Indicates if the results of the frame have not been read yet.
+    };
+
+    /**
+     * @brief Reads the results of the pending frames, from the oldest, until one is not available yet.
+     */
+    void resolve();
+
+private:
+    std::array<Frame, FRAME_LATENCY> mFrames;           ///< Ring buffer of the recorded frames.
+    std::vector<int> mStack;                            ///< Indices of the zones that have begun and not ended yet.
+    std::vector<Zone> mZones;                           ///< Zones of the last resolved frame.
+    std::unordered_map<std::string, double> mAverages;  ///< Rolling averages of the zones, by path.
+    int mCurrent;                                       ///< Index of the frame being recorded.
+    bool mSupported;                                    ///< Indicates if timestamp queries are supported.
+    bool mEnabled;                                      ///< Indicates if the current frame is being recorded.
+};
+
+/* Implementation */
+
+inline GPUProfiler::GPUProfiler()
+    : mCurrent(0)
+    , mSupported(false)
+    , mEnabled(false)
+{
+    // NOTE: Timer queries are core since OpenGL 3.3, but an implementation
+    //       may still report a counter of zero bits if it cannot measure time
+
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    mSupported = (bits > 0);
+
+    if (!mSupported) {
+        TraceLog(LOG_WARNING, "R3D: Timestamp queries are not supported, GPU profiling is disabled");
+    }
+}
+
+inline GPUProfiler::~GPUProfiler()
+{
+    for (const auto& frame : mFrames) {
+        for (const auto& query : frame.queries) {
+            glDeleteQueries(1, &query.begin);
+            glDeleteQueries(1, &query.end);
+        }
+    }
+}
+
+inline bool GPUProfiler::isSupported() const
+{
+    return mSupported;
+}
+
+inline void GPUProfiler::beginFrame(bool enabled)
+{
+    mEnabled = enabled && mSupported;
+    mStack.clear();
+
+    if (!mEnabled) {
+        return;
+    }
+
+    Frame& frame = mFrames[mCurrent];
+    frame.count = 0;
+    frame.pending = false;
+
+    begin("Frame");
+}
+
+inline void GPUProfiler::endFrame()
+{
+    if (!mEnabled) {
+        return;
+    }
+
+    while (!mStack.empty()) {
+        end();
+    }
+
+    mFrames[mCurrent].pending = true;
+    mCurrent = (mCurrent + 1) % FRAME_LATENCY;
+    mEnabled = false;
+
+    resolve();
+}
+
+template <typename... Args>
+inline void GPUProfiler::begin(const char* format, Args... args)
+{
+    if (!mEnabled) {
+        return;
+    }
+
+    Frame& frame = mFrames[mCurrent];
+
+    if (frame.count == static_cast<int>(frame.queries.size())) {
+        Query& query = frame.queries.emplace_back();
+        glGenQueries(1, &query.begin);
+        glGenQueries(1, &query.end);
+    }
+
+    Query& query = frame.queries[frame.count];
+
+    if constexpr (sizeof...(Args) > 0) {
+        query.name = TextFormat(format, args...);
+    } else {
+        query.name = format;
+    }
+
+    // The zones directly below the frame are named after themselves
+
+    if (mStack.size() > 1) {
+        query.path = frame.queries[mStack.back()].path + '/' + query.name;
+    } else {
+        query.path = query.name;
+    }
+
+    query.depth = static_cast<int>(mStack.size());
+    glQueryCounter(query.begin, GL_TIMESTAMP);
+
+    mStack.push_back(frame.count++);
+}
+
+inline void GPUProfiler::end()
+{
+    if (!mEnabled || mStack.empty()) {
+        return;
+    }
+
+    glQueryCounter(mFrames[mCurrent].queries[mStack.back()].end, GL_TIMESTAMP);
+    mStack.pop_back();
+}
+
+inline const std::vector<GPUProfiler::Zone>& GPUProfiler::zones() const
+{
+    return mZones;
+}
+
+inline double GPUProfiler::average(const std::string& path) const
+{
+    auto it = mAverages.find(path);
+    return (it != mAverages.end()) ? it->second : 0.0;
+}
+
+/* Private implementation */
+
+inline void GPUProfiler::resolve()
+{
+    // The oldest frame is the one that will be recorded next
+
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        Frame& frame = mFrames[(mCurrent + i) % FRAME_LATENCY];
+        if (!frame.pending) continue;
+
+        // The root zone ends last, once its result is available all the others are too
+
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[0].end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        mZones.resize(frame.count);
+
+        for (int j = 0; j < frame.count; j++) {
+            const Query& query = frame.queries[j];
+
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &t1);
+
+            double time = static_cast<double>(t1 - t0) * 1e-6;
+
+            auto [it, inserted] = mAverages.try_emplace(query.path, time);
+            if (!inserted) it->second += (time - it->second) * AVERAGE_FACTOR;
+
+            Zone& zone = mZones[j];
+            zone.name = query.name;
+            zone.path = query.path;
+            zone.depth = query.depth;
+            zone.time = time;
+            zone.average = it->second;
+        }
+
+        frame.pending = false;
+    }
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_GPU_PROFILER_HPP
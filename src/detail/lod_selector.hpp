@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_LOD_SELECTOR_HPP
+#define R3D_DETAIL_LOD_SELECTOR_HPP
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace r3d {
+
+/**
+ * @brief Selection of the level of detail of the objects of the scene, with hysteresis.
+ * 
+ * The level of an object is the coarsest one whose error, projected on the screen, stays below a threshold
+ * in pixels. To avoid popping when an object stays around a distance of transition, the level selected for
+ * each object instance is kept from one frame to the next: a coarser level is only selected once its error
+ * is clearly below the threshold, and a finer one once the error of the current level is clearly above it.
+ * 
+ * As for the occlusion queries, the instances are identified by the internal data of the object and the
+ * number of times it was already drawn in the frame.
+ */
+class LODSelector
+{
+public:
+    static constexpr float HYSTERESIS = 0.25f;          ///< Margin around the threshold before switching, relative to the threshold.
+    static constexpr uint32_t MAX_UNUSED_FRAMES = 60;   ///< Number of frames without draw after which the level of an object is forgotten.
+
+public:
+    /**
+     * @brief Starts a new frame, the instances of the objects being counted from zero.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Selects the level of detail of an object instance.
+     * 
+     * @param object The internal data identifying the object.
+     * @param errors The error of each level after the full detail one, in increasing order, in the units of the object.
+     * @param pixelsPerUnit The number of pixels covered by one unit of the object at its nearest point.
+     * @param threshold The largest projected error allowed, in pixels.
+     * @return The selected level, 0 being the full detail.
+     */
+    int select(const void* object, const std::vector<float>& errors, float pixelsPerUnit, float threshold);
+
+private:
+    struct Key
+    {
+        const void* object;
+        int instance;
+
+        bool operator==(const Key& other) const {
+            return object == other.object && instance == other.instance;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.object) ^ (static_cast<size_t>(key.instance) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Entry
+    {
+        int level = 0;              ///< Level selected during `lastFrame`.
+        uint32_t lastFrame = 0;     ///< Last frame during which the object was drawn.
+    };
+
+private:
+    std::unordered_map<Key, Entry, KeyHash> mEntries;       ///< Level of each object instance, by key.
+    std::unordered_map<const void*, int> mInstances;        ///< Number of draws of each object during the current frame.
+    uint32_t mFrame = 1;                                    ///< Index of the current frame.
+};
+
+
+/* Implementation */
+
+inline void LODSelector::beginFrame()
+{
+    mFrame++;
+    mInstances.clear();
+
+    // The levels of the objects that are no longer drawn are forgotten from time to time
+
+    if (mFrame % MAX_UNUSED_FRAMES != 0) {
+        return;
+    }
+
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (mFrame - it->second.lastFrame > MAX_UNUSED_FRAMES) {
+            it = mEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+inline int LODSelector::select(const void* object, const std::vector<float>& errors, float pixelsPerUnit, float threshold)
+{
+    int instance = mInstances[object]++;
+    Entry& entry = mEntries[Key { object, instance }];
+
+    // The coarsest level below the given limit, the errors being sorted
+
+    auto coarsestLevel = [&](float limit) {
+        int level = 0;
+        while (level < static_cast<int>(errors.size()) && errors[level] * pixelsPerUnit <= limit) {
+            level++;
+        }
+        return level;
+    };
+
+    int level = coarsestLevel(threshold);
+
+    // The previous level is only relevant if the object was drawn during the previous frame
+
+    if (entry.lastFrame + 1 == mFrame) {
+        int current = std::min(entry.level, static_cast<int>(errors.size()));
+        if (level > current) {
+            level = std::max(current, coarsestLevel(threshold * (1.0f - HYSTERESIS)));
+        } else if (level < current && errors[current - 1] * pixelsPerUnit <= threshold * (1.0f + HYSTERESIS)) {
+            level = current;
+        }
+    }
+
+    entry.level = level;
+    entry.lastFrame = mFrame;
+
+    return level;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_LOD_SELECTOR_HPP
@@ -22,6 +22,8 @@
 
 #include "r3d.h"
 
+#include "./simd.h"
+
 #include <raylib.h>
 #include <raymath.h>
 
@@ -83,76 +85,108 @@ inline Vector3 getMatrixScale(const Matrix& mat)
  * @brief Computes a billboard rotation matrix to align a 3D object with the camera.
  *
  * This function generates a rotation matrix that aligns a 3D object (the "billboard") 
- * towards the camera based on the specified billboard mode. Two modes are supported:
+ * with the view plane of the camera, based on the specified billboard mode. It matches
+ * the orientation computed by the billboard variants of the 'material' shader.
  * - `R3D_BILLBOARD_ENABLED`: The object fully faces the camera, rotating on all axes.
  * - `R3D_BILLBOARD_Y_AXIS`: The object is constrained to rotate only around the Y-axis, 
  *   which is commonly used for objects that should remain upright (e.g., characters or signs).
  *
  * @param mode The billboard mode to use (e.g., `R3D_BILLBOARD_ENABLED` or `R3D_BILLBOARD_Y_AXIS`).
- * @param modelPos The position of the 3D object (billboard) in the world.
- * @param viewPos The position of the camera in the world.
+ * @param matView The view matrix of the camera, from which its basis is extracted.
  * @return A rotation matrix that aligns the object to face the camera based on the specified mode.
  */
-inline Matrix getBillboardRotationMatrix(R3D_BillboardMode mode, const Vector3 modelPos, const Vector3& viewPos)
+inline Matrix getBillboardRotationMatrix(R3D_BillboardMode mode, const Matrix& matView)
 {
     Matrix billboardRotation = MatrixIdentity();
 
+    // The rows of the rotation part of the view matrix are the axes of the camera
+    Vector3 right = { matView.m0, matView.m4, matView.m8 };
+    Vector3 up = { matView.m1, matView.m5, matView.m9 };
+    Vector3 back = { matView.m2, matView.m6, matView.m10 };
+
     switch (mode) {
-        case R3D_BILLBOARD_ENABLED: {
-            // Full billboard: faces the camera on all axes
-
-            // Compute direction from the model to the camera
-            Vector3 toCamera = Vector3Subtract(viewPos, modelPos);
-            toCamera = Vector3Normalize(toCamera);
-
-            // Create a "look-at" alignment using the camera direction
-            Vector3 up = { 0.0f, 1.0f, 0.0f }; // Global up axis
-            Vector3 right = Vector3Normalize(Vector3CrossProduct(up, toCamera)); // X-axis of the billboard
-            up = Vector3CrossProduct(toCamera, right); // Recalculate the Y-axis
-
-            // Build the rotation matrix using the aligned axes
-            billboardRotation = {
-                right.x, up.x, toCamera.x, 0.0f,
-                right.y, up.y, toCamera.y, 0.0f,
-                right.z, up.z, toCamera.z, 0.0f,
-                0.0f,    0.0f,     0.0f,   1.0f
-            };
-        } break;
-
-        case R3D_BILLBOARD_Y_AXIS: {
-            // Y-axis constrained billboard: rotates only around the Y-axis
-
-            // Compute direction from the model to the camera, projected on the XZ plane
-            Vector3 toCamera = Vector3Subtract(viewPos, modelPos);
-            toCamera.y = 0.0f; // Ignore the Y component
-            toCamera = Vector3Normalize(toCamera);
-
-            // Compute the X-axis
-            Vector3 up = { 0.0f, 1.0f, 0.0f }; // Global up axis (Y-axis)
-            Vector3 right = Vector3CrossProduct(up, toCamera);
-
-            // Build the rotation matrix
-            billboardRotation = {
-                right.x, up.x, toCamera.x, 0.0f,
-                right.y, up.y, toCamera.y, 0.0f,
-                right.z, up.z, toCamera.z, 0.0f,
-                0.0f,    0.0f,     0.0f,   1.0f
-            };
-        } break;
+        case R3D_BILLBOARD_ENABLED:
+            break;
+
+        case R3D_BILLBOARD_Y_AXIS:
+            // The camera's right axis stays horizontal with a Y-up camera
+            right = Vector3Normalize({ right.x, 0.0f, right.z });
+            up = { 0.0f, 1.0f, 0.0f };
+            back = { -right.z, 0.0f, right.x };
+            break;
 
         default:
             // If no valid mode is provided, return the identity matrix
-            break;
+            return billboardRotation;
     }
 
+    billboardRotation = {
+        right.x, up.x, back.x, 0.0f,
+        right.y, up.y, back.y, 0.0f,
+        right.z, up.z, back.z, 0.0f,
+        0.0f,    0.0f, 0.0f,   1.0f
+    };
+
     return billboardRotation;
 }
 
+/**
+ * @brief Applies a billboard rotation to a transformation matrix, around its translation.
+ *
+ * The rotation/scale of the transformation is applied first, then the result is oriented
+ * towards the camera, while the position of the object remains unchanged.
+ *
+ * @param mode The billboard mode to use.
+ * @param transform The global transformation matrix of the object.
+ * @param matView The view matrix of the camera.
+ * @return The transformation matrix of the billboard.
+ */
+inline Matrix getBillboardTransformMatrix(R3D_BillboardMode mode, const Matrix& transform, const Matrix& matView)
+{
+    Matrix result = transform;
+    result.m12 = result.m13 = result.m14 = 0.0f;
+
+    result = simdMatrixMultiplyAffine(result, getBillboardRotationMatrix(mode, matView));
+
+    result.m12 = transform.m12;
+    result.m13 = transform.m13;
+    result.m14 = transform.m14;
+
+    return result;
+}
+
+/**
+ * @brief Computes a bounding box containing a billboard whatever its orientation.
+ *
+ * Since billboards are oriented on the GPU, their bounds must be valid for any rotation
+ * around their pivot. The returned box contains the sphere centered on the pivot and
+ * passing through the farthest corner of the given box.
+ *
+ * @param aabb The bounding box of the object, transformed without billboarding.
+ * @param pivot The position around which the object is oriented.
+ * @return A bounding box valid for any orientation of the object.
+ */
+inline BoundingBox getBillboardBoundingBox(const BoundingBox& aabb, const Vector3& pivot)
+{
+    Vector3 extent = {
+        fmaxf(fabsf(aabb.min.x - pivot.x), fabsf(aabb.max.x - pivot.x)),
+        fmaxf(fabsf(aabb.min.y - pivot.y), fabsf(aabb.max.y - pivot.y)),
+        fmaxf(fabsf(aabb.min.z - pivot.z), fabsf(aabb.max.z - pivot.z))
+    };
+
+    float radius = Vector3Length(extent);
+
+    return {
+        Vector3Subtract(pivot, { radius, radius, radius }),
+        Vector3Add(pivot, { radius, radius, radius })
+    };
+}
+
 inline BoundingBox transformBoundingBox(const BoundingBox& aabb, const Matrix& transform)
 {
     return {
-        Vector3Transform(aabb.min, transform),
-        Vector3Transform(aabb.max, transform)
+        simdVector3Transform(aabb.min, transform),
+        simdVector3Transform(aabb.max, transform)
     };
 }
 
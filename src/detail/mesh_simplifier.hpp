@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_MESH_SIMPLIFIER_HPP
+#define R3D_DETAIL_MESH_SIMPLIFIER_HPP
+
+#include <raylib.h>
+#include <raymath.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <queue>
+#include <cmath>
+
+namespace r3d {
+
+/**
+ * @class MeshSimplifier
+ * @brief Reduces the triangle count of a mesh by edge collapses ordered by a quadric error metric.
+ *
+ * The vertices sharing all their attributes are welded first, then the vertices sharing only their position
+ * are considered as the same point of the surface. Each point accumulates the quadric of the planes of its
+ * triangles, and the collapses of a point into one of its neighbors are applied from the cheapest one, the
+ * cost being the sum of the squared distances between the neighbor and the accumulated planes.
+ *
+ * The points are only moved onto existing vertices, so the simplified triangles index the vertices of the
+ * source mesh and keep their attributes. The points lying on a border, or on an attribute seam (e.g. UV or
+ * normal discontinuity), are never moved so that the silhouette and the texture mapping are preserved.
+ * A collapse is also rejected if it flips a triangle or makes the surface non-manifold.
+ *
+ * The simplification can be continued with smaller targets to produce a chain of levels of detail.
+ * No GL call is made, so several meshes can be simplified in parallel.
+ */
+class MeshSimplifier
+{
+public:
+    static constexpr float MIN_NORMAL_DOT = 0.2f;   ///< Minimum cosine between the normals of a triangle before and after a collapse.
+
+public:
+    /**
+     * @brief Prepares the simplification of a mesh.
+     *
+     * @param mesh The source mesh, with its vertices in CPU memory.
+     */
+    explicit MeshSimplifier(const ::Mesh& mesh);
+
+    /**
+     * @brief Collapses edges until the triangle count reaches the target or no more collapse is possible.
+     *
+     * @param targetTriangleCount The number of triangles to reach.
+     * @return The number of triangles remaining.
+     */
+    size_t simplify(size_t targetTriangleCount);
+
+    /**
+     * @brief Retrieves the current triangles, indexing the vertices of the source mesh.
+     */
+    std::vector<uint32_t> indices() const;
+
+    /**
+     * @brief Retrieves the current number of triangles.
+     */
+    size_t triangleCount() const;
+
+    /**
+     * @brief Retrieves the largest error of the collapses applied so far.
+     *
+     * This is the square root of the largest quadric cost, an estimate of the distance between
+     * the simplified surface and the source one, in the units of the mesh.
+     */
+    float error() const;
+
+    /**
+     * @brief Builds a new mesh from triangles indexing the vertices of a source mesh.
+     *
+     * Only the used vertices are copied, with all their attributes. The mesh is indexed unless it would
+     * exceed the 16-bit indices of raylib. It is not uploaded to the GPU.
+     *
+     * @param source The source mesh, with its attributes in CPU memory.
+     * @param indices The triangles, as returned by `indices`.
+     * @return The new mesh, to be uploaded with `UploadMesh`.
+     */
+    static ::Mesh buildMesh(const ::Mesh& source, const std::vector<uint32_t>& indices);
+
+private:
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+
+        void addPlane(double nx, double ny, double nz, double d);
+        Quadric& operator+=(const Quadric& other);
+        double evaluate(const Vector3& p) const;
+    };
+
+    struct Point
+    {
+        Vector3 position;
+        Quadric quadric;
+        std::vector<uint32_t> triangles;    ///< Triangles using the point, including the removed ones until cleaned.
+        uint32_t version = 0;               ///< Incremented each time the point changes, to invalidate the collapses in the queue.
+        bool locked = false;                ///< Border or seam point, it can be the target of a collapse but never moved.
+        bool removed = false;
+    };
+
+    struct Triangle
+    {
+        uint32_t vertices[3];               ///< Vertices of the source mesh.
+        uint32_t points[3];
+        bool removed = false;
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from, to;
+        uint32_t fromVersion, toVersion;
+
+        bool operator>(const Collapse& other) const {
+            return cost > other.cost;
+        }
+    };
+
+private:
+    std::vector<uint32_t> weld(const ::Mesh& mesh);
+    void pushCollapses(uint32_t point);
+    void pushCollapse(uint32_t from, uint32_t to);
+    bool apply(const Collapse& collapse);
+    void neighbors(uint32_t point, std::vector<uint32_t>* result) const;
+
+private:
+    std::vector<Point> mPoints;
+    std::vector<Triangle> mTriangles;
+    std::vector<uint32_t> mVertexPoint;         ///< Point of each vertex of the source mesh.
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mQueue;
+    std::vector<uint32_t> mNeighborsFrom;       ///< Scratch buffers of the collapse tests.
+    std::vector<uint32_t> mNeighborsTo;
+    size_t mTriangleCount = 0;
+    double mMaxCost = 0.0;
+};
+
+
+/* Implementation */
+
+inline void MeshSimplifier::Quadric::addPlane(double nx, double ny, double nz, double d)
+{
+    a00 += nx * nx; a01 += nx * ny; a02 += nx * nz;
+    a11 += ny * ny; a12 += ny * nz; a22 += nz * nz;
+    b0 += nx * d; b1 += ny * d; b2 += nz * d;
+    c += d * d;
+}
+
+inline MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other)
+{
+    a00 += other.a00; a01 += other.a01; a02 += other.a02;
+    a11 += other.a11; a12 += other.a12; a22 += other.a22;
+    b0 += other.b0; b1 += other.b1; b2 += other.b2;
+    c += other.c;
+    return *this;
+}
+
+inline double MeshSimplifier::Quadric::evaluate(const Vector3& p) const
+{
+    double x = p.x, y = p.y, z = p.z;
+
+    double cost = a00 * x * x + a11 * y * y + a22 * z * z
+        + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+        + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+
+    return std::max(cost, 0.0);
+}
+
+inline MeshSimplifier::MeshSimplifier(const ::Mesh& mesh)
+{
+    if (mesh.vertices == nullptr || mesh.vertexCount < 3) {
+        return;
+    }
+
+    std::vector<uint32_t> welded = weld(mesh);
+
+    // Gathers the triangles between distinct points, the others are already degenerate
+
+    size_t triangleCount = (mesh.indices != nullptr) ? mesh.triangleCount : mesh.vertexCount / 3;
+
+    mTriangles.reserve(triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        Triangle triangle;
+        for (int j = 0; j < 3; j++) {
+            uint32_t vertex = (mesh.indices != nullptr) ? mesh.indices[3 * i + j] : static_cast<uint32_t>(3 * i + j);
+            triangle.vertices[j] = welded[vertex];
+            triangle.points[j] = mVertexPoint[vertex];
+        }
+        if (triangle.points[0] == triangle.points[1] || triangle.points[1] == triangle.points[2] || triangle.points[2] == triangle.points[0]) {
+            continue;
+        }
+        uint32_t index = static_cast<uint32_t>(mTriangles.size());
+        for (uint32_t point : triangle.points) {
+            mPoints[point].triangles.push_back(index);
+        }
+        mTriangles.push_back(triangle);
+    }
+
+    mTriangleCount = mTriangles.size();
+
+    // Accumulates the plane of each triangle in the quadrics of its points,
+    // and counts the triangles of each edge to find the borders
+
+    std::unordered_map<uint64_t, int> edges;
+    edges.reserve(3 * mTriangles.size());
+
+    for (const Triangle& triangle : mTriangles) {
+        const Vector3& p0 = mPoints[triangle.points[0]].position;
+        const Vector3& p1 = mPoints[triangle.points[1]].position;
+        const Vector3& p2 = mPoints[triangle.points[2]].position;
+
+        Vector3 normal = Vector3CrossProduct(Vector3Subtract(p1, p0), Vector3Subtract(p2, p0));
+        float length = Vector3Length(normal);
+
+        if (length > 0.0f) {
+            normal = Vector3Scale(normal, 1.0f / length);
+            Quadric quadric;
+            quadric.addPlane(normal.x, normal.y, normal.z, -Vector3DotProduct(normal, p0));
+            for (uint32_t point : triangle.points) {
+                mPoints[point].quadric += quadric;
+            }
+        }
+
+        for (int j = 0; j < 3; j++) {
+            uint32_t a = triangle.points[j];
+            uint32_t b = triangle.points[(j + 1) % 3];
+            edges[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+        }
+    }
+
+    for (const auto& [edge, count] : edges) {
+        if (count != 2) {
+            mPoints[edge >> 32].locked = true;
+            mPoints[edge & 0xFFFFFFFF].locked = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < mPoints.size(); i++) {
+        pushCollapses(i);
+    }
+}
+
+inline size_t MeshSimplifier::simplify(size_t targetTriangleCount)
+{
+    while (mTriangleCount > targetTriangleCount && !mQueue.empty()) {
+        Collapse collapse = mQueue.top();
+        mQueue.pop();
+
+        const Point& from = mPoints[collapse.from];
+        const Point& to = mPoints[collapse.to];
+
+        if (from.removed || to.removed || from.version != collapse.fromVersion || to.version != collapse.toVersion) {
+            continue;
+        }
+
+        if (apply(collapse)) {
+            mMaxCost = std::max(mMaxCost, collapse.cost);
+        }
+    }
+
+    return mTriangleCount;
+}
+
+inline std::vector<uint32_t> MeshSimplifier::indices() const
+{
+    std::vector<uint32_t> result;
+    result.reserve(3 * mTriangleCount);
+
+    for (const Triangle& triangle : mTriangles) {
+        if (!triangle.removed) {
+            result.insert(result.end(), triangle.vertices, triangle.vertices + 3);
+        }
+    }
+
+    return result;
+}
+
+inline size_t MeshSimplifier::triangleCount() const
+{
+    return mTriangleCount;
+}
+
+inline float MeshSimplifier::error() const
+{
+    return static_cast<float>(std::sqrt(mMaxCost));
+}
+
+inline ::Mesh MeshSimplifier::buildMesh(const ::Mesh& source, const std::vector<uint32_t>& indices)
+{
+    ::Mesh mesh{};
+
+    // Assigns a new index to each used vertex, unless they are too many for 16-bit indices
+
+    std::vector<int> remap(source.vertexCount, -1);
+    std::vector<uint32_t> vertices;
+
+    for (uint32_t index : indices) {
+        if (remap[index] < 0) {
+            remap[index] = static_cast<int>(vertices.size());
+            vertices.push_back(index);
+        }
+    }
+
+    bool indexed = vertices.size() <= 0xFFFF;
+
+    if (!indexed) {
+        vertices = indices;
+    }
+
+    mesh.vertexCount = static_cast<int>(vertices.size());
+    mesh.triangleCount = static_cast<int>(indices.size() / 3);
+
+    auto copy = [&vertices]<typename T>(const T* src, int components) -> T* {
+        if (src == nullptr) return nullptr;
+        T* dst = static_cast<T*>(RL_MALLOC(vertices.size() * components * sizeof(T)));
+        for (size_t i = 0; i < vertices.size(); i++) {
+            std::memcpy(dst + i * components, src + vertices[i] * components, components * sizeof(T));
+        }
+        return dst;
+    };
+
+    mesh.vertices = copy(source.vertices, 3);
+    mesh.texcoords = copy(source.texcoords, 2);
+    mesh.texcoords2 = copy(source.texcoords2, 2);
+    mesh.normals = copy(source.normals, 3);
+    mesh.tangents = copy(source.tangents, 4);
+    mesh.colors = copy(source.colors, 4);
+
+    if (indexed) {
+        mesh.indices = static_cast<unsigned short*>(RL_MALLOC(indices.size() * sizeof(unsigned short)));
+        for (size_t i = 0; i < indices.size(); i++) {
+            mesh.indices[i] = static_cast<unsigned short>(remap[indices[i]]);
+        }
+    }
+
+    return mesh;
+}
+
+inline std::vector<uint32_t> MeshSimplifier::weld(const ::Mesh& mesh)
+{
+    // Sorts the vertices by position then by attributes, so that the identical
+    // vertices are adjacent, and the vertices of a same position too
+
+    auto comparePosition = [&mesh](uint32_t a, uint32_t b) -> int {
+        for (int i = 0; i < 3; i++) {
+            float va = mesh.vertices[3 * a + i], vb = mesh.vertices[3 * b + i];
+            if (va != vb) return va < vb ? -1 : 1;
+        }
+        return 0;
+    };
+
+    auto compareAttributes = [&mesh](uint32_t a, uint32_t b) -> int {
+        auto compare = [a, b](const void* data, size_t size) -> int {
+            if (data == nullptr) return 0;
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            return std::memcmp(bytes + a * size, bytes + b * size, size);
+        };
+        int result = 0;
+        if (result == 0) result = compare(mesh.texcoords, 2 * sizeof(float));
+        if (result == 0) result = compare(mesh.texcoords2, 2 * sizeof(float));
+        if (result == 0) result = compare(mesh.normals, 3 * sizeof(float));
+        if (result == 0) result = compare(mesh.tangents, 4 * sizeof(float));
+        if (result == 0) result = compare(mesh.colors, 4 * sizeof(unsigned char));
+        return result;
+    };
+
+    std::vector<uint32_t> order(mesh.vertexCount);
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        int result = comparePosition(a, b);
+        return (result != 0) ? result < 0 : compareAttributes(a, b) < 0;
+    });
+
+    // Each vertex is replaced in the triangles by the first of the identical vertices,
+    // and a point is created for each distinct position
+
+    std::vector<uint32_t> weldedVertex(mesh.vertexCount);
+    mVertexPoint.resize(mesh.vertexCount);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        uint32_t vertex = order[i];
+        uint32_t previous = (i > 0) ? order[i - 1] : vertex;
+        bool samePosition = (i > 0) && comparePosition(vertex, previous) == 0;
+
+        if (!samePosition) {
+            Point point;
+            point.position = { mesh.vertices[3 * vertex], mesh.vertices[3 * vertex + 1], mesh.vertices[3 * vertex + 2] };
+            mPoints.push_back(std::move(point));
+            weldedVertex[vertex] = vertex;
+        } else if (compareAttributes(vertex, previous) == 0) {
+            weldedVertex[vertex] = weldedVertex[previous];
+        } else {
+            weldedVertex[vertex] = vertex;
+            mPoints.back().locked = true;   //< Several distinct vertices at this position, this is a seam
+        }
+
+        mVertexPoint[vertex] = static_cast<uint32_t>(mPoints.size() - 1);
+    }
+
+    return weldedVertex;
+}
+
+inline void MeshSimplifier::pushCollapses(uint32_t point)
+{
+    if (mPoints[point].removed) {
+        return;
+    }
+
+    neighbors(point, &mNeighborsFrom);
+
+    for (uint32_t neighbor : mNeighborsFrom) {
+        pushCollapse(point, neighbor);
+        pushCollapse(neighbor, point);
+    }
+}
+
+inline void MeshSimplifier::pushCollapse(uint32_t from, uint32_t to)
+{
+    const Point& pointFrom = mPoints[from];
+    const Point& pointTo = mPoints[to];
+
+    if (pointFrom.locked) {
+        return;
+    }
+
+    Quadric quadric = pointFrom.quadric;
+    quadric += pointTo.quadric;
+
+    mQueue.push(Collapse {
+        .cost = quadric.evaluate(pointTo.position),
+        .from = from, .to = to,
+        .fromVersion = pointFrom.version,
+        .toVersion = pointTo.version
+    });
+}
+
+inline bool MeshSimplifier::apply(const Collapse& collapse)
+{
+    Point& from = mPoints[collapse.from];
+    Point& to = mPoints[collapse.to];
+
+    // Link condition: the only neighbors shared by the two points must be the opposite
+    // corners of the triangles of the edge, otherwise the collapse would pinch the surface
+
+    neighbors(collapse.from, &mNeighborsFrom);
+    neighbors(collapse.to, &mNeighborsTo);
+
+    int sharedNeighbors = 0;
+    for (uint32_t neighbor : mNeighborsFrom) {
+        if (std::find(mNeighborsTo.begin(), mNeighborsTo.end(), neighbor) != mNeighborsTo.end()) {
+            sharedNeighbors++;
+        }
+    }
+
+    // Finds the vertex replacing the moved one, and checks that no remaining triangle flips
+
+    int sharedTriangles = 0;
+    uint32_t vertexTo = UINT32_MAX;
+
+    for (uint32_t index : from.triangles) {
+        const Triangle& triangle = mTriangles[index];
+        if (triangle.removed) continue;
+
+        int corner = 0;
+        bool hasTo = false;
+
+        for (int j = 0; j < 3; j++) {
+            if (triangle.points[j] == collapse.from) corner = j;
+            if (triangle.points[j] == collapse.to) {
+                hasTo = true;
+                if (vertexTo == UINT32_MAX) vertexTo = triangle.vertices[j];
+            }
+        }
+
+        if (hasTo) {
+            sharedTriangles++;
+            continue;
+        }
+
+        const Vector3& p1 = mPoints[triangle.points[(corner + 1) % 3]].position;
+        const Vector3& p2 = mPoints[triangle.points[(corner + 2) % 3]].position;
+
+        Vector3 normalBefore = Vector3CrossProduct(Vector3Subtract(p1, from.position), Vector3Subtract(p2, from.position));
+        Vector3 normalAfter = Vector3CrossProduct(Vector3Subtract(p1, to.position), Vector3Subtract(p2, to.position));
+
+        float lengthBefore = Vector3Length(normalBefore);
+        float lengthAfter = Vector3Length(normalAfter);
+
+        if (lengthAfter <= 0.0f || Vector3DotProduct(normalBefore, normalAfter) < MIN_NORMAL_DOT * lengthBefore * lengthAfter) {
+            return false;
+        }
+    }
+
+    if (vertexTo == UINT32_MAX || sharedNeighbors > sharedTriangles) {
+        return false;
+    }
+
+    // Moves the point: the triangles of the edge disappear, the others are given to the target
+
+    for (uint32_t index : from.triangles) {
+        Triangle& triangle = mTriangles[index];
+        if (triangle.removed) continue;
+
+        if (std::find(triangle.points, triangle.points + 3, collapse.to) != triangle.points + 3) {
+            triangle.removed = true;
+            mTriangleCount--;
+            continue;
+        }
+
+        for (int j = 0; j < 3; j++) {
+            if (triangle.points[j] == collapse.from) {
+                triangle.points[j] = collapse.to;
+                triangle.vertices[j] = vertexTo;
+            }
+        }
+
+        to.triangles.push_back(index);
+    }
+
+    to.quadric += from.quadric;
+    to.version++;
+
+    from.removed = true;
+    from.triangles.clear();
+    from.triangles.shrink_to_fit();
+
+    std::erase_if(to.triangles, [this](uint32_t index) {
+        return mTriangles[index].removed;
+    });
+
+    // The collapses involving the target are outdated, they are queued again with its new quadric
+
+    pushCollapses(collapse.to);
+
+    return true;
+}
+
+inline void MeshSimplifier::neighbors(uint32_t point, std::vector<uint32_t>* result) const
+{
+    result->clear();
+
+    for (uint32_t index : mPoints[point].triangles) {
+        const Triangle& triangle = mTriangles[index];
+        if (triangle.removed) continue;
+        for (uint32_t other : triangle.points) {
+            if (other != point && std::find(result->begin(), result->end(), other) == result->end()) {
+                result->push_back(other);
+            }
+        }
+    }
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_MESH_SIMPLIFIER_HPP
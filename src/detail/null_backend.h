@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_NULL_BACKEND_H
+#define R3D_DETAIL_NULL_BACKEND_H
+
+/**
+ * Null backend, used when the library is initialized with `R3D_FLAG_NULL_BACKEND`.
+ *
+ * Instead of a real OpenGL context, rlgl and glad are loaded with stub functions that do
+ * nothing but record the binds, uniform uploads, draws and state changes into a compact
+ * command stream (see `R3D_GetRecordedCommands`). The queries answer as a complete and
+ * error-free OpenGL 3.3 implementation would, and the active uniforms of the programs are
+ * found by parsing the sources of their shaders, so the renderer runs unchanged.
+ *
+ * The stream of a frame begins with `R3D_Begin` and is kept from one `R3D_End` to the next.
+ */
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Loads the stub functions and initializes rlgl without any window or context.
+ * @param width Width of the default framebuffer.
+ * @param height Height of the default framebuffer.
+ */
+void r3d_nullBackendInit(int width, int height);
+
+/**
+ * @brief Closes rlgl and releases the recorded commands, if the null backend is active.
+ */
+void r3d_nullBackendClose(void);
+
+/**
+ * @brief Indicates if the null backend is active.
+ * @return True between `r3d_nullBackendInit` and `r3d_nullBackendClose`.
+ */
+bool r3d_nullBackendIsActive(void);
+
+/**
+ * @brief Discards the commands recorded since the end of the previous frame.
+ */
+void r3d_nullBackendBeginFrame(void);
+
+/**
+ * @brief Keeps the commands recorded since `r3d_nullBackendBeginFrame` as those of the last frame.
+ */
+void r3d_nullBackendEndFrame(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // R3D_DETAIL_NULL_BACKEND_H
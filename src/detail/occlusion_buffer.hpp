@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_OCCLUSION_BUFFER_HPP
+#define R3D_DETAIL_OCCLUSION_BUFFER_HPP
+
+#include "./simd.h"
+
+#include <raylib.h>
+#include <raymath.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <cmath>
+
+namespace r3d {
+
+/**
+ * @class OcclusionBuffer
+ * @brief Low resolution depth buffer rasterized on the CPU, used to cull the objects hidden behind occluders.
+ * 
+ * The occluder triangles are transformed, clipped against the near plane and binned into tiles as they are
+ * added. They are only rasterized when an object is tested, tile by tile, keeping the nearest depth of each
+ * pixel. A hierarchy of mips keeping the farthest depth of each 2x2 block is then built, so that an object
+ * is tested against at most 2x2 texels: it is hidden if its nearest point is behind all of them.
+ * 
+ * Occluders added after a test are rasterized into the same buffer before the next test, so the objects
+ * are only tested against the occluders added before them.
+ * 
+ * The depths are the normalized device coordinates remapped to [0, 1], which are linear in screen space
+ * for both perspective and orthographic projections. A pixel is considered covered by a triangle if its
+ * center is, so an object sticking out of an occluder by less than a pixel may be culled.
+ */
+class OcclusionBuffer
+{
+public:
+    static constexpr int TILE_SIZE = 32;        ///< Size of the tiles in which the triangles are binned, in pixels.
+    static constexpr float DEPTH_BIAS = 1e-6f;  ///< Tolerance of the depth test, so that an object can be its own occluder.
+
+public:
+    /**
+     * @brief Creates an occlusion buffer.
+     * 
+     * @param width Width of the buffer, rounded up to a multiple of 4.
+     * @param height Height of the buffer.
+     */
+    OcclusionBuffer(int width = 256, int height = 128);
+
+    /**
+     * @brief Clears the buffer and sets the camera of the new frame.
+     * 
+     * @param viewProj The view-projection matrix of the camera.
+     */
+    void begin(const Matrix& viewProj);
+
+    /**
+     * @brief Adds the triangles of a mesh as occluder.
+     * 
+     * @param mesh The mesh, whose vertices (and indices if any) must be available in CPU memory.
+     * @param transform The global transform of the mesh.
+     * @return The number of triangles binned, after the clipping and the rejection of the triangles out of the screen.
+     */
+    int addOccluder(const ::Mesh& mesh, const Matrix& transform);
+
+    /**
+     * @brief Checks if no occluder has been added since the last call to `begin`.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Checks if a bounding box is potentially visible behind the occluders.
+     * 
+     * @param aabb The bounding box, in world space.
+     * @return `false` if the bounding box is entirely hidden by the occluders, otherwise `true`.
+     */
+    bool aabbIn(const BoundingBox& aabb);
+
+    /**
+     * @brief Retrieves the depth buffer, rasterizing the pending occluders first.
+     * 
+     * @return The depth of each pixel, row by row from the bottom of the screen, 1.0 for the uncovered pixels.
+     */
+    const std::vector<float>& depth();
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+
+private:
+    /**
+     * @brief Triangle set up for the rasterization, in pixels.
+     * 
+     * The edge functions are positive inside the triangle, whatever its winding,
+     * and the depth is given by a plane equation.
+     */
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];     ///< Edge functions `A * x + B * y + C`.
+        float depthA, depthB, depthC;           ///< Depth plane `A * x + B * y + C`.
+        int minX, minY, maxX, maxY;             ///< Covered pixels, inclusive.
+    };
+
+    struct Level
+    {
+        int width;
+        int height;
+        std::vector<float> depth;
+    };
+
+private:
+    bool setupTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2);
+    void clipTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2);
+    void rasterizeTile(int tileX, int tileY);
+    void flush();
+
+    static Vector4 transformPoint(const Matrix& mat, float x, float y, float z);
+
+private:
+    Matrix mViewProj{};                         ///< View-projection matrix of the current frame.
+    int mWidth, mHeight;                        ///< Resolution of the buffer.
+    int mTilesX, mTilesY;                       ///< Number of tiles along each axis.
+    std::vector<Level> mLevels;                 ///< Depth buffer followed by its farthest-depth mips.
+    std::vector<Triangle> mTriangles;           ///< Triangles of the frame.
+    std::vector<std::vector<uint32_t>> mBins;   ///< Triangles pending rasterization in each tile.
+    std::vector<Vector4> mClipVertices;         ///< Vertices of the occluder being added, in clip space.
+    bool mEmpty = true;                         ///< Whether no triangle has been binned this frame.
+    bool mPending = false;                      ///< Whether triangles have been binned since the last rasterization.
+};
+
+
+/* Implementation */
+
+inline OcclusionBuffer::OcclusionBuffer(int width, int height)
+    : mWidth((std::max(width, 4) + 3) & ~3)
+    , mHeight(std::max(height, 1))
+    , mTilesX((mWidth + TILE_SIZE - 1) / TILE_SIZE)
+    , mTilesY((mHeight + TILE_SIZE - 1) / TILE_SIZE)
+    , mBins(mTilesX * mTilesY)
+{
+    int w = mWidth, h = mHeight;
+
+    while (true) {
+        mLevels.push_back({ w, h, std::vector<float>(w * h, 1.0f) });
+        if (w == 1 && h == 1) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+}
+
+inline void OcclusionBuffer::begin(const Matrix& viewProj)
+{
+    mViewProj = viewProj;
+
+    if (mEmpty) {
+        return;
+    }
+
+    for (Level& level : mLevels) {
+        std::fill(level.depth.begin(), level.depth.end(), 1.0f);
+    }
+
+    for (auto& bin : mBins) {
+        bin.clear();
+    }
+
+    mTriangles.clear();
+    mEmpty = true;
+    mPending = false;
+}
+
+inline int OcclusionBuffer::addOccluder(const ::Mesh& mesh, const Matrix& transform)
+{
+    if (mesh.vertices == nullptr || mesh.vertexCount < 3) {
+        return 0;
+    }
+
+    Matrix mvp = simdMatrixMultiply(transform, mViewProj);
+
+    mClipVertices.resize(mesh.vertexCount);
+    for (int i = 0; i < mesh.vertexCount; i++) {
+        const float* v = mesh.vertices + 3 * i;
+        mClipVertices[i] = transformPoint(mvp, v[0], v[1], v[2]);
+    }
+
+    size_t triangleCount = mTriangles.size();
+    int count = (mesh.indices != nullptr) ? 3 * mesh.triangleCount : mesh.vertexCount - mesh.vertexCount % 3;
+
+    for (int i = 0; i < count; i += 3) {
+        if (mesh.indices != nullptr) {
+            clipTriangle(
+                mClipVertices[mesh.indices[i]],
+                mClipVertices[mesh.indices[i + 1]],
+                mClipVertices[mesh.indices[i + 2]]
+            );
+        } else {
+            clipTriangle(mClipVertices[i], mClipVertices[i + 1], mClipVertices[i + 2]);
+        }
+    }
+
+    // Bins the new triangles in the tiles they overlap
+
+    for (size_t i = triangleCount; i < mTriangles.size(); i++) {
+        const Triangle& tri = mTriangles[i];
+        for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ty++) {
+            for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; tx++) {
+                mBins[ty * mTilesX + tx].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    int added = static_cast<int>(mTriangles.size() - triangleCount);
+
+    if (added > 0) {
+        mEmpty = false;
+        mPending = true;
+    }
+
+    return added;
+}
+
+inline bool OcclusionBuffer::empty() const
+{
+    return mEmpty;
+}
+
+inline bool OcclusionBuffer::aabbIn(const BoundingBox& aabb)
+{
+    if (mEmpty) {
+        return true;
+    }
+
+    // Screen rectangle and nearest depth of the box, which is considered
+    // visible as soon as one of its corners is behind the near plane
+
+    float minX = mWidth, minY = mHeight, minZ = 1.0f;
+    float maxX = 0.0f, maxY = 0.0f;
+
+    for (int i = 0; i < 8; i++) {
+        Vector4 p = transformPoint(mViewProj,
+            (i & 1) ? aabb.max.x : aabb.min.x,
+            (i & 2) ? aabb.max.y : aabb.min.y,
+            (i & 4) ? aabb.max.z : aabb.min.z
+        );
+        if (p.w <= 0.0f || p.z < -p.w) {
+            return true;
+        }
+        float invW = 1.0f / p.w;
+        float x = (p.x * invW * 0.5f + 0.5f) * mWidth;
+        float y = (p.y * invW * 0.5f + 0.5f) * mHeight;
+        minX = std::min(minX, x), maxX = std::max(maxX, x);
+        minY = std::min(minY, y), maxY = std::max(maxY, y);
+        minZ = std::min(minZ, p.z * invW * 0.5f + 0.5f);
+    }
+
+    int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+    int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+    int x1 = std::min(static_cast<int>(std::ceil(maxX)) - 1, mWidth - 1);
+    int y1 = std::min(static_cast<int>(std::ceil(maxY)) - 1, mHeight - 1);
+
+    // Out of the screen, left to the frustum culling
+    if (x0 > x1 || y0 > y1) {
+        return true;
+    }
+
+    if (mPending) {
+        flush();
+    }
+
+    // The mip is chosen so that the rectangle covers at most 2x2 texels
+
+    int lod = 0;
+    while (lod + 1 < static_cast<int>(mLevels.size()) && ((x1 >> lod) - (x0 >> lod) > 1 || (y1 >> lod) - (y0 >> lod) > 1)) {
+        lod++;
+    }
+
+    const Level& level = mLevels[lod];
+
+    for (int y = y0 >> lod; y <= (y1 >> lod); y++) {
+        for (int x = x0 >> lod; x <= (x1 >> lod); x++) {
+            if (minZ <= level.depth[y * level.width + x] + DEPTH_BIAS) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+inline const std::vector<float>& OcclusionBuffer::depth()
+{
+    if (mPending) {
+        flush();
+    }
+
+    return mLevels[0].depth;
+}
+
+inline bool OcclusionBuffer::setupTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+{
+    // Screen space positions and depths
+
+    const Vector4* v[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3];
+
+    for (int i = 0; i < 3; i++) {
+        float invW = 1.0f / v[i]->w;
+        x[i] = (v[i]->x * invW * 0.5f + 0.5f) * mWidth;
+        y[i] = (v[i]->y * invW * 0.5f + 0.5f) * mHeight;
+        z[i] = v[i]->z * invW * 0.5f + 0.5f;
+    }
+
+    // Covered pixels, whose centers are at half coordinates
+
+    Triangle tri;
+
+    tri.minX = std::max(static_cast<int>(std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f)), 0);
+    tri.minY = std::max(static_cast<int>(std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f)), 0);
+    tri.maxX = std::min(static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f)), mWidth - 1);
+    tri.maxY = std::min(static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f)), mHeight - 1);
+
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+        return false;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+    if (std::fabs(area) < 1e-6f) {
+        return false;
+    }
+
+    // The occluders are two-sided, the edges are oriented so that the inside is positive
+
+    if (area < 0.0f) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int j = (i + 1) % 3;
+        tri.edgeA[i] = y[i] - y[j];
+        tri.edgeB[i] = x[j] - x[i];
+        tri.edgeC[i] = -(tri.edgeA[i] * x[i] + tri.edgeB[i] * y[i]);
+    }
+
+    float invArea = 1.0f / area;
+
+    tri.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+    tri.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+    tri.depthC = z[0] - tri.depthA * x[0] - tri.depthB * y[0];
+
+    mTriangles.push_back(tri);
+
+    return true;
+}
+
+inline void OcclusionBuffer::clipTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+{
+    // Distances to the near plane (z = -w), positive on the visible side
+    const Vector4* in[3] = { &v0, &v1, &v2 };
+    float d[3] = { v0.z + v0.w, v1.z + v1.w, v2.z + v2.w };
+
+    if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f) {
+        setupTriangle(v0, v1, v2);
+        return;
+    }
+
+    // Clips the triangle into a polygon of up to four vertices
+
+    Vector4 poly[4];
+    int count = 0;
+
+    for (int i = 0; i < 3; i++) {
+        int j = (i + 1) % 3;
+        if (d[i] >= 0.0f) {
+            poly[count++] = *in[i];
+        }
+        if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+            float t = d[i] / (d[i] - d[j]);
+            poly[count++] = {
+                in[i]->x + t * (in[j]->x - in[i]->x),
+                in[i]->y + t * (in[j]->y - in[i]->y),
+                in[i]->z + t * (in[j]->z - in[i]->z),
+                in[i]->w + t * (in[j]->w - in[i]->w)
+            };
+        }
+    }
+
+    for (int i = 2; i < count; i++) {
+        setupTriangle(poly[0], poly[i - 1], poly[i]);
+    }
+}
+
+inline void OcclusionBuffer::rasterizeTile(int tileX, int tileY)
+{
+    auto& bin = mBins[tileY * mTilesX + tileX];
+
+    int tileMinX = tileX * TILE_SIZE;
+    int tileMinY = tileY * TILE_SIZE;
+    int tileMaxX = std::min(tileMinX + TILE_SIZE, mWidth) - 1;
+    int tileMaxY = std::min(tileMinY + TILE_SIZE, mHeight) - 1;
+
+    float* depth = mLevels[0].depth.data();
+
+    for (uint32_t index : bin)
+    {
+        const Triangle& tri = mTriangles[index];
+
+        // Pixels of the triangle in the tile, horizontally aligned on blocks of four
+        int minX = std::max(tri.minX, tileMinX) & ~3;
+        int minY = std::max(tri.minY, tileMinY);
+        int maxX = std::min(tri.maxX, tileMaxX);
+        int maxY = std::min(tri.maxY, tileMaxY);
+
+        // NOTE: Both paths evaluate the edge functions and the depth of the same pixels, up to the end of the
+        //       last block of four, with the same operations, so that their results are bit-identical
+
+#if !defined(R3D_SIMD_SCALAR)
+        // Pixel centers of the first block of the rows, stepped by four pixels
+        const float offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+        simd_f32x4 startX = simdAdd(simdSplat(static_cast<float>(minX)), simdLoad(offsets));
+        simd_f32x4 stepX = simdSplat(4.0f);
+        simd_f32x4 zero = simdSplat(0.0f);
+
+        simd_f32x4 a0 = simdSplat(tri.edgeA[0]);
+        simd_f32x4 a1 = simdSplat(tri.edgeA[1]);
+        simd_f32x4 a2 = simdSplat(tri.edgeA[2]);
+        simd_f32x4 aZ = simdSplat(tri.depthA);
+#endif
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            float py = y + 0.5f;
+            float* row = depth + y * mWidth;
+
+            // Values of the edge functions and of the depth at the start of the row
+            float e0 = tri.edgeB[0] * py + tri.edgeC[0];
+            float e1 = tri.edgeB[1] * py + tri.edgeC[1];
+            float e2 = tri.edgeB[2] * py + tri.edgeC[2];
+            float z = tri.depthB * py + tri.depthC;
+
+#if defined(R3D_SIMD_SCALAR)
+            for (int x = minX; x <= (maxX | 3); x++) {
+                float px = x + 0.5f;
+                if (tri.edgeA[0] * px + e0 >= 0.0f && tri.edgeA[1] * px + e1 >= 0.0f && tri.edgeA[2] * px + e2 >= 0.0f) {
+                    row[x] = std::min(row[x], tri.depthA * px + z);
+                }
+            }
+#else
+            simd_f32x4 c0 = simdSplat(e0);
+            simd_f32x4 c1 = simdSplat(e1);
+            simd_f32x4 c2 = simdSplat(e2);
+            simd_f32x4 cZ = simdSplat(z);
+            simd_f32x4 px = startX;
+
+            for (int x = minX; x <= maxX; x += 4)
+            {
+                simd_f32x4 edge0 = simdAdd(simdMul(a0, px), c0);
+                simd_f32x4 edge1 = simdAdd(simdMul(a1, px), c1);
+                simd_f32x4 edge2 = simdAdd(simdMul(a2, px), c2);
+                simd_f32x4 value = simdAdd(simdMul(aZ, px), cZ);
+
+                simd_mask32x4 mask = simdCmpGe(simdMin(simdMin(edge0, edge1), edge2), zero);
+
+                // Same operand order as 'std::min(current, value)'
+                simd_f32x4 current = simdLoad(row + x);
+                simdStore(row + x, simdSelect(mask, simdMin(value, current), current));
+
+                px = simdAdd(px, stepX);
+            }
+#endif
+        }
+    }
+
+    bin.clear();
+}
+
+inline void OcclusionBuffer::flush()
+{
+    // Rasterization of the pending triangles
+
+    for (int ty = 0; ty < mTilesY; ty++) {
+        for (int tx = 0; tx < mTilesX; tx++) {
+            if (!mBins[ty * mTilesX + tx].empty()) {
+                rasterizeTile(tx, ty);
+            }
+        }
+    }
+
+    // Farthest depth of each 2x2 block, the texels past the edges of odd sizes being clamped
+
+    for (size_t i = 1; i < mLevels.size(); i++)
+    {
+        const Level& src = mLevels[i - 1];
+        Level& dst = mLevels[i];
+
+        for (int y = 0; y < dst.height; y++) {
+            const float* row0 = src.depth.data() + (2 * y) * src.width;
+            const float* row1 = src.depth.data() + std::min(2 * y + 1, src.height - 1) * src.width;
+            for (int x = 0; x < dst.width; x++) {
+                int x0 = 2 * x, x1 = std::min(2 * x + 1, src.width - 1);
+                dst.depth[y * dst.width + x] = std::max(
+                    std::max(row0[x0], row0[x1]),
+                    std::max(row1[x0], row1[x1])
+                );
+            }
+        }
+    }
+
+    mPending = false;
+}
+
+inline Vector4 OcclusionBuffer::transformPoint(const Matrix& mat, float x, float y, float z)
+{
+    return {
+        mat.m0 * x + mat.m4 * y + mat.m8 * z + mat.m12,
+        mat.m1 * x + mat.m5 * y + mat.m9 * z + mat.m13,
+        mat.m2 * x + mat.m6 * y + mat.m10 * z + mat.m14,
+        mat.m3 * x + mat.m7 * y + mat.m11 * z + mat.m15
+    };
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_OCCLUSION_BUFFER_HPP
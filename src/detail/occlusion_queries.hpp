@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_OCCLUSION_QUERIES_HPP
+#define R3D_DETAIL_OCCLUSION_QUERIES_HPP
+
+#include "./drawable_cube.hpp"
+#include "./simd.h"
+#include "./gl.hpp"
+
+#include <raylib.h>
+#include <raymath.h>
+#include <rlgl.h>
+
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <vector>
+
+namespace r3d {
+
+/**
+ * @brief Temporally coherent hardware occlusion culling of the objects of the scene.
+ * 
+ * Each object drawn in a frame is identified by its internal data and the number of times it was already
+ * drawn in the frame, so that the same model drawn several times gets one query per instance as long as the
+ * draw order does not change. The draws are numbered before any culling, so that an instance culled on the
+ * CPU does not shift the numbers of the following ones. After the scene has been rendered, the bounding box of each object is drawn
+ * without writing anything, inside a `GL_ANY_SAMPLES_PASSED` query. During the next frame, the draws of the
+ * object are conditioned by this query with `glBeginConditionalRender`, and skipped by the GPU if none of the
+ * samples of its box passed the depth test. The CPU never waits for the results: the object is drawn if they
+ * are not available yet.
+ * 
+ * The objects that were not queried during the previous frame (e.g. because they just entered the frustum),
+ * and the objects whose box contains the camera, are drawn unconditionally. So are all the instances of an
+ * object drawn a different number of times than during the previous frame, whose numbers may designate other
+ * instances. An object hidden during a frame appears one frame late, once its box has been found visible.
+ */
+class OcclusionQueries
+{
+public:
+    static constexpr float BOX_MARGIN = 0.05f;      ///< Enlargement of the boxes, relative to their size, so that they are not coplanar with the objects.
+    static constexpr float BOX_MARGIN_DISTANCE = 0.01f; ///< Minimum enlargement of the boxes, relative to their distance to the camera, for the flat objects.
+    static constexpr uint32_t MAX_UNUSED_FRAMES = 60;   ///< Number of frames without draw after which the query of an object is deleted.
+
+public:
+    OcclusionQueries() = default;
+    ~OcclusionQueries();
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    /**
+     * @brief Starts a new frame, the instances of the objects being counted from zero.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Numbers a draw of an object.
+     * 
+     * Must be called for every draw of the object, before it is culled, so that each instance keeps its number.
+     * 
+     * @param object The internal data identifying the object.
+     * @return The number of the instance, to pass to `request` if the object is not culled.
+     */
+    int addInstance(const void* object);
+
+    /**
+     * @brief Registers the draw of an object, whose box will be queried at the end of the scene pass.
+     * 
+     * @param object The internal data identifying the object.
+     * @param instance The number of the instance returned by `addInstance`.
+     * @param aabb The bounding box of the object, in world space.
+     * @param viewPosition The position of the camera.
+     * @param nearPlane The distance of the near plane of the camera.
+     * @return The handle to pass to `getQuery` when drawing the object, or -1 if its draws must not be conditioned.
+     */
+    int request(const void* object, int instance, const BoundingBox& aabb, const Vector3& viewPosition, float nearPlane);
+
+    /**
+     * @brief Retrieves the query to condition the draws of an object with.
+     * 
+     * Must be called once all the objects of the frame have been numbered, since it depends on
+     * the number of instances of the object drawn during the frame.
+     * 
+     * @param handle The handle returned by `request`.
+     * @return The query of the previous frame, or 0 if the draws must not be conditioned.
+     */
+    GLuint getQuery(int handle) const;
+
+    /**
+     * @brief Draws the box of each object registered during the frame inside its query.
+     * 
+     * The depth buffer of the scene must be bound, along with a depth shader using `locMVP`.
+     * The color and depth writes and the face culling are disabled during the draws.
+     * 
+     * @param cube The unit cube drawn for each box.
+     * @param locMVP The location of the model-view-projection matrix in the bound shader.
+     * @param viewProj The view-projection matrix of the camera.
+     * @return The number of queries issued.
+     */
+    int issue(const Cube& cube, int locMVP, const Matrix& viewProj);
+
+private:
+    struct Key
+    {
+        const void* object;
+        int instance;
+
+        bool operator==(const Key& other) const {
+            return object == other.object && instance == other.instance;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.object) ^ (static_cast<size_t>(key.instance) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Request
+    {
+        const void* object;         ///< Object drawn.
+        GLuint query;               ///< Query issued during the previous frame for this instance, 0 if none.
+    };
+
+    struct Entry
+    {
+        GLuint query = 0;           ///< Query of the box of the object.
+        BoundingBox box{};          ///< Enlarged box of the object during the current frame.
+        uint32_t lastFrame = 0;     ///< Last frame during which the object was drawn.
+        bool issued = false;        ///< Indicates if the query was issued during `lastFrame`.
+    };
+
+private:
+    std::unordered_map<Key, Entry, KeyHash> mEntries;       ///< Query of each object instance, by key.
+    std::unordered_map<const void*, int> mInstances;        ///< Number of draws of each object during the current frame.
+    std::unordered_map<const void*, int> mPreviousInstances;    ///< Number of draws of each object during the previous frame.
+    std::vector<Request> mRequests;                         ///< Requests of the current frame, by handle.
+    std::vector<Entry*> mPending;                           ///< Entries to query at the end of the current frame.
+    uint32_t mFrame = 1;                                    ///< Index of the current frame.
+};
+
+
+/* Implementation */
+
+inline OcclusionQueries::~OcclusionQueries()
+{
+    for (const auto& [key, entry] : mEntries) {
+        glDeleteQueries(1, &entry.query);
+    }
+}
+
+inline void OcclusionQueries::beginFrame()
+{
+    mFrame++;
+    std::swap(mInstances, mPreviousInstances);
+    mInstances.clear();
+    mRequests.clear();
+    mPending.clear();
+
+    // The queries of the objects that are no longer drawn are deleted from time to time
+
+    if (mFrame % MAX_UNUSED_FRAMES != 0) {
+        return;
+    }
+
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (mFrame - it->second.lastFrame > MAX_UNUSED_FRAMES) {
+            glDeleteQueries(1, &it->second.query);
+            it = mEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+inline int OcclusionQueries::addInstance(const void* object)
+{
+    return mInstances[object]++;
+}
+
+inline int OcclusionQueries::request(const void* object, int instance, const BoundingBox& aabb, const Vector3& viewPosition, float nearPlane)
+{
+    Entry& entry = mEntries[Key { object, instance }];
+
+    if (entry.query == 0) {
+        glGenQueries(1, &entry.query);
+    }
+
+    // The result is only relevant if the object was queried during the previous frame
+    bool coherent = entry.issued && (entry.lastFrame + 1 == mFrame);
+
+    entry.lastFrame = mFrame;
+    entry.issued = false;
+
+    // The box is enlarged so that its faces are in front of those of the object, by at least a fraction
+    // of its distance so that the depth precision separates them even on the thin axis of a flat object.
+    // It must not contain the camera, whose near plane would clip its faces
+
+    Vector3 center = Vector3Scale(Vector3Add(aabb.min, aabb.max), 0.5f);
+    float minMargin = BOX_MARGIN_DISTANCE * Vector3Distance(center, viewPosition);
+
+    Vector3 margin = Vector3Max(Vector3Scale(Vector3Subtract(aabb.max, aabb.min), BOX_MARGIN), { minMargin, minMargin, minMargin });
+    Vector3 marginNear = Vector3Add(margin, { nearPlane, nearPlane, nearPlane });
+
+    if (viewPosition.x >= aabb.min.x - marginNear.x && viewPosition.x <= aabb.max.x + marginNear.x &&
+        viewPosition.y >= aabb.min.y - marginNear.y && viewPosition.y <= aabb.max.y + marginNear.y &&
+        viewPosition.z >= aabb.min.z - marginNear.z && viewPosition.z <= aabb.max.z + marginNear.z) {
+        return -1;
+    }
+
+    entry.box = { Vector3Subtract(aabb.min, margin), Vector3Add(aabb.max, margin) };
+    mPending.push_back(&entry);
+
+    mRequests.push_back(Request { object, coherent ? entry.query : 0 });
+
+    return static_cast<int>(mRequests.size()) - 1;
+}
+
+inline GLuint OcclusionQueries::getQuery(int handle) const
+{
+    if (handle < 0 || mRequests[handle].query == 0) {
+        return 0;
+    }
+
+    const Request& request = mRequests[handle];
+
+    // The instances are only matched to their queries if the object is drawn as many times as before
+
+    auto previous = mPreviousInstances.find(request.object);
+    auto current = mInstances.find(request.object);
+
+    if (previous == mPreviousInstances.end() || current == mInstances.end() || previous->second != current->second) {
+        return 0;
+    }
+
+    return request.query;
+}
+
+inline int OcclusionQueries::issue(const Cube& cube, int locMVP, const Matrix& viewProj)
+{
+    if (mPending.empty()) {
+        return 0;
+    }
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    rlDisableBackfaceCulling();
+
+    for (Entry* entry : mPending) {
+        const BoundingBox& box = entry->box;
+
+        // The cube spans [-1, 1] on each axis
+        Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+        Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+        Matrix matModel = MatrixScale(extent.x, extent.y, extent.z);
+        matModel.m12 = center.x, matModel.m13 = center.y, matModel.m14 = center.z;
+
+        rlSetUniformMatrix(locMVP, simdMatrixMultiply(matModel, viewProj));
+
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, entry->query);
+        cube.draw();
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+        entry->issued = true;
+    }
+
+    rlEnableBackfaceCulling();
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    int count = static_cast<int>(mPending.size());
+    mPending.clear();
+
+    return count;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_OCCLUSION_QUERIES_HPP
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_OFFSCREEN_RENDERER_HPP
+#define R3D_DETAIL_OFFSCREEN_RENDERER_HPP
+
+#include "r3d.h"
+
+#include "./gl_helper/gl_framebuffer.hpp"
+#include "./gl_helper/gl_shader.hpp"
+#include "./render_target.hpp"
+#include "./shader_code.hpp"
+#include "./drawable_quad.hpp"
+#include "./gl.hpp"
+
+#include <rlgl.h>
+#include <algorithm>
+#include <cassert>
+
+namespace r3d {
+
+/**
+ * @brief Class for rendering transparent surfaces at a reduced resolution.
+ *
+ * The surfaces are rendered in a render target whose dimensions are divided by the given scale factor.
+ * Before rendering, the depth of the scene is downsampled into this target so that the surfaces can be
+ * depth tested, then the result is composited over the scene with a depth-aware upsample.
+ *
+ * The color attachment stores the accumulated color in the RGB channels and the transmittance in the
+ * alpha channel, which is why the blend functions of the color and alpha channels are set separately.
+ */
+class OffscreenRenderer
+{
+public:
+    /**
+     * @brief Constructs an OffscreenRenderer with specified dimensions.
+     * @param rendererWidth The width of the renderer.
+     * @param rendererHeight The height of the renderer.
+     * @param scale The divisor applied to the dimensions of the renderer (e.g. 2 for half resolution).
+     */
+    OffscreenRenderer(int rendererWidth, int rendererHeight, int scale);
+
+    /**
+     * @brief Resizes the renderer.
+     * @param newWidth The new width for the renderer.
+     * @param newHeight The new height for the renderer.
+     */
+    void resize(int newWidth, int newHeight);
+
+    /**
+     * @brief Downsamples the scene depth into the offscreen target, clears its color and binds it.
+     * @param texSceneDepth The full resolution depth texture of the scene.
+     */
+    void begin(const GLTexture& texSceneDepth);
+
+    /**
+     * @brief Unbinds the offscreen target and restores the depth state.
+     */
+    void end();
+
+    /**
+     * @brief Composites the offscreen target over the currently bound framebuffer.
+     *
+     * The scene render target must be bound, the result is written to its color attachment.
+     *
+     * @param texSceneDepth The full resolution depth texture of the scene.
+     * @param orthographic Whether the scene was rendered with an orthographic projection,
+     *        its depth is then linear and must not be linearized as a perspective one.
+     */
+    void composite(const GLTexture& texSceneDepth, bool orthographic);
+
+    /**
+     * @brief Sets the blend functions for a surface rendered in the offscreen target.
+     * @param mode The blend mode of the surface, must be supported (see `isBlendModeSupported`).
+     */
+    static void setBlendMode(R3D_BlendMode mode);
+
+    /**
+     * @brief Checks whether the given blend mode can be rendered in an offscreen target.
+     * @param mode The blend mode to check.
+     * @return True if the blend mode can be expressed with a color and a transmittance.
+     */
+    static bool isBlendModeSupported(R3D_BlendMode mode);
+
+private:
+    RenderTarget mTarget;           /**< Reduced resolution render target. */
+    GLShader mShaderDownsample;     /**< Shader used to downsample the scene depth. */
+    GLShader mShaderComposite;      /**< Shader used to composite the result over the scene. */
+    Quad mQuad;                     /**< A quad used for rendering the texture. */
+    int mScale;                     /**< Divisor applied to the dimensions of the renderer. */
+};
+
+/* Implementation */
+
+inline OffscreenRenderer::OffscreenRenderer(int rendererWidth, int rendererHeight, int scale)
+    : mTarget(std::max(rendererWidth / scale, 1), std::max(rendererHeight / scale, 1))
+    , mShaderDownsample(VS_CODE_OFFSCREEN, FS_CODE_DEPTH_DOWNSAMPLE)
+    , mShaderComposite(VS_CODE_OFFSCREEN, FS_CODE_OFFSCREEN_COMPOSITE)
+    , mScale(scale)
+{
+    mTarget.createAttachment(GLAttachement::DEPTH, GL_TEXTURE_2D, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+
+    auto& texture = mTarget.createAttachment(
+        GLAttachement::COLOR_0, GL_TEXTURE_2D,
+        GL_RGBA16F, GL_RGBA, GL_FLOAT
+    );
+
+    texture.filter(GLTexture::Filter::BILINEAR);
+    texture.wrap(GLTexture::Wrap::CLAMP_EDGE);
+}
+
+inline void OffscreenRenderer::resize(int newWidth, int newHeight)
+{
+    mTarget.resize(
+        std::max(newWidth / mScale, 1),
+        std::max(newHeight / mScale, 1)
+    );
+}
+
+inline void OffscreenRenderer::begin(const GLTexture& texSceneDepth)
+{
+    mTarget.begin();
+
+    /* Downsample the scene depth and clear the color attachment */
+
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_TRUE);
+    glDisablei(GL_BLEND, 0);
+
+    mShaderDownsample.begin();
+    {
+        mShaderDownsample.setValue("uScale", mScale);
+        mShaderDownsample.bindTexture("uTexDepth", texSceneDepth);
+        mQuad.draw();
+    }
+    mShaderDownsample.end();
+
+    /* Setup the state for the transparent surfaces, the depth is only tested */
+
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_FALSE);
+    glEnablei(GL_BLEND, 0);
+}
+
+inline void OffscreenRenderer::end()
+{
+    glDepthMask(GL_TRUE);
+    mTarget.end();
+}
+
+inline void OffscreenRenderer::composite(const GLTexture& texSceneDepth, bool orthographic)
+{
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    glEnablei(GL_BLEND, 0);
+
+    rlSetBlendFactors(GL_ONE, GL_SRC_ALPHA, GL_FUNC_ADD);
+    rlSetBlendMode(RL_BLEND_CUSTOM);
+
+    mShaderComposite.begin();
+    {
+        mShaderComposite.bindTexture("uTexColor", mTarget.attachement(GLAttachement::COLOR_0));
+        mShaderComposite.bindTexture("uTexDepth", mTarget.attachement(GLAttachement::DEPTH));
+        mShaderComposite.bindTexture("uTexSceneDepth", texSceneDepth);
+        mShaderComposite.setValue("uNear", static_cast<float>(rlGetCullDistanceNear()));
+        mShaderComposite.setValue("uFar", static_cast<float>(rlGetCullDistanceFar()));
+        mShaderComposite.setValue("uOrthographic", orthographic);
+        mQuad.draw();
+    }
+    mShaderComposite.end();
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+inline void OffscreenRenderer::setBlendMode(R3D_BlendMode mode)
+{
+    // The RGB channels accumulate the color as usual, while the alpha
+    // channel accumulates the product of the transmittances (1 - alpha)
+    // NOTE: The factors are set through rlgl to keep its blend mode cache valid
+
+    switch (mode) {
+        case R3D_BLEND_ALPHA:
+            rlSetBlendFactorsSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA, GL_FUNC_ADD, GL_FUNC_ADD);
+            break;
+        case R3D_BLEND_ADDITIVE:
+            rlSetBlendFactorsSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE, GL_FUNC_ADD, GL_FUNC_ADD);
+            break;
+        case R3D_BLEND_ADD_COLORS:
+            rlSetBlendFactorsSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE, GL_FUNC_ADD, GL_FUNC_ADD);
+            break;
+        case R3D_BLEND_ALPHA_PREMULTIPLY:
+            rlSetBlendFactorsSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA, GL_FUNC_ADD, GL_FUNC_ADD);
+            break;
+        default:
+            assert(false && "Unsupported blend mode for offscreen rendering");
+            return;
+    }
+
+    rlSetBlendMode(RL_BLEND_CUSTOM_SEPARATE);
+}
+
+inline bool OffscreenRenderer::isBlendModeSupported(R3D_BlendMode mode)
+{
+    switch (mode) {
+        case R3D_BLEND_ALPHA:
+        case R3D_BLEND_ADDITIVE:
+        case R3D_BLEND_ADD_COLORS:
+        case R3D_BLEND_ALPHA_PREMULTIPLY:
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_OFFSCREEN_RENDERER_HPP
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_PROGRAM_CACHE_HPP
+#define R3D_DETAIL_PROGRAM_CACHE_HPP
+
+#include "./gl.hpp"
+#include "./trace.h"
+
+#include <raylib.h>
+#include <rlgl.h>
+
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#   define GL_COMPLETION_STATUS_KHR 0x91B1    //< Not exposed by the glad build, same value for the ARB extension
+#endif
+
+namespace r3d {
+
+/**
+ * @brief Disk cache of linked shader programs.
+ *
+ * When a cache directory is defined and the driver supports `ARB_get_program_binary` (core since OpenGL 4.1),
+ * the binaries of the linked programs are saved in this directory and reloaded on the next request of the same
+ * program, instead of compiling the sources again.
+ *
+ * A binary is identified by a hash of the complete sources, which already include the `#define` of the variant,
+ * and of the vendor, renderer and version strings of the driver. If a binary is rejected by the driver (e.g. after
+ * a driver update that kept the same version string), the program is compiled again and its binary replaced.
+ *
+ * Programs can also be compiled asynchronously with `loadAsync`. When the driver exposes `KHR_parallel_shader_compile`
+ * (or its ARB equivalent), the compilation and the link run on the driver's threads and `isComplete` can be polled
+ * without blocking. Otherwise `loadAsync` still returns immediately, but the first status query will block.
+ */
+class ProgramCache
+{
+public:
+    /**
+     * @brief Sets the directory in which the binaries are stored.
+     * @param directory Path of the directory, created if necessary. An empty path disables the cache.
+     */
+    static void setDirectory(const std::string& directory);
+
+    /**
+     * @brief Loads a program from the cache, or compiles it and stores its binary.
+     * @param vsCode Complete source code of the vertex shader.
+     * @param fsCode Complete source code of the fragment shader.
+     * @return The ID of the linked program, or 0 on failure.
+     */
+    static GLuint load(const std::string& vsCode, const std::string& fsCode);
+
+    /**
+     * @brief Program whose link was requested but whose status has not been queried yet.
+     */
+    struct Request {
+        GLuint program = 0;     ///< ID of the program, 0 if it could not be created.
+        std::string path{};     ///< Cache file to write once the program is linked, empty if nothing is to be saved.
+    };
+
+    /**
+     * @brief Loads a program from the cache, or starts its compilation without waiting for it.
+     * @param vsCode Complete source code of the vertex shader.
+     * @param fsCode Complete source code of the fragment shader.
+     * @return The request to pass to `isComplete` and `finish`.
+     */
+    static Request loadAsync(const std::string& vsCode, const std::string& fsCode);
+
+    /**
+     * @brief Checks, without blocking, if the compilation of a program has finished.
+     * @return Always true if parallel compilation is not supported by the driver.
+     */
+    static bool isComplete(const Request& request);
+
+    /**
+     * @brief Waits for the end of the compilation of a program, checks it and stores its binary.
+     * @return The ID of the linked program, or 0 on failure (the program is then deleted).
+     */
+    static GLuint finish(const Request& request);
+
+    /**
+     * @brief Indicates if the driver compiles the programs in parallel (`KHR_parallel_shader_compile`).
+     */
+    static bool isParallelSupported();
+
+private:
+    /**
+     * @brief Header written before the binary in the cache files.
+     */
+    struct Header {
+        char magic[4];          ///< Always "R3DP".
+        uint32_t version;       ///< Version of the file layout, see `VERSION`.
+        uint32_t format;        ///< Binary format returned by the driver.
+        uint32_t size;          ///< Size of the binary in bytes.
+    };
+
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    static bool isSupported();
+    static uint64_t hash(uint64_t seed, const char* data, size_t size);
+    static std::string getFilePath(const std::string& vsCode, const std::string& fsCode);
+    static GLuint loadBinary(const std::string& path);
+    static void saveBinary(const std::string& path, GLuint program);
+    static GLuint compile(const std::string& vsCode, const std::string& fsCode, bool retrievable);
+
+private:
+    static inline std::string sDirectory{};     ///< Directory of the binaries, empty if the cache is disabled.
+    static inline int sSupported = -1;          ///< Support of program binaries, -1 until queried.
+    static inline int sParallel = -1;           ///< Support of parallel compilation, -1 until queried.
+};
+
+/* Implementation */
+
+inline void ProgramCache::setDirectory(const std::string& directory)
+{
+    sDirectory = directory;
+
+    if (sDirectory.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(sDirectory, error);
+
+    if (error) {
+        TraceLog(LOG_WARNING, "R3D: Unable to create the shader cache directory '%s', the cache is disabled", sDirectory.c_str());
+        sDirectory.clear();
+    }
+}
+
+inline GLuint ProgramCache::load(const std::string& vsCode, const std::string& fsCode)
+{
+    return finish(loadAsync(vsCode, fsCode));
+}
+
+inline ProgramCache::Request ProgramCache::loadAsync(const std::string& vsCode, const std::string& fsCode)
+{
+    R3D_TRACE_ZONE("ProgramCache::loadAsync");
+
+    if (sDirectory.empty() || !isSupported()) {
+        return { compile(vsCode, fsCode, false) };
+    }
+
+    std::string path = getFilePath(vsCode, fsCode);
+
+    if (GLuint program = loadBinary(path)) {
+        return { program };
+    }
+
+    return { compile(vsCode, fsCode, true), std::move(path) };
+}
+
+inline bool ProgramCache::isComplete(const Request& request)
+{
+    if (request.program == 0 || !isParallelSupported()) {
+        return true;
+    }
+
+    GLint completed = GL_FALSE;
+    glGetProgramiv(request.program, GL_COMPLETION_STATUS_KHR, &completed);
+
+    return completed;
+}
+
+inline GLuint ProgramCache::finish(const Request& request)
+{
+    R3D_TRACE_ZONE("ProgramCache::finish");
+
+    if (request.program == 0) {
+        return 0;
+    }
+
+    GLint success = GL_FALSE;
+    glGetProgramiv(request.program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        // The program log also contains the errors of the shaders with most drivers
+        char log[1024]{};
+        glGetProgramInfoLog(request.program, sizeof(log), nullptr, log);
+        TraceLog(LOG_WARNING, "R3D: Failed to link shader program: %s", log);
+        glDeleteProgram(request.program);
+        return 0;
+    }
+
+    if (!request.path.empty()) {
+        saveBinary(request.path, request.program);
+    }
+
+    return request.program;
+}
+
+inline bool ProgramCache::isParallelSupported()
+{
+    if (sParallel < 0) {
+        sParallel = 0;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count && !sParallel; i++) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            sParallel = name != nullptr && (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0
+                || std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0);
+        }
+    }
+
+    return sParallel;
+}
+
+inline bool ProgramCache::isSupported()
+{
+    if (sSupported < 0) {
+    #if defined(__APPLE__)
+        bool available = true;  //< macOS core profiles are 4.1
+    #else
+        bool available = GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary;
+    #endif
+        GLint formatCount = 0;
+        if (available) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        }
+        sSupported = (formatCount > 0);
+    }
+
+    return sSupported;
+}
+
+inline uint64_t ProgramCache::hash(uint64_t seed, const char* data, size_t size)
+{
+    // FNV-1a, the seed allows chaining several strings
+
+    for (size_t i = 0; i < size; i++) {
+        seed ^= static_cast<uint8_t>(data[i]);
+        seed *= 0x100000001b3ULL;
+    }
+
+    return seed;
+}
+
+inline std::string ProgramCache::getFilePath(const std::string& vsCode, const std::string& fsCode)
+{
+    uint64_t key = 0xcbf29ce484222325ULL;
+
+    key = hash(key, vsCode.data(), vsCode.size() + 1);
+    key = hash(key, fsCode.data(), fsCode.size() + 1);
+
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str != nullptr) key = hash(key, str, std::strlen(str) + 1);
+    }
+
+    return (std::filesystem::path(sDirectory) / TextFormat("%016llx.bin", static_cast<unsigned long long>(key))).string();
+}
+
+inline GLuint ProgramCache::loadBinary(const std::string& path)
+{
+    if (!FileExists(path.c_str())) {
+        return 0;
+    }
+
+    int dataSize = 0;
+    unsigned char* data = LoadFileData(path.c_str(), &dataSize);
+
+    if (data == nullptr) {
+        return 0;
+    }
+
+    Header header{};
+    GLuint program = 0;
+
+    if (dataSize >= static_cast<int>(sizeof(Header))) {
+        std::memcpy(&header, data, sizeof(Header));
+    }
+
+    bool valid = std::memcmp(header.magic, "R3DP", 4) == 0
+        && header.version == VERSION
+        && header.size == dataSize - sizeof(Header);
+
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, data + sizeof(Header), header.size);
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+        if (!success) {
+            TraceLog(LOG_INFO, "R3D: Shader binary '%s' rejected by the driver, recompiling", path.c_str());
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    UnloadFileData(data);
+
+    return program;
+}
+
+inline void ProgramCache::saveBinary(const std::string& path, GLuint program)
+{
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+    if (size <= 0) {
+        return;
+    }
+
+    std::vector<unsigned char> data(sizeof(Header) + size);
+
+    GLenum format = 0;
+    glGetProgramBinary(program, size, nullptr, &format, data.data() + sizeof(Header));
+
+    Header header = { { 'R', '3', 'D', 'P' }, VERSION, format, static_cast<uint32_t>(size) };
+    std::memcpy(data.data(), &header, sizeof(Header));
+
+    SaveFileData(path.c_str(), data.data(), static_cast<int>(data.size()));
+}
+
+inline GLuint ProgramCache::compile(const std::string& vsCode, const std::string& fsCode, bool retrievable)
+{
+    // Same steps as 'rlLoadShaderCode', except that no status is queried here,
+    // so that the driver can compile and link the program in the background
+
+    GLuint vsID = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fsID = glCreateShader(GL_FRAGMENT_SHADER);
+
+    const char* vsSource = vsCode.c_str();
+    const char* fsSource = fsCode.c_str();
+
+    glShaderSource(vsID, 1, &vsSource, nullptr);
+    glShaderSource(fsID, 1, &fsSource, nullptr);
+
+    glCompileShader(vsID);
+    glCompileShader(fsID);
+
+    GLuint program = glCreateProgram();
+
+    glAttachShader(program, vsID);
+    glAttachShader(program, fsID);
+
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+    glBindAttribLocation(program, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+
+    if (retrievable) {
+        // The program must be flagged as retrievable before being linked
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    glLinkProgram(program);
+
+    // The shaders are only flagged for deletion, they are
+    // released with the program, once the link is complete
+
+    glDeleteShader(vsID);
+    glDeleteShader(fsID);
+
+    return program;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_PROGRAM_CACHE_HPP
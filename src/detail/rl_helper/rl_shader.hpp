@@ -20,6 +20,8 @@
 #ifndef R3D_DETAIL_RL_SHADER_HPP
 #define R3D_DETAIL_RL_SHADER_HPP
 
+#include "../program_cache.hpp"
+
 #include <raylib.h>
 #include <rlgl.h>
 
@@ -40,7 +42,7 @@ public:
     { }
 
     RLShader(const char* vsCode, const char* fsCode)
-        : ::Shader(LoadShaderFromMemory(vsCode, fsCode))
+        : ::Shader(load(vsCode, fsCode))
     { }
 
     ~RLShader() {
@@ -84,7 +86,52 @@ public:
     }
 
     bool valid() const {
-        return id > 0;
+        return id > 0 && id != rlGetShaderIdDefault();
+    }
+
+private:
+    /**
+     * @brief Equivalent of 'LoadShaderFromMemory' going through the program cache.
+     * 
+     * As with raylib, the default shader is returned if the program fails to compile or link,
+     * so that its locations can always be accessed; 'UnloadShader' does not unload it.
+     */
+    static ::Shader load(const char* vsCode, const char* fsCode) {
+        ::Shader shader{};
+
+        shader.id = ProgramCache::load(vsCode, fsCode);
+
+        if (shader.id == 0) {
+            TraceLog(LOG_WARNING, "R3D: Failed to load shader, the default shader will be used instead");
+            shader.id = rlGetShaderIdDefault();
+            shader.locs = rlGetShaderLocsDefault();
+            return shader;
+        }
+
+        shader.locs = static_cast<int*>(RL_MALLOC(RL_MAX_SHADER_LOCATIONS * sizeof(int)));
+        for (int i = 0; i < RL_MAX_SHADER_LOCATIONS; i++) shader.locs[i] = -1;
+
+        // Same default locations as those retrieved by raylib
+
+        shader.locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+        shader.locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+        shader.locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+        shader.locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+        shader.locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+        shader.locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(shader.id, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+
+        shader.locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_MVP);
+        shader.locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_VIEW);
+        shader.locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_PROJECTION);
+        shader.locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_MODEL);
+        shader.locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_NORMAL);
+        shader.locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_UNIFORM_NAME_COLOR);
+
+        shader.locs[SHADER_LOC_MAP_ALBEDO] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE0);
+        shader.locs[SHADER_LOC_MAP_METALNESS] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE1);
+        shader.locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(shader.id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE2);
+
+        return shader;
     }
 };
 
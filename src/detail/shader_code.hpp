@@ -14,6 +14,8 @@ extern const char FS_CODE_DEPTH_CUBE[];
 
 extern const char VS_CODE_BLUR[];
 extern const char FS_CODE_BLUR[];
+extern const char FS_CODE_BLOOM_DOWNSAMPLE[];
+extern const char FS_CODE_BLOOM_UPSAMPLE[];
 
 extern const char VS_CODE_POSTFX[];
 extern const char FS_CODE_POSTFX[];
@@ -33,6 +35,10 @@ extern const char VS_CODE_DEBUG_DEPTH[];
 extern const char FS_CODE_DEBUG_DEPTH_TEXTURE_2D[];
 extern const char FS_CODE_DEBUG_DEPTH_CUBEMAP[];
 
+extern const char VS_CODE_OFFSCREEN[];
+extern const char FS_CODE_DEPTH_DOWNSAMPLE[];
+extern const char FS_CODE_OFFSCREEN_COMPOSITE[];
+
 } // namespace r3d
 
 #endif // R3D_DETAIL_SHADER_CODES_HPP
@@ -24,6 +24,7 @@
 
 #include "./gl_helper/gl_framebuffer.hpp"
 #include "./gl_helper/gl_shader.hpp"
+#include "./program_cache.hpp"
 #include "./gl.hpp"
 
 #include "../objects/skybox.hpp"
@@ -32,8 +33,11 @@
 #include <raylib.h>
 #include <raymath.h>
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <cstdint>
+#include <string>
 #include <utility>
 #include <array>
 
@@ -41,7 +45,7 @@ namespace r3d {
 
 /**
  * @brief Maximum number of lights per surface, matching the value defined in the 'material' shader.
- * @note If you modify this value, ensure to update it in 'material.vs' and 'material.fs' shaders as well.
+ * @note If you modify this value, ensure to update the default of NUM_LIGHTS in the 'material.fs' shader as well.
  */
 static constexpr int SHADER_LIGHT_COUNT = 8;
 
@@ -50,6 +54,30 @@ static constexpr int SHADER_LIGHT_COUNT = 8;
  */
 using ShaderLightArray = std::array<const Light*, SHADER_LIGHT_COUNT>;
 
+/**
+ * @brief Light counts for which material shader variants are compiled, in ascending order.
+ * 
+ * A draw uses the smallest variant that can hold all of its lights, so that
+ * the shaders do not iterate over the unused entries of the light array.
+ */
+static constexpr std::array<int, 5> SHADER_LIGHT_BUCKETS = { 0, 1, 2, 4, SHADER_LIGHT_COUNT };
+
+/**
+ * @brief Binding point of the 'ViewBlock' uniform block declared in 'material.vs'.
+ */
+static constexpr GLuint SHADER_VIEW_BLOCK_BINDING = 0;
+
+/**
+ * @brief Content of the 'ViewBlock' uniform block (std140 layout), shared by all material shaders.
+ * 
+ * It contains the basis of the camera, used by the billboard variants to orient the surfaces.
+ */
+struct ShaderViewBlock {
+    Vector4 right;      /**< Right axis of the camera in world space (w unused). */
+    Vector4 up;         /**< Up axis of the camera in world space (w unused). */
+    Vector4 back;       /**< Backward axis of the camera in world space, pointing towards the viewer (w unused). */
+};
+
 /**
  * @class ShaderMaterial
  * @brief Class for managing the 'material.vs' / 'material.fs' shader.
@@ -62,8 +90,47 @@ public:
     /**
      * @brief Constructs a ShaderMaterial object with the specified material shader configuration.
      * @param config Configuration parameters for the material shader.
+     * @param lightCount Number of lights of the variant, one of `SHADER_LIGHT_BUCKETS`.
+     */
+    ShaderMaterial(R3D_MaterialShaderConfig config, int lightCount = SHADER_LIGHT_COUNT);
+
+    /**
+     * @brief Constructs a ShaderMaterial object from an already linked program.
+     * @param config Configuration parameters for the material shader.
+     * @param lightCount Number of lights of the variant, one of `SHADER_LIGHT_BUCKETS`.
+     * @param program ID of the program built from `getVertexCode` and `getFragmentCode`, owned by the object afterwards.
+     */
+    ShaderMaterial(R3D_MaterialShaderConfig config, int lightCount, GLuint program);
+
+    /**
+     * @brief Generates the vertex shader source code of a configuration.
+     * @note The vertex shader does not depend on the light count of the variant.
+     * @param config Configuration parameters for the material shader.
+     * @return The complete source code, including the defines of the variant.
+     */
+    static std::string getVertexCode(R3D_MaterialShaderConfig config);
+
+    /**
+     * @brief Generates the fragment shader source code of a configuration.
+     * @param config Configuration parameters for the material shader.
+     * @param lightCount Number of lights of the variant.
+     * @return The complete source code, including the defines of the variant.
+     */
+    static std::string getFragmentCode(R3D_MaterialShaderConfig config, int lightCount);
+
+    /**
+     * @brief Gets the smallest light count of `SHADER_LIGHT_BUCKETS` that can hold the given number of lights.
+     * @param lightCount Number of lights affecting a draw.
+     * @return The light count of the variant to use.
      */
-    ShaderMaterial(R3D_MaterialShaderConfig config);
+    static int getLightBucket(int lightCount);
+
+    /**
+     * @brief Counts the lights of an array, which are packed at its beginning.
+     * @param lights The lights affecting a draw.
+     * @return The number of lights before the first null pointer.
+     */
+    static int getLightCount(const ShaderLightArray& lights);
 
     // Destructor for ShaderMaterial
     ~ShaderMaterial();
@@ -88,10 +155,15 @@ public:
 
     /**
      * @brief Sets the environment parameters for the shader.
+     * 
+     * The uniforms are only uploaded by the first call of a frame, the sky textures
+     * are bound by every call since `end` unbinds them.
+     * 
      * @param env The environment settings to be applied.
      * @param viewPos The camera/viewer's position in the world space.
+     * @param frame The index of the current frame.
      */
-    void setEnvironment(const R3D_Environment& env, const Vector3& viewPos);
+    void setEnvironment(const R3D_Environment& env, const Vector3& viewPos, uint32_t frame);
 
     /**
      * @brief Sets the material properties for the shader.
@@ -117,6 +189,31 @@ public:
      */
     void setMatMVP(const Matrix& matMVP);
 
+    /**
+     * @brief Gets the configuration of the shader.
+     * @return The material shader configuration.
+     */
+    const R3D_MaterialShaderConfig& config() const;
+
+    /**
+     * @brief Gets the number of lights supported by this variant of the shader.
+     * @return The light count of the variant.
+     */
+    int lightCount() const;
+
+    /**
+     * @brief GL state changes issued by all the material shaders, gathered into the frame statistics.
+     * 
+     * The counters are only incremented, the renderer reads and resets them at the end of each frame.
+     */
+    struct Counters {
+        int shaderBinds;            /**< Number of programs bound by `begin`. */
+        int textureBinds;           /**< Number of textures bound to the sampler units. */
+        int uniformUploads;         /**< Number of uniforms uploaded, the unchanged values being skipped. */
+    };
+
+    static inline Counters sCounters{};
+
 private:
     /**
      * @brief Template class for managing shader uniform variables of type Type and GLType.
@@ -224,7 +321,9 @@ private:
 
 private:
     R3D_MaterialShaderConfig mConfig;                   /**< The material shader configuration. */
+    int mLightCount;                                    /**< The number of lights of the variant. */
     GLuint mShaderID;                                   /**< The shader program ID. */
+    uint32_t mEnvironmentFrame = 0;                     /**< The frame during which the environment uniforms were last uploaded. */
 
     std::array<Light, SHADER_LIGHT_COUNT> mLights;      /**< Array of light sources. */
 
@@ -235,7 +334,6 @@ private:
     Uniform<Vector2, GL_FLOAT_VEC2> mTexCoordOffset;    /**< Offsets texture coordinates for effects like scrolling or repositioning. */
     Uniform<Vector2, GL_FLOAT_VEC2> mTexCoordScale;     /**< Scales texture coordinates to adjust texture size or tiling. */
 
-    Uniform<float, GL_FLOAT> mBloomHdrThreshold;        /**< Threshold for HDR bloom effect. */
     Uniform<Color, GL_FLOAT_VEC3> mColAmbient;          /**< Ambient color of the scene. */
     Uniform<Vector3, GL_FLOAT_VEC3> mViewPos;           /**< Position of the viewer (camera). */
 
@@ -267,20 +365,29 @@ private:
 
 /* ShaderMaterial implementation */
 
-inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
-    : mConfig(config)
+inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config, int lightCount)
+    : ShaderMaterial(config, lightCount, ProgramCache::load(
+        getVertexCode(config), getFragmentCode(config, lightCount)
+    ))
+{ }
+
+inline std::string ShaderMaterial::getVertexCode(R3D_MaterialShaderConfig config)
 {
     std::string vsCode("#version 330 core\n");
     {
         if (config.flags & R3D_MATERIAL_FLAG_VERTEX_COLOR) {
             vsCode += "#define VERTEX_COLOR\n";
         }
+        if (config.billboard == R3D_BILLBOARD_ENABLED) {
+            vsCode += "#define BILLBOARD\n";
+        } else if (config.billboard == R3D_BILLBOARD_Y_AXIS) {
+            vsCode += "#define BILLBOARD\n";
+            vsCode += "#define BILLBOARD_Y_AXIS\n";
+        }
         if (config.diffuse == R3D_DIFFUSE_UNSHADED) {
             vsCode += "#define DIFFUSE_UNSHADED\n";
         } else {
-            if (config.flags & R3D_MATERIAL_FLAG_RECEIVE_SHADOW) {
-                vsCode += "#define RECEIVE_SHADOW\n";
-            }
+            // The light-space positions used by the shadows are computed in the fragment shader
             if (config.flags & R3D_MATERIAL_FLAG_MAP_NORMAL) {
                 vsCode += "#define MAP_NORMAL\n";
             }
@@ -289,8 +396,15 @@ inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
         vsCode += VS_CODE_MATERIAL;
     }
 
+    return vsCode;
+}
+
+inline std::string ShaderMaterial::getFragmentCode(R3D_MaterialShaderConfig config, int lightCount)
+{
     std::string fsCode("#version 330 core\n");
     {
+        fsCode += TextFormat("#define NUM_LIGHTS %i\n", lightCount);
+
         switch (config.diffuse) {
             case R3D_DIFFUSE_UNSHADED:
                 fsCode += "#define DIFFUSE_UNSHADED\n";
@@ -333,7 +447,7 @@ inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
                 default:
                     break;
             }
-            if (config.flags & R3D_MATERIAL_FLAG_RECEIVE_SHADOW) {
+            if ((config.flags & R3D_MATERIAL_FLAG_RECEIVE_SHADOW) && lightCount > 0) {
                 fsCode += "#define RECEIVE_SHADOW\n";
             }
             if (config.flags & R3D_MATERIAL_FLAG_MAP_EMISSION) {
@@ -353,8 +467,28 @@ inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
         fsCode += FS_CODE_MATERIAL;
     }
 
-    mShaderID = rlLoadShaderCode(vsCode.c_str(), fsCode.c_str());
+    return fsCode;
+}
+
+inline int ShaderMaterial::getLightBucket(int lightCount)
+{
+    for (int bucket : SHADER_LIGHT_BUCKETS) {
+        if (bucket >= lightCount) return bucket;
+    }
+
+    return SHADER_LIGHT_COUNT;
+}
 
+inline int ShaderMaterial::getLightCount(const ShaderLightArray& lights)
+{
+    return static_cast<int>(std::find(lights.begin(), lights.end(), nullptr) - lights.begin());
+}
+
+inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config, int lightCount, GLuint program)
+    : mConfig(config)
+    , mLightCount(lightCount)
+    , mShaderID(program)
+{
     /* Get uniforms and init samplers */
 
     GLint textureSlot = 0;
@@ -369,14 +503,20 @@ inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
     mTexAlbedo = Sampler<GL_TEXTURE_2D>(mShaderID, "uTexAlbedo", textureSlot++);
     mColAlbedo = Uniform<Color, GL_FLOAT_VEC4>(mShaderID, "uColAlbedo");
 
+    // The model matrix is also used by the unshaded billboard variants
+    mMatModel = Uniform<Matrix, GL_FLOAT_MAT4>(mShaderID, "uMatModel");
+
+    if (config.billboard != R3D_BILLBOARD_DISABLED) {
+        GLuint blockIndex = glGetUniformBlockIndex(mShaderID, "ViewBlock");
+        glUniformBlockBinding(mShaderID, blockIndex, SHADER_VIEW_BLOCK_BINDING);
+    }
+
     if (config.diffuse == R3D_DIFFUSE_UNSHADED) {
         return;
     }
 
     mMatNormal = Uniform<Matrix, GL_FLOAT_MAT4>(mShaderID, "uMatNormal");
-    mMatModel = Uniform<Matrix, GL_FLOAT_MAT4>(mShaderID, "uMatModel");
 
-    mBloomHdrThreshold = Uniform<float, GL_FLOAT>(mShaderID, "uBloomHdrThreshold");
     mColAmbient = Uniform<Color, GL_FLOAT_VEC3>(mShaderID, "uColAmbient");
     mViewPos = Uniform<Vector3, GL_FLOAT_VEC3>(mShaderID, "uViewPos");
 
@@ -409,7 +549,7 @@ inline ShaderMaterial::ShaderMaterial(R3D_MaterialShaderConfig config)
         mHasSkybox = Uniform<bool, GL_BOOL>(mShaderID, "uHasSkybox");
     }
 
-    for (int i = 0; i < SHADER_LIGHT_COUNT; i++) {
+    for (int i = 0; i < mLightCount; i++) {
         if (config.flags & R3D_MATERIAL_FLAG_RECEIVE_SHADOW) {
             mLights[i].shadowCubemap = Sampler<GL_TEXTURE_CUBE_MAP>(mShaderID, TextFormat("uLights[%i].shadowCubemap", i), textureSlot++);
             mLights[i].shadowMap = Sampler<GL_TEXTURE_2D>(mShaderID, TextFormat("uLights[%i].shadowMap", i), textureSlot++);
@@ -439,12 +579,13 @@ inline ShaderMaterial::~ShaderMaterial()
 
 inline ShaderMaterial::ShaderMaterial(ShaderMaterial&& other) noexcept
     : mConfig(other.mConfig)
+    , mLightCount(other.mLightCount)
     , mShaderID(std::exchange(other.mShaderID, 0))
+    , mEnvironmentFrame(other.mEnvironmentFrame)
     , mLights(other.mLights)
     , mMatNormal(other.mMatNormal)
     , mMatModel(other.mMatModel)
     , mMatMVP(other.mMatMVP)
-    , mBloomHdrThreshold(other.mBloomHdrThreshold)
     , mColAmbient(other.mColAmbient)
     , mViewPos(other.mViewPos)
     , mTexAlbedo(other.mTexAlbedo)
@@ -469,12 +610,13 @@ inline ShaderMaterial::ShaderMaterial(ShaderMaterial&& other) noexcept
 inline ShaderMaterial& ShaderMaterial::operator=(ShaderMaterial&& other) noexcept {
     if (this != &other) {
         mConfig = other.mConfig;
+        mLightCount = other.mLightCount;
         mShaderID = std::exchange(other.mShaderID, 0);
+        mEnvironmentFrame = other.mEnvironmentFrame;
         mLights = other.mLights;
         mMatNormal = other.mMatNormal;
         mMatModel = other.mMatModel;
         mMatMVP = other.mMatMVP;
-        mBloomHdrThreshold = other.mBloomHdrThreshold;
         mColAmbient = other.mColAmbient;
         mViewPos = other.mViewPos;
         mTexAlbedo = other.mTexAlbedo;
@@ -501,6 +643,7 @@ inline ShaderMaterial& ShaderMaterial::operator=(ShaderMaterial&& other) noexcep
 inline void ShaderMaterial::begin() const
 {
     glUseProgram(mShaderID);
+    sCounters.shaderBinds++;
 }
 
 inline void ShaderMaterial::end() const
@@ -540,32 +683,39 @@ inline void ShaderMaterial::end() const
     }
 }
 
-inline void ShaderMaterial::setEnvironment(const R3D_Environment& env, const Vector3& viewPos)
+inline void ShaderMaterial::setEnvironment(const R3D_Environment& env, const Vector3& viewPos, uint32_t frame)
 {
+    bool upload = (frame != mEnvironmentFrame);
+    mEnvironmentFrame = frame;
+
     bool skyAmbient = false;
 
     if (mConfig.flags & R3D_MATERIAL_FLAG_SKY_IBL) {
-        mHasSkybox.set(env.world.skybox != nullptr);
+        if (upload) {
+            mHasSkybox.set(env.world.skybox != nullptr);
+        }
         if (env.world.skybox != nullptr) {
             Skybox *sky = static_cast<Skybox*>(env.world.skybox->internal);
             mCubeIrradiance.bind(sky->getIrradianceCubemapID());
             mCubePrefilter.bind(sky->getPrefilterCubemapID());
             mTexBrdfLUT.bind(sky->getBrdfLUTTextureID());
-            mQuatSkybox.set(QuaternionFromEuler(
-                env.world.skybox->rotation.x * DEG2RAD,
-                env.world.skybox->rotation.y * DEG2RAD,
-                env.world.skybox->rotation.z * DEG2RAD
-            ));
+            if (upload) {
+                mQuatSkybox.set(QuaternionFromEuler(
+                    env.world.skybox->rotation.x * DEG2RAD,
+                    env.world.skybox->rotation.y * DEG2RAD,
+                    env.world.skybox->rotation.z * DEG2RAD
+                ));
+            }
             skyAmbient = true;
         }
     }
 
-    if (!skyAmbient) {
-        mColAmbient.set(env.world.ambient);
+    if (!upload) {
+        return;
     }
 
-    if (env.bloom.mode != R3D_BLOOM_DISABLED) {
-        mBloomHdrThreshold.set(env.bloom.hdrThreshold);
+    if (!skyAmbient) {
+        mColAmbient.set(env.world.ambient);
     }
 
     mViewPos.set(viewPos);
@@ -611,7 +761,7 @@ inline void ShaderMaterial::setLights(const ShaderLightArray& lights)
         return;
     }
 
-    for (int i = 0; i < SHADER_LIGHT_COUNT; i++) {
+    for (int i = 0; i < mLightCount; i++) {
         const r3d::Light *light = lights[i];
         Light& mLight = mLights[i];
 
@@ -668,7 +818,7 @@ inline void ShaderMaterial::setLights(const ShaderLightArray& lights)
 
 inline void ShaderMaterial::setMatModel(const Matrix& matModel)
 {
-    mMatNormal.set(MatrixTranspose(MatrixInvert(matModel)));
+    mMatNormal.set(simdMatrixNormal(matModel));
     mMatModel.set(matModel);
 }
 
@@ -677,6 +827,16 @@ inline void ShaderMaterial::setMatMVP(const Matrix& matMVP)
     mMatMVP.set(matMVP);
 }
 
+inline const R3D_MaterialShaderConfig& ShaderMaterial::config() const
+{
+    return mConfig;
+}
+
+inline int ShaderMaterial::lightCount() const
+{
+    return mLightCount;
+}
+
 
 /* ShaderMaterial::Uniform implementation */
 
@@ -692,36 +852,43 @@ void ShaderMaterial::Uniform<Type, GLType>::set(const Type& value)
     if constexpr (std::is_same_v<Type, bool>) {
         if (mValue != value) {
             glUniform1i(mLoc, static_cast<int>(value));
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, int>) {
         if (mValue != value) {
             glUniform1i(mLoc, value);
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, float>) {
         if (mValue != value) {
             glUniform1f(mLoc, value);
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, double>) {
         if (mValue != value) {
             glUniform1f(mLoc, static_cast<float>(value));
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, Vector2>) {
         if (mValue != value) {
             glUniform2f(mLoc, value.x, value.y);
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, Vector3>) {
         if (mValue != value) {
             glUniform3f(mLoc, value.x, value.y, value.z);
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, Vector4>) {
         if (mValue != value) {
             glUniform4f(mLoc, value.x, value.y, value.z, value.w);
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, Color>) {
@@ -731,10 +898,12 @@ void ShaderMaterial::Uniform<Type, GLType>::set(const Type& value)
             } else if constexpr (GLType == GL_FLOAT_VEC4) {
                 glUniform4f(mLoc, value.r / 255.0f, value.g / 255.0f, value.b / 255.0f, value.a / 255.0f);
             }
+            sCounters.uniformUploads++;
             mValue = value;
         }
     } else if constexpr (std::is_same_v<Type, Matrix>) {
         rlSetUniformMatrix(mLoc, value);
+        sCounters.uniformUploads++;
         mValue = value;
     }
 }
@@ -766,6 +935,7 @@ void ShaderMaterial::Sampler<GLTarget>::bind(GLuint texture) const
 {
     glActiveTexture(GL_TEXTURE0 + mSlot);
     glBindTexture(GLTarget, texture);
+    sCounters.textureBinds++;
 }
 
 template <GLenum GLTarget>
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_SIMD_H
+#define R3D_DETAIL_SIMD_H
+
+/**
+ * Matrix and vector kernels used in the hot paths of the renderer.
+ *
+ * The functions take and return raylib types and follow the conventions of raymath
+ * (e.g. `simdMatrixMultiply(a, b)` applies `a` then `b`). They are implemented with
+ * SSE or NEON when available, otherwise they fall back to scalar code.
+ *
+ * The multiply and transform functions evaluate the same products, summed in the same
+ * order, as their raymath counterparts; their results are therefore bit-identical to
+ * raymath, provided the compiler doesn't contract multiplications and additions into
+ * FMA instructions (e.g. `-ffp-contract=off`, or no FMA in the target instruction set).
+ *
+ * The affine variants assume that the last row of the matrices is (0, 0, 0, 1),
+ * which is the case for the model, view and bone transforms used by the renderer.
+ *
+ * The comparisons return a lane mask (`simd_mask32x4`), only meant to be passed to `simdSelect`.
+ *
+ * Define `R3D_NO_SIMD` to force the scalar implementation.
+ */
+
+#include <raylib.h>
+#include <raymath.h>
+
+#if defined(R3D_NO_SIMD)
+#   define R3D_SIMD_SCALAR
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define R3D_SIMD_SSE
+#   include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define R3D_SIMD_NEON
+#   include <arm_neon.h>
+#else
+#   define R3D_SIMD_SCALAR
+#endif
+
+/*
+ * NOTE: The fields of `Matrix` are declared row by row (m0, m4, m8, m12, m1, ...),
+ *       so `&mat.m0`, `&mat.m1`, `&mat.m2` and `&mat.m3` each point to a row of four
+ *       contiguous floats. Row `i` of `MatrixMultiply(a, b)` is the combination of the
+ *       rows of `a` weighted by the components of row `i` of `b`.
+ */
+
+#if defined(R3D_SIMD_SSE)
+
+typedef __m128 simd_f32x4;
+typedef __m128 simd_mask32x4;
+
+#define simdLoad(ptr)           _mm_loadu_ps(ptr)
+#define simdStore(ptr, v)       _mm_storeu_ps(ptr, v)
+#define simdMul(a, b)           _mm_mul_ps(a, b)
+#define simdAdd(a, b)           _mm_add_ps(a, b)
+#define simdMin(a, b)           _mm_min_ps(a, b)
+#define simdSplat(x)            _mm_set1_ps(x)
+#define simdCmpGe(a, b)         _mm_cmpge_ps(a, b)
+#define simdSelect(m, a, b)     _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+
+#elif defined(R3D_SIMD_NEON)
+
+typedef float32x4_t simd_f32x4;
+typedef uint32x4_t simd_mask32x4;
+
+#define simdLoad(ptr)           vld1q_f32(ptr)
+#define simdStore(ptr, v)       vst1q_f32(ptr, v)
+#define simdMul(a, b)           vmulq_f32(a, b)
+#define simdAdd(a, b)           vaddq_f32(a, b)
+#define simdMin(a, b)           vminq_f32(a, b)
+#define simdSplat(x)            vdupq_n_f32(x)
+#define simdCmpGe(a, b)         vcgeq_f32(a, b)
+#define simdSelect(m, a, b)     vbslq_f32(m, a, b)
+
+#endif
+
+#if !defined(R3D_SIMD_SCALAR)
+
+/**
+ * @brief Computes `r.x * b0 + r.y * b1 + r.z * b2 + r.w * b3`, summed from left to right.
+ */
+static inline simd_f32x4 simdCombineRow(const float* r, simd_f32x4 b0, simd_f32x4 b1, simd_f32x4 b2, simd_f32x4 b3)
+{
+    simd_f32x4 v = simdMul(simdSplat(r[0]), b0);
+    v = simdAdd(v, simdMul(simdSplat(r[1]), b1));
+    v = simdAdd(v, simdMul(simdSplat(r[2]), b2));
+    return simdAdd(v, simdMul(simdSplat(r[3]), b3));
+}
+
+#endif
+
+/**
+ * @brief Multiplies two matrices, same as raymath's `MatrixMultiply`.
+ */
+static inline Matrix simdMatrixMultiply(Matrix left, Matrix right)
+{
+#if defined(R3D_SIMD_SCALAR)
+    return MatrixMultiply(left, right);
+#else
+    Matrix result;
+
+    simd_f32x4 l0 = simdLoad(&left.m0);
+    simd_f32x4 l1 = simdLoad(&left.m1);
+    simd_f32x4 l2 = simdLoad(&left.m2);
+    simd_f32x4 l3 = simdLoad(&left.m3);
+
+    simdStore(&result.m0, simdCombineRow(&right.m0, l0, l1, l2, l3));
+    simdStore(&result.m1, simdCombineRow(&right.m1, l0, l1, l2, l3));
+    simdStore(&result.m2, simdCombineRow(&right.m2, l0, l1, l2, l3));
+    simdStore(&result.m3, simdCombineRow(&right.m3, l0, l1, l2, l3));
+
+    return result;
+#endif
+}
+
+/**
+ * @brief Multiplies two affine matrices.
+ *
+ * The last row of the result is not computed but set to (0, 0, 0, 1),
+ * the other rows are bit-identical to those of `MatrixMultiply`.
+ */
+static inline Matrix simdMatrixMultiplyAffine(Matrix left, Matrix right)
+{
+    Matrix result;
+
+#if defined(R3D_SIMD_SCALAR)
+    result.m0 = left.m0*right.m0 + left.m1*right.m4 + left.m2*right.m8 + left.m3*right.m12;
+    result.m1 = left.m0*right.m1 + left.m1*right.m5 + left.m2*right.m9 + left.m3*right.m13;
+    result.m2 = left.m0*right.m2 + left.m1*right.m6 + left.m2*right.m10 + left.m3*right.m14;
+    result.m4 = left.m4*right.m0 + left.m5*right.m4 + left.m6*right.m8 + left.m7*right.m12;
+    result.m5 = left.m4*right.m1 + left.m5*right.m5 + left.m6*right.m9 + left.m7*right.m13;
+    result.m6 = left.m4*right.m2 + left.m5*right.m6 + left.m6*right.m10 + left.m7*right.m14;
+    result.m8 = left.m8*right.m0 + left.m9*right.m4 + left.m10*right.m8 + left.m11*right.m12;
+    result.m9 = left.m8*right.m1 + left.m9*right.m5 + left.m10*right.m9 + left.m11*right.m13;
+    result.m10 = left.m8*right.m2 + left.m9*right.m6 + left.m10*right.m10 + left.m11*right.m14;
+    result.m12 = left.m12*right.m0 + left.m13*right.m4 + left.m14*right.m8 + left.m15*right.m12;
+    result.m13 = left.m12*right.m1 + left.m13*right.m5 + left.m14*right.m9 + left.m15*right.m13;
+    result.m14 = left.m12*right.m2 + left.m13*right.m6 + left.m14*right.m10 + left.m15*right.m14;
+#else
+    simd_f32x4 l0 = simdLoad(&left.m0);
+    simd_f32x4 l1 = simdLoad(&left.m1);
+    simd_f32x4 l2 = simdLoad(&left.m2);
+    simd_f32x4 l3 = simdLoad(&left.m3);
+
+    simdStore(&result.m0, simdCombineRow(&right.m0, l0, l1, l2, l3));
+    simdStore(&result.m1, simdCombineRow(&right.m1, l0, l1, l2, l3));
+    simdStore(&result.m2, simdCombineRow(&right.m2, l0, l1, l2, l3));
+#endif
+
+    result.m3 = 0.0f;
+    result.m7 = 0.0f;
+    result.m11 = 0.0f;
+    result.m15 = 1.0f;
+
+    return result;
+}
+
+/**
+ * @brief Inverts an affine matrix.
+ *
+ * The inverse of the upper 3x3 part is computed from the cross products of its
+ * columns, and the translation is then transformed by it. This is much cheaper
+ * than the cofactor expansion of `MatrixInvert`, but not bit-identical to it.
+ */
+static inline Matrix simdMatrixInvertAffine(Matrix mat)
+{
+    // Columns of the upper 3x3 part
+    Vector3 c0 = { mat.m0, mat.m1, mat.m2 };
+    Vector3 c1 = { mat.m4, mat.m5, mat.m6 };
+    Vector3 c2 = { mat.m8, mat.m9, mat.m10 };
+
+    // The rows of the inverse are the cross products of the columns divided by the determinant
+    Vector3 r0 = Vector3CrossProduct(c1, c2);
+    Vector3 r1 = Vector3CrossProduct(c2, c0);
+    Vector3 r2 = Vector3CrossProduct(c0, c1);
+
+    float invDet = 1.0f / Vector3DotProduct(c0, r0);
+
+    r0 = Vector3Scale(r0, invDet);
+    r1 = Vector3Scale(r1, invDet);
+    r2 = Vector3Scale(r2, invDet);
+
+    Vector3 t = { mat.m12, mat.m13, mat.m14 };
+
+    Matrix result;
+
+    result.m0 = r0.x; result.m4 = r0.y; result.m8 = r0.z;  result.m12 = -Vector3DotProduct(r0, t);
+    result.m1 = r1.x; result.m5 = r1.y; result.m9 = r1.z;  result.m13 = -Vector3DotProduct(r1, t);
+    result.m2 = r2.x; result.m6 = r2.y; result.m10 = r2.z; result.m14 = -Vector3DotProduct(r2, t);
+    result.m3 = 0.0f; result.m7 = 0.0f; result.m11 = 0.0f; result.m15 = 1.0f;
+
+    return result;
+}
+
+/**
+ * @brief Computes the normal matrix of an affine matrix, i.e. the transpose of its inverse.
+ */
+static inline Matrix simdMatrixNormal(Matrix mat)
+{
+    return MatrixTranspose(simdMatrixInvertAffine(mat));
+}
+
+/**
+ * @brief Transforms a point by a matrix, same as raymath's `Vector3Transform`.
+ */
+static inline Vector3 simdVector3Transform(Vector3 v, Matrix mat)
+{
+#if defined(R3D_SIMD_SCALAR)
+    return Vector3Transform(v, mat);
+#else
+    // The columns of the matrix are gathered so that the
+    // sum is evaluated in the same order as in raymath
+    const float c0[4] = { mat.m0, mat.m1, mat.m2, mat.m3 };
+    const float c1[4] = { mat.m4, mat.m5, mat.m6, mat.m7 };
+    const float c2[4] = { mat.m8, mat.m9, mat.m10, mat.m11 };
+    const float c3[4] = { mat.m12, mat.m13, mat.m14, mat.m15 };
+    const float p[4] = { v.x, v.y, v.z, 1.0f };
+
+    float r[4];
+    simdStore(r, simdCombineRow(p, simdLoad(c0), simdLoad(c1), simdLoad(c2), simdLoad(c3)));
+
+    Vector3 result = { r[0], r[1], r[2] };
+    return result;
+#endif
+}
+
+#endif // R3D_DETAIL_SIMD_H
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_SPRITE_BATCHER_HPP
+#define R3D_DETAIL_SPRITE_BATCHER_HPP
+
+#include "r3d.h"
+
+#include "./simd.h"
+#include "./gl.hpp"
+
+#include <raylib.h>
+#include <raymath.h>
+#include <rlgl.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace r3d {
+
+/**
+ * @brief Class for drawing many sprites in a single draw call.
+ *
+ * The quads of the sprites are expanded on the CPU into a single streamed vertex buffer, in world space,
+ * with their UV rect already applied. The resulting geometry is exposed as a raylib `Mesh` so that it can
+ * go through the same scene and shadow paths as any other surface, with an identity model matrix.
+ *
+ * When the sprites are billboarded, the quads are only transformed by the rotation/scale of the sprites and
+ * their pivots are stored in a separate attribute, so that the material shader can orient them on the GPU.
+ *
+ * The albedo color of each sprite is stored in its vertices, so that sprites with different tints can share
+ * a batch; they must be drawn with a material shader using `R3D_MATERIAL_FLAG_VERTEX_COLOR`.
+ *
+ * The indices are 16-bit, so a single draw call is limited to `MAX_SPRITES` sprites.
+ */
+class SpriteBatcher
+{
+public:
+    static constexpr int MAX_SPRITES = 65536 / 4;   ///< Maximum number of sprites per draw call.
+    static constexpr int ATTRIB_LOCATION_CENTER = 10;   ///< Location of `aBillboardCenter` in 'material.vs'.
+
+public:
+    /**
+     * @brief Constructs a SpriteBatcher and allocates its GPU buffers.
+     */
+    SpriteBatcher();
+
+    /**
+     * @brief Releases the GPU buffers.
+     */
+    ~SpriteBatcher();
+
+    SpriteBatcher(const SpriteBatcher&) = delete;
+    SpriteBatcher& operator=(const SpriteBatcher&) = delete;
+
+    /**
+     * @brief Adds a sprite to the current batch.
+     * @param transform The global transformation matrix of the sprite.
+     * @param uvOffset The offset of the UV rect of the sprite.
+     * @param uvScale The scale of the UV rect of the sprite.
+     * @param color The albedo color of the sprite.
+     * @param billboard Whether the quad is oriented by the shader, in which case its pivot is stored apart.
+     * @return False if the batch is full, in which case the sprite is not added.
+     */
+    bool push(const Matrix& transform, const Vector2& uvOffset, const Vector2& uvScale, Color color, bool billboard);
+
+    /**
+     * @brief Uploads the current batch to the GPU.
+     * @return A mesh referencing the uploaded geometry, valid until the next upload.
+     */
+    const Mesh& upload();
+
+    /**
+     * @brief Clears the current batch.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of sprites in the current batch.
+     */
+    int count() const;
+
+    /**
+     * @brief Checks whether two sprite materials only differ by their UV rect and albedo color,
+     *        in which case the sprites can be drawn in the same batch.
+     */
+    static bool isMaterialBatchable(const R3D_Material& a, const R3D_Material& b);
+
+private:
+    struct Vertex {
+        Vector3 position;
+        Vector2 texcoord;
+        Vector3 normal;
+        Color color;
+        Vector4 tangent;
+        Vector3 center;
+    };
+
+private:
+    std::vector<Vertex> mVertices;      ///< Vertices of the current batch, four per sprite.
+    unsigned int mVBOs[9]{};            ///< Buffers indexed by raylib's attribute locations, as expected by `Mesh::vboId`.
+    Mesh mMesh{};                       ///< Mesh referencing the streamed buffers.
+};
+
+/* Implementation */
+
+inline SpriteBatcher::SpriteBatcher()
+{
+    // Indices are the same for every batch, they are generated once for the maximum size
+
+    std::vector<unsigned short> indices(MAX_SPRITES * 6);
+
+    for (int i = 0; i < MAX_SPRITES; i++) {
+        unsigned short v = static_cast<unsigned short>(i * 4);
+        unsigned short* quad = &indices[i * 6];
+        quad[0] = v + 0; quad[1] = v + 1; quad[2] = v + 2;  // Same winding as `Quad`
+        quad[3] = v + 1; quad[4] = v + 3; quad[5] = v + 2;
+    }
+
+    mMesh.vaoId = rlLoadVertexArray();
+    rlEnableVertexArray(mMesh.vaoId);
+
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(
+        indices.data(), static_cast<int>(indices.size() * sizeof(unsigned short)), false
+    );
+
+    GLuint vbo = rlLoadVertexBuffer(nullptr, 4 * sizeof(Vertex), true);
+
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = vbo;
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = vbo;
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = vbo;
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] = vbo;
+    mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT] = vbo;
+
+    // The pivot attribute is not part of raylib's layout, it is
+    // only read by the billboard variants of the material shader
+
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, position));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texcoord));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, sizeof(Vertex), offsetof(Vertex, color));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, RL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, tangent));
+    rlSetVertexAttribute(ATTRIB_LOCATION_CENTER, 3, RL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, center));
+
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+    rlEnableVertexAttribute(ATTRIB_LOCATION_CENTER);
+
+    rlDisableVertexArray();
+
+    mMesh.vboId = mVBOs;
+    mVertices.reserve(256 * 4);
+}
+
+inline SpriteBatcher::~SpriteBatcher()
+{
+    const GLuint buffers[] = {
+        mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION],
+        mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]
+    };
+    glDeleteBuffers(2, buffers);
+    if (mMesh.vaoId > 0) {
+        glDeleteVertexArrays(1, &mMesh.vaoId);
+    }
+}
+
+inline bool SpriteBatcher::push(const Matrix& transform, const Vector2& uvOffset, const Vector2& uvScale, Color color, bool billboard)
+{
+    if (count() >= MAX_SPRITES) {
+        return false;
+    }
+
+    // Same corners and texcoords as `Quad`
+
+    static constexpr float CORNERS[4][4] = {
+        // x      y      u     v
+        { -1.0f,  1.0f,  0.0f, 1.0f },
+        { -1.0f, -1.0f,  0.0f, 0.0f },
+        {  1.0f,  1.0f,  1.0f, 1.0f },
+        {  1.0f, -1.0f,  1.0f, 0.0f },
+    };
+
+    // The normal of the quad is (0, 0, 1), so its transformed
+    // normal is the third column of the normal matrix
+
+    Matrix matNormal = simdMatrixNormal(transform);
+    Vector3 normal = Vector3Normalize({ matNormal.m8, matNormal.m9, matNormal.m10 });
+
+    // The tangent follows the U axis of the UV rect, which is the X axis of the quad flipped
+    // with the rect, its sign makes the bitangent follow the V axis in the same way
+
+    float signU = (uvScale.x < 0.0f) ? -1.0f : 1.0f;
+    float signV = (uvScale.y < 0.0f) ? -1.0f : 1.0f;
+
+    Vector3 axisX = Vector3Normalize({ transform.m0, transform.m1, transform.m2 });
+    Vector4 tangent = { axisX.x * signU, axisX.y * signU, axisX.z * signU, signU * signV };
+
+    // For billboards, the translation is moved from the positions to the pivot
+
+    Matrix matLocal = transform;
+    Vector3 center = { 0.0f, 0.0f, 0.0f };
+
+    if (billboard) {
+        center = { transform.m12, transform.m13, transform.m14 };
+        matLocal.m12 = matLocal.m13 = matLocal.m14 = 0.0f;
+    }
+
+    for (const auto& c : CORNERS) {
+        mVertices.push_back({
+            simdVector3Transform({ c[0], c[1], 0.0f }, matLocal),
+            { uvOffset.x + c[2] * uvScale.x, uvOffset.y + c[3] * uvScale.y },
+            normal, color, tangent, center
+        });
+    }
+
+    return true;
+}
+
+inline const Mesh& SpriteBatcher::upload()
+{
+    // The buffer is respecified on each upload, which lets the driver orphan
+    // the previous storage instead of waiting for the draws that still use it
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVBOs[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION]);
+    glBufferData(GL_ARRAY_BUFFER, mVertices.size() * sizeof(Vertex), mVertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    mMesh.vertexCount = static_cast<int>(mVertices.size());
+    mMesh.triangleCount = count() * 2;
+
+    return mMesh;
+}
+
+inline void SpriteBatcher::clear()
+{
+    mVertices.clear();
+}
+
+inline int SpriteBatcher::count() const
+{
+    return static_cast<int>(mVertices.size() / 4);
+}
+
+inline bool SpriteBatcher::isMaterialBatchable(const R3D_Material& a, const R3D_Material& b)
+{
+    return a.albedo.texture.id == b.albedo.texture.id
+        && a.metalness.texture.id == b.metalness.texture.id
+        && a.metalness.factor == b.metalness.factor
+        && a.roughness.texture.id == b.roughness.texture.id
+        && a.roughness.factor == b.roughness.factor
+        && a.emission.texture.id == b.emission.texture.id
+        && a.emission.energy == b.emission.energy
+        && ColorIsEqual(a.emission.color, b.emission.color)
+        && a.normal.texture.id == b.normal.texture.id
+        && a.ao.texture.id == b.ao.texture.id
+        && a.ao.lightAffect == b.ao.lightAffect;
+}
+
+} // namespace r3d
+
+#endif // R3D_DETAIL_SPRITE_BATCHER_HPP
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_STATS_H
+#define R3D_DETAIL_STATS_H
+
+/**
+ * Counters of the frame statistics (see `R3D_GetFrameStats`) that are updated from the C objects.
+ *
+ * They are kept apart from the renderer, which takes them at the end of each `R3D_End`, so that
+ * the objects updating them can be built and benchmarked without it. They can be updated from
+ * any thread.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Adds the particles updated by a CPU particle system to the statistics of the frame.
+ * @param count Number of particles simulated.
+ */
+void r3d_statsAddParticlesSimulated(int count);
+
+/**
+ * @brief Returns the particles simulated since the previous call and resets the counter.
+ * @return Number of particles simulated.
+ */
+int r3d_statsTakeParticlesSimulated(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // R3D_DETAIL_STATS_H
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef R3D_DETAIL_TRACE_H
+#define R3D_DETAIL_TRACE_H
+
+/**
+ * CPU trace zones, recorded only when the library is built with `R3D_ENABLE_TRACE`.
+ *
+ * Each thread records its completed zones into its own ring buffer, the recording thread
+ * being the only writer, so no lock is taken on the hot paths. The zones can be saved as
+ * a Chrome/Perfetto trace with `R3D_SaveTraceJSON`. Without `R3D_ENABLE_TRACE` the macros
+ * below expand to nothing.
+ *
+ * The zone names must be string literals (or outlive the trace), only their address is kept.
+ *
+ * C:   R3D_TRACE_BEGIN("Name"); ... R3D_TRACE_END();
+ * C++: R3D_TRACE_ZONE("Name");  // Ends at the end of the scope
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Begins a zone nested in the current zone of the calling thread.
+ * @param name Name of the zone, must be a string literal.
+ */
+void r3d_traceBegin(const char* name);
+
+/**
+ * @brief Ends the current zone of the calling thread and records it.
+ */
+void r3d_traceEnd(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(R3D_ENABLE_TRACE)
+#   define R3D_TRACE_BEGIN(name) r3d_traceBegin(name)
+#   define R3D_TRACE_END() r3d_traceEnd()
+#else
+#   define R3D_TRACE_BEGIN(name) ((void)0)
+#   define R3D_TRACE_END() ((void)0)
+#endif
+
+#ifdef __cplusplus
+
+namespace r3d {
+
+/**
+ * @brief Begins a trace zone on construction and ends it on destruction.
+ */
+struct TraceZone
+{
+    explicit TraceZone(const char* name) { r3d_traceBegin(name); }
+    ~TraceZone() { r3d_traceEnd(); }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+};
+
+} // namespace r3d
+
+#if defined(R3D_ENABLE_TRACE)
+#   define R3D_TRACE_CONCAT_IMPL(a, b) a##b
+#   define R3D_TRACE_CONCAT(a, b) R3D_TRACE_CONCAT_IMPL(a, b)
+#   define R3D_TRACE_ZONE(name) ::r3d::TraceZone R3D_TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#   define R3D_TRACE_ZONE(name) ((void)0)
+#endif
+
+#endif // __cplusplus
+
+#endif // R3D_DETAIL_TRACE_H
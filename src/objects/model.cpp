@@ -21,6 +21,10 @@
 
 #include "./model.hpp"
 
+#include "../core/renderer.hpp"
+
+#include "../detail/trace.h"
+
 #include <raylib.h>
 #include <raymath.h>
 #include <rlgl.h>
@@ -82,11 +86,17 @@ R3D_Model R3D_LoadModel(const char* fileName)
         .shadow = R3D_CAST_ON,
         .billboard = R3D_BILLBOARD_DISABLED,
         .layer = R3D_LAYER_1,
+        .maxDrawDistance = 0.0f,
+        .maxShadowDistance = 0.0f,
         .internal = r3dModel,
     };
 
     R3D_UpdateModelAABB(&model, 0.0f);
 
+    if (gRenderer && (gRenderer->flags & R3D_FLAG_MODEL_LODS)) {
+        r3dModel->generateLODs(r3d::Model::DEFAULT_LOD_COUNT, r3d::Model::DEFAULT_LOD_REDUCTION);
+    }
+
     return model;
 }
 
@@ -105,11 +115,17 @@ R3D_Model R3D_LoadModelFromMesh(Mesh mesh)
         .shadow = R3D_CAST_ON,
         .billboard = R3D_BILLBOARD_DISABLED,
         .layer = R3D_LAYER_1,
+        .maxDrawDistance = 0.0f,
+        .maxShadowDistance = 0.0f,
         .internal = r3dModel,
     };
 
     R3D_UpdateModelAABB(&model, 0.0f);
 
+    if (gRenderer && (gRenderer->flags & R3D_FLAG_MODEL_LODS)) {
+        r3dModel->generateLODs(r3d::Model::DEFAULT_LOD_COUNT, r3d::Model::DEFAULT_LOD_REDUCTION);
+    }
+
     return model;
 }
 
@@ -242,59 +258,17 @@ void R3D_UnloadAnimationNames(char** names, int count)
 
 void R3D_UpdateModelAnimation(R3D_Model* model, const char* name, int frame)
 {
+    R3D_TRACE_ZONE("R3D_UpdateModelAnimation");
+
     r3d::Model *r3dModel = static_cast<r3d::Model*>(model->internal);
     const r3d::Model::Animation& anim = r3dModel->animations.at(name);
 
     r3dModel->updateAnimationBones(anim, frame);
 
     for (auto& surface : r3dModel->surfaces) {
-        Mesh mesh = surface.mesh;
-        Vector3 animVertex = { 0 };
-        Vector3 animNormal = { 0 };
-        int boneId = 0;
-        int boneCounter = 0;
-        float boneWeight = 0.0f;
-        bool updated = false;           // Flag to check when anim vertex information is updated
-        const int vValues = 3 * mesh.vertexCount;
-
-        for (int vCounter = 0; vCounter < vValues; vCounter += 3) {
-            mesh.animVertices[vCounter] = 0;
-            mesh.animVertices[vCounter + 1] = 0;
-            mesh.animVertices[vCounter + 2] = 0;
-
-            if (mesh.animNormals != nullptr) {
-                mesh.animNormals[vCounter] = 0;
-                mesh.animNormals[vCounter + 1] = 0;
-                mesh.animNormals[vCounter + 2] = 0;
-            }
-
-            // Iterates over 4 bones per vertex
-            for (int j = 0; j < 4; j++, boneCounter++) {
-                boneWeight = mesh.boneWeights[boneCounter];
-                boneId = mesh.boneIds[boneCounter];
-
-                // Early stop when no transformation will be applied
-                if (boneWeight == 0.0f) continue;
-                animVertex = { mesh.vertices[vCounter], mesh.vertices[vCounter + 1], mesh.vertices[vCounter + 2] };
-                animVertex = Vector3Transform(animVertex, surface.mesh.boneMatrices[boneId]);
-                mesh.animVertices[vCounter] += animVertex.x * boneWeight;
-                mesh.animVertices[vCounter+1] += animVertex.y * boneWeight;
-                mesh.animVertices[vCounter+2] += animVertex.z * boneWeight;
-                updated = true;
-
-                // Normals processing
-                // NOTE: We use meshes.baseNormals (default normal) to calculate meshes.normals (animated normals)
-                if (mesh.normals != nullptr) {
-                    animNormal = { mesh.normals[vCounter], mesh.normals[vCounter + 1], mesh.normals[vCounter + 2] };
-                    animNormal = Vector3Transform(animNormal, MatrixTranspose(MatrixInvert(surface.mesh.boneMatrices[boneId])));
-                    mesh.animNormals[vCounter] += animNormal.x * boneWeight;
-                    mesh.animNormals[vCounter + 1] += animNormal.y * boneWeight;
-                    mesh.animNormals[vCounter + 2] += animNormal.z * boneWeight;
-                }
-            }
-        }
+        const Mesh& mesh = surface.mesh;
 
-        if (updated) {
+        if (r3d::Model::skinMesh(mesh)) {
             rlUpdateVertexBuffer(mesh.vboId[0], mesh.animVertices, 3 * mesh.vertexCount * sizeof(float), 0); // Update vertex position
             rlUpdateVertexBuffer(mesh.vboId[2], mesh.animNormals, 3 * mesh.vertexCount * sizeof(float), 0);  // Update vertex normals
         }
@@ -347,3 +321,25 @@ void R3D_GenTangents(R3D_Model* model)
         GenMeshTangents(&surface.mesh);
     }
 }
+
+int R3D_GenerateModelLODs(R3D_Model* model, int levelCount, float reduction)
+{
+    R3D_TRACE_ZONE("R3D_GenerateModelLODs");
+
+    return static_cast<r3d::Model*>(model->internal)->generateLODs(levelCount, reduction);
+}
+
+bool R3D_AddModelLOD(R3D_Model* model, int surfaceIndex, Mesh mesh, float error)
+{
+    return static_cast<r3d::Model*>(model->internal)->addLOD(surfaceIndex, mesh, error);
+}
+
+void R3D_ClearModelLODs(R3D_Model* model)
+{
+    static_cast<r3d::Model*>(model->internal)->clearLODs();
+}
+
+int R3D_GetModelLODCount(const R3D_Model* model)
+{
+    return static_cast<int>(static_cast<const r3d::Model*>(model->internal)->lodErrors.size());
+}
@@ -22,10 +22,14 @@
 
 #include "r3d.h"
 
+#include "../detail/mesh_simplifier.hpp"
+#include "../detail/simd.h"
+
 #include <raylib.h>
 #include <raymath.h>
 
 #include <unordered_map>
+#include <algorithm>
 #include <utility>
 #include <cassert>
 #include <vector>
@@ -83,7 +87,18 @@ struct Model
         }
     };
 
+    static constexpr int DEFAULT_LOD_COUNT = 3;             // Levels generated with R3D_FLAG_MODEL_LODS
+    static constexpr float DEFAULT_LOD_REDUCTION = 0.5f;
+
+    struct LOD
+    {
+        ::Mesh mesh;                // Simplified mesh, owned by the model
+        float error;                // Distance to the full detail mesh, in the units of the model
+    };
+
     std::vector<R3D_Surface> surfaces;
+    std::vector<std::vector<LOD>> lods;     // LOD chain of each surface, from the finest to the coarsest
+    std::vector<float> lodErrors;           // Error of each LOD level of the model, the largest of its surfaces
     std::unordered_map<std::string, Animation> animations;
 
     std::span<::BoneInfo> bones;
@@ -97,6 +112,27 @@ struct Model
     Model& operator=(const Model&) = delete;
 
     void updateAnimationBones(const struct Animation& anim, int frame) const;
+
+    // Returns the mesh of a surface at a LOD level, the surfaces with a shorter chain use their coarsest mesh
+    const ::Mesh& getMesh(size_t surface, int level) const;
+
+    // Replaces the LOD chains by simplified meshes, each level keeping 'reduction' times the triangles of the previous one
+    // The surfaces are simplified in parallel when OpenMP is enabled, the meshes are uploaded afterwards
+    // Returns the number of levels generated
+    int generateLODs(int levelCount, float reduction);
+
+    // Appends a mesh to the LOD chain of a surface, the model takes its ownership
+    // Returns false if the surface does not exist, the mesh is then left to the caller
+    bool addLOD(size_t surface, const ::Mesh& mesh, float error);
+
+    void clearLODs();
+
+    // Recomputes the errors of the levels of the model from the chains of its surfaces
+    void updateLODErrors();
+
+    // Computes the animated vertices and normals of a mesh from its bone matrices, without any GL call
+    // Returns true if at least one vertex is affected by a bone, the buffers then have to be uploaded
+    static bool skinMesh(const ::Mesh& mesh);
 };
 
 /* Public implementation */
@@ -104,6 +140,8 @@ struct Model
 
 inline Model::~Model()
 {
+    clearLODs();
+
     for (const auto& surface : surfaces) {
         UnloadMesh(surface.mesh);
     }
@@ -146,7 +184,7 @@ inline void Model::updateAnimationBones(const Animation& anim, int frame) const
                     Quaternion boneRotation = QuaternionMultiply(outRotation, invRotation);
                     Vector3 boneScale = Vector3Multiply(outScale, invScale);
 
-                    Matrix boneMatrix = MatrixMultiply(MatrixMultiply(
+                    Matrix boneMatrix = simdMatrixMultiplyAffine(simdMatrixMultiplyAffine(
                         QuaternionToMatrix(boneRotation),
                         MatrixTranslate(boneTranslation.x, boneTranslation.y, boneTranslation.z)),
                         MatrixScale(boneScale.x, boneScale.y, boneScale.z));
@@ -158,6 +196,179 @@ inline void Model::updateAnimationBones(const Animation& anim, int frame) const
     }
 }
 
+inline const ::Mesh& Model::getMesh(size_t surface, int level) const
+{
+    if (level <= 0 || surface >= lods.size() || lods[surface].empty()) {
+        return surfaces[surface].mesh;
+    }
+
+    const std::vector<LOD>& chain = lods[surface];
+    return chain[std::min(static_cast<size_t>(level), chain.size()) - 1].mesh;
+}
+
+inline int Model::generateLODs(int levelCount, float reduction)
+{
+    clearLODs();
+
+    if (levelCount <= 0 || reduction <= 0.0f || reduction >= 1.0f) {
+        return 0;
+    }
+
+    lods.resize(surfaces.size());
+
+    // NOTE: The skinned meshes are not simplified, their LODs would not follow the animations
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(surfaces.size()); i++) {
+        const ::Mesh& mesh = surfaces[i].mesh;
+        if (mesh.vertices == nullptr || mesh.boneIds != nullptr) {
+            continue;
+        }
+
+        MeshSimplifier simplifier(mesh);
+
+        size_t baseCount = simplifier.triangleCount();
+        size_t previousCount = baseCount;
+        float target = static_cast<float>(baseCount);
+
+        for (int level = 0; level < levelCount; level++) {
+            target *= reduction;
+            size_t count = simplifier.simplify(static_cast<size_t>(target));
+
+            // A level removing less than a tenth of the triangles of the previous one is not worth it,
+            // the simplification is then blocked by the borders and seams of the mesh
+            if (count == 0 || count > previousCount - previousCount / 10) {
+                break;
+            }
+
+            lods[i].push_back(LOD {
+                .mesh = MeshSimplifier::buildMesh(mesh, simplifier.indices()),
+                .error = simplifier.error()
+            });
+
+            previousCount = count;
+        }
+    }
+
+    for (auto& chain : lods) {
+        for (auto& lod : chain) {
+            UploadMesh(&lod.mesh, false);
+        }
+    }
+
+    updateLODErrors();
+
+    return static_cast<int>(lodErrors.size());
+}
+
+inline bool Model::addLOD(size_t surface, const ::Mesh& mesh, float error)
+{
+    if (surface >= surfaces.size()) {
+        TraceLog(LOG_WARNING, "R3D: Cannot add a LOD to the surface %i, the model has %i surfaces",
+            static_cast<int>(surface), static_cast<int>(surfaces.size()));
+        return false;
+    }
+
+    if (lods.size() < surfaces.size()) {
+        lods.resize(surfaces.size());
+    }
+
+    std::vector<LOD>& chain = lods[surface];
+    chain.push_back(LOD { mesh, chain.empty() ? error : std::max(error, chain.back().error) });
+
+    if (chain.back().mesh.vaoId == 0) {
+        UploadMesh(&chain.back().mesh, false);
+    }
+
+    updateLODErrors();
+
+    return true;
+}
+
+inline void Model::clearLODs()
+{
+    for (const auto& chain : lods) {
+        for (const auto& lod : chain) {
+            UnloadMesh(lod.mesh);
+        }
+    }
+
+    lods.clear();
+    lodErrors.clear();
+}
+
+inline void Model::updateLODErrors()
+{
+    lodErrors.clear();
+
+    for (const auto& chain : lods) {
+        if (chain.size() > lodErrors.size()) {
+            lodErrors.resize(chain.size(), 0.0f);
+        }
+    }
+
+    // A surface whose chain is shorter keeps its coarsest mesh, and its error, for the next levels
+
+    for (const auto& chain : lods) {
+        for (size_t level = 0; level < lodErrors.size() && !chain.empty(); level++) {
+            float error = chain[std::min(level, chain.size() - 1)].error;
+            lodErrors[level] = std::max(lodErrors[level], error);
+        }
+    }
+}
+
+inline bool Model::skinMesh(const ::Mesh& mesh)
+{
+    Vector3 animVertex = { 0 };
+    Vector3 animNormal = { 0 };
+    int boneId = 0;
+    int boneCounter = 0;
+    float boneWeight = 0.0f;
+    bool updated = false;           // Flag to check when anim vertex information is updated
+    const int vValues = 3 * mesh.vertexCount;
+
+    for (int vCounter = 0; vCounter < vValues; vCounter += 3) {
+        mesh.animVertices[vCounter] = 0;
+        mesh.animVertices[vCounter + 1] = 0;
+        mesh.animVertices[vCounter + 2] = 0;
+
+        if (mesh.animNormals != nullptr) {
+            mesh.animNormals[vCounter] = 0;
+            mesh.animNormals[vCounter + 1] = 0;
+            mesh.animNormals[vCounter + 2] = 0;
+        }
+
+        // Iterates over 4 bones per vertex
+        for (int j = 0; j < 4; j++, boneCounter++) {
+            boneWeight = mesh.boneWeights[boneCounter];
+            boneId = mesh.boneIds[boneCounter];
+
+            // Early stop when no transformation will be applied
+            if (boneWeight == 0.0f) continue;
+            animVertex = { mesh.vertices[vCounter], mesh.vertices[vCounter + 1], mesh.vertices[vCounter + 2] };
+            animVertex = Vector3Transform(animVertex, mesh.boneMatrices[boneId]);
+            mesh.animVertices[vCounter] += animVertex.x * boneWeight;
+            mesh.animVertices[vCounter+1] += animVertex.y * boneWeight;
+            mesh.animVertices[vCounter+2] += animVertex.z * boneWeight;
+            updated = true;
+
+            // Normals processing
+            // NOTE: We use meshes.baseNormals (default normal) to calculate meshes.normals (animated normals)
+            if (mesh.normals != nullptr) {
+                animNormal = { mesh.normals[vCounter], mesh.normals[vCounter + 1], mesh.normals[vCounter + 2] };
+                animNormal = Vector3Transform(animNormal, MatrixTranspose(MatrixInvert(mesh.boneMatrices[boneId])));
+                mesh.animNormals[vCounter] += animNormal.x * boneWeight;
+                mesh.animNormals[vCounter + 1] += animNormal.y * boneWeight;
+                mesh.animNormals[vCounter + 2] += animNormal.z * boneWeight;
+            }
+        }
+    }
+
+    return updated;
+}
+
 } // namespace r3d
 
 #endif // R3D_MODEL_HPP
@@ -19,6 +19,9 @@
 
 #include "r3d.h"
 
+#include "../detail/stats.h"
+#include "../detail/trace.h"
+
 #include <math.h>
 #include <float.h>
 #include <limits.h>
@@ -205,6 +208,8 @@ bool R3D_EmitParticleCPU(R3D_ParticleSystemCPU* system)
 
 void R3D_UpdateParticleEmitterCPU(R3D_ParticleSystemCPU* system, float deltaTime)
 {
+    R3D_TRACE_BEGIN("R3D_UpdateParticleEmitterCPU");
+
     system->emissionTimer -= deltaTime;
 
     if (system->emissionRate > 0.0f) {
@@ -266,6 +271,10 @@ void R3D_UpdateParticleEmitterCPU(R3D_ParticleSystemCPU* system, float deltaTime
         particle->velocity.y += system->gravity.y * deltaTime;
         particle->velocity.z += system->gravity.z * deltaTime;
     }
+
+    r3d_statsAddParticlesSimulated(system->particleCount);
+
+    R3D_TRACE_END();
 }
 
 void R3D_UpdateParticleEmitterCPUAABB(R3D_ParticleSystemCPU* system)
@@ -49,6 +49,7 @@ class Skybox
 public:
     Skybox(const std::string& skyboxTexturePath, CubemapLayout layout);
     Skybox(const std::string& hdrSkyboxTexturePath, int size);
+    Skybox(const Image& image, CubemapLayout layout);
 
     ~Skybox();
 
@@ -58,6 +59,10 @@ public:
         return mCubemap.id;
     }
 
+    int getSkyboxCubemapSize() const {
+        return mCubemap.width;
+    }
+
     unsigned int getIrradianceCubemapID() const {
         return mIrradiance.id;
     }
@@ -105,6 +110,7 @@ private:
 
 private:
     void load(const std::string& skyboxTexturePath, CubemapLayout layout);
+    void load(const Image& image, CubemapLayout layout);
     void loadHDR(const std::string& hdrSkyboxTexturePath, int size);
 
     void generateIrradiance();
@@ -130,6 +136,14 @@ inline Skybox::Skybox(const std::string& hdrSkyboxTexturePath, int size)
     loadHDR(hdrSkyboxTexturePath.c_str(), size);
 }
 
+inline Skybox::Skybox(const Image& image, CubemapLayout layout)
+{
+    if (sInstanceCounter++ == 0) {
+        sShared = std::make_unique<SharedData>();
+    }
+    load(image, layout);
+}
+
 inline Skybox::~Skybox()
 {
     if (--sInstanceCounter == 0) {
@@ -201,8 +215,13 @@ inline void Skybox::load(const std::string& skyboxTexturePath, CubemapLayout lay
 {
     // Load the cubemap texture from the image file
     Image img = LoadImage(skyboxTexturePath.c_str());
-    mCubemap = LoadTextureCubemap(img, layout);
+    load(img, layout);
     UnloadImage(img);
+}
+
+inline void Skybox::load(const Image& image, CubemapLayout layout)
+{
+    mCubemap = LoadTextureCubemap(image, layout);
 
     // Generate maps
     generateIrradiance();
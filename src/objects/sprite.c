@@ -16,9 +16,12 @@ R3D_Sprite R3D_CreateSprite(Texture2D texture, int xFrameCount, int yFrameCount)
     sprite.material.albedo.texture = texture;
 
     sprite.currentFrame = 0;
+    sprite.region = (Rectangle) {
+        0, 0, (float)texture.width, (float)texture.height
+    };
     sprite.frameSize = (Vector2) {
-        (float)texture.width / xFrameCount,
-        (float)texture.height / yFrameCount,
+        sprite.region.width / xFrameCount,
+        sprite.region.height / yFrameCount,
     };
 
     sprite.xFrameCount = xFrameCount;
@@ -52,8 +55,9 @@ void R3D_UpdateSpriteEx(R3D_Sprite* sprite, int firstFrame, int lastFrame, float
 Vector2 R3D_GetCurrentSpriteFrameCoord(const R3D_Sprite* sprite)
 {
     int xFrame = (int)(sprite->currentFrame) % sprite->xFrameCount;
-    int yFrame = (int)(sprite->currentFrame) / sprite->yFrameCount;
-    return Vector2Multiply((Vector2) { (float)xFrame, (float)yFrame }, sprite->frameSize);
+    int yFrame = (int)(sprite->currentFrame) / sprite->xFrameCount;
+    Vector2 coord = Vector2Multiply((Vector2) { (float)xFrame, (float)yFrame }, sprite->frameSize);
+    return (Vector2) { sprite->region.x + coord.x, sprite->region.y + coord.y };
 }
 
 Rectangle R3D_GetCurrentSpriteFrameRect(const R3D_Sprite* sprite)
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "r3d.h"
+
+#include <raylib.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Helper Functions */
+
+static void ExtrudeImageBorder(Image* image, int padding)
+{
+    // The image must be in R8G8B8A8 format, with its content
+    // surrounded by a transparent border of 'padding' pixels
+
+    Color *pixels = (Color*)image->data;
+
+    int w = image->width;
+    int h = image->height;
+
+    int x0 = padding, x1 = w - padding - 1;
+    int y0 = padding, y1 = h - padding - 1;
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = 0; x < x0; x++) pixels[y * w + x] = pixels[y * w + x0];
+        for (int x = x1 + 1; x < w; x++) pixels[y * w + x] = pixels[y * w + x1];
+    }
+
+    for (int y = 0; y < y0; y++) {
+        memcpy(&pixels[y * w], &pixels[y0 * w], w * sizeof(Color));
+    }
+
+    for (int y = y1 + 1; y < h; y++) {
+        memcpy(&pixels[y * w], &pixels[y1 * w], w * sizeof(Color));
+    }
+}
+
+/* Public API */
+
+R3D_SpriteAtlas R3D_LoadSpriteAtlas(int width, int height, int capacity)
+{
+    R3D_SpriteAtlas atlas = { 0 };
+
+    Image image = GenImageColor(width, height, BLANK);
+    atlas.texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    atlas.regions = RL_MALLOC(capacity * sizeof(Rectangle));
+    atlas.capacity = capacity;
+    atlas.padding = 2;
+
+    return atlas;
+}
+
+void R3D_UnloadSpriteAtlas(R3D_SpriteAtlas* atlas)
+{
+    UnloadTexture(atlas->texture);
+    RL_FREE(atlas->regions);
+
+    *atlas = (R3D_SpriteAtlas) { 0 };
+}
+
+int R3D_AddSpriteAtlasImage(R3D_SpriteAtlas* atlas, Image image)
+{
+    if (atlas->count >= atlas->capacity || atlas->texture.id == 0) {
+        return -1;
+    }
+
+    int padding = atlas->padding;
+    int paddedW = image.width + 2 * padding;
+    int paddedH = image.height + 2 * padding;
+
+    // Move to the next shelf if the image does not fit in the current one
+
+    if (atlas->shelfX + paddedW > atlas->texture.width) {
+        atlas->shelfY += atlas->shelfHeight;
+        atlas->shelfX = 0;
+        atlas->shelfHeight = 0;
+    }
+
+    if (paddedW > atlas->texture.width || atlas->shelfY + paddedH > atlas->texture.height) {
+        TraceLog(LOG_WARNING, "R3D: Not enough space left in the sprite atlas for a %ix%i image", image.width, image.height);
+        return -1;
+    }
+
+    // Copies the image with a border in which its edges are extruded
+
+    Image padded = ImageCopy(image);
+    ImageFormat(&padded, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    ImageResizeCanvas(&padded, paddedW, paddedH, padding, padding, BLANK);
+    ExtrudeImageBorder(&padded, padding);
+
+    UpdateTextureRec(atlas->texture, (Rectangle) {
+        (float)atlas->shelfX, (float)atlas->shelfY,
+        (float)paddedW, (float)paddedH
+    }, padded.data);
+
+    UnloadImage(padded);
+
+    // Stores the region of the image itself and advances the cursor
+
+    int index = atlas->count++;
+
+    atlas->regions[index] = (Rectangle) {
+        (float)(atlas->shelfX + padding),
+        (float)(atlas->shelfY + padding),
+        (float)image.width, (float)image.height
+    };
+
+    atlas->shelfX += paddedW;
+
+    if (paddedH > atlas->shelfHeight) {
+        atlas->shelfHeight = paddedH;
+    }
+
+    return index;
+}
+
+int R3D_AddSpriteAtlasTexture(R3D_SpriteAtlas* atlas, Texture2D texture)
+{
+    Image image = LoadImageFromTexture(texture);
+
+    if (image.data == NULL) {
+        return -1;
+    }
+
+    int index = R3D_AddSpriteAtlasImage(atlas, image);
+    UnloadImage(image);
+
+    return index;
+}
+
+R3D_Sprite R3D_CreateSpriteFromAtlas(const R3D_SpriteAtlas* atlas, int region, int xFrameCount, int yFrameCount)
+{
+    // The frame counts divide the size of the region, an invalid
+    // request gives a sprite displaying the whole atlas instead
+
+    if (region < 0 || region >= atlas->count) {
+        TraceLog(LOG_WARNING, "R3D: Sprite atlas region %i out of range [0, %i)", region, atlas->count);
+        return R3D_CreateSprite(atlas->texture, 1, 1);
+    }
+
+    if (xFrameCount <= 0 || yFrameCount <= 0) {
+        TraceLog(LOG_WARNING, "R3D: Invalid sprite frame counts (%i, %i), they must be positive", xFrameCount, yFrameCount);
+        return R3D_CreateSprite(atlas->texture, 1, 1);
+    }
+
+    R3D_Sprite sprite = R3D_CreateSprite(atlas->texture, xFrameCount, yFrameCount);
+
+    sprite.region = atlas->regions[region];
+    sprite.frameSize = (Vector2) {
+        sprite.region.width / xFrameCount,
+        sprite.region.height / yFrameCount,
+    };
+
+    // The UV rect must be restricted to the region from the
+    // start, otherwise the whole atlas would be displayed
+
+    R3D_UpdateSpriteEx(&sprite, 0, xFrameCount * yFrameCount, 0.0f);
+
+    return sprite;
+}
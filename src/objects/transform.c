@@ -19,6 +19,8 @@
 
 #include "r3d.h"
 
+#include "../detail/simd.h"
+
 #include <raymath.h>
 
 /* Public API */
@@ -29,7 +31,8 @@ R3D_Transform R3D_CreateTransformIdentity(const R3D_Transform* parent)
         .position = { 0, 0, 0 },
         .rotation = { 0, 0, 0, 1 },
         .scale = { 1, 1, 1 },
-        .parent = parent
+        .parent = parent,
+        .world = 0
     };
 }
 
@@ -70,8 +73,9 @@ R3D_Transform R3D_TransformFromMatrix(Matrix mat)
     // Convert the rotation matrix to a quaternion
     transform.rotation = QuaternionFromMatrix(rotationMatrix);
 
-    // Initialize the parent to NULL
+    // Initialize the parent and the cached world matrix to NULL
     transform.parent = 0;
+    transform.world = 0;
 
     return transform;
 }
@@ -82,17 +86,35 @@ Matrix R3D_TransformToLocal(const R3D_Transform* transform)
     Matrix mat_rotation = QuaternionToMatrix(transform->rotation);
     Matrix mat_scale = MatrixScale(transform->scale.x, transform->scale.y, transform->scale.z);
 
-    return MatrixMultiply(MatrixMultiply(mat_translation, mat_rotation), mat_scale);
+    // NOTE: raymath applies the left operand first, so the order is scale, rotation, then translation
+    return simdMatrixMultiplyAffine(simdMatrixMultiplyAffine(mat_scale, mat_rotation), mat_translation);
 }
 
 Matrix R3D_TransformToGlobal(const R3D_Transform* transform)
 {
+    if (transform->world) {
+        return *transform->world;
+    }
+
     if (transform->parent) {
-        return MatrixMultiply(
-            R3D_TransformToGlobal(transform),
-            R3D_TransformToLocal(transform)
+        return simdMatrixMultiplyAffine(
+            R3D_TransformToLocal(transform),
+            R3D_TransformToGlobal(transform->parent)
         );
     }
 
     return R3D_TransformToLocal(transform);
 }
+
+R3D_Transform R3D_CreateTransformFromNode(const R3D_TransformHierarchy* hierarchy, int node)
+{
+    R3D_Transform transform = R3D_CreateTransformIdentity(NULL);
+
+    if (node < 0 || node >= hierarchy->count) {
+        TraceLog(LOG_WARNING, "R3D: Invalid transform node index %i (hierarchy of %i nodes)", node, hierarchy->count);
+        return transform;
+    }
+
+    transform.world = &hierarchy->worlds[node];
+    return transform;
+}
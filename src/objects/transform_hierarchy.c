@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2024 Le Juez Victor
+ * 
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ * 
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ * 
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ * 
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "r3d.h"
+
+#include "../detail/simd.h"
+
+#include <raymath.h>
+#include <string.h>
+
+/* Helper Functions */
+
+static bool IsNodeValid(const R3D_TransformHierarchy* hierarchy, int node)
+{
+    if (node < 0 || node >= hierarchy->count) {
+        TraceLog(LOG_WARNING, "R3D: Invalid transform node index %i (hierarchy of %i nodes)", node, hierarchy->count);
+        return false;
+    }
+
+    return true;
+}
+
+static int GetNodeDepth(const R3D_TransformHierarchy* hierarchy, int node)
+{
+    int depth = 0;
+
+    for (int parent = hierarchy->parents[node]; parent >= 0; parent = hierarchy->parents[parent]) {
+        depth++;
+    }
+
+    return depth;
+}
+
+static void RebuildNodeOrder(R3D_TransformHierarchy* hierarchy)
+{
+    int maxDepth = 0;
+
+    for (int i = 0; i < hierarchy->count; i++) {
+        int depth = GetNodeDepth(hierarchy, i);
+        hierarchy->depths[i] = depth;
+        if (depth > maxDepth) maxDepth = depth;
+    }
+
+    // Counting sort by depth, the relative order of the nodes of a same level is kept
+
+    int *offsets = RL_CALLOC(maxDepth + 2, sizeof(int));
+
+    for (int i = 0; i < hierarchy->count; i++) {
+        offsets[hierarchy->depths[i] + 1]++;
+    }
+
+    for (int d = 1; d <= maxDepth + 1; d++) {
+        offsets[d] += offsets[d - 1];
+    }
+
+    for (int i = 0; i < hierarchy->count; i++) {
+        hierarchy->order[offsets[hierarchy->depths[i]]++] = i;
+    }
+
+    RL_FREE(offsets);
+
+    hierarchy->orderDirty = false;
+}
+
+static void UpdateNode(R3D_TransformHierarchy* hierarchy, int node)
+{
+    int parent = hierarchy->parents[node];
+
+    // The parents are always processed before their children,
+    // so a dirty parent propagates its flag to the whole subtree
+
+    if (parent >= 0 && hierarchy->dirty[parent]) {
+        hierarchy->dirty[node] = true;
+    }
+
+    if (!hierarchy->dirty[node]) {
+        return;
+    }
+
+    Matrix local = R3D_TransformToLocal(&hierarchy->locals[node]);
+
+    hierarchy->worlds[node] = (parent >= 0)
+        ? simdMatrixMultiplyAffine(local, hierarchy->worlds[parent])
+        : local;
+}
+
+/* Public API */
+
+R3D_TransformHierarchy R3D_LoadTransformHierarchy(int capacity)
+{
+    R3D_TransformHierarchy hierarchy = { 0 };
+
+    if (capacity <= 0) {
+        TraceLog(LOG_WARNING, "R3D: Invalid transform hierarchy capacity %i, it must be positive", capacity);
+        return hierarchy;
+    }
+
+    hierarchy.locals = RL_MALLOC(capacity * sizeof(R3D_Transform));
+    hierarchy.worlds = RL_MALLOC(capacity * sizeof(Matrix));
+    hierarchy.parents = RL_MALLOC(capacity * sizeof(int));
+    hierarchy.depths = RL_MALLOC(capacity * sizeof(int));
+    hierarchy.order = RL_MALLOC(capacity * sizeof(int));
+    hierarchy.dirty = RL_CALLOC(capacity, sizeof(bool));
+
+    if (!hierarchy.locals || !hierarchy.worlds || !hierarchy.parents ||
+        !hierarchy.depths || !hierarchy.order || !hierarchy.dirty) {
+        TraceLog(LOG_WARNING, "R3D: Failed to allocate a transform hierarchy of %i nodes", capacity);
+        R3D_UnloadTransformHierarchy(&hierarchy);
+        return hierarchy;
+    }
+
+    hierarchy.capacity = capacity;
+    hierarchy.count = 0;
+
+    return hierarchy;
+}
+
+void R3D_UnloadTransformHierarchy(R3D_TransformHierarchy* hierarchy)
+{
+    RL_FREE(hierarchy->locals);
+    RL_FREE(hierarchy->worlds);
+    RL_FREE(hierarchy->parents);
+    RL_FREE(hierarchy->depths);
+    RL_FREE(hierarchy->order);
+    RL_FREE(hierarchy->dirty);
+
+    *hierarchy = (R3D_TransformHierarchy) { 0 };
+}
+
+int R3D_AddTransformNode(R3D_TransformHierarchy* hierarchy, int parent, R3D_Transform local)
+{
+    if (hierarchy->count >= hierarchy->capacity || parent >= hierarchy->count) {
+        return -1;
+    }
+
+    int node = hierarchy->count++;
+
+    hierarchy->locals[node] = local;
+    hierarchy->worlds[node] = MatrixIdentity();
+    hierarchy->parents[node] = (parent < 0) ? -1 : parent;
+    hierarchy->depths[node] = 0;
+    hierarchy->order[node] = node;
+    hierarchy->dirty[node] = true;
+
+    hierarchy->orderDirty = true;
+
+    return node;
+}
+
+bool R3D_SetTransformNodeParent(R3D_TransformHierarchy* hierarchy, int node, int parent)
+{
+    if (node < 0 || node >= hierarchy->count || parent >= hierarchy->count) {
+        return false;
+    }
+
+    // Refuse the new parent if the node is one of its ancestors (or itself)
+
+    for (int ancestor = parent; ancestor >= 0; ancestor = hierarchy->parents[ancestor]) {
+        if (ancestor == node) {
+            return false;
+        }
+    }
+
+    hierarchy->parents[node] = (parent < 0) ? -1 : parent;
+    hierarchy->dirty[node] = true;
+    hierarchy->orderDirty = true;
+
+    return true;
+}
+
+void R3D_SetTransformNodeLocal(R3D_TransformHierarchy* hierarchy, int node, R3D_Transform local)
+{
+    if (!IsNodeValid(hierarchy, node)) {
+        return;
+    }
+
+    hierarchy->locals[node] = local;
+    hierarchy->dirty[node] = true;
+}
+
+R3D_Transform R3D_GetTransformNodeLocal(const R3D_TransformHierarchy* hierarchy, int node)
+{
+    if (!IsNodeValid(hierarchy, node)) {
+        return R3D_CreateTransformIdentity(NULL);
+    }
+
+    return hierarchy->locals[node];
+}
+
+Matrix R3D_GetTransformNodeWorld(const R3D_TransformHierarchy* hierarchy, int node)
+{
+    if (!IsNodeValid(hierarchy, node)) {
+        return MatrixIdentity();
+    }
+
+    return hierarchy->worlds[node];
+}
+
+void R3D_UpdateTransformHierarchy(R3D_TransformHierarchy* hierarchy)
+{
+    if (hierarchy->orderDirty) {
+        RebuildNodeOrder(hierarchy);
+    }
+
+    // Process the nodes level by level, the nodes of a same level
+    // only depend on the previous ones and can be updated in parallel
+
+    int begin = 0;
+
+    while (begin < hierarchy->count) {
+        int depth = hierarchy->depths[hierarchy->order[begin]];
+        int end = begin + 1;
+
+        while (end < hierarchy->count && hierarchy->depths[hierarchy->order[end]] == depth) {
+            end++;
+        }
+
+#ifdef _OPENMP
+#       pragma omp parallel for if (end - begin >= 256)
+#endif
+        for (int i = begin; i < end; i++) {
+            UpdateNode(hierarchy, hierarchy->order[i]);
+        }
+
+        begin = end;
+    }
+
+    memset(hierarchy->dirty, 0, hierarchy->count * sizeof(bool));
+}
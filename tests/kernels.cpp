@@ -0,0 +1,195 @@
+/**
+ * R3D - CPU kernel tests
+ *
+ * Checks the results of the math kernels of the hot CPU paths against reference values:
+ * frustum culling, bounding box transforms, CPU skinning and the curves evaluated over
+ * the lifetime of the particles. Like the microbenchmarks, these tests are built from the
+ * GL-free sources of the kernels only, and never create a window or a GL context.
+ */
+
+#include "test.hpp"
+
+#include <r3d.h>
+
+#include "detail/frustum.hpp"
+#include "detail/math.h"
+#include "objects/model.hpp"
+
+#include <cmath>
+#include <vector>
+
+
+/* Frustum */
+
+static r3d::Frustum testFrustum()
+{
+    // Camera at z = 10 looking at the origin, 90 degrees of vertical field of view
+    Matrix view = MatrixLookAt({ 0, 0, 10 }, { 0, 0, 0 }, { 0, 1, 0 });
+    Matrix proj = MatrixPerspective(90.0 * DEG2RAD, 1.0, 0.1, 100.0);
+    return r3d::Frustum(view, proj);
+}
+
+R3D_TEST(frustumPoints)
+{
+    r3d::Frustum frustum = testFrustum();
+
+    R3D_CHECK(frustum.pointIn({ 0, 0, 0 }));
+    R3D_CHECK(frustum.pointIn({ 5, 5, 0 }));        // Inside the corner of the field of view at distance 10
+    R3D_CHECK(!frustum.pointIn({ 0, 0, 20 }));      // Behind the camera
+    R3D_CHECK(!frustum.pointIn({ 0, 0, -100 }));    // Beyond the far plane
+    R3D_CHECK(!frustum.pointIn({ 11, 0, 0 }));      // Out of the field of view
+    R3D_CHECK(!frustum.pointIn({ 0, -11, 0 }));
+
+    R3D_CHECK(frustum.sphereIn({ 11, 0, 0 }, 2.0f));
+    R3D_CHECK(!frustum.sphereIn({ 20, 0, 0 }, 2.0f));
+}
+
+R3D_TEST(frustumAABB)
+{
+    r3d::Frustum frustum = testFrustum();
+
+    auto box = [](Vector3 min, Vector3 max) { return BoundingBox { min, max }; };
+
+    R3D_CHECK(frustum.aabbIn(box({ -1, -1, -1 }, { 1, 1, 1 })));
+    R3D_CHECK(frustum.aabbIn(box({ 8, -1, -1 }, { 12, 1, 1 })));        // Straddles the right plane
+    R3D_CHECK(frustum.aabbIn(box({ -1, -1, 5 }, { 1, 1, 15 })));        // Contains the camera
+    R3D_CHECK(frustum.aabbIn(box({ -50, -1, -1 }, { 50, 1, 1 })));      // All corners out, but crosses the frustum
+
+    R3D_CHECK(!frustum.aabbIn(box({ 12, -1, -1 }, { 14, 1, 1 })));
+    R3D_CHECK(!frustum.aabbIn(box({ -1, 12, -1 }, { 1, 14, 1 })));
+    R3D_CHECK(!frustum.aabbIn(box({ -1, -1, 11 }, { 1, 1, 13 })));      // Behind the camera
+    R3D_CHECK(!frustum.aabbIn(box({ -1, -1, -200 }, { 1, 1, -150 })));  // Beyond the far plane
+}
+
+
+/* Bounding boxes */
+
+R3D_TEST(transformBoundingBox)
+{
+    BoundingBox box = { { -1, -1, -1 }, { 1, 1, 1 } };
+
+    // Scale then translation, exact in floating point
+    Matrix transform = MatrixMultiply(MatrixScale(2, 2, 2), MatrixTranslate(1, 2, 3));
+    BoundingBox result = r3d::transformBoundingBox(box, transform);
+
+    R3D_CHECK(result.min.x == -1 && result.min.y == 0 && result.min.z == 1);
+    R3D_CHECK(result.max.x == 3 && result.max.y == 4 && result.max.z == 5);
+
+    // Same corners as raymath for any transform
+    transform = MatrixMultiply(MatrixRotateXYZ({ 0.3f, -1.2f, 2.5f }), MatrixTranslate(-4.5f, 0.25f, 7.0f));
+    result = r3d::transformBoundingBox(box, transform);
+
+    R3D_CHECK(r3d::test::bitEqual(result.min, Vector3Transform(box.min, transform)));
+    R3D_CHECK(r3d::test::bitEqual(result.max, Vector3Transform(box.max, transform)));
+}
+
+
+/* Skinning */
+
+R3D_TEST(skinMesh)
+{
+    // One vertex per bone, and one shared by the two translations
+    std::vector<float> vertices = { 1, 2, 3,  1, 2, 3,  1, 2, 3,  1, 2, 3 };
+    std::vector<float> normals = { 0, 0, 1,  0, 0, 1,  0, 0, 1,  0, 0, 1 };
+    std::vector<unsigned char> boneIds = { 0, 0, 0, 0,  1, 0, 0, 0,  2, 0, 0, 0,  0, 1, 0, 0 };
+    std::vector<float> boneWeights = { 1, 0, 0, 0,  1, 0, 0, 0,  1, 0, 0, 0,  0.5f, 0.5f, 0, 0 };
+
+    std::vector<Matrix> boneMatrices = {
+        MatrixTranslate(1, 0, 0),
+        MatrixTranslate(0, 2, 0),
+        MatrixScale(2, 2, 2)
+    };
+
+    std::vector<float> animVertices(vertices.size()), animNormals(normals.size());
+
+    Mesh mesh{};
+    mesh.vertexCount = 4;
+    mesh.vertices = vertices.data();
+    mesh.normals = normals.data();
+    mesh.animVertices = animVertices.data();
+    mesh.animNormals = animNormals.data();
+    mesh.boneIds = boneIds.data();
+    mesh.boneWeights = boneWeights.data();
+    mesh.boneCount = static_cast<int>(boneMatrices.size());
+    mesh.boneMatrices = boneMatrices.data();
+
+    R3D_CHECK(r3d::Model::skinMesh(mesh));
+
+    const std::vector<float> expectedVertices = { 2, 2, 3,  1, 4, 3,  2, 4, 6,  1.5f, 3, 3 };
+    R3D_CHECK(animVertices == expectedVertices);
+
+    // The translations keep the normals, the scale divides them (inverse transpose)
+    const std::vector<float> expectedNormals = { 0, 0, 1,  0, 0, 1,  0, 0, 0.5f,  0, 0, 1 };
+    R3D_CHECK(animNormals == expectedNormals);
+}
+
+
+/* Particles */
+
+R3D_TEST(evaluateCurve)
+{
+    R3D_InterpolationCurve curve = R3D_LoadInterpolationCurve(3);
+
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 0.5f) == 0.0f);     // Empty curve
+
+    R3D_AddKeyframe(&curve, 0.0f, 0.0f);
+    R3D_AddKeyframe(&curve, 0.5f, 1.0f);
+    R3D_AddKeyframe(&curve, 1.0f, 0.0f);
+
+    R3D_CHECK(R3D_EvaluateCurve(&curve, -1.0f) == 0.0f);    // Clamped before the first keyframe
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 0.0f) == 0.0f);
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 0.25f) == 0.5f);
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 0.5f) == 1.0f);
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 0.75f) == 0.5f);
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 1.0f) == 0.0f);
+    R3D_CHECK(R3D_EvaluateCurve(&curve, 2.0f) == 0.0f);     // Clamped after the last keyframe
+
+    R3D_UnloadInterpolationCurve(&curve);
+}
+
+R3D_TEST(particleCurves)
+{
+    R3D_InterpolationCurve scale = R3D_LoadInterpolationCurve(3);
+    R3D_AddKeyframe(&scale, 0.0f, 0.0f);
+    R3D_AddKeyframe(&scale, 0.5f, 1.0f);
+    R3D_AddKeyframe(&scale, 1.0f, 0.0f);
+
+    R3D_InterpolationCurve speed = R3D_LoadInterpolationCurve(2);
+    R3D_AddKeyframe(&speed, 0.0f, 1.0f);
+    R3D_AddKeyframe(&speed, 1.0f, 0.0f);
+
+    Mesh mesh{};
+    R3D_Material material{};
+
+    R3D_ParticleSystemCPU* system = R3D_LoadParticleEmitterCPU(&mesh, &material, 1);
+    system->initialScale = { 2, 2, 2 };
+    system->initialVelocity = { 0, 4, 0 };
+    system->gravity = { 0, 0, 0 };
+    system->emissionRate = 0.0f;
+    system->scaleOverLifetime = &scale;
+    system->speedOverLifetime = &speed;
+
+    R3D_CHECK(R3D_EmitParticleCPU(system));
+    R3D_CHECK(!R3D_EmitParticleCPU(system));    // Full
+
+    // A quarter of the lifetime: half the scale and three quarters of the speed
+    R3D_UpdateParticleEmitterCPU(system, 0.25f);
+    R3D_CHECK(system->particleCount == 1);
+    R3D_CHECK(system->particles[0].scale.x == 1.0f && system->particles[0].scale.y == 1.0f);
+    R3D_CHECK(system->particles[0].velocity.y == 3.0f);
+    R3D_CHECK(system->particles[0].position.y == 0.75f);
+
+    // Half the lifetime: full scale and half the speed
+    R3D_UpdateParticleEmitterCPU(system, 0.25f);
+    R3D_CHECK(system->particles[0].scale.z == 2.0f);
+    R3D_CHECK(system->particles[0].velocity.y == 2.0f);
+    R3D_CHECK(system->particles[0].position.y == 1.25f);
+
+    // End of the lifetime
+    R3D_UpdateParticleEmitterCPU(system, 0.5f);
+    R3D_CHECK(system->particleCount == 0);
+
+    R3D_UnloadParticleEmitterCPU(system);
+    R3D_UnloadInterpolationCurve(&speed);
+    R3D_UnloadInterpolationCurve(&scale);
+}
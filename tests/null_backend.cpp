@@ -0,0 +1,158 @@
+/**
+ * R3D - Null backend tests
+ *
+ * Renders small scenes with `R3D_FLAG_NULL_BACKEND`, without any window or GL context,
+ * and checks the binds and draws of the GL command stream returned by
+ * `R3D_GetRecordedCommands`: the draws added by each object, the programs bound once
+ * per batch of objects sharing a material, and the sprites merged into a single draw.
+ * The frames of the sprites packed into an atlas are also checked, the atlas texture
+ * being created through the stubs.
+ *
+ * The counts of a frame also include the fixed cost of the post-processing and the
+ * presentation, so they are compared between scenes that only differ by their objects.
+ */
+
+#include "test.hpp"
+
+#include <r3d.h>
+
+#include <functional>
+
+struct FrameCommands
+{
+    int draws = 0;
+    int programBinds = 0;
+};
+
+/**
+ * @brief Renders a frame, and counts the draws and program binds it recorded.
+ *
+ * The frame is rendered twice and the commands of the second one are counted,
+ * so that the resources created lazily during the first frame don't change the result.
+ */
+static FrameCommands renderFrame(const std::function<void()>& drawScene)
+{
+    Camera3D camera = { { 0, 2, 10 }, { 0, 0, 0 }, { 0, 1, 0 }, 60, CAMERA_PERSPECTIVE };
+
+    for (int i = 0; i < 2; i++) {
+        R3D_Begin(camera);
+        drawScene();
+        R3D_End();
+    }
+
+    FrameCommands result;
+
+    const R3D_Command* commands = R3D_GetRecordedCommands();
+    int count = R3D_GetRecordedCommandCount();
+
+    for (int i = 0; i < count; i++) {
+        switch (commands[i].type) {
+            case R3D_COMMAND_DRAW:
+                result.draws++;
+                break;
+            case R3D_COMMAND_BIND_PROGRAM:
+                result.programBinds += (commands[i].object != 0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return result;
+}
+
+R3D_TEST(nullBackendModels)
+{
+    R3D_InitEx(64, 64, R3D_FLAG_NULL_BACKEND);
+
+    R3D_Model cube = R3D_LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+
+    auto drawCubes = [&cube](int count) {
+        return [&cube, count]() {
+            for (int i = 0; i < count; i++) {
+                R3D_DrawModelEx(&cube, { -3.0f + 2.0f * i, 0.0f, 0.0f }, 1.0f);
+            }
+        };
+    };
+
+    FrameCommands empty = renderFrame([]() { });
+    FrameCommands one = renderFrame(drawCubes(1));
+    FrameCommands four = renderFrame(drawCubes(4));
+
+    R3D_CHECK(R3D_GetRecordedCommandCount() > 0);
+    R3D_CHECK(empty.draws > 0);     // Post-processing and presentation
+
+    // Each cube adds the same draws, and they all share the program of their material
+    R3D_CHECK(one.draws > empty.draws);
+    R3D_CHECK(four.draws - empty.draws == 4 * (one.draws - empty.draws));
+    R3D_CHECK(four.programBinds == one.programBinds);
+
+    R3D_UnloadModel(&cube);
+    R3D_Close();
+
+    R3D_CHECK(R3D_GetRecordedCommandCount() == 0);
+}
+
+R3D_TEST(nullBackendSprites)
+{
+    R3D_InitEx(64, 64, R3D_FLAG_NULL_BACKEND);
+
+    R3D_Sprite sprite = R3D_CreateSprite(*R3D_GetDefaultTextureWhite(), 1, 1);
+
+    auto drawSprites = [&sprite](int count) {
+        return [&sprite, count]() {
+            for (int i = 0; i < count; i++) {
+                R3D_DrawSpriteEx(&sprite, { -3.0f + 2.0f * i, 0.0f, 0.0f }, 1.0f);
+            }
+        };
+    };
+
+    FrameCommands empty = renderFrame([]() { });
+    FrameCommands one = renderFrame(drawSprites(1));
+    FrameCommands four = renderFrame(drawSprites(4));
+
+    // The sprites sharing their material and lights are merged into a single draw
+    R3D_CHECK(one.draws > empty.draws);
+    R3D_CHECK(four.draws == one.draws);
+    R3D_CHECK(four.programBinds == one.programBinds);
+
+    R3D_Close();
+}
+
+R3D_TEST(spriteAtlasFrames)
+{
+    R3D_InitEx(64, 64, R3D_FLAG_NULL_BACKEND);
+
+    R3D_SpriteAtlas atlas = R3D_LoadSpriteAtlas(256, 256, 2);
+
+    // A first spritesheet so that the second one does not start at the origin,
+    // the second having 3x2 frames of 40x20 pixels
+    Image first = GenImageColor(30, 50, RED);
+    Image second = GenImageColor(120, 40, BLUE);
+
+    R3D_CHECK(R3D_AddSpriteAtlasImage(&atlas, first) == 0);
+    int region = R3D_AddSpriteAtlasImage(&atlas, second);
+    R3D_CHECK(region == 1);
+
+    R3D_Sprite sprite = R3D_CreateSpriteFromAtlas(&atlas, region, 3, 2);
+    Rectangle bounds = atlas.regions[region];
+
+    R3D_CHECK(sprite.frameSize.x == 40.0f && sprite.frameSize.y == 20.0f);
+
+    // The frames are read row by row, without leaving the region of the spritesheet
+    for (int frame = 0; frame < 6; frame++) {
+        sprite.currentFrame = static_cast<float>(frame);
+        Rectangle rect = R3D_GetCurrentSpriteFrameRect(&sprite);
+
+        R3D_CHECK(rect.x == bounds.x + 40.0f * (frame % 3));
+        R3D_CHECK(rect.y == bounds.y + 20.0f * (frame / 3));
+        R3D_CHECK(rect.width == 40.0f && rect.height == 20.0f);
+        R3D_CHECK(rect.x + rect.width <= bounds.x + bounds.width);
+        R3D_CHECK(rect.y + rect.height <= bounds.y + bounds.height);
+    }
+
+    UnloadImage(second);
+    UnloadImage(first);
+    R3D_UnloadSpriteAtlas(&atlas);
+    R3D_Close();
+}
@@ -0,0 +1,227 @@
+/**
+ * R3D - Occlusion buffer tests
+ *
+ * Checks the coverage and the depth of the occluders rasterized by the `OcclusionBuffer`,
+ * their clipping against the near plane, the visibility of the bounding boxes behind them,
+ * and that the SIMD rasterization is bit-identical to the scalar one.
+ *
+ * Most tests use an identity view-projection, so that the vertices are given directly in
+ * normalized device coordinates and the expected coverage and depths are exact.
+ */
+
+#include "test.hpp"
+#include "scalar_kernels.hpp"
+
+#include "detail/occlusion_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr int WIDTH = 64;
+static constexpr int HEIGHT = 64;
+
+/**
+ * @brief Geometry of an occluder, referenced by the `Mesh` it returns.
+ */
+struct Geometry
+{
+    std::vector<float> vertices;
+    std::vector<unsigned short> indices;
+
+    Mesh mesh()
+    {
+        Mesh mesh{};
+        mesh.vertexCount = static_cast<int>(vertices.size() / 3);
+        mesh.vertices = vertices.data();
+        if (!indices.empty()) {
+            mesh.triangleCount = static_cast<int>(indices.size() / 3);
+            mesh.indices = indices.data();
+        }
+        return mesh;
+    }
+};
+
+/**
+ * @brief Quad covering [x0, x1] x [y0, y1] in NDC, whose depth (NDC z) is given at its four corners.
+ */
+static Geometry quad(float x0, float y0, float x1, float y1, float z00, float z10, float z01, float z11)
+{
+    return Geometry {
+        { x0, y0, z00,  x1, y0, z10,  x1, y1, z11,  x0, y1, z01 },
+        { 0, 1, 2,  0, 2, 3 }
+    };
+}
+
+static float depthAt(const std::vector<float>& depth, int x, int y)
+{
+    return depth[y * WIDTH + x];
+}
+
+R3D_TEST(occlusionQuadCoverage)
+{
+    // Quad over the pixels [16, 47] at NDC depth 0, i.e. 0.5 in the buffer
+    Geometry geometry = quad(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    r3d::OcclusionBuffer buffer(WIDTH, HEIGHT);
+    buffer.begin(MatrixIdentity());
+
+    R3D_CHECK(buffer.empty());
+    R3D_CHECK(buffer.addOccluder(geometry.mesh(), MatrixIdentity()) == 2);
+    R3D_CHECK(!buffer.empty());
+
+    const std::vector<float>& depth = buffer.depth();
+    R3D_CHECK(static_cast<int>(depth.size()) == WIDTH * HEIGHT);
+
+    int covered = 0, wrong = 0;
+
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            bool inside = (x >= 16 && x < 48 && y >= 16 && y < 48);
+            float expected = inside ? 0.5f : 1.0f;
+            covered += inside && depthAt(depth, x, y) == 0.5f;
+            wrong += depthAt(depth, x, y) != expected;
+        }
+    }
+
+    R3D_CHECK(covered == 32 * 32);
+    R3D_CHECK(wrong == 0);
+
+    // A new frame clears the buffer
+    buffer.begin(MatrixIdentity());
+    R3D_CHECK(buffer.empty());
+    R3D_CHECK(buffer.depth()[32 * WIDTH + 32] == 1.0f);
+}
+
+R3D_TEST(occlusionQuadDepth)
+{
+    // Full screen quad whose NDC depth goes from -0.5 on the left to 0.5 on the right,
+    // the depth of the buffer being linear in screen space: 0.25 + 0.5 * (x + 0.5) / WIDTH
+    Geometry geometry = quad(-1.0f, -1.0f, 1.0f, 1.0f, -0.5f, 0.5f, -0.5f, 0.5f);
+
+    r3d::OcclusionBuffer buffer(WIDTH, HEIGHT);
+    buffer.begin(MatrixIdentity());
+    buffer.addOccluder(geometry.mesh(), MatrixIdentity());
+
+    const std::vector<float>& depth = buffer.depth();
+    int wrong = 0;
+
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            float expected = 0.25f + 0.5f * (x + 0.5f) / WIDTH;
+            wrong += std::fabs(depthAt(depth, x, y) - expected) > 1e-5f;
+        }
+    }
+
+    R3D_CHECK(wrong == 0);
+}
+
+R3D_TEST(occlusionNearClipping)
+{
+    // Full screen quad whose NDC depth goes from -3 on the left to 1 on the right: the part
+    // nearer than the near plane (z < -w, the left half) must be clipped, not projected
+    Geometry geometry = quad(-1.0f, -1.0f, 1.0f, 1.0f, -3.0f, 1.0f, -3.0f, 1.0f);
+
+    r3d::OcclusionBuffer buffer(WIDTH, HEIGHT);
+    buffer.begin(MatrixIdentity());
+
+    // The triangle with one vertex behind the near plane is clipped into a quadrilateral,
+    // i.e. two triangles, the one with two vertices behind into a smaller triangle
+    R3D_CHECK(buffer.addOccluder(geometry.mesh(), MatrixIdentity()) == 3);
+
+    const std::vector<float>& depth = buffer.depth();
+    int wrong = 0;
+
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            float d = depthAt(depth, x, y);
+            if (x < WIDTH / 2) {
+                wrong += (d != 1.0f);
+            } else {
+                float expected = -1.0f + 2.0f * ((x + 0.5f) / WIDTH - 0.5f) * 2.0f;
+                wrong += std::fabs(d - (expected * 0.5f + 0.5f)) > 1e-5f;
+            }
+        }
+    }
+
+    R3D_CHECK(wrong == 0);
+
+    // Entirely behind the near plane
+    Geometry behind = quad(-1.0f, -1.0f, 1.0f, 1.0f, -2.0f, -2.0f, -2.0f, -2.0f);
+    buffer.begin(MatrixIdentity());
+    R3D_CHECK(buffer.addOccluder(behind.mesh(), MatrixIdentity()) == 0);
+    R3D_CHECK(buffer.empty());
+}
+
+R3D_TEST(occlusionAABB)
+{
+    // Occluder over the pixels [16, 47] at a depth of 0.5
+    Geometry geometry = quad(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    r3d::OcclusionBuffer buffer(WIDTH, HEIGHT);
+    buffer.begin(MatrixIdentity());
+
+    BoundingBox hidden = { { -0.25f, -0.25f, 0.2f }, { 0.25f, 0.25f, 0.8f } };
+    R3D_CHECK(buffer.aabbIn(hidden));   // No occluder yet
+
+    buffer.addOccluder(geometry.mesh(), MatrixIdentity());
+
+    R3D_CHECK(!buffer.aabbIn(hidden));
+    R3D_CHECK(!buffer.aabbIn({ { -0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, 0.9f } }));   // Exactly behind the occluder
+
+    R3D_CHECK(buffer.aabbIn({ { -0.25f, -0.25f, -0.5f }, { 0.25f, 0.25f, -0.2f } }));  // In front
+    R3D_CHECK(buffer.aabbIn({ { 0.25f, -0.25f, 0.2f }, { 0.75f, 0.25f, 0.8f } }));     // Partially visible beside
+    R3D_CHECK(buffer.aabbIn({ { -0.25f, -0.25f, -0.2f }, { 0.25f, 0.25f, 0.2f } }));   // Straddles the occluder
+    R3D_CHECK(buffer.aabbIn({ { -0.25f, -0.25f, -2.0f }, { 0.25f, 0.25f, 0.8f } }));   // Crosses the near plane
+    R3D_CHECK(buffer.aabbIn({ { 2.0f, 2.0f, 0.2f }, { 3.0f, 3.0f, 0.8f } }));          // Out of the screen
+}
+
+R3D_TEST(occlusionSIMDMatchesScalar)
+{
+    // Random triangles seen in perspective, some of them crossing the near plane
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+
+    Geometry geometry;
+    for (int i = 0; i < 3 * 200; i++) {
+        geometry.vertices.push_back(position(random));
+        geometry.vertices.push_back(position(random));
+        geometry.vertices.push_back(position(random) - 15.0f);
+    }
+
+    std::vector<BoundingBox> boxes;
+    for (int i = 0; i < 500; i++) {
+        Vector3 min = { position(random), position(random), position(random) - 15.0f };
+        boxes.push_back({ min, Vector3Add(min, { 1.0f, 1.0f, 1.0f }) });
+    }
+
+    Matrix view = MatrixLookAt({ 0, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 });
+    Matrix proj = MatrixPerspective(60.0 * DEG2RAD, 1.0, 0.5, 100.0);
+    Matrix viewProj = MatrixMultiply(view, proj);
+
+    Mesh mesh = geometry.mesh();
+
+    r3d::OcclusionBuffer buffer(WIDTH, HEIGHT);
+    buffer.begin(viewProj);
+    buffer.addOccluder(mesh, MatrixIdentity());
+
+    std::vector<bool> visible;
+    for (const BoundingBox& box : boxes) {
+        visible.push_back(buffer.aabbIn(box));
+    }
+
+    std::vector<bool> visibleScalar;
+    std::vector<float> depthScalar = scalar::occlusionBuffer(WIDTH, HEIGHT, viewProj, mesh, boxes, visibleScalar);
+
+    const std::vector<float>& depth = buffer.depth();
+
+    R3D_CHECK(depth.size() == depthScalar.size());
+    R3D_CHECK(std::memcmp(depth.data(), depthScalar.data(), depth.size() * sizeof(float)) == 0);
+    R3D_CHECK(visible == visibleScalar);
+
+    // The scene must actually cover and hide something for the comparison to be meaningful
+    R3D_CHECK(std::count(depth.begin(), depth.end(), 1.0f) < static_cast<long>(depth.size()));
+    R3D_CHECK(std::count(visible.begin(), visible.end(), false) > 0);
+}
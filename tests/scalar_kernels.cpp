@@ -0,0 +1,58 @@
+/**
+ * R3D - Scalar build of the SIMD kernels
+ *
+ * The headers of the kernels are included in the namespace `scalar` with `R3D_NO_SIMD` defined,
+ * so that they don't conflict with the SIMD build. Their own dependencies are included first,
+ * their include guards then keeping them out of the namespace.
+ */
+
+#include "scalar_kernels.hpp"
+
+#include <raylib.h>
+#include <raymath.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <cmath>
+
+#define R3D_NO_SIMD
+
+namespace scalar {
+#include "detail/simd.h"
+#include "detail/occlusion_buffer.hpp"
+}
+
+#if !defined(R3D_SIMD_SCALAR)
+#   error "The scalar kernels must be built without SIMD"
+#endif
+
+Matrix scalar::matrixMultiply(Matrix left, Matrix right)
+{
+    return simdMatrixMultiply(left, right);
+}
+
+Matrix scalar::matrixMultiplyAffine(Matrix left, Matrix right)
+{
+    return simdMatrixMultiplyAffine(left, right);
+}
+
+Vector3 scalar::vector3Transform(Vector3 v, Matrix mat)
+{
+    return simdVector3Transform(v, mat);
+}
+
+std::vector<float> scalar::occlusionBuffer(int width, int height, const Matrix& viewProj, const Mesh& mesh,
+                                           const std::vector<BoundingBox>& boxes, std::vector<bool>& visible)
+{
+    r3d::OcclusionBuffer buffer(width, height);
+    buffer.begin(viewProj);
+    buffer.addOccluder(mesh, MatrixIdentity());
+
+    visible.clear();
+    for (const BoundingBox& box : boxes) {
+        visible.push_back(buffer.aabbIn(box));
+    }
+
+    return buffer.depth();
+}
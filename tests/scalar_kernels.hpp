@@ -0,0 +1,33 @@
+/**
+ * R3D - Scalar build of the SIMD kernels
+ *
+ * The kernels of 'detail/simd.h' and the `OcclusionBuffer` compiled with their scalar fallback
+ * (`R3D_NO_SIMD`), so that the tests can compare them to the SIMD build, used by the rest of the
+ * executable.
+ */
+
+#ifndef R3D_TESTS_SCALAR_KERNELS_HPP
+#define R3D_TESTS_SCALAR_KERNELS_HPP
+
+#include <raylib.h>
+
+#include <vector>
+
+namespace scalar {
+
+Matrix matrixMultiply(Matrix left, Matrix right);
+Matrix matrixMultiplyAffine(Matrix left, Matrix right);
+Vector3 vector3Transform(Vector3 v, Matrix mat);
+
+/**
+ * @brief Adds a mesh as occluder to an `OcclusionBuffer`, then tests the bounding boxes against it.
+ * 
+ * @param visible Receives the result of `aabbIn` for each box.
+ * @return The depth buffer, see `OcclusionBuffer::depth`.
+ */
+std::vector<float> occlusionBuffer(int width, int height, const Matrix& viewProj, const Mesh& mesh,
+                                   const std::vector<BoundingBox>& boxes, std::vector<bool>& visible);
+
+} // namespace scalar
+
+#endif // R3D_TESTS_SCALAR_KERNELS_HPP
@@ -0,0 +1,73 @@
+/**
+ * R3D - SIMD kernel tests
+ *
+ * Checks that the matrix and vector kernels of 'detail/simd.h' are bit-identical to their
+ * raymath counterparts, in both their SIMD build (SSE or NEON, when available) and their
+ * scalar fallback. This requires the multiplications and additions not to be contracted
+ * into FMA instructions, see the options of the test target.
+ */
+
+#include "test.hpp"
+#include "scalar_kernels.hpp"
+
+#include "detail/simd.h"
+
+#include <random>
+
+static std::mt19937 gRandom(1234);
+
+static float randomFloat(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(gRandom);
+}
+
+static Matrix randomMatrix()
+{
+    Matrix mat;
+    float* values = &mat.m0;
+    for (int i = 0; i < 16; i++) {
+        values[i] = randomFloat(-10.0f, 10.0f);
+    }
+    return mat;
+}
+
+static Matrix randomAffineMatrix()
+{
+    Matrix mat = randomMatrix();
+    mat.m3 = 0.0f;
+    mat.m7 = 0.0f;
+    mat.m11 = 0.0f;
+    mat.m15 = 1.0f;
+    return mat;
+}
+
+R3D_TEST(simdMatrixMultiply)
+{
+    for (int i = 0; i < 1000; i++) {
+        Matrix a = randomMatrix(), b = randomMatrix();
+        Matrix expected = MatrixMultiply(a, b);
+        R3D_CHECK(r3d::test::bitEqual(simdMatrixMultiply(a, b), expected));
+        R3D_CHECK(r3d::test::bitEqual(scalar::matrixMultiply(a, b), expected));
+    }
+}
+
+R3D_TEST(simdMatrixMultiplyAffine)
+{
+    for (int i = 0; i < 1000; i++) {
+        Matrix a = randomAffineMatrix(), b = randomAffineMatrix();
+        Matrix expected = MatrixMultiply(a, b);
+        R3D_CHECK(r3d::test::bitEqual(simdMatrixMultiplyAffine(a, b), expected));
+        R3D_CHECK(r3d::test::bitEqual(scalar::matrixMultiplyAffine(a, b), expected));
+    }
+}
+
+R3D_TEST(simdVector3Transform)
+{
+    for (int i = 0; i < 1000; i++) {
+        Matrix mat = randomMatrix();
+        Vector3 v = { randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f) };
+        Vector3 expected = Vector3Transform(v, mat);
+        R3D_CHECK(r3d::test::bitEqual(simdVector3Transform(v, mat), expected));
+        R3D_CHECK(r3d::test::bitEqual(scalar::vector3Transform(v, mat), expected));
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * R3D - Test runner
+ *
+ * Runs the tests linked into the executable and returns a non-zero status if any check failed.
+ *
+ * Usage: <test executable> [filter]
+ *     filter                  Runs only the tests whose name contains this text
+ */
+
+#include "test.hpp"
+
+#include <cstdio>
+
+static const char* gCurrent = nullptr;
+static int gFailures = 0;
+
+std::vector<r3d::test::Case>& r3d::test::cases()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void r3d::test::fail(const char* file, int line, const char* expression)
+{
+    std::printf("%s:%d: %s: check failed: %s\n", file, line, gCurrent, expression);
+    gFailures++;
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = (argc > 1) ? argv[1] : nullptr;
+    int run = 0, failed = 0;
+
+    for (const r3d::test::Case& test : r3d::test::cases()) {
+        if (filter != nullptr && std::strstr(test.name, filter) == nullptr) {
+            continue;
+        }
+
+        gCurrent = test.name;
+        int failures = gFailures;
+        test.function();
+
+        bool ok = (gFailures == failures);
+        std::printf("[%s] %s\n", ok ? "  OK  " : " FAIL ", test.name);
+
+        failed += !ok;
+        run++;
+    }
+
+    std::printf("%d tests, %d failed\n", run, failed);
+
+    return (failed > 0) ? 1 : 0;
+}
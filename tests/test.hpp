@@ -0,0 +1,59 @@
+/**
+ * R3D - Minimal test harness
+ *
+ * The tests are functions declared with `R3D_TEST`, which registers them before `main`
+ * runs, and checking their expectations with `R3D_CHECK`. A failed check is reported
+ * with its location and the test continues, so that all the failures are listed.
+ */
+
+#ifndef R3D_TESTS_TEST_HPP
+#define R3D_TESTS_TEST_HPP
+
+#include <cstring>
+#include <vector>
+
+namespace r3d::test {
+
+struct Case
+{
+    const char* name;
+    void (*function)();
+};
+
+/**
+ * @brief Returns the registered tests, in the order of their registration.
+ */
+std::vector<Case>& cases();
+
+/**
+ * @brief Reports a failed check of the running test.
+ */
+void fail(const char* file, int line, const char* expression);
+
+struct Registrar
+{
+    Registrar(const char* name, void (*function)()) {
+        cases().push_back({ name, function });
+    }
+};
+
+/**
+ * @brief Compares the bytes of two values, to check that the results of two kernels are bit-identical.
+ */
+template <typename T>
+bool bitEqual(const T& a, const T& b)
+{
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+} // namespace r3d::test
+
+#define R3D_TEST(name) \
+    static void name(); \
+    static r3d::test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define R3D_CHECK(expression) \
+    do { if (!(expression)) r3d::test::fail(__FILE__, __LINE__, #expression); } while (0)
+
+#endif // R3D_TESTS_TEST_HPP